@@ -0,0 +1,154 @@
+﻿#include <array>
+#include <atomic>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/containers/concurrent_id_slotmap.hpp>
+#include <fea/containers/id_slotmap.hpp>
+#include <fea/performance/thread.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <thread>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_keys = 100'000;
+constexpr size_t num_lookups = 2'000'000;
+#else
+constexpr size_t num_keys = 10'000;
+constexpr size_t num_lookups = 200'000;
+#endif
+
+struct small_obj {
+	float x{ 42 };
+	float y{ 42 };
+	float z{ 42 };
+};
+
+// Runs func(thread_idx) on num_t threads. If with_writer, a thread
+// continuously writes using write_func until readers are done.
+template <class Func, class WriteFunc>
+void run_readers(size_t num_t, Func&& func, bool with_writer,
+		WriteFunc&& write_func) {
+	std::atomic<bool> done{ false };
+	std::thread writer;
+	if (with_writer) {
+		writer = std::thread{ [&]() {
+			size_t i = 0;
+			while (!done.load(std::memory_order_relaxed)) {
+				write_func(i++ % num_keys);
+			}
+		} };
+	}
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_t);
+	for (size_t t = 0; t < num_t; ++t) {
+		threads.emplace_back(func, t);
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+
+	done = true;
+	if (writer.joinable()) {
+		writer.join();
+	}
+}
+
+void benchmarks(size_t num_t, bool with_writer) {
+	std::vector<size_t> keys;
+	{
+		std::mt19937_64 gen{ 42 };
+		std::uniform_int_distribution<size_t> dis{ 0, num_keys - 1 };
+		keys.reserve(num_lookups);
+		for (size_t i = 0; i < num_lookups; ++i) {
+			keys.push_back(dis(gen));
+		}
+	}
+
+	fea::mtx_safe<fea::id_slotmap<size_t, small_obj>> locked_map;
+	fea::concurrent_id_slotmap<size_t, small_obj> conc_map{ num_keys };
+	locked_map.write([](fea::id_slotmap<size_t, small_obj>& map) {
+		for (size_t i = 0; i < num_keys; ++i) {
+			map.insert({ i, { float(i), float(i), float(i) } });
+		}
+	});
+	for (size_t i = 0; i < num_keys; ++i) {
+		conc_map.insert(i, { float(i), float(i), float(i) });
+	}
+
+	std::vector<float> sums(num_t);
+	const size_t per_thread = num_lookups / num_t;
+
+	std::array<char, 128> title;
+	title.fill('\0');
+	std::snprintf(title.data(), title.size(),
+			"%zu lookups, %zu reader threads, %s", per_thread * num_t, num_t,
+			with_writer ? "1 writer" : "no writer");
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+	suite.benchmark("mtx_safe<id_slotmap> find", [&]() {
+		run_readers(
+				num_t,
+				[&](size_t t) {
+					float sum = 0.f;
+					for (size_t i = t * per_thread; i < (t + 1) * per_thread;
+							++i) {
+						locked_map.read(
+								[&](const fea::id_slotmap<size_t, small_obj>&
+												map) {
+									auto it = map.find(keys[i]);
+									if (it != map.end()) {
+										sum += it->second.x;
+									}
+								});
+					}
+					sums[t] = sum;
+				},
+				with_writer,
+				[&](size_t k) {
+					locked_map.write(
+							[&](fea::id_slotmap<size_t, small_obj>& map) {
+								map.insert_or_assign(k, small_obj{});
+							});
+				});
+	});
+
+	suite.benchmark("concurrent_id_slotmap find", [&]() {
+		run_readers(
+				num_t,
+				[&](size_t t) {
+					float sum = 0.f;
+					for (size_t i = t * per_thread; i < (t + 1) * per_thread;
+							++i) {
+						decltype(conc_map)::read_guard g{ conc_map };
+						const small_obj* v = conc_map.find(keys[i], g);
+						if (v != nullptr) {
+							sum += v->x;
+						}
+					}
+					sums[t] = sum;
+				},
+				with_writer,
+				[&](size_t k) { conc_map.insert_or_assign(k, small_obj{}); });
+	});
+	suite.print();
+
+	float total = 0.f;
+	for (float f : sums) {
+		total += f;
+	}
+	printf("sum : %f\n\n", total);
+}
+
+TEST(concurrent_id_slotmap, benchmarks) {
+	const size_t max_t = fea::num_threads();
+	for (size_t num_t = 1; num_t <= max_t; num_t *= 2) {
+		benchmarks(num_t, false);
+		benchmarks(num_t, true);
+	}
+}
+} // namespace
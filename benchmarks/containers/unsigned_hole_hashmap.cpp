@@ -2,6 +2,7 @@
 #include <array>
 #include <cstdio>
 #include <fea/benchmark/benchmark.hpp>
+#include <fea/containers/unsigned_group_hashmap.hpp>
 #include <fea/containers/unsigned_hole_hashmap.hpp>
 #include <fea/utility/platform.hpp>
 #include <gtest/gtest.h>
@@ -58,10 +59,12 @@ void benchmarks(const std::vector<size_t>& keys) {
 	std::map<size_t, small_obj> map_small;
 	std::unordered_map<size_t, small_obj> unordered_map_small;
 	fea::unsigned_hole_hashmap<size_t, small_obj> unsigned_map_small;
+	fea::unsigned_group_hashmap<size_t, small_obj> group_map_small;
 
 	std::map<size_t, big_obj> map_big;
 	std::unordered_map<size_t, big_obj> unordered_map_big;
 	fea::unsigned_hole_hashmap<size_t, big_obj> unsigned_map_big;
+	fea::unsigned_group_hashmap<size_t, big_obj> group_map_big;
 
 
 	// Preheat
@@ -75,6 +78,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_small.insert(keys[i], { float(i), float(i), float(i) });
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_small.insert(keys[i], { float(i), float(i), float(i) });
+	}
 	for (size_t i = 0; i < keys.size(); ++i) {
 		map_big.insert({ keys[i], {} });
 	}
@@ -84,6 +90,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_big.insert(keys[i], {});
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_big.insert(keys[i], {});
+	}
 	printf("Num unique keys : %zu\n\n", map_small.size());
 	// printf("%zu\n", unordered_map_small.size());
 	// printf("%zu\n", unsigned_map_small.size());
@@ -110,6 +119,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	suite.benchmark("fea::unsigned_hole_hashmap copy ctor", [&]() {
 		fea::unsigned_hole_hashmap<size_t, small_obj> cpy(unsigned_map_small);
 	});
+	suite.benchmark("fea::unsigned_group_hashmap copy ctor", [&]() {
+		fea::unsigned_group_hashmap<size_t, small_obj> cpy(group_map_small);
+	});
 	suite.print();
 
 
@@ -127,6 +139,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	suite.benchmark("fea::unsigned_hole_hashmap copy ctor", [&]() {
 		fea::unsigned_hole_hashmap<size_t, big_obj> cpy(unsigned_map_big);
 	});
+	suite.benchmark("fea::unsigned_group_hashmap copy ctor", [&]() {
+		fea::unsigned_group_hashmap<size_t, big_obj> cpy(group_map_big);
+	});
 	suite.print();
 
 
@@ -141,6 +156,8 @@ void benchmarks(const std::vector<size_t>& keys) {
 			"std::unordered_map clear", [&]() { unordered_map_small.clear(); });
 	suite.benchmark("fea::unsigned_hole_hashmap clear",
 			[&]() { unsigned_map_small.clear(); });
+	suite.benchmark("fea::unsigned_group_hashmap clear",
+			[&]() { group_map_small.clear(); });
 	suite.print();
 
 	// Bench : clear big
@@ -154,6 +171,8 @@ void benchmarks(const std::vector<size_t>& keys) {
 			"std::unordered_map clear", [&]() { unordered_map_big.clear(); });
 	suite.benchmark("fea::unsigned_hole_hashmap clear",
 			[&]() { unsigned_map_big.clear(); });
+	suite.benchmark("fea::unsigned_group_hashmap clear",
+			[&]() { group_map_big.clear(); });
 	suite.print();
 
 
@@ -180,10 +199,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 					keys[i], { float(i), float(i), float(i) });
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap insert", [&]() {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			group_map_small.insert(keys[i], { float(i), float(i), float(i) });
+		}
+	});
 	suite.print();
 	map_small.clear();
 	unordered_map_small.clear();
 	unsigned_map_small.clear();
+	group_map_small.clear();
 
 
 	// Bench : insert big_obj
@@ -207,10 +232,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 			unsigned_map_big.insert(keys[i], {});
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap insert", [&]() {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			group_map_big.insert(keys[i], {});
+		}
+	});
 	suite.print();
 	map_big.clear();
 	unordered_map_big.clear();
 	unsigned_map_big.clear();
+	group_map_big.clear();
 
 
 	// Bench : erase small_obj
@@ -224,6 +255,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_small.insert(keys[i], { float(i), float(i), float(i) });
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_small.insert(keys[i], { float(i), float(i), float(i) });
+	}
 
 	title.fill('\0');
 	std::snprintf(title.data(), title.size(),
@@ -252,10 +286,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 			unsigned_map_small.erase(random_keys[i]);
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap erase", [&]() {
+		for (size_t i = 0; i < random_keys.size(); ++i) {
+			group_map_small.erase(random_keys[i]);
+		}
+	});
 	suite.print();
 	map_small.clear();
 	unordered_map_small.clear();
 	unsigned_map_small.clear();
+	group_map_small.clear();
 
 
 	// Bench : erase big_obj
@@ -268,6 +308,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_big.insert(keys[i], {});
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_big.insert(keys[i], {});
+	}
 
 	title.fill('\0');
 	std::snprintf(title.data(), title.size(),
@@ -289,10 +332,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 			unsigned_map_big.erase(random_keys[i]);
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap erase", [&]() {
+		for (size_t i = 0; i < random_keys.size(); ++i) {
+			group_map_big.erase(random_keys[i]);
+		}
+	});
 	suite.print();
 	map_big.clear();
 	unordered_map_big.clear();
 	unsigned_map_big.clear();
+	group_map_big.clear();
 
 
 	// Bench : insert small_obj reserves
@@ -303,6 +352,7 @@ void benchmarks(const std::vector<size_t>& keys) {
 
 	unordered_map_small.reserve(keys.size());
 	unsigned_map_small.reserve(keys.size());
+	group_map_small.reserve(keys.size());
 
 	suite.benchmark("std::map insert", [&]() {
 		for (size_t i = 0; i < keys.size(); ++i) {
@@ -319,10 +369,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 			unsigned_map_small.insert(keys[i], {});
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap insert", [&]() {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			group_map_small.insert(keys[i], {});
+		}
+	});
 	suite.print();
 	map_big.clear();
 	unordered_map_small.clear();
 	unsigned_map_small.clear();
+	group_map_small.clear();
 
 
 	// Bench : insert big_obj reserves
@@ -333,6 +389,7 @@ void benchmarks(const std::vector<size_t>& keys) {
 
 	unordered_map_big.reserve(keys.size());
 	unsigned_map_big.reserve(keys.size());
+	group_map_big.reserve(keys.size());
 
 	suite.benchmark("std::map insert", [&]() {
 		for (size_t i = 0; i < keys.size(); ++i) {
@@ -349,10 +406,16 @@ void benchmarks(const std::vector<size_t>& keys) {
 			unsigned_map_big.insert(keys[i], {});
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap insert", [&]() {
+		for (size_t i = 0; i < keys.size(); ++i) {
+			group_map_big.insert(keys[i], {});
+		}
+	});
 	suite.print();
 	map_big.clear();
 	unordered_map_big.clear();
 	unsigned_map_big.clear();
+	group_map_big.clear();
 
 
 	// Bench : Iterate and assign value small_obj
@@ -366,6 +429,71 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_small.insert(keys[i], { float(i), float(i), float(i) });
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_small.insert(keys[i], { float(i), float(i), float(i) });
+	}
+
+	// Bench : find small_obj
+	{
+		std::vector<size_t> find_keys = keys;
+		std::mt19937_64 find_urng(rng());
+		std::shuffle(find_keys.begin(), find_keys.end(), find_urng);
+
+		title.fill('\0');
+		std::snprintf(title.data(), title.size(),
+				"Find %zu small objects at random", find_keys.size());
+		suite.title(title.data());
+
+		float sum = 0.f;
+		suite.benchmark("std::map find", [&]() {
+			for (size_t k : find_keys) {
+				sum += map_small.find(k)->second.x;
+			}
+		});
+		suite.benchmark("std::unordered_map find", [&]() {
+			for (size_t k : find_keys) {
+				sum += unordered_map_small.find(k)->second.x;
+			}
+		});
+		suite.benchmark("fea::unsigned_hole_hashmap find", [&]() {
+			for (size_t k : find_keys) {
+				sum += unsigned_map_small.find(k)->x;
+			}
+		});
+		suite.benchmark("fea::unsigned_group_hashmap find", [&]() {
+			for (size_t k : find_keys) {
+				sum += group_map_small.find(k)->x;
+			}
+		});
+		suite.print();
+
+		// Misses, the worst case for probing.
+		const size_t miss_offset = num_keys * 4;
+		suite.title("Find missing keys");
+		size_t found = 0;
+		suite.benchmark("std::map find miss", [&]() {
+			for (size_t k : find_keys) {
+				found += map_small.count(k + miss_offset);
+			}
+		});
+		suite.benchmark("std::unordered_map find miss", [&]() {
+			for (size_t k : find_keys) {
+				found += unordered_map_small.count(k + miss_offset);
+			}
+		});
+		suite.benchmark("fea::unsigned_hole_hashmap find miss", [&]() {
+			for (size_t k : find_keys) {
+				found += unsigned_map_small.count(k + miss_offset);
+			}
+		});
+		suite.benchmark("fea::unsigned_group_hashmap find miss", [&]() {
+			for (size_t k : find_keys) {
+				found += group_map_small.count(k + miss_offset);
+			}
+		});
+		suite.print();
+		printf("%f %zu\n\n", sum, found);
+	}
 
 	title.fill('\0');
 	std::snprintf(title.data(), title.size(),
@@ -388,11 +516,17 @@ void benchmarks(const std::vector<size_t>& keys) {
 			p.y = float(rand() % 100);
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap iterate & assign", [&]() {
+		for (auto& p : group_map_small) {
+			p.y = float(rand() % 100);
+		}
+	});
 	suite.print();
 
 	map_small.clear();
 	unordered_map_small.clear();
 	unsigned_map_small.clear();
+	group_map_small.clear();
 
 
 	// Bench : Iterate and assign value big_obj
@@ -405,6 +539,9 @@ void benchmarks(const std::vector<size_t>& keys) {
 	for (size_t i = 0; i < keys.size(); ++i) {
 		unsigned_map_big.insert(keys[i], {});
 	}
+	for (size_t i = 0; i < keys.size(); ++i) {
+		group_map_big.insert(keys[i], {});
+	}
 
 	title.fill('\0');
 	std::snprintf(title.data(), title.size(),
@@ -427,11 +564,17 @@ void benchmarks(const std::vector<size_t>& keys) {
 			p.data.fill(rand() % 100);
 		}
 	});
+	suite.benchmark("fea::unsigned_group_hashmap iterate & assign", [&]() {
+		for (auto& p : group_map_big) {
+			p.data.fill(rand() % 100);
+		}
+	});
 	suite.print();
 
 	map_big.clear();
 	unordered_map_big.clear();
 	unsigned_map_big.clear();
+	group_map_big.clear();
 }
 
 
@@ -0,0 +1,122 @@
+﻿#include <array>
+#include <cstdio>
+#include <deque>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/encoding/base64.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_bytes = 64 * 1024 * 1024;
+#else
+constexpr size_t num_bytes = 8 * 1024 * 1024;
+#endif
+
+// Prints the throughput of every result, before they are cleared.
+void print(fea::bench::suite& suite, size_t bytes) {
+	std::vector<std::pair<std::string, double>> throughputs;
+	for (const fea::bench::result& r : suite.results()) {
+		throughputs.push_back({ r.name, double(bytes) / r.mean / 1e9 });
+	}
+	suite.print();
+
+	for (const auto& [name, gbs] : throughputs) {
+		printf("%s%*.2f GB/s\n", name.c_str(), 70 - int(name.size()), gbs);
+	}
+	printf("\n");
+}
+
+TEST(base64, benchmarks) {
+	std::mt19937 gen{ 42 };
+	std::vector<uint8_t> data(num_bytes);
+	for (uint8_t& b : data) {
+		b = uint8_t(gen());
+	}
+	const std::deque<uint8_t> data_deque{ data.begin(), data.end() };
+
+	std::string enc(fea::base64_encoded_size(num_bytes), '\0');
+	std::vector<std::byte> dec(num_bytes);
+	const std::string dec_title = "base64 decode, GB/s of encoded input";
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(),
+			"base64 encode, %zu bytes, detected isa %s", num_bytes,
+			fea::to_string(fea::detected_isa()));
+
+	fea::bench::suite suite;
+	suite.average(5);
+
+	// Encode.
+	{
+		suite.title(title.data());
+
+		suite.benchmark("to_base64 (iterators, byte at a time)", [&]() {
+			fea::to_base64(data_deque.begin(), data_deque.end(), enc.begin());
+		});
+
+		suite.benchmark("scalar", [&]() {
+			fea::detail::base64_encode_scalar(
+					data.data(), num_bytes, enc.data());
+		});
+
+		using fn_t = fea::detail::base64_encode_fn;
+		auto bench = [&](const char* name, fn_t fn) {
+			suite.benchmark(name, [&]() {
+				size_t i = fn(data.data(), num_bytes, enc.data());
+				fea::detail::base64_encode_scalar(data.data() + i,
+						num_bytes - i, enc.data() + i / 3 * 4);
+			});
+		};
+#if FEA_DISPATCH
+		if (fea::detected_isa() >= fea::isa::sse42) {
+			bench("ssse3", &fea::detail::base64_encode_ssse3);
+		}
+		if (fea::detected_isa() >= fea::isa::avx2) {
+			bench("avx2", &fea::detail::base64_encode_avx2);
+		}
+#endif
+		bench("dispatched", fea::detail::base64_encode_kernel());
+
+		print(suite, num_bytes);
+	}
+
+	// Decode.
+	{
+		suite.title(dec_title);
+		const std::deque<char> enc_deque{ enc.begin(), enc.end() };
+		const size_t body = enc.size() - 4;
+		uint8_t* dst = reinterpret_cast<uint8_t*>(dec.data());
+
+		suite.benchmark("from_base64 (iterators, byte at a time)", [&]() {
+			fea::from_base64(enc_deque.begin(), enc_deque.end(), dec.begin());
+		});
+
+		using fn_t = fea::detail::base64_decode_fn;
+		auto bench = [&](const char* name, fn_t fn) {
+			suite.benchmark(name, [&]() { fn(enc.data(), body, dst); });
+		};
+#if FEA_DISPATCH
+		if (fea::detected_isa() >= fea::isa::sse42) {
+			bench("ssse3 kernel", &fea::detail::base64_decode_ssse3);
+		}
+		if (fea::detected_isa() >= fea::isa::avx2) {
+			bench("avx2 kernel", &fea::detail::base64_decode_avx2);
+		}
+#endif
+
+		suite.benchmark("from_base64 (validating, dispatched)", [&]() {
+			fea::base64_result res = fea::from_base64(enc, dec.data());
+			EXPECT_TRUE(res.valid());
+		});
+
+		print(suite, enc.size());
+	}
+
+	EXPECT_TRUE(std::equal(dec.begin(), dec.end(),
+			reinterpret_cast<const std::byte*>(data.data())));
+}
+} // namespace
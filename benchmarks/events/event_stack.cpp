@@ -0,0 +1,112 @@
+﻿#include <array>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/events/event_stack.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace {
+constexpr size_t num_subscribers = 10'000;
+#if FEA_RELEASE
+constexpr size_t num_triggers = 1'000;
+#else
+constexpr size_t num_triggers = 10;
+#endif
+
+enum class event { one, count };
+
+// Captures 24 bytes, larger than most std::function small buffers.
+// Subscribers are interleaved with other allocations, as they would be in an
+// application.
+template <class Stack>
+void subscribe(Stack& stack, std::vector<double>& results,
+		std::vector<fea::event_id<event, event::one>>& ids,
+		std::vector<std::unique_ptr<char[]>>& other_allocs) {
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<size_t> size_dis{ 16, 256 };
+	for (size_t i = 0; i < num_subscribers; ++i) {
+		double* out = &results[i];
+		double scale = double(i % 7);
+		ids.push_back(stack.template subscribe<event::one>(
+				[out, i, scale](double v) { *out += v * scale + double(i); }));
+		other_allocs.push_back(std::make_unique<char[]>(size_dis(gen)));
+	}
+}
+
+template <class Stack>
+void unsubscribe_half(Stack& stack,
+		const std::vector<fea::event_id<event, event::one>>& ids) {
+	for (size_t i = 0; i < ids.size(); i += 2) {
+		stack.unsubscribe(ids[i]);
+	}
+}
+
+TEST(event_stack, benchmarks) {
+	using std_stack_t = fea::event_stack<event, void(double)>;
+	using inplace_stack_t = fea::inplace_event_stack<event, void(double)>;
+
+	std::vector<double> std_results(num_subscribers);
+	std::vector<double> inplace_results(num_subscribers);
+	std::vector<fea::event_id<event, event::one>> std_ids;
+	std::vector<fea::event_id<event, event::one>> inplace_ids;
+
+	std_stack_t std_stack;
+	inplace_stack_t inplace_stack;
+
+	std::vector<std::unique_ptr<char[]>> other_allocs;
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(), "subscribe %zu callbacks",
+			num_subscribers);
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+	suite.benchmark("std::function", [&]() {
+		subscribe(std_stack, std_results, std_ids, other_allocs);
+	});
+	suite.benchmark("inplace_function", [&]() {
+		subscribe(inplace_stack, inplace_results, inplace_ids, other_allocs);
+	});
+	suite.print();
+
+	std::snprintf(title.data(), title.size(),
+			"trigger %zu callbacks, %zu times", num_subscribers, num_triggers);
+	suite.title(title.data());
+	suite.average(5);
+	suite.benchmark("std::function", [&]() {
+		for (size_t i = 0; i < num_triggers; ++i) {
+			std_stack.trigger<event::one>(1.0);
+		}
+	});
+	suite.benchmark("inplace_function", [&]() {
+		for (size_t i = 0; i < num_triggers; ++i) {
+			inplace_stack.trigger<event::one>(1.0);
+		}
+	});
+	suite.print();
+
+	unsubscribe_half(std_stack, std_ids);
+	unsubscribe_half(inplace_stack, inplace_ids);
+
+	std::snprintf(title.data(), title.size(),
+			"trigger %zu callbacks after unsubscribing half, %zu times",
+			std_stack.size(), num_triggers);
+	suite.title(title.data());
+	suite.benchmark("std::function", [&]() {
+		for (size_t i = 0; i < num_triggers; ++i) {
+			std_stack.trigger<event::one>(1.0);
+		}
+	});
+	suite.benchmark("inplace_function", [&]() {
+		for (size_t i = 0; i < num_triggers; ++i) {
+			inplace_stack.trigger<event::one>(1.0);
+		}
+	});
+	suite.print();
+
+	EXPECT_EQ(std_results, inplace_results);
+}
+} // namespace
@@ -0,0 +1,100 @@
+﻿#include <array>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/graphs/flat_bf_graph.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr uint32_t num_nodes = 1'000'000;
+#else
+constexpr uint32_t num_nodes = 100'000;
+#endif
+constexpr uint32_t num_roots = 16;
+
+// A scene graph like node, world = parent world * local.
+struct transform {
+	std::array<float, 16> local{};
+	std::array<float, 16> world{};
+};
+
+void multiply(const std::array<float, 16>& lhs,
+		const std::array<float, 16>& rhs, std::array<float, 16>& out) {
+	for (size_t r = 0; r < 4; ++r) {
+		for (size_t c = 0; c < 4; ++c) {
+			float sum = 0.f;
+			for (size_t i = 0; i < 4; ++i) {
+				sum += lhs[r * 4 + i] * rhs[i * 4 + c];
+			}
+			out[r * 4 + c] = sum;
+		}
+	}
+}
+
+void eval(const uint32_t&, transform& t, const transform* parent) {
+	if (parent == nullptr) {
+		t.world = t.local;
+		return;
+	}
+	multiply(parent->world, t.local, t.world);
+}
+
+TEST(flat_bf_graph, benchmarks) {
+	using graph_t = fea::experimental::flat_bf_graph<uint32_t, transform>;
+
+	std::mt19937 gen{ 42 };
+	transform identity{};
+	for (size_t i = 0; i < 4; ++i) {
+		identity.local[i * 4 + i] = 1.f;
+	}
+
+	fea::experimental::flat_bf_graph_builder<uint32_t, transform> builder;
+	builder.reserve(num_nodes);
+	for (uint32_t i = 0; i < num_roots; ++i) {
+		builder.push_back(i, identity);
+	}
+	for (uint32_t i = num_roots; i < num_nodes; ++i) {
+		builder.push_back(uint32_t(gen() % i), i, identity);
+	}
+	graph_t graph{ std::move(builder) };
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(),
+			"flat_bf_graph evaluation, %u nodes, %zu breadths, %zu threads",
+			num_nodes, graph.breadth_size(), fea::num_threads());
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+	suite.average(10);
+
+	suite.benchmark("serial lookup iteration", [&]() {
+		std::span<const uint32_t> keys = graph.keys();
+		std::span<const uint32_t> parents = graph.parents();
+		for (size_t i = 0; i < keys.size(); ++i) {
+			const transform* parent = nullptr;
+			if (parents[i] != graph.root_key()) {
+				parent = &graph.at_unchecked(parents[i]);
+			}
+			eval(keys[i], graph[i], parent);
+		}
+	});
+
+	suite.benchmark("evaluate", [&]() { graph.evaluate(eval); });
+
+	suite.benchmark("evaluate_parallel", [&]() {
+		graph.evaluate_parallel(eval);
+	});
+
+	suite.benchmark("evaluate_parallel (grain 256)", [&]() {
+		graph.evaluate_parallel(eval, 256);
+	});
+
+	suite.print();
+
+	const transform& last = graph[graph.size() - 1];
+	EXPECT_EQ(last.world[0], 1.f);
+}
+} // namespace
@@ -0,0 +1,144 @@
+﻿#include <array>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/containers/flat_id_slotmap.hpp>
+#include <fea/graphs/lazy_graph.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_edges = 1'000'000;
+#else
+constexpr size_t num_edges = 50'000;
+#endif
+
+// Each cluster is a small, shallow DAG.
+// 4 roots, 8 middle nodes with 2 root parents each (one random), 2 sinks
+// with 4 middle parents each. 24 edges per cluster.
+constexpr unsigned num_roots = 4;
+constexpr unsigned num_middle = 8;
+constexpr unsigned num_sinks = 2;
+constexpr unsigned cluster_size = num_roots + num_middle + num_sinks;
+constexpr size_t cluster_edges = num_middle * 2 + num_sinks * 4;
+constexpr size_t num_clusters = num_edges / cluster_edges;
+
+struct edge {
+	unsigned child;
+	unsigned parent;
+};
+
+std::vector<edge> make_edges() {
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<unsigned> root_dis{ 0, num_roots - 1 };
+
+	std::vector<edge> ret;
+	ret.reserve(num_clusters * cluster_edges);
+	for (size_t c = 0; c < num_clusters; ++c) {
+		unsigned base = unsigned(c) * cluster_size;
+		unsigned mid_base = base + num_roots;
+		unsigned sink_base = mid_base + num_middle;
+
+		for (unsigned i = 0; i < num_middle; ++i) {
+			unsigned p0 = i % num_roots;
+			unsigned p1 = (p0 + 1 + root_dis(gen) % (num_roots - 1))
+					% num_roots;
+			ret.push_back({ mid_base + i, base + p0 });
+			ret.push_back({ mid_base + i, base + p1 });
+		}
+		for (unsigned i = 0; i < num_sinks; ++i) {
+			for (unsigned j = 0; j < 4; ++j) {
+				ret.push_back({ sink_base + i, mid_base + i * 4 + j });
+			}
+		}
+	}
+	return ret;
+}
+
+template <class Graph>
+void bench_graph(const char* name, const std::vector<edge>& edges,
+		const std::vector<unsigned>& roots,
+		const std::vector<unsigned>& sinks, fea::bench::suite& build_suite,
+		fea::bench::suite& clean_suite, fea::bench::suite& dirty_suite) {
+	using callback_data_t = fea::callback_data<unsigned>;
+
+	Graph graph;
+	std::array<char, 128> title{};
+
+	std::snprintf(title.data(), title.size(), "%s add_dependency", name);
+	build_suite.benchmark(title.data(), [&]() {
+		for (const edge& e : edges) {
+			graph.add_dependency(e.child, e.parent);
+		}
+	});
+
+	size_t num_cbs = 0;
+	auto cb = fea::make_callback([&](const callback_data_t& d) {
+		num_cbs += d.parents.size();
+	});
+
+	// Warm up, computes and caches evaluation graphs.
+	graph.clean({ sinks.data(), sinks.size() }, cb);
+
+	std::snprintf(title.data(), title.size(), "%s make_dirty + clean", name);
+	clean_suite.benchmark(title.data(), [&]() {
+		for (unsigned r : roots) {
+			graph.make_dirty(r);
+		}
+		graph.clean({ sinks.data(), sinks.size() }, cb);
+	});
+
+	for (unsigned r : roots) {
+		graph.make_dirty(r);
+	}
+	graph.update_topology();
+
+	size_t num_dirty = 0;
+	std::snprintf(title.data(), title.size(), "%s is_dirty", name);
+	dirty_suite.benchmark(title.data(), [&]() {
+		for (unsigned s : sinks) {
+			num_dirty += size_t(graph.is_dirty(s));
+		}
+	});
+
+	EXPECT_EQ(num_dirty, sinks.size());
+	EXPECT_NE(num_cbs, 0u);
+}
+
+TEST(lazy_graph, benchmarks) {
+	std::vector<edge> edges = make_edges();
+
+	std::vector<unsigned> roots;
+	std::vector<unsigned> sinks;
+	for (size_t c = 0; c < num_clusters; ++c) {
+		unsigned base = unsigned(c) * cluster_size;
+		for (unsigned i = 0; i < num_roots; ++i) {
+			roots.push_back(base + i);
+		}
+		for (unsigned i = 0; i < num_sinks; ++i) {
+			sinks.push_back(base + num_roots + num_middle + i);
+		}
+	}
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(),
+			"lazy_graph, %zu edges in %zu clusters", edges.size(),
+			num_clusters);
+
+	fea::bench::suite build_suite;
+	build_suite.title(title.data());
+	fea::bench::suite clean_suite;
+	fea::bench::suite dirty_suite;
+
+	bench_graph<fea::lazy_graph<unsigned>>("unordered_map", edges, roots,
+			sinks, build_suite, clean_suite, dirty_suite);
+	bench_graph<fea::flat_lazy_graph<unsigned>>("flat", edges, roots,
+			sinks, build_suite, clean_suite, dirty_suite);
+
+	build_suite.print();
+	clean_suite.print();
+	dirty_suite.print();
+}
+} // namespace
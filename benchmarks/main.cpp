@@ -1,11 +1,120 @@
-﻿#include <fea/terminal/pipe.hpp>
+﻿#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/getopt/getopt.hpp>
+#include <fea/terminal/pipe.hpp>
 #include <fea/terminal/utf8_io.hpp>
 #include <fea/utility/unused.hpp>
 #include <gtest/gtest.h>
 #include <iostream>
+#include <string>
 
 const char* argv0;
 
+namespace {
+bool to_double(const std::string& str, double& out) {
+	char* end = nullptr;
+	out = std::strtod(str.c_str(), &end);
+	return end != str.c_str() && *end == '\0' && out >= 0.0;
+}
+
+bool to_size(const std::string& str, size_t& out) {
+	double d = 0.0;
+	if (!to_double(str, d)) {
+		return false;
+	}
+	out = size_t(d);
+	return true;
+}
+
+// Benchmark options, gtest options are parsed first.
+bool parse_options(
+		int argc, char** argv, std::string& json_path, std::string& csv_path) {
+	fea::bench::options& opts = fea::bench::global_options();
+
+	fea::get_opt<char> opt;
+	opt.no_options_is_ok();
+	opt.add_help_intro("Google test options are also supported, see "
+					   "--gtest_help.");
+
+	opt.add_required_arg_option(
+			"warmup",
+			[&](std::string&& s) { return to_size(s, opts.warmup); },
+			"Unmeasured runs of each benchmark before sampling.");
+	opt.add_required_arg_option(
+			"samples",
+			[&](std::string&& s) { return to_size(s, opts.samples); },
+			"Number of samples per benchmark, overrides the benchmark's "
+			"own setting.");
+	opt.add_required_arg_option(
+			"min_time",
+			[&](std::string&& s) {
+				double ms = 0.0;
+				if (!to_double(s, ms)) {
+					return false;
+				}
+				opts.min_sample_time = std::chrono::nanoseconds(
+						int64_t(ms * 1'000'000.0));
+				return true;
+			},
+			"Calibrates iterations so each sample lasts at least this many "
+			"milliseconds.");
+	opt.add_required_arg_option(
+			"outlier_sigma",
+			[&](std::string&& s) { return to_double(s, opts.outlier_sigma); },
+			"Rejects samples further than sigma * stddev from the mean.");
+	opt.add_flag_option(
+			"counters",
+			[&]() {
+				opts.counters = true;
+				return true;
+			},
+			"Measures hardware performance counters per iteration (cycles, "
+			"instructions, cache, branch and tlb misses), when available.");
+	opt.add_required_arg_option(
+			"threshold",
+			[&](std::string&& s) {
+				double pct = 0.0;
+				if (!to_double(s, pct)) {
+					return false;
+				}
+				opts.regression_threshold = pct / 100.0;
+				return true;
+			},
+			"Slowdown percentage from baseline considered a regression, if "
+			"statistically significant. Default 5.");
+	opt.add_required_arg_option(
+			"baseline",
+			[&](std::string&& s) {
+				if (!fea::bench::load_baseline(s)) {
+					std::fprintf(stderr, "Couldn't read baseline '%s'.\n",
+							s.c_str());
+					return false;
+				}
+				return true;
+			},
+			"Compares results to a json report from a previous run and flags "
+			"significant slowdowns.");
+	opt.add_required_arg_option(
+			"json",
+			[&](std::string&& s) {
+				json_path = std::move(s);
+				return true;
+			},
+			"Writes all results to a json report.");
+	opt.add_required_arg_option(
+			"csv",
+			[&](std::string&& s) {
+				csv_path = std::move(s);
+				return true;
+			},
+			"Writes all results to a csv file.");
+
+	return opt.parse_options(size_t(argc), argv);
+}
+} // namespace
+
 int main(int argc, char** argv) {
 	fea::fast_iostreams();
 	auto e = fea::utf8_io();
@@ -14,5 +123,27 @@ int main(int argc, char** argv) {
 	argv0 = argv[0];
 
 	::testing::InitGoogleTest(&argc, argv);
-	return RUN_ALL_TESTS();
+	std::string json_path;
+	std::string csv_path;
+	if (!parse_options(argc, argv, json_path, csv_path)) {
+		return EXIT_FAILURE;
+	}
+
+	int ret = RUN_ALL_TESTS();
+	if (!json_path.empty()
+			&& !fea::bench::write_json(json_path, fea::bench::report())) {
+		std::fprintf(stderr, "Couldn't write '%s'.\n", json_path.c_str());
+		ret = EXIT_FAILURE;
+	}
+	if (!csv_path.empty()
+			&& !fea::bench::write_csv(csv_path, fea::bench::report())) {
+		std::fprintf(stderr, "Couldn't write '%s'.\n", csv_path.c_str());
+		ret = EXIT_FAILURE;
+	}
+	if (fea::bench::num_regressions() != 0) {
+		std::fprintf(stderr, "%zu benchmark regression(s) against baseline.\n",
+				fea::bench::num_regressions());
+		ret = EXIT_FAILURE;
+	}
+	return ret;
 }
@@ -0,0 +1,60 @@
+﻿#include <array>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/string/ascii_kernels.hpp>
+#include <fea/string/string.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t str_size = 100'000'000;
+#else
+constexpr size_t str_size = 10'000'000;
+#endif
+
+TEST(cpu_dispatch, benchmarks) {
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<int> dis{ 32, 126 };
+	std::string str(str_size, '\0');
+	for (char& c : str) {
+		c = char(dis(gen));
+	}
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(),
+			"ascii case conversion, %zu bytes, detected isa %s", str_size,
+			fea::to_string(fea::detected_isa()));
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+	suite.average(10);
+
+	suite.benchmark("to_lower_ascii_inplace", [&]() {
+		fea::to_lower_ascii_inplace(str);
+	});
+
+	using fn_t = fea::detail::ascii_flip_case_fn;
+	auto bench = [&](const char* name, fn_t fn) {
+		suite.benchmark(name, [&]() { fn(str.data(), str.size(), 'A'); });
+	};
+
+	bench("scalar", &fea::detail::ascii_flip_case_scalar);
+#if FEA_DISPATCH
+	if (fea::detected_isa() >= fea::isa::sse42) {
+		bench("sse4.2", &fea::detail::ascii_flip_case_sse42);
+	}
+	if (fea::detected_isa() >= fea::isa::avx2) {
+		bench("avx2", &fea::detail::ascii_flip_case_avx2);
+	}
+	if (fea::detected_isa() >= fea::isa::avx512) {
+		bench("avx-512", &fea::detail::ascii_flip_case_avx512);
+	}
+#endif
+	suite.print();
+
+	std::string lower = fea::to_lower_ascii(str);
+	EXPECT_EQ(fea::to_upper_ascii(lower), fea::to_upper_ascii(str));
+}
+} // namespace
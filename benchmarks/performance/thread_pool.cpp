@@ -0,0 +1,77 @@
+﻿#include <atomic>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/performance/thread.hpp>
+#include <gtest/gtest.h>
+#include <thread>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_calls = 10'000;
+#else
+constexpr size_t num_calls = 1'000;
+#endif
+constexpr size_t loop_count = 4'096;
+
+// The previous fea::parallel_for, which spawned threads every call.
+void spawning_parallel_for(size_t count,
+		const std::function<void(const std::pair<size_t, size_t>&, size_t)>&
+				func) {
+	const size_t num_t = fea::num_threads();
+	size_t chunk_size = count / num_t;
+
+	std::vector<std::thread> threads;
+	threads.reserve(num_t);
+	for (size_t i = 0; i < num_t; ++i) {
+		std::pair<size_t, size_t> range{ i * chunk_size,
+			i == num_t - 1 ? count : (i + 1) * chunk_size };
+		threads.emplace_back(func, range, i);
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+}
+
+TEST(thread_pool, benchmarks) {
+	std::vector<float> vals(loop_count, 1.f);
+	auto chunk_func = [&](const std::pair<size_t, size_t>& range, size_t) {
+		for (size_t i = range.first; i < range.second; ++i) {
+			vals[i] = vals[i] * 1.0001f + 0.5f;
+		}
+	};
+
+	char title[128];
+	std::snprintf(title, sizeof(title),
+			"%zu parallel_for calls, %zu iterations each", num_calls,
+			loop_count);
+
+	fea::bench::suite suite;
+	suite.title(title);
+	suite.benchmark("spawn threads every call", [&]() {
+		for (size_t i = 0; i < num_calls; ++i) {
+			spawning_parallel_for(loop_count, chunk_func);
+		}
+	});
+	suite.benchmark("fea::parallel_for, chunked", [&]() {
+		for (size_t i = 0; i < num_calls; ++i) {
+			fea::parallel_for(loop_count, chunk_func);
+		}
+	});
+	suite.benchmark("fea::parallel_for, dynamic", [&]() {
+		for (size_t i = 0; i < num_calls; ++i) {
+			fea::parallel_for(loop_count, 256,
+					[&](const std::pair<size_t, size_t>& range) {
+						chunk_func(range, 0);
+					});
+		}
+	});
+	suite.print();
+
+	float sum = 0.f;
+	for (float f : vals) {
+		sum += f;
+	}
+	printf("sum : %f\n\n", sum);
+}
+} // namespace
@@ -0,0 +1,163 @@
+﻿#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/memory/fmap.hpp>
+#include <fea/serialize/serialize.hpp>
+#include <fea/utility/file.hpp>
+#include <fea/utility/platform.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string_view>
+#include <vector>
+
+extern const char* argv0;
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_ints = 25'000'000;
+#else
+constexpr size_t num_ints = 5'000'000;
+#endif
+constexpr size_t num_sections = 1'000;
+
+std::filesystem::path filepath() {
+	const std::filesystem::path dir = fea::executable_dir(argv0) / "tests_data";
+	std::filesystem::create_directory(dir);
+	return dir / "deserializer_bench.bin";
+}
+
+TEST(deserializer, benchmarks) {
+	{
+		std::vector<int> data(num_ints);
+		for (size_t i = 0; i < data.size(); ++i) {
+			data[i] = int(i);
+		}
+		std::string str(num_ints, 'a');
+
+		fea::serializer ofs{ filepath() };
+		fea::serialize(data, ofs);
+		fea::serialize(str, ofs);
+	}
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(), "deserialize %zu MB",
+			size_t(std::filesystem::file_size(filepath())) / (1024 * 1024));
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+
+	size_t sum = 0;
+	suite.benchmark("file read, copy", [&]() {
+		fea::deserializer ifs{ filepath() };
+		std::vector<int> data;
+		std::string str;
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		EXPECT_TRUE(fea::deserialize(ifs, str));
+		sum += size_t(data.back()) + str.size();
+	});
+
+	suite.benchmark("file map, copy", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		std::vector<int> data;
+		std::string str;
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		EXPECT_TRUE(fea::deserialize(ifs, str));
+		sum += size_t(data.back()) + str.size();
+	});
+
+	suite.benchmark("file map, in place", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		fea::span<const int> data;
+		std::string_view str;
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		EXPECT_TRUE(fea::deserialize(ifs, str));
+		sum += size_t(data.back()) + str.size();
+	});
+
+	suite.print();
+
+	// Indexed archive, nested containers in many sections.
+	{
+		std::vector<std::vector<int>> data(256);
+		for (std::vector<int>& v : data) {
+			v.resize(16);
+		}
+
+		fea::serializer ofs{ filepath() };
+		for (size_t i = 0; i < num_sections; ++i) {
+			std::snprintf(title.data(), title.size(), "%zu", i);
+			fea::serialize_section(title.data(), data, ofs);
+		}
+	}
+
+	std::snprintf(title.data(), title.size(), "%zu sections, %zu MB",
+			num_sections,
+			size_t(std::filesystem::file_size(filepath())) / (1024 * 1024));
+	suite.title(title.data());
+
+	suite.benchmark("front to back, last section", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		std::vector<std::vector<int>> data;
+		for (size_t i = 0; i < num_sections; ++i) {
+			data.clear();
+			EXPECT_TRUE(fea::deserialize(ifs, data));
+		}
+		sum += data.size();
+	});
+
+	suite.benchmark("seek, last section", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		std::vector<std::vector<int>> data;
+		EXPECT_TRUE(ifs.seek(num_sections - 1));
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		sum += data.size();
+	});
+
+	suite.print();
+
+	// Small sorted ids, fixed and compact.
+	std::vector<uint32_t> ids(num_ints);
+	for (size_t i = 0; i < ids.size(); ++i) {
+		ids[i] = uint32_t(i * 3);
+	}
+
+	const std::filesystem::path compact_filepath
+			= filepath().replace_extension(".compact.bin");
+	{
+		fea::serializer ofs{ filepath() };
+		fea::serialize(ids, ofs);
+	}
+	{
+		fea::serializer ofs{ compact_filepath,
+			fea::serialize_encoding::compact };
+		fea::serialize(ids, ofs);
+	}
+
+	std::snprintf(title.data(), title.size(),
+			"%zu ids, fixed %zu MB, compact %zu MB", ids.size(),
+			size_t(std::filesystem::file_size(filepath())) / (1024 * 1024),
+			size_t(std::filesystem::file_size(compact_filepath))
+					/ (1024 * 1024));
+	suite.title(title.data());
+
+	suite.benchmark("file map, fixed", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		std::vector<uint32_t> data;
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		sum += data.back();
+	});
+
+	suite.benchmark("file map, compact", [&]() {
+		fea::deserializer ifs{ fea::ifmap{ compact_filepath } };
+		std::vector<uint32_t> data;
+		EXPECT_TRUE(fea::deserialize(ifs, data));
+		sum += data.back();
+	});
+
+	suite.print();
+	EXPECT_NE(sum, 0u);
+	std::filesystem::remove(filepath());
+	std::filesystem::remove(compact_filepath);
+}
+} // namespace
@@ -0,0 +1,105 @@
+﻿#include <array>
+#include <chrono>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/serialize/lz.hpp>
+#include <fea/serialize/serialize.hpp>
+#include <fea/utility/platform.hpp>
+#include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_entries = 500'000;
+#else
+constexpr size_t num_entries = 20'000;
+#endif
+
+struct entry {
+	std::string name;
+	std::vector<float> values;
+	int id = 0;
+
+	friend void serialize(const entry& e, fea::serializer& os) {
+		using fea::serialize;
+		serialize(e.name, os);
+		serialize(e.values, os);
+		serialize(e.id, os);
+	}
+};
+
+// A snapshot like archive, names and small arrays of quantized floats.
+std::vector<std::byte> make_snapshot() {
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<int> val_dis{ 0, 16 };
+
+	std::vector<entry> entries(num_entries);
+	for (size_t i = 0; i < entries.size(); ++i) {
+		entry& e = entries[i];
+		e.name = "node_" + std::to_string(i % 1'000) + "_transform";
+		e.values.resize(16);
+		for (float& f : e.values) {
+			f = float(val_dis(gen)) * 0.25f;
+		}
+		e.id = int(i);
+	}
+
+	fea::serializer ofs;
+	fea::serialize(entries, ofs);
+	return ofs.extract();
+}
+
+TEST(lz, benchmarks) {
+	const std::vector<std::byte> data = make_snapshot();
+	const std::vector<std::byte> compressed = fea::lz_compress(data);
+
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(),
+			"lz, %zu MB snapshot, ratio %.2f", data.size() / (1024 * 1024),
+			double(data.size()) / double(compressed.size()));
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+
+	size_t sum = 0;
+	suite.benchmark("compress", [&]() {
+		sum += fea::lz_compress(data).size();
+	});
+	suite.benchmark("compress_mt", [&]() {
+		sum += fea::lz_compress_mt(data).size();
+	});
+	suite.print();
+
+	fea::bench::suite dsuite;
+	std::vector<std::byte> out;
+	dsuite.benchmark("decompress", [&]() {
+		EXPECT_TRUE(fea::lz_decompress(compressed, out));
+		sum += out.size();
+	});
+	dsuite.benchmark("decompress_mt", [&]() {
+		EXPECT_TRUE(fea::lz_decompress_mt(compressed, out));
+		sum += out.size();
+	});
+	dsuite.print();
+
+	// Throughput, single threaded.
+	auto gbps = [&](auto&& func) {
+		auto start = std::chrono::steady_clock::now();
+		func();
+		std::chrono::duration<double> dur
+				= std::chrono::steady_clock::now() - start;
+		return double(data.size()) / dur.count() / 1e9;
+	};
+	double c = gbps([&]() { sum += fea::lz_compress(data).size(); });
+	double d = gbps([&]() {
+		EXPECT_TRUE(fea::lz_decompress(compressed, out));
+	});
+	std::printf("compress %.2f GB/s, decompress %.2f GB/s\n\n", c, d);
+
+	EXPECT_EQ(out, data);
+	EXPECT_NE(sum, 0u);
+}
+} // namespace
@@ -0,0 +1,97 @@
+﻿#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/time/timeout_queue.hpp>
+#include <fea/utility/platform.hpp>
+#include <functional>
+#include <gtest/gtest.h>
+#include <random>
+#include <utility>
+#include <vector>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_updates = 10'000;
+#else
+constexpr size_t num_updates = 100;
+#endif
+
+// Models timer::update with pending elapsed callbacks. Each update advances
+// time by one tick, expired callbacks are called and rescheduled, keeping the
+// number of pending callbacks constant. Timeouts are up to max_timeout ticks
+// in the future.
+constexpr uint64_t max_timeout = 10'000;
+
+using callback_t = std::function<void()>;
+
+// The previous implementation, scanning every pending callback each update.
+struct vector_timeouts {
+	void push(uint64_t k, callback_t&& cb) {
+		_callbacks.push_back({ k, std::move(cb) });
+	}
+
+	template <class Func>
+	void pop_until(uint64_t k, Func&& func) {
+		auto new_end = std::partition(_callbacks.begin(), _callbacks.end(),
+				[&](const auto& p) { return p.first > k; });
+		for (auto it = new_end; it != _callbacks.end(); ++it) {
+			func(std::move(it->second));
+		}
+		_callbacks.erase(new_end, _callbacks.end());
+	}
+
+	std::vector<std::pair<uint64_t, callback_t>> _callbacks;
+};
+
+template <class Queue>
+size_t run(Queue& q, size_t num_pending) {
+	std::mt19937_64 gen{ 42 };
+	std::uniform_int_distribution<uint64_t> dis{ 1, max_timeout };
+
+	size_t num_called = 0;
+	for (size_t i = 0; i < num_pending; ++i) {
+		q.push(dis(gen), [&num_called]() { ++num_called; });
+	}
+
+	std::vector<callback_t> due;
+	for (uint64_t now = 1; now <= num_updates; ++now) {
+		q.pop_until(now, [&](callback_t&& cb) {
+			due.push_back(std::move(cb));
+		});
+		for (callback_t& cb : due) {
+			cb();
+			q.push(now + dis(gen), std::move(cb));
+		}
+		due.clear();
+	}
+	return num_called;
+}
+
+TEST(timeout_queue, benchmarks) {
+	for (size_t num_pending : { size_t(1'000), size_t(10'000),
+				 size_t(100'000) }) {
+		std::array<char, 128> title{};
+		std::snprintf(title.data(), title.size(),
+				"%zu updates, %zu pending callbacks", num_updates, num_pending);
+
+		size_t vec_called = 0;
+		size_t queue_called = 0;
+
+		fea::bench::suite suite;
+		suite.title(title.data());
+		suite.benchmark("vector scan", [&]() {
+			vector_timeouts q;
+			vec_called = run(q, num_pending);
+		});
+		suite.benchmark("fea::timeout_queue", [&]() {
+			fea::timeout_queue<uint64_t, callback_t> q;
+			queue_called = run(q, num_pending);
+		});
+		suite.print();
+
+		EXPECT_EQ(vec_called, queue_called);
+	}
+}
+} // namespace
@@ -0,0 +1,57 @@
+﻿#include <array>
+#include <cstdio>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/performance/profiler.hpp>
+#include <gtest/gtest.h>
+
+namespace {
+#if FEA_RELEASE
+constexpr size_t num_zones = 10'000'000;
+#else
+constexpr size_t num_zones = 1'000'000;
+#endif
+
+TEST(profiler, benchmarks) {
+	std::array<char, 128> title{};
+	std::snprintf(title.data(), title.size(), "profiler, %zu zones", num_zones);
+
+	fea::bench::suite suite;
+	suite.title(title.data());
+	suite.average(5);
+
+	size_t count = 0;
+	suite.benchmark("empty loop", [&]() {
+		for (size_t i = 0; i < num_zones; ++i) {
+			++count;
+			fea::bench::clobber();
+		}
+	});
+
+	suite.benchmark("FEA_PROFILE_ZONE", [&]() {
+		for (size_t i = 0; i < num_zones; ++i) {
+			FEA_PROFILE_ZONE("profiler benchmark");
+			++count;
+			fea::bench::clobber();
+		}
+	});
+
+	suite.benchmark("nested FEA_PROFILE_ZONE", [&]() {
+		for (size_t i = 0; i < num_zones / 2; ++i) {
+			FEA_PROFILE_ZONE("profiler benchmark outer");
+			{
+				FEA_PROFILE_ZONE("profiler benchmark inner");
+				++count;
+				fea::bench::clobber();
+			}
+		}
+	});
+
+	const double zone_ns = (suite.results()[1].mean - suite.results()[0].mean)
+			* 1'000'000'000.0 / double(num_zones);
+	suite.print();
+	std::printf("~%.1fns per zone\n\n", zone_ns);
+
+	fea::profile::clear();
+	EXPECT_NE(count, 0u);
+}
+} // namespace
@@ -31,6 +31,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  **/
 #pragma once
+#include "fea/containers/span.hpp"
 #include "fea/meta/static_for.hpp"
 #include "fea/meta/traits.hpp"
 #include "fea/numerics/numerics.hpp"
@@ -43,6 +44,7 @@
 #include <cassert>
 #include <cstdint>
 #include <cstring>
+#include <functional>
 #include <iterator>
 #include <limits>
 #include <numeric>
@@ -52,6 +54,7 @@ namespace fea {
 // Radix sort.
 // Values pointed to must be arithmetic (integers or floats).
 // Performance wise : unsigned > signed > floats
+// Tiny ranges are insertion sorted instead.
 //
 // Thread-safe.
 // Allocates thread caches on first call.
@@ -70,6 +73,40 @@ void radix_sort(FwdIt first, FwdIt last);
 template <class FwdIt, class FwdIt2>
 void radix_sort_idxes(
 		FwdIt first, FwdIt last, FwdIt2 first_idx, FwdIt2 last_idx);
+
+// Radix sort, using the provided scratch memory.
+// Scratch must be at least as large as the sorted range.
+// Doesn't allocate values.
+template <class FwdIt>
+void radix_sort(FwdIt first, FwdIt last,
+		fea::span<fea::iterator_value_t<FwdIt>> scratch);
+
+// Radix sort records by key.
+// key_projection is called with a record and must return an arithmetic key,
+// it may be a callable or a member pointer. Records are moved directly to
+// their sorted position, no index permutation is applied afterwards.
+// Records must be default constructible and movable.
+//
+// Stable. Iterators must be random access.
+// Allocates records every call.
+template <class RandIt, class Proj>
+void radix_sort_by(RandIt first, RandIt last, Proj&& key_projection);
+
+// Radix sort records by key, using the provided scratch memory.
+// Scratch must be at least as large as the sorted range.
+// Doesn't allocate records.
+template <class RandIt, class Proj>
+void radix_sort_by(RandIt first, RandIt last, Proj&& key_projection,
+		fea::span<fea::iterator_value_t<RandIt>> scratch);
+
+// Radix sort arithmetic keys, and co-sort payloads in the same passes.
+// Both ranges must be the same size. payload[i] is associated to key[i].
+//
+// Stable. Iterators must be random access.
+// Allocates keys and payloads every call.
+template <class RandIt, class RandIt2>
+void radix_sort_paired(RandIt first, RandIt last, RandIt2 payload_first,
+		RandIt2 payload_last);
 } // namespace fea
 
 
@@ -83,12 +120,17 @@ struct radix_data {
 	std::array<std::array<IndexT, 256>, sizeof(void*)> jmp_table; // uninit
 };
 
+// Sorts are called in hot loops, threads cache their slot.
+template <class IndexT>
+using radix_tls = fea::tls<radix_data<IndexT>,
+		std::allocator<radix_data<IndexT>>, fea::tls_mode::cached>;
+
 // Caches, 1 per index type * number of caller threads.
-inline fea::tls<radix_data<uint8_t>> radix_data_cache8;
-inline fea::tls<radix_data<uint16_t>> radix_data_cache16;
-inline fea::tls<radix_data<uint32_t>> radix_data_cache32;
+inline radix_tls<uint8_t> radix_data_cache8;
+inline radix_tls<uint16_t> radix_data_cache16;
+inline radix_tls<uint32_t> radix_data_cache32;
 #if FEA_ARCH >= 64
-inline fea::tls<radix_data<uint64_t>> radix_data_cache64;
+inline radix_tls<uint64_t> radix_data_cache64;
 #endif
 
 // Checks basics before running sort.
@@ -105,6 +147,25 @@ void radix_checks() {
 			"Radix sort only works on arithmetic types.");
 }
 
+// Under this count, insertion sort beats radix passes.
+inline constexpr size_t radix_insertion_threshold = 64u;
+
+// Binary insertion sort, for tiny ranges.
+// Works on forward iterators.
+template <class FwdIt>
+void insertion_sort(FwdIt first, FwdIt last) {
+	if (first == last) {
+		return;
+	}
+
+	for (FwdIt it = std::next(first); it != last; ++it) {
+		FwdIt pos = std::upper_bound(first, it, *it);
+		if (pos != it) {
+			std::rotate(pos, it, std::next(it));
+		}
+	}
+}
+
 // Returns the right cache which uses an unsigned type able to fit 'count'
 // elements.
 template <class Func>
@@ -236,17 +297,12 @@ bool radix_precompute(
 	return false;
 }
 
-template <class ValueT, size_t PassIdx, class FwdIt, class IndexT, class Func>
-void radix_pass(FwdIt first1, FwdIt last1, FwdIt first2, FwdIt last2,
+template <class ValueT, size_t PassIdx, class FwdIt, class FwdIt2,
+		class IndexT, class Func>
+void radix_scatter(FwdIt read_first, FwdIt read_last, FwdIt2 write_first,
 		Func&& get_value_func, radix_data<IndexT>* rad_data_ptr) {
 	radix_data<IndexT>& rad_data = *rad_data_ptr;
 	std::array<IndexT, 256>& jmp_table = std::get<PassIdx>(rad_data.jmp_table);
-
-	FwdIt read_first = (PassIdx % 2) == 0 ? first1 : first2;
-	FwdIt read_last = (PassIdx % 2) == 0 ? last1 : last2;
-
-	FwdIt write_first = (PassIdx % 2) == 0 ? first2 : first1;
-	//FwdIt write_last = (PassIdx % 2) == 0 ? last2 : last1;
 	assert(&(*read_first) != &(*write_first));
 
 	for (FwdIt it = read_first; it != read_last; ++it) {
@@ -268,17 +324,33 @@ void radix_pass(FwdIt first1, FwdIt last1, FwdIt first2, FwdIt last2,
 			off = ptrdiff_t(jmp_table[radix]++);
 		}
 
-		FwdIt cpy_it = std::next(write_first, off);
+		FwdIt2 cpy_it = std::next(write_first, off);
 		*cpy_it = *it;
 	}
 }
 
+// Even passes read from the first range and write to the second range,
+// odd passes do the opposite.
+template <class ValueT, size_t PassIdx, class FwdIt, class FwdIt2,
+		class IndexT, class Func>
+void radix_pass(FwdIt first1, FwdIt last1, FwdIt2 first2, FwdIt2 last2,
+		Func&& get_value_func, radix_data<IndexT>* rad_data_ptr) {
+	if constexpr ((PassIdx % 2) == 0) {
+		radix_scatter<ValueT, PassIdx>(first1, last1, first2,
+				std::forward<Func>(get_value_func), rad_data_ptr);
+	} else {
+		radix_scatter<ValueT, PassIdx>(first2, last2, first1,
+				std::forward<Func>(get_value_func), rad_data_ptr);
+	}
+}
+
 // Notes :
 // Signed negative values are at the wrong position but correct order.
 // Float negative values are at the wrong position and worng order.
 template <class FwdIt, class IndexT>
-void radix_sort(
-		FwdIt first, FwdIt last, size_t count, radix_data<IndexT>& rad_data) {
+void radix_sort(FwdIt first, FwdIt last, size_t count,
+		fea::span<fea::iterator_value_t<FwdIt>> scratch,
+		radix_data<IndexT>& rad_data) {
 	using value_t = fea::iterator_value_t<FwdIt>;
 
 	if (fea::detail::radix_precompute(first, last, count, &rad_data)) {
@@ -287,12 +359,21 @@ void radix_sort(
 	}
 
 	// We'll flip flop sorted values between input and scratch storage.
-	std::vector<value_t> scratch(count);
+	// Allocate it if the user didn't provide any.
+	std::vector<value_t> scratch_storage;
+	if (scratch.empty()) {
+		scratch_storage.resize(count);
+		scratch = { scratch_storage.data(), scratch_storage.size() };
+	}
+	assert(scratch.size() >= count);
+
+	value_t* scratch_first = scratch.data();
+	value_t* scratch_last = scratch.data() + count;
 
 	// Doit.
 	fea::static_for<sizeof(value_t)>([&](auto const_pass_idx) {
 		fea::detail::radix_pass<value_t, const_pass_idx>(
-				first, last, scratch.begin(), scratch.end(),
+				first, last, scratch_first, scratch_last,
 				[](const auto& it) -> const value_t& { return *it; },
 				&rad_data);
 	});
@@ -300,7 +381,7 @@ void radix_sort(
 	if constexpr (sizeof(value_t) == 1) {
 		// We were a char (non-even byte size).
 		// The output is in the wrong storage.
-		std::copy(scratch.begin(), scratch.end(), first);
+		std::copy(scratch_first, scratch_last, first);
 	}
 }
 
@@ -365,6 +446,112 @@ void radix_sort(FwdIt first, FwdIt last, FwdIt2 idx_first,
 		}
 	}
 }
+
+// Maps values to unsigned keys which sort in the same order.
+template <class T>
+fea::byte_uint_t<sizeof(T)> radix_ukey(T v) {
+	using ukey_t = fea::byte_uint_t<sizeof(T)>;
+	constexpr ukey_t sign_bit = ukey_t(ukey_t(1) << (sizeof(T) * 8 - 1));
+
+	ukey_t ret;
+	std::memcpy(&ret, &v, sizeof(T));
+	if constexpr (std::is_floating_point_v<T>) {
+		// Negatives are reversed, positives go after negatives.
+		return (ret & sign_bit) != 0 ? ukey_t(~ret) : ukey_t(ret | sign_bit);
+	} else if constexpr (std::is_signed_v<T>) {
+		return ukey_t(ret ^ sign_bit);
+	} else {
+		return ret;
+	}
+}
+
+// Single-threaded lsd radix sort of records, generic on storage.
+// key_at(from_scratch, i) returns the key of record i.
+// move_to(from_scratch, i, dst_i) moves record i to the other storage.
+// Returns true if the sorted records ended in scratch storage.
+template <class Key, class KeyAt, class MoveTo>
+bool radix_sort_records(size_t count, const KeyAt& key_at, const MoveTo& move_to) {
+	static_assert(std::is_arithmetic_v<Key>,
+			"Radix sort only works on arithmetic keys.");
+	using ukey_t = fea::byte_uint_t<sizeof(Key)>;
+	using counts_t = std::array<size_t, 256>;
+
+	// Compute all histograms in one go, and check if already sorted.
+	std::array<counts_t, sizeof(Key)> counts{};
+	{
+		bool pre_sorted = true;
+		ukey_t prev_ukey = radix_ukey(key_at(false, 0));
+		for (size_t i = 0; i < count; ++i) {
+			ukey_t ukey = radix_ukey(key_at(false, i));
+			pre_sorted &= prev_ukey <= ukey;
+			prev_ukey = ukey;
+
+			fea::static_for<sizeof(Key)>([&](auto const_pass_idx) {
+				constexpr size_t pass_idx = const_pass_idx;
+				++std::get<pass_idx>(counts)[(ukey >> (pass_idx * 8)) & 0xFFu];
+			});
+		}
+
+		if (pre_sorted) {
+			return false;
+		}
+	}
+
+	bool in_scratch = false;
+	for (counts_t& offsets : counts) {
+		const size_t pass_idx = size_t(&offsets - counts.data());
+
+		// Skip passes where all keys share the same radix.
+		if (std::find(offsets.begin(), offsets.end(), count) != offsets.end()) {
+			continue;
+		}
+
+		size_t offset = 0;
+		for (size_t& o : offsets) {
+			size_t c = o;
+			o = offset;
+			offset += c;
+		}
+
+		for (size_t i = 0; i < count; ++i) {
+			ukey_t ukey = radix_ukey(key_at(in_scratch, i));
+			size_t radix = size_t((ukey >> (pass_idx * 8)) & 0xFFu);
+			move_to(in_scratch, i, offsets[radix]++);
+		}
+		in_scratch = !in_scratch;
+	}
+	return in_scratch;
+}
+
+template <class RandIt, class Proj>
+void radix_sort_by(RandIt first, size_t count, const Proj& key_projection,
+		fea::iterator_value_t<RandIt>* scratch) {
+	using value_t = fea::iterator_value_t<RandIt>;
+	using key_t = std::decay_t<std::invoke_result_t<const Proj&,
+			const value_t&>>;
+
+	bool in_scratch = radix_sort_records<key_t>(
+			count,
+			[&](bool from_scratch, size_t i) -> key_t {
+				if (from_scratch) {
+					return std::invoke(key_projection, scratch[i]);
+				}
+				return std::invoke(key_projection, first[i]);
+			},
+			[&](bool from_scratch, size_t i, size_t dst_i) {
+				if (from_scratch) {
+					first[dst_i] = std::move(scratch[i]);
+				} else {
+					scratch[dst_i] = std::move(first[i]);
+				}
+			});
+
+	if (in_scratch) {
+		// The output is in the wrong storage.
+		std::move(scratch, scratch + count, first);
+	}
+}
+
 } // namespace detail
 
 
@@ -377,13 +564,44 @@ void radix_sort(FwdIt first, FwdIt last) {
 		return;
 	}
 
+	if (count < fea::detail::radix_insertion_threshold) {
+		fea::detail::insertion_sort(first, last);
+		return;
+	}
+
 	// Dispatch to the most appropriate index type to optimize memory usage.
 	// Overall, we'll use more memory in total, since we have 1 cache per index
 	// size. However for any given sort, the memory will be as compressed as
 	// possible, accelerating the loops.
 	// Absolutely take the tradeoff!
 	fea::detail::radix_get_tls_cache(count, [&](auto& local_cache) {
-		return fea::detail::radix_sort(first, last, count, local_cache);
+		return fea::detail::radix_sort(first, last, count, {}, local_cache);
+	});
+}
+
+template <class FwdIt>
+void radix_sort(FwdIt first, FwdIt last,
+		fea::span<fea::iterator_value_t<FwdIt>> scratch) {
+	fea::detail::radix_checks<FwdIt>();
+
+	size_t count = size_t(std::distance(first, last));
+	if (scratch.size() < count) {
+		fea::maybe_throw<std::invalid_argument>(
+				__FUNCTION__, __LINE__, "Scratch memory is too small.");
+	}
+
+	if (count <= 1) {
+		return;
+	}
+
+	if (count < fea::detail::radix_insertion_threshold) {
+		fea::detail::insertion_sort(first, last);
+		return;
+	}
+
+	fea::detail::radix_get_tls_cache(count, [&](auto& local_cache) {
+		return fea::detail::radix_sort(
+				first, last, count, scratch, local_cache);
 	});
 }
 
@@ -419,4 +637,89 @@ void radix_sort_idxes(
 				first, last, idx_first, idx_last, count, local_cache);
 	});
 }
+
+template <class RandIt, class Proj>
+void radix_sort_by(RandIt first, RandIt last, Proj&& key_projection) {
+	using value_t = fea::iterator_value_t<RandIt>;
+	size_t count = size_t(std::distance(first, last));
+	if (count <= 1) {
+		return;
+	}
+
+	std::vector<value_t> scratch(count);
+	fea::radix_sort_by(first, last, std::forward<Proj>(key_projection),
+			fea::span<value_t>{ scratch.data(), scratch.size() });
+}
+
+template <class RandIt, class Proj>
+void radix_sort_by(RandIt first, RandIt last, Proj&& key_projection,
+		fea::span<fea::iterator_value_t<RandIt>> scratch) {
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+						  fea::iterator_category_t<RandIt>>,
+			"Iterators must be random access iterators.");
+
+	size_t count = size_t(std::distance(first, last));
+	if (scratch.size() < count) {
+		fea::maybe_throw<std::invalid_argument>(
+				__FUNCTION__, __LINE__, "Scratch memory is too small.");
+	}
+
+	if (count <= 1) {
+		return;
+	}
+
+	fea::detail::radix_sort_by(first, count, key_projection, scratch.data());
+}
+
+template <class RandIt, class RandIt2>
+void radix_sort_paired(RandIt first, RandIt last, RandIt2 payload_first,
+		RandIt2 payload_last) {
+	fea::detail::radix_checks<RandIt>();
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+						  fea::iterator_category_t<RandIt>>
+					  && std::is_base_of_v<std::random_access_iterator_tag,
+							  fea::iterator_category_t<RandIt2>>,
+			"Iterators must be random access iterators.");
+	using key_t = fea::iterator_value_t<RandIt>;
+	using payload_t = fea::iterator_value_t<RandIt2>;
+
+	size_t count = size_t(std::distance(first, last));
+	size_t payload_count = size_t(std::distance(payload_first, payload_last));
+	if (count != payload_count) {
+		fea::maybe_throw<std::invalid_argument>(
+				__FUNCTION__, __LINE__, "Mismatch key and payload count.");
+	}
+
+	if (count <= 1) {
+		return;
+	}
+
+	std::vector<key_t> key_scratch(count);
+	std::vector<payload_t> payload_scratch(count);
+
+	bool in_scratch = fea::detail::radix_sort_records<key_t>(
+			count,
+			[&](bool from_scratch, size_t i) -> key_t {
+				if (from_scratch) {
+					return key_scratch[i];
+				}
+				return first[i];
+			},
+			[&](bool from_scratch, size_t i, size_t dst_i) {
+				if (from_scratch) {
+					first[dst_i] = key_scratch[i];
+					payload_first[dst_i] = std::move(payload_scratch[i]);
+				} else {
+					key_scratch[dst_i] = first[i];
+					payload_scratch[dst_i] = std::move(payload_first[i]);
+				}
+			});
+
+	if (in_scratch) {
+		// The output is in the wrong storage.
+		std::copy(key_scratch.begin(), key_scratch.end(), first);
+		std::move(payload_scratch.begin(), payload_scratch.end(),
+				payload_first);
+	}
+}
 } // namespace fea
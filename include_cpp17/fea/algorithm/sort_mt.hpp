@@ -0,0 +1,243 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/algorithm/sort.hpp"
+#include "fea/containers/span.hpp"
+#include "fea/meta/traits.hpp"
+#include "fea/performance/cpu_topology.hpp"
+#include "fea/performance/thread.hpp"
+#include "fea/utility/error.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#if FEA_WITH_TBB
+#include <tbb/parallel_for.h>
+#endif
+
+/*
+Multi-threaded radix sorts.
+Kept out of sort.hpp, so single-threaded sorts don't pull in threads and the
+cpu topology.
+*/
+
+namespace fea {
+// Multi-threaded radix sort.
+// Histograms and scatters are computed in parallel, on one chunk of the values
+// per physical core. Uses tbb if FEA_WITH_TBB is set, fea::parallel_for
+// otherwise. Small ranges are sorted on the caller thread.
+//
+// Iterators must be random access.
+// Allocates values every call.
+template <class RandIt>
+void radix_sort_mt(RandIt first, RandIt last);
+
+// Multi-threaded radix sort, using the provided scratch memory.
+// Scratch must be at least as large as the sorted range.
+// Doesn't allocate values.
+template <class RandIt>
+void radix_sort_mt(RandIt first, RandIt last,
+		fea::span<fea::iterator_value_t<RandIt>> scratch);
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+namespace detail {
+// Under this count, the multi-threaded sort runs on the caller thread.
+inline constexpr size_t radix_mt_threshold = 65'536u;
+
+// Calls func(chunk_idx) for every chunk, in parallel.
+template <class Func>
+void radix_parallel(size_t num_chunks, const Func& func) {
+#if FEA_WITH_TBB
+	tbb::parallel_for(size_t(0), num_chunks, [&](size_t i) { func(i); });
+#else
+	fea::parallel_for(
+			num_chunks, [&](const std::pair<size_t, size_t>& range, size_t) {
+				for (size_t i = range.first; i < range.second; ++i) {
+					func(i);
+				}
+			});
+#endif
+}
+
+// Multi-threaded lsd radix sort.
+// Each chunk computes its histogram, then offsets are computed so every chunk
+// scatters in its own region of the buckets. This keeps the sort stable.
+template <class RandIt>
+void radix_sort_mt(RandIt first, size_t count,
+		fea::iterator_value_t<RandIt>* scratch) {
+	using value_t = fea::iterator_value_t<RandIt>;
+	using counts_t = std::array<size_t, 256>;
+	static_assert(sizeof(value_t) <= sizeof(uint64_t),
+			"Multi-threaded radix sort doesn't support values larger than 64 "
+			"bits.");
+
+	// Histograms and scatters are memory bound, hyper-threads don't help.
+	const size_t num_chunks = fea::num_physical_threads();
+	const size_t chunk_size = (count + num_chunks - 1) / num_chunks;
+	std::vector<counts_t> chunk_counts(num_chunks);
+
+	auto chunk_first = [&](size_t chunk_idx) {
+		return (std::min)(chunk_idx * chunk_size, count);
+	};
+	auto chunk_last = [&](size_t chunk_idx) {
+		return (std::min)((chunk_idx + 1) * chunk_size, count);
+	};
+
+	bool in_scratch = false;
+	for (size_t pass_idx = 0; pass_idx < sizeof(value_t); ++pass_idx) {
+		const size_t shift = pass_idx * 8;
+
+		// Compute histograms.
+		auto histogram = [&](auto src) {
+			radix_parallel(num_chunks, [&](size_t chunk_idx) {
+				counts_t& counts = chunk_counts[chunk_idx];
+				counts.fill(0);
+				for (size_t i = chunk_first(chunk_idx); i < chunk_last(chunk_idx);
+						++i) {
+					++counts[(radix_ukey(src[i]) >> shift) & 0xFFu];
+				}
+			});
+		};
+		if (in_scratch) {
+			histogram(scratch);
+		} else {
+			histogram(first);
+		}
+
+		// Compute offsets. Every chunk writes after the previous chunks
+		// in a given bucket.
+		// Skip passes where all values share the same radix.
+		bool skip_pass = false;
+		size_t offset = 0;
+		for (size_t radix = 0; radix < 256; ++radix) {
+			size_t bucket_count = 0;
+			for (const counts_t& counts : chunk_counts) {
+				bucket_count += counts[radix];
+			}
+			if (bucket_count == count) {
+				skip_pass = true;
+				break;
+			}
+
+			for (counts_t& counts : chunk_counts) {
+				size_t c = counts[radix];
+				counts[radix] = offset;
+				offset += c;
+			}
+		}
+
+		if (skip_pass) {
+			continue;
+		}
+
+		// Scatter.
+		auto scatter = [&](auto src, auto dst) {
+			radix_parallel(num_chunks, [&](size_t chunk_idx) {
+				counts_t& offsets = chunk_counts[chunk_idx];
+				for (size_t i = chunk_first(chunk_idx); i < chunk_last(chunk_idx);
+						++i) {
+					const value_t& v = src[i];
+					dst[offsets[(radix_ukey(v) >> shift) & 0xFFu]++] = v;
+				}
+			});
+		};
+		if (in_scratch) {
+			scatter(scratch, first);
+		} else {
+			scatter(first, scratch);
+		}
+		in_scratch = !in_scratch;
+	}
+
+	if (in_scratch) {
+		// The output is in the wrong storage.
+		radix_parallel(num_chunks, [&](size_t chunk_idx) {
+			std::copy(scratch + chunk_first(chunk_idx),
+					scratch + chunk_last(chunk_idx),
+					first + chunk_first(chunk_idx));
+		});
+	}
+}
+} // namespace detail
+
+
+template <class RandIt>
+void radix_sort_mt(RandIt first, RandIt last) {
+	fea::detail::radix_checks<RandIt>();
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+						  fea::iterator_category_t<RandIt>>,
+			"Iterators must be random access iterators.");
+	using value_t = fea::iterator_value_t<RandIt>;
+
+	size_t count = size_t(std::distance(first, last));
+	if (count < fea::detail::radix_mt_threshold) {
+		fea::radix_sort(first, last);
+		return;
+	}
+
+	std::vector<value_t> scratch(count);
+	fea::detail::radix_sort_mt(first, count, scratch.data());
+}
+
+template <class RandIt>
+void radix_sort_mt(RandIt first, RandIt last,
+		fea::span<fea::iterator_value_t<RandIt>> scratch) {
+	fea::detail::radix_checks<RandIt>();
+	static_assert(std::is_base_of_v<std::random_access_iterator_tag,
+						  fea::iterator_category_t<RandIt>>,
+			"Iterators must be random access iterators.");
+
+	size_t count = size_t(std::distance(first, last));
+	if (scratch.size() < count) {
+		fea::maybe_throw<std::invalid_argument>(
+				__FUNCTION__, __LINE__, "Scratch memory is too small.");
+	}
+
+	if (count < fea::detail::radix_mt_threshold) {
+		fea::radix_sort(first, last, scratch);
+		return;
+	}
+
+	fea::detail::radix_sort_mt(first, count, scratch.data());
+}
+} // namespace fea
@@ -29,15 +29,24 @@
  * OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
  */
 #pragma once
+#include "fea/benchmark/perf_counters.hpp"
+#include "fea/math/statistics.hpp"
+#include "fea/utility/file.hpp"
 #include "fea/utility/platform.hpp"
 #include "fea/utility/unused.hpp"
 
 #include <algorithm>
 #include <chrono>
+#include <cmath>
 #include <cstdio>
+#include <cstdlib>
 #include <cstring>
+#include <filesystem>
+#include <optional>
 #include <string>
 #include <thread>
+#include <type_traits>
+#include <unordered_map>
 #include <vector>
 
 #if FEA_WINDOWS
@@ -77,6 +86,84 @@ inline void escape(void* p);
  */
 inline void clobber();
 
+// Run-wide settings, usually filled from the command-line.
+// Non-zero values override the per-suite settings.
+struct options {
+	// Unmeasured runs of each benchmark, before sampling.
+	size_t warmup = 0;
+
+	// Number of samples per benchmark (overrides suite::average).
+	size_t samples = 0;
+
+	// Calibrates iterations so a sample lasts at least this long.
+	std::chrono::nanoseconds min_sample_time{ 0 };
+
+	// Rejects samples further than sigma * stddev from the mean.
+	double outlier_sigma = 0.0;
+
+	// Measures hardware performance counters, when available.
+	bool counters = false;
+
+	// Relative slowdown from baseline mean considered a regression,
+	// if it is also statistically significant.
+	double regression_threshold = 0.05;
+};
+
+// The statistics of a benchmark, times are in seconds per iteration.
+struct result {
+	std::string suite;
+	std::string name;
+	size_t samples = 0;
+	size_t iterations = 1;
+	size_t outliers = 0;
+	double mean = 0.0;
+	double min = 0.0;
+	double median = 0.0;
+	double p90 = 0.0;
+	double p99 = 0.0;
+	double max = 0.0;
+	double stddev = 0.0;
+
+	// Hardware counters per iteration, over all samples.
+	// Negative when not measured.
+	std::array<double, size_t(perf_counter::count)> counters{ -1.0, -1.0,
+		-1.0, -1.0, -1.0 };
+};
+
+// The global run options.
+[[nodiscard]]
+inline options& global_options();
+
+// All results printed so far, in order.
+[[nodiscard]]
+inline const std::vector<result>& report();
+
+// Loads a previously written json report. Printed results are compared
+// against it and flagged when slower.
+inline bool load_baseline(const std::filesystem::path& path);
+
+// The number of regressions flagged against the baseline so far.
+[[nodiscard]]
+inline size_t num_regressions();
+
+// Is current slower than baseline by more than the relative threshold,
+// and is the difference statistically significant (Welch's t-test).
+[[nodiscard]]
+inline bool is_regression(
+		const result& baseline, const result& current, double threshold);
+
+// Writes results as json. Returns false on failure.
+inline bool write_json(
+		const std::filesystem::path& path, const std::vector<result>& results);
+
+// Writes results as csv, one row per benchmark. Returns false on failure.
+inline bool write_csv(
+		const std::filesystem::path& path, const std::vector<result>& results);
+
+// Reads results written with write_json. Returns false on failure.
+inline bool read_json(
+		const std::filesystem::path& path, std::vector<result>& results);
+
 struct suite {
 	// Set the title for the benchmark run. Optional.
 	inline void title(const std::string& message);
@@ -90,6 +177,22 @@ struct suite {
 	// Useful when profiling. Sleeps in between runs of the benchmarks.
 	inline void sleep_between(std::chrono::milliseconds milli_seconds);
 
+	// Run each benchmark num_runs times before measuring.
+	inline void warmup(size_t num_runs);
+
+	// Runs func multiple times per sample, so each sample lasts at least
+	// min_time. Useful for very short benchmarks. The in-between function
+	// is still called after each call to func.
+	inline void calibrate(std::chrono::nanoseconds min_time);
+
+	// Rejects samples further than sigma * standard deviation from the
+	// mean. Disabled with 0.
+	inline void reject_outliers(double sigma);
+
+	// Measures hardware performance counters (cycles, instructions, cache,
+	// branch and tlb misses) of the calling thread, when available.
+	inline void counters(bool enable);
+
 	// Run a benchmark on func.
 	// If averaging was set, will average the times.
 	// Pass in message (name of the benchmark).
@@ -107,6 +210,10 @@ struct suite {
 	template <class Func>
 	void benchmark(const std::string& message, Func&& func);
 
+	// The results of benchmarks ran since the last print.
+	[[nodiscard]]
+	inline const std::vector<result>& results() const;
+
 	// Print the results of the benchmark run to selected stream output
 	// (defaults to stdout).
 	// Resets the suite to accept new benchmarks.
@@ -115,18 +222,18 @@ struct suite {
 private:
 	using clock_duration_t = std::chrono::steady_clock::duration;
 
-	struct pair {
-		inline pair(const std::string& msg, double t);
-		pair() = default;
-
-		std::string message;
-		double time{ 0.0 };
-	};
+	inline void compute(const std::string& message,
+			std::vector<double>&& samples, size_t iterations,
+			const perf_values& counter_values);
 
 	std::string _title;
 	size_t _num_average = 1;
+	size_t _num_warmup = 0;
+	std::chrono::nanoseconds _min_sample_time{ 0 };
+	double _outlier_sigma = 0.0;
+	bool _counters = false;
 	std::chrono::milliseconds _sleep_between{ 0 };
-	std::vector<pair> _results;
+	std::vector<result> _results;
 };
 } // namespace bench
 } // namespace fea
@@ -183,6 +290,402 @@ void clobber() {
 #endif
 }
 
+namespace detail {
+struct global_state {
+	options opts;
+	std::vector<result> report;
+	std::unordered_map<std::string, result> baseline;
+	size_t num_regressions = 0;
+	bool counters_warned = false;
+};
+
+inline global_state& global() {
+	static global_state ret;
+	return ret;
+}
+
+inline std::string baseline_key(const result& r) {
+	return r.suite + '\n' + r.name;
+}
+
+// Tag for benchmarks without an in-between function, allows timing
+// multiple iterations at once.
+struct no_inbetween {
+	constexpr void operator()() const {
+	}
+};
+
+// Approximate one-sided 99% critical value of Student's t distribution.
+// Cornish-Fisher expansion around the normal quantile.
+inline double t_critical(double df) {
+	constexpr double z = 2.326348;
+	const double z3 = z * z * z;
+	const double z5 = z3 * z * z;
+	const double z7 = z5 * z * z;
+	return z + (z3 + z) / (4.0 * df)
+			+ (5.0 * z5 + 16.0 * z3 + 3.0 * z) / (96.0 * df * df)
+			+ (3.0 * z7 + 19.0 * z5 + 17.0 * z3 - 15.0 * z)
+			/ (384.0 * df * df * df);
+}
+
+inline void json_write_string(std::FILE* f, const std::string& str) {
+	std::fputc('"', f);
+	for (char c : str) {
+		if (c == '"' || c == '\\') {
+			std::fputc('\\', f);
+			std::fputc(c, f);
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			std::fprintf(f, "\\u%04x", unsigned(c));
+		} else {
+			std::fputc(c, f);
+		}
+	}
+	std::fputc('"', f);
+}
+
+// Prints available counters per iteration, and ipc.
+inline void print_counters(FILE* stream, const result& r) {
+	fprintf(stream, "%s", " ");
+	for (size_t i = 0; i < r.counters.size(); ++i) {
+		if (r.counters[i] < 0.0) {
+			continue;
+		}
+		fprintf(stream, " %s %.2f ", to_string(perf_counter(i)),
+				r.counters[i]);
+
+		double cycles = r.counters[size_t(perf_counter::cycles)];
+		if (perf_counter(i) == perf_counter::instructions && cycles > 0.0) {
+			fprintf(stream, " ipc %.2f ", r.counters[i] / cycles);
+		}
+	}
+	fprintf(stream, "%s", " (per iteration)\n");
+}
+
+inline void csv_write_string(std::FILE* f, const std::string& str) {
+	std::fputc('"', f);
+	for (char c : str) {
+		if (c == '"') {
+			std::fputc('"', f);
+		}
+		std::fputc(c, f);
+	}
+	std::fputc('"', f);
+}
+
+// Reads the subset of json written by write_json.
+struct json_reader {
+	bool expect(char c) {
+		skip_whitespace();
+		if (it == end || *it != c) {
+			return false;
+		}
+		++it;
+		return true;
+	}
+
+	bool peek(char c) {
+		skip_whitespace();
+		return it != end && *it == c;
+	}
+
+	bool read_string(std::string& out) {
+		if (!expect('"')) {
+			return false;
+		}
+
+		out.clear();
+		while (it != end && *it != '"') {
+			char c = *it++;
+			if (c != '\\') {
+				out.push_back(c);
+				continue;
+			}
+
+			if (it == end) {
+				return false;
+			}
+			c = *it++;
+			switch (c) {
+			case 'n': {
+				out.push_back('\n');
+			} break;
+			case 't': {
+				out.push_back('\t');
+			} break;
+			case 'r': {
+				out.push_back('\r');
+			} break;
+			case 'u': {
+				// Only ascii escapes are supported.
+				if (end - it < 4) {
+					return false;
+				}
+				char hex[5] = { it[0], it[1], it[2], it[3], '\0' };
+				char* hex_end = nullptr;
+				unsigned long v = std::strtoul(hex, &hex_end, 16);
+				if (hex_end != hex + 4 || v >= 0x80) {
+					return false;
+				}
+				out.push_back(char(v));
+				it += 4;
+			} break;
+			default: {
+				out.push_back(c);
+			} break;
+			}
+		}
+		return expect('"');
+	}
+
+	// Expects a null terminated buffer.
+	bool read_number(double& out) {
+		skip_whitespace();
+		char* num_end = nullptr;
+		out = std::strtod(it, &num_end);
+		if (num_end == it) {
+			return false;
+		}
+		it = num_end;
+		return true;
+	}
+
+	void skip_whitespace() {
+		while (it != end
+				&& (*it == ' ' || *it == '\t' || *it == '\n' || *it == '\r')) {
+			++it;
+		}
+	}
+
+	const char* it = nullptr;
+	const char* end = nullptr;
+};
+
+inline bool json_read_result(json_reader& reader, result& res) {
+	if (!reader.expect('{')) {
+		return false;
+	}
+	if (reader.expect('}')) {
+		return true;
+	}
+
+	std::string key;
+	std::string str;
+	double num = 0.0;
+	do {
+		if (!reader.read_string(key) || !reader.expect(':')) {
+			return false;
+		}
+
+		if (reader.peek('"')) {
+			if (!reader.read_string(str)) {
+				return false;
+			}
+			if (key == "suite") {
+				res.suite = str;
+			} else if (key == "name") {
+				res.name = str;
+			}
+			continue;
+		}
+
+		if (!reader.read_number(num)) {
+			return false;
+		}
+		if (key == "samples") {
+			res.samples = size_t(num);
+		} else if (key == "iterations") {
+			res.iterations = size_t(num);
+		} else if (key == "outliers") {
+			res.outliers = size_t(num);
+		} else if (key == "mean") {
+			res.mean = num;
+		} else if (key == "min") {
+			res.min = num;
+		} else if (key == "median") {
+			res.median = num;
+		} else if (key == "p90") {
+			res.p90 = num;
+		} else if (key == "p99") {
+			res.p99 = num;
+		} else if (key == "max") {
+			res.max = num;
+		} else if (key == "stddev") {
+			res.stddev = num;
+		} else {
+			for (size_t i = 0; i < res.counters.size(); ++i) {
+				if (key == to_string(perf_counter(i))) {
+					res.counters[i] = num;
+				}
+			}
+		}
+	} while (reader.expect(','));
+
+	return reader.expect('}');
+}
+} // namespace detail
+
+options& global_options() {
+	return detail::global().opts;
+}
+
+const std::vector<result>& report() {
+	return detail::global().report;
+}
+
+bool load_baseline(const std::filesystem::path& path) {
+	std::vector<result> results;
+	if (!read_json(path, results)) {
+		return false;
+	}
+
+	detail::global_state& state = detail::global();
+	state.baseline.clear();
+	for (result& r : results) {
+		std::string key = detail::baseline_key(r);
+		state.baseline.insert_or_assign(std::move(key), std::move(r));
+	}
+	return true;
+}
+
+size_t num_regressions() {
+	return detail::global().num_regressions;
+}
+
+bool is_regression(
+		const result& baseline, const result& current, double threshold) {
+	if (!(current.mean > baseline.mean * (1.0 + threshold))) {
+		return false;
+	}
+
+	// Without spread, only the threshold can be used.
+	if (baseline.samples < 2 || current.samples < 2) {
+		return true;
+	}
+
+	const double nb = double(baseline.samples);
+	const double nc = double(current.samples);
+	const double vb = baseline.stddev * baseline.stddev / nb;
+	const double vc = current.stddev * current.stddev / nc;
+	const double std_err = std::sqrt(vb + vc);
+	if (std_err == 0.0) {
+		return true;
+	}
+
+	const double t = (current.mean - baseline.mean) / std_err;
+	const double df = (vb + vc) * (vb + vc)
+			/ (vb * vb / (nb - 1.0) + vc * vc / (nc - 1.0));
+	return t > detail::t_critical(df);
+}
+
+bool write_json(
+		const std::filesystem::path& path, const std::vector<result>& results) {
+	std::FILE* f = fea::fopen(path, "wb");
+	if (f == nullptr) {
+		return false;
+	}
+
+	std::fprintf(f, "{\n\t\"benchmarks\": [");
+	for (size_t i = 0; i < results.size(); ++i) {
+		const result& r = results[i];
+		std::fprintf(f, "%s\n\t\t{ \"suite\": ", i == 0 ? "" : ",");
+		detail::json_write_string(f, r.suite);
+		std::fprintf(f, ", \"name\": ");
+		detail::json_write_string(f, r.name);
+		std::fprintf(f,
+				", \"samples\": %zu, \"iterations\": %zu, \"outliers\": %zu, "
+				"\"mean\": %.17g, \"min\": %.17g, \"median\": %.17g, "
+				"\"p90\": %.17g, \"p99\": %.17g, \"max\": %.17g, "
+				"\"stddev\": %.17g",
+				r.samples, r.iterations, r.outliers, r.mean, r.min, r.median,
+				r.p90, r.p99, r.max, r.stddev);
+		for (size_t j = 0; j < r.counters.size(); ++j) {
+			if (r.counters[j] >= 0.0) {
+				std::fprintf(f, ", \"%s\": %.17g", to_string(perf_counter(j)),
+						r.counters[j]);
+			}
+		}
+		std::fprintf(f, " }");
+	}
+	std::fprintf(f, "\n\t]\n}\n");
+	return std::fclose(f) == 0;
+}
+
+bool write_csv(
+		const std::filesystem::path& path, const std::vector<result>& results) {
+	std::FILE* f = fea::fopen(path, "wb");
+	if (f == nullptr) {
+		return false;
+	}
+
+	std::fprintf(f,
+			"suite,name,samples,iterations,outliers,mean,min,median,p90,p99,"
+			"max,stddev");
+	for (size_t i = 0; i < size_t(perf_counter::count); ++i) {
+		std::fprintf(f, ",%s", to_string(perf_counter(i)));
+	}
+	std::fputc('\n', f);
+
+	for (const result& r : results) {
+		detail::csv_write_string(f, r.suite);
+		std::fputc(',', f);
+		detail::csv_write_string(f, r.name);
+		std::fprintf(f,
+				",%zu,%zu,%zu,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g,%.17g",
+				r.samples, r.iterations, r.outliers, r.mean, r.min, r.median,
+				r.p90, r.p99, r.max, r.stddev);
+
+		// Empty when not measured.
+		for (double c : r.counters) {
+			std::fputc(',', f);
+			if (c >= 0.0) {
+				std::fprintf(f, "%.17g", c);
+			}
+		}
+		std::fputc('\n', f);
+	}
+	return std::fclose(f) == 0;
+}
+
+bool read_json(
+		const std::filesystem::path& path, std::vector<result>& results) {
+	std::FILE* f = fea::fopen(path, "rb");
+	if (f == nullptr) {
+		return false;
+	}
+
+	std::string data;
+	char buf[4096];
+	size_t read_size = 0;
+	while ((read_size = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+		data.append(buf, read_size);
+	}
+	std::fclose(f);
+
+	detail::json_reader reader{ data.c_str(), data.c_str() + data.size() };
+	std::string key;
+	if (!reader.expect('{') || !reader.read_string(key) || key != "benchmarks"
+			|| !reader.expect(':') || !reader.expect('[')) {
+		return false;
+	}
+
+	std::vector<result> ret;
+	if (!reader.peek(']')) {
+		do {
+			result res;
+			if (!detail::json_read_result(reader, res)) {
+				return false;
+			}
+			ret.push_back(std::move(res));
+		} while (reader.expect(','));
+	}
+
+	if (!reader.expect(']') || !reader.expect('}')) {
+		return false;
+	}
+	results = std::move(ret);
+	return true;
+}
+
 void suite::title(const std::string& message) {
 	_title = message;
 }
@@ -202,34 +705,131 @@ void suite::sleep_between(std::chrono::milliseconds milli_seconds) {
 	_sleep_between = milli_seconds;
 }
 
+void suite::warmup(size_t num_runs) {
+	_num_warmup = num_runs;
+}
+
+void suite::calibrate(std::chrono::nanoseconds min_time) {
+	_min_sample_time = min_time;
+}
+
+void suite::reject_outliers(double sigma) {
+	_outlier_sigma = sigma;
+}
+
+void suite::counters(bool enable) {
+	_counters = enable;
+}
+
 template <class Func, class InBetweenFunc>
 void suite::benchmark(const std::string& message, Func&& func,
 		InBetweenFunc&& inbetween_func) {
+	const options& opts = global_options();
+	const size_t num_samples = (std::max)(size_t(1),
+			opts.samples != 0 ? opts.samples : _num_average);
+	const size_t num_warmup = opts.warmup != 0 ? opts.warmup : _num_warmup;
+	const std::chrono::nanoseconds min_time
+			= opts.min_sample_time.count() != 0 ? opts.min_sample_time
+												: _min_sample_time;
+
+	// Counters are enabled outside the timed region.
+	std::optional<perf_counters> counters;
+	if (opts.counters || _counters) {
+		counters.emplace();
+		detail::global_state& state = detail::global();
+		if (!counters->available() && !state.counters_warned) {
+			state.counters_warned = true;
+			fprintf(stderr, "%s",
+					"Hardware performance counters are unavailable.\n");
+		}
+	}
+
+	// Times iterations calls to func, the in-between function isn't measured.
+	auto run = [&](size_t iterations, perf_counters* pc) {
+		if constexpr (std::is_same_v<std::decay_t<InBetweenFunc>,
+							  detail::no_inbetween>) {
+			if (pc != nullptr) {
+				pc->enable();
+			}
+			time_point_t start_time = std::chrono::steady_clock::now();
+			for (size_t i = 0; i < iterations; ++i) {
+				func();
+			}
+			time_point_t end_time = std::chrono::steady_clock::now();
+			if (pc != nullptr) {
+				pc->disable();
+			}
+			return clock_duration_t(end_time - start_time);
+		} else {
+			clock_duration_t elapsed_time = clock_duration_t(0);
+			for (size_t i = 0; i < iterations; ++i) {
+				if (pc != nullptr) {
+					pc->enable();
+				}
+				time_point_t start_time = std::chrono::steady_clock::now();
+				func();
+				elapsed_time += std::chrono::steady_clock::now() - start_time;
+				if (pc != nullptr) {
+					pc->disable();
+				}
+				inbetween_func();
+			}
+			return elapsed_time;
+		}
+	};
 
-	clock_duration_t elapsed_time = clock_duration_t(0);
 	std::this_thread::sleep_for(_sleep_between);
 
-	for (size_t i = 0; i < _num_average; ++i) {
-		std::chrono::time_point<std::chrono::steady_clock> _start_time,
-				_end_time;
+	for (size_t i = 0; i < num_warmup; ++i) {
+		run(1, nullptr);
+	}
 
-		_start_time = std::chrono::steady_clock::now();
-		func();
-		_end_time = std::chrono::steady_clock::now();
+	// Grow iterations until a sample lasts min_time, at most 10x per step.
+	size_t iterations = 1;
+	if (min_time.count() > 0) {
+		constexpr size_t max_iterations = size_t(1) << 32;
+		while (iterations < max_iterations) {
+			clock_duration_t elapsed_time = run(iterations, nullptr);
+			if (elapsed_time >= min_time) {
+				break;
+			}
+
+			double multiplier = 10.0;
+			if (elapsed_time.count() > 0) {
+				multiplier = (std::min)(multiplier,
+						1.4 * std::chrono::duration<double>(min_time)
+										.count()
+								/ std::chrono::duration<double>(elapsed_time)
+										  .count());
+			}
+			iterations = (std::max)(
+					iterations + 1, size_t(double(iterations) * multiplier));
+		}
+	}
 
-		elapsed_time += _end_time - _start_time;
+	perf_counters* pc = counters ? &*counters : nullptr;
+	if (pc != nullptr) {
+		pc->reset();
+	}
 
-		inbetween_func();
+	std::vector<double> samples;
+	samples.reserve(num_samples);
+	for (size_t i = 0; i < num_samples; ++i) {
+		std::chrono::duration<double> elapsed_d(run(iterations, pc));
+		samples.push_back(elapsed_d.count() / double(iterations));
 	}
 
-	std::chrono::duration<double> elapsed_d(elapsed_time);
-	_results.push_back(
-			pair{ message, elapsed_d.count() / double(_num_average) });
+	compute(message, std::move(samples), iterations,
+			pc != nullptr ? pc->read() : perf_values{});
 }
 
 template <class Func>
 void suite::benchmark(const std::string& message, Func&& func) {
-	benchmark(message, std::forward<Func>(func), []() {});
+	benchmark(message, std::forward<Func>(func), detail::no_inbetween{});
+}
+
+const std::vector<result>& suite::results() const {
+	return _results;
 }
 
 void suite::print(FILE* stream) {
@@ -250,24 +850,98 @@ void suite::print(FILE* stream) {
 
 	if (_results.size() > 1) {
 		std::sort(_results.begin(), _results.end(),
-				[](const pair& lhs, const pair& rhs) {
-					return lhs.time < rhs.time;
+				[](const result& lhs, const result& rhs) {
+					return lhs.mean < rhs.mean;
 				});
 	}
 
-	for (const pair& p : _results) {
-		double ratio = _results.back().time / p.time;
-		fprintf(stream, "%s%*fs        %fx\n", p.message.c_str(),
-				70 - int(p.message.size()), p.time, ratio);
+	detail::global_state& state = detail::global();
+	for (const result& r : _results) {
+		double ratio = _results.back().mean / r.mean;
+		fprintf(stream, "%s%*fs        %fx\n", r.name.c_str(),
+				70 - int(r.name.size()), r.mean, ratio);
+
+		if (r.samples > 1 || r.iterations > 1) {
+			fprintf(stream,
+					"  min %fs  median %fs  p90 %fs  p99 %fs  stddev %fs  "
+					"(%zu samples x %zu iterations, %zu outliers)\n",
+					r.min, r.median, r.p90, r.p99, r.stddev, r.samples,
+					r.iterations, r.outliers);
+		}
+
+		if (std::any_of(r.counters.begin(), r.counters.end(),
+					[](double c) { return c >= 0.0; })) {
+			detail::print_counters(stream, r);
+		}
+
+		auto it = state.baseline.find(detail::baseline_key(r));
+		if (it != state.baseline.end()) {
+			const result& base = it->second;
+			bool slower = is_regression(
+					base, r, state.opts.regression_threshold);
+			state.num_regressions += size_t(slower);
+			fprintf(stream, "  baseline %fs  %+.2f%%%s\n", base.mean,
+					(r.mean / base.mean - 1.0) * 100.0,
+					slower ? "  REGRESSION" : "");
+		}
+
+		state.report.push_back(r);
 	}
 	fprintf(stream, "%s", "\n");
 
 	_results.clear();
 }
 
-suite::pair::pair(const std::string& msg, double t)
-		: message(msg)
-		, time(t) {
+void suite::compute(const std::string& message,
+		std::vector<double>&& samples, size_t iterations,
+		const perf_values& counter_values) {
+	const double sigma = global_options().outlier_sigma != 0.0
+			? global_options().outlier_sigma
+			: _outlier_sigma;
+
+	// Nothing to report, min and max need at least one sample.
+	if (samples.empty()) {
+		return;
+	}
+
+	result res;
+	res.suite = _title;
+	res.name = message;
+	res.iterations = iterations;
+
+	const double num_iterations = double(samples.size() * iterations);
+	for (size_t i = 0; i < res.counters.size(); ++i) {
+		if (counter_values.valid[i]) {
+			res.counters[i] = double(counter_values.values[i]) / num_iterations;
+		}
+	}
+
+	if (sigma > 0.0 && samples.size() > 2) {
+		std::vector<double> kept;
+		kept.reserve(samples.size());
+		fea::sample_sigma_filter(samples.begin(), samples.end(), sigma,
+				[&](double v) { kept.push_back(v); });
+
+		// Identical samples have no deviation and are all filtered.
+		if (!kept.empty()) {
+			res.outliers = samples.size() - kept.size();
+			samples = std::move(kept);
+		}
+	}
+
+	auto minmax = std::minmax_element(samples.begin(), samples.end());
+	res.samples = samples.size();
+	res.mean = fea::mean(samples.begin(), samples.end());
+	res.min = *minmax.first;
+	res.max = *minmax.second;
+	res.median = fea::median(samples.begin(), samples.end());
+	res.p90 = fea::percentile(samples.begin(), samples.end(), 0.9);
+	res.p99 = fea::percentile(samples.begin(), samples.end(), 0.99);
+	if (samples.size() > 1) {
+		res.stddev = fea::sample_std_deviation(samples.begin(), samples.end());
+	}
+
+	_results.push_back(std::move(res));
 }
 } // namespace bench
 } // namespace fea
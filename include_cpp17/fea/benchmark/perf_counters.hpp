@@ -0,0 +1,332 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/utility/platform.hpp"
+
+#include <array>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+
+#if FEA_LINUX
+#include <linux/perf_event.h>
+#include <sys/ioctl.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+/*
+Hardware performance counters, for the calling thread only.
+
+Uses perf_event_open on linux. The counters are opened as one group,
+led by the first counter that opens (cycles when possible), so they
+are scheduled, enabled, disabled and read together. Counters that
+can't be opened (other platforms, virtual machines without a PMU,
+restrictive perf_event_paranoid) are unavailable and always read 0.
+*/
+
+namespace fea {
+namespace bench {
+enum class perf_counter : uint8_t {
+	cycles,
+	instructions,
+	cache_misses,
+	branch_misses,
+	tlb_misses,
+	count,
+};
+
+// Counter values of a measured region.
+struct perf_values {
+	// The value of counter c, 0 if unavailable.
+	[[nodiscard]]
+	constexpr uint64_t operator[](perf_counter c) const;
+
+	// Was counter c measured.
+	[[nodiscard]]
+	constexpr bool has(perf_counter c) const;
+
+	// Instructions per cycle, 0 if unavailable.
+	[[nodiscard]]
+	constexpr double ipc() const;
+
+	std::array<uint64_t, size_t(perf_counter::count)> values{};
+	std::array<bool, size_t(perf_counter::count)> valid{};
+};
+
+// Opens the counters on construction. Counting accumulates over
+// enable / disable pairs, until reset.
+struct perf_counters {
+	inline perf_counters();
+	inline ~perf_counters();
+
+	perf_counters(const perf_counters&) = delete;
+	perf_counters& operator=(const perf_counters&) = delete;
+
+	// Was any counter opened.
+	[[nodiscard]]
+	inline bool available() const;
+
+	// Was counter c opened.
+	[[nodiscard]]
+	inline bool available(perf_counter c) const;
+
+	// Zeroes the counters.
+	inline void reset();
+
+	// Start counting.
+	inline void enable();
+
+	// Stop counting.
+	inline void disable();
+
+	// The accumulated values. Scaled when the kernel multiplexed the group.
+	// No counter is valid if the group was never scheduled.
+	[[nodiscard]]
+	inline perf_values read() const;
+
+	// Resets and enables.
+	inline void start();
+
+	// Disables and reads.
+	[[nodiscard]]
+	inline perf_values stop();
+
+private:
+	std::array<int, size_t(perf_counter::count)> _fds;
+	int _leader = -1;
+};
+
+// The name of counter c.
+[[nodiscard]]
+inline const char* to_string(perf_counter c);
+} // namespace bench
+} // namespace fea
+
+
+/**
+ * Implementation
+ */
+namespace fea {
+namespace bench {
+constexpr uint64_t perf_values::operator[](perf_counter c) const {
+	return values[size_t(c)];
+}
+
+constexpr bool perf_values::has(perf_counter c) const {
+	return valid[size_t(c)];
+}
+
+constexpr double perf_values::ipc() const {
+	if (!has(perf_counter::cycles) || !has(perf_counter::instructions)
+			|| (*this)[perf_counter::cycles] == 0) {
+		return 0.0;
+	}
+	return double((*this)[perf_counter::instructions])
+			/ double((*this)[perf_counter::cycles]);
+}
+
+#if FEA_LINUX
+namespace detail {
+// Opens a counter in the group led by group_fd, or a new group leader
+// if group_fd is -1. Only the leader starts disabled, members follow it.
+inline int perf_open(uint32_t type, uint64_t config, int group_fd) {
+	perf_event_attr attr{};
+	attr.size = sizeof(perf_event_attr);
+	attr.type = type;
+	attr.config = config;
+	attr.disabled = group_fd < 0 ? 1 : 0;
+	attr.exclude_kernel = 1;
+	attr.exclude_hv = 1;
+	attr.read_format = PERF_FORMAT_GROUP | PERF_FORMAT_TOTAL_TIME_ENABLED
+			| PERF_FORMAT_TOTAL_TIME_RUNNING;
+
+	// This thread, any cpu.
+	return int(syscall(SYS_perf_event_open, &attr, 0, -1, group_fd, 0));
+}
+
+// The PERF_FORMAT_GROUP read layout.
+struct perf_group_read {
+	uint64_t nr = 0;
+	uint64_t time_enabled = 0;
+	uint64_t time_running = 0;
+	std::array<uint64_t, size_t(perf_counter::count)> values{};
+};
+} // namespace detail
+
+perf_counters::perf_counters() {
+	constexpr uint64_t dtlb_read_miss = PERF_COUNT_HW_CACHE_DTLB
+			| (PERF_COUNT_HW_CACHE_OP_READ << 8)
+			| (PERF_COUNT_HW_CACHE_RESULT_MISS << 16);
+
+	constexpr std::array<std::pair<uint32_t, uint64_t>,
+			size_t(perf_counter::count)>
+			events{ {
+					{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CPU_CYCLES },
+					{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_INSTRUCTIONS },
+					{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_CACHE_MISSES },
+					{ PERF_TYPE_HARDWARE, PERF_COUNT_HW_BRANCH_MISSES },
+					{ PERF_TYPE_HW_CACHE, dtlb_read_miss },
+			} };
+
+	// Group values are read in open order, leader first.
+	for (size_t i = 0; i < _fds.size(); ++i) {
+		_fds[i] = detail::perf_open(events[i].first, events[i].second, _leader);
+		if (_leader < 0) {
+			_leader = _fds[i];
+		}
+	}
+}
+
+perf_counters::~perf_counters() {
+	// Close the members before their leader.
+	for (size_t i = _fds.size(); i-- > 0;) {
+		if (_fds[i] >= 0) {
+			close(_fds[i]);
+		}
+	}
+}
+
+void perf_counters::reset() {
+	if (_leader >= 0) {
+		ioctl(_leader, PERF_EVENT_IOC_RESET, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+void perf_counters::enable() {
+	if (_leader >= 0) {
+		ioctl(_leader, PERF_EVENT_IOC_ENABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+void perf_counters::disable() {
+	if (_leader >= 0) {
+		ioctl(_leader, PERF_EVENT_IOC_DISABLE, PERF_IOC_FLAG_GROUP);
+	}
+}
+
+perf_values perf_counters::read() const {
+	perf_values ret;
+	if (_leader < 0) {
+		return ret;
+	}
+
+	detail::perf_group_read buf;
+	ssize_t size = ::read(_leader, &buf, sizeof(buf));
+	if (size < ssize_t(3 * sizeof(uint64_t))) {
+		return ret;
+	}
+
+	// The whole group shares its enabled and running times.
+	// A group that never ran measured nothing, its zeros aren't values.
+	if (buf.time_running == 0) {
+		return ret;
+	}
+
+	double scale = 1.0;
+	if (buf.time_running < buf.time_enabled) {
+		scale = double(buf.time_enabled) / double(buf.time_running);
+	}
+
+	size_t idx = 0;
+	for (size_t i = 0; i < _fds.size() && idx < buf.nr; ++i) {
+		if (_fds[i] < 0) {
+			continue;
+		}
+
+		ret.valid[i] = true;
+		ret.values[i] = buf.values[idx++];
+		if (scale != 1.0) {
+			ret.values[i] = uint64_t(double(ret.values[i]) * scale);
+		}
+	}
+	return ret;
+}
+#else
+perf_counters::perf_counters() {
+	_fds.fill(-1);
+}
+
+perf_counters::~perf_counters() = default;
+
+void perf_counters::reset() {
+}
+
+void perf_counters::enable() {
+}
+
+void perf_counters::disable() {
+}
+
+perf_values perf_counters::read() const {
+	return {};
+}
+#endif
+
+bool perf_counters::available() const {
+	for (int fd : _fds) {
+		if (fd >= 0) {
+			return true;
+		}
+	}
+	return false;
+}
+
+bool perf_counters::available(perf_counter c) const {
+	return _fds[size_t(c)] >= 0;
+}
+
+void perf_counters::start() {
+	reset();
+	enable();
+}
+
+perf_values perf_counters::stop() {
+	disable();
+	return read();
+}
+
+const char* to_string(perf_counter c) {
+	constexpr std::array<const char*, size_t(perf_counter::count)> names{
+		"cycles",
+		"instructions",
+		"cache_misses",
+		"branch_misses",
+		"tlb_misses",
+	};
+	assert(c < perf_counter::count);
+	return names[size_t(c)];
+}
+} // namespace bench
+} // namespace fea
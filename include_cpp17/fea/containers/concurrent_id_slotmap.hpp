@@ -0,0 +1,700 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2025, Philippe Groarke
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fea/containers/id_hash.hpp"
+#include "fea/memory/memory.hpp"
+#include "fea/performance/constants.hpp"
+#include "fea/utility/error.hpp"
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+fea::concurrent_id_slotmap is a read-mostly, thread-safe id slot map.
+
+Lookups (find, read, at, contains, count) are wait-free and never block,
+whatever the writers are doing. Writers (insert, erase, clear, etc) are
+serialized between themselves with a mutex, readers never touch it.
+
+Each value lives in an immutable node. Writers publish new nodes atomically
+in a lookup table that grows as big as the biggest id (like fea::id_slotmap).
+Assigning to an existing key publishes a new node, values are never modified
+while a reader may see them.
+
+Removed nodes (and old lookup tables) are reclaimed with epochs, RCU style.
+Readers announce themselves in a striped, cache line padded counter.
+Writers wait until all readers which could have seen a node are gone before
+deleting it. Reclamation is batched, and may be forced with reclaim().
+
+Pointers obtained from find() are only valid while the read_guard passed to
+find() is alive. Use read() or at() for simple one-shot lookups.
+
+Never call a modifier (or reclaim) while the calling thread holds a
+read_guard on the same map. Reclamation waits for every reader to leave,
+including the writer's own guard, and deadlocks. Since reclamation is
+batched, this may only hang once in a while. Debug builds assert instead.
+
+Notes :
+- Since values may be erased at any time, apis don't return iterators.
+	Modifiers return whether the value was inserted.
+- Values are stored in individual nodes, iterate with for_each. Iterating
+	locks out writers, not readers.
+- For single threaded use, prefer fea::id_slotmap or fea::flat_id_slotmap.
+- To add custom id classes, specialize fea::id_hash (see id_slotmap.hpp).
+*/
+
+namespace fea {
+namespace detail {
+// Epoch based reclamation used by concurrent containers.
+// Readers increment a counter on entry and decrement it on exit, the counter
+// parity is selected by the current epoch. Writers flip the epoch twice and
+// wait for both parities to drain.
+struct epoch_domain {
+	epoch_domain() = default;
+	epoch_domain(const epoch_domain&) = delete;
+	epoch_domain(epoch_domain&&) = delete;
+	epoch_domain& operator=(const epoch_domain&) = delete;
+	epoch_domain& operator=(epoch_domain&&) = delete;
+
+	// Enter a read-side critical section. Wait-free.
+	// Returns a ticket to pass to leave.
+	[[nodiscard]]
+	inline size_t enter() const noexcept;
+
+	// Leave a read-side critical section. Wait-free.
+	inline void leave(size_t ticket) const noexcept;
+
+	// Blocks until all readers that entered before this call have left.
+	// Must be called by one thread at a time, which isn't a reader.
+	inline void synchronize() const noexcept;
+
+private:
+	static constexpr size_t num_stripes = 32u;
+
+	struct alignas(fea::cache_line_size) stripe {
+		std::atomic<size_t> counts[2]{};
+	};
+
+	// Threads are assigned a stripe round-robin, on first use.
+	[[nodiscard]]
+	static size_t stripe_idx() noexcept {
+		static std::atomic<size_t> next{ 0 };
+		thread_local size_t idx
+				= next.fetch_add(1, std::memory_order_relaxed) % num_stripes;
+		return idx;
+	}
+
+	// Waits until no reader is in the parity counter.
+	inline void wait_drained(size_t parity) const noexcept;
+
+#if FEA_DEBUG
+	// The domains this thread is reading, once per entered guard.
+	// Fixed size, so reading never allocates. Guards nested deeper than
+	// the capacity are counted but not checked.
+	struct readings {
+		static constexpr size_t capacity = 16u;
+		std::array<const epoch_domain*, capacity> domains{};
+		size_t size = 0;
+	};
+
+	[[nodiscard]]
+	static readings& thread_readings() noexcept {
+		thread_local readings ret;
+		return ret;
+	}
+#endif
+
+	alignas(fea::cache_line_size) mutable std::atomic<size_t> _epoch{ 0 };
+	mutable std::array<stripe, num_stripes> _stripes{};
+};
+} // namespace detail
+
+
+template <class Key, class T>
+struct concurrent_id_slotmap {
+	// Sanity checks.
+	static_assert(std::is_unsigned_v<fea::detail::id_hash_return_t<Key>>,
+			"concurrent_id_slotmap : key or id_hash return type must be "
+			"unsigned integer");
+
+	// Typedefs
+	using key_type = Key;
+	using mapped_type = T;
+	using size_type = std::size_t;
+	using underlying_key_type = fea::detail::id_hash_return_t<Key>;
+
+	// Pins the map for reading. Pointers obtained with find stay valid until
+	// the guard is destroyed. Cheap, wait-free and reentrant.
+	struct read_guard {
+		explicit read_guard(const concurrent_id_slotmap& map) noexcept
+				: _domain(&map._domain)
+				, _ticket(map._domain.enter()) {
+		}
+		~read_guard() {
+			_domain->leave(_ticket);
+		}
+		read_guard(const read_guard&) = delete;
+		read_guard(read_guard&&) = delete;
+		read_guard& operator=(const read_guard&) = delete;
+		read_guard& operator=(read_guard&&) = delete;
+
+	private:
+		const detail::epoch_domain* _domain;
+		size_t _ticket;
+	};
+
+	// Ctors
+	explicit concurrent_id_slotmap(size_t key_new_cap);
+
+	concurrent_id_slotmap() = default;
+	~concurrent_id_slotmap();
+	concurrent_id_slotmap(const concurrent_id_slotmap&) = delete;
+	concurrent_id_slotmap(concurrent_id_slotmap&&) = delete;
+	concurrent_id_slotmap& operator=(const concurrent_id_slotmap&) = delete;
+	concurrent_id_slotmap& operator=(concurrent_id_slotmap&&) = delete;
+
+
+	// Capacity
+
+	// checks whether the container is empty
+	[[nodiscard]]
+	bool empty() const noexcept;
+
+	// returns the number of elements
+	[[nodiscard]]
+	size_type size() const noexcept;
+
+	// Reserves the lookup, recommended maxid + 1.
+	void reserve(size_type key_new_cap);
+
+
+	// Lookup, wait-free
+
+	// Returns a pointer to the value at key, or nullptr.
+	// The pointer is valid as long as guard is alive.
+	[[nodiscard]]
+	const mapped_type* find(
+			const key_type& k, const read_guard& guard) const noexcept;
+
+	// Calls func(const mapped_type&) with the value at key, if it exists.
+	// Returns true if the value was found.
+	template <class Func>
+	bool read(const key_type& k, Func&& func) const;
+
+	// Returns a copy of the value at key, with bounds checking.
+	[[nodiscard]]
+	mapped_type at(const key_type& k) const;
+
+	// returns the number of elements matching specific key (which is 1 or 0,
+	// since there are no duplicates)
+	[[nodiscard]]
+	size_type count(const key_type& k) const noexcept;
+
+	// checks if the container contains element with specific key
+	[[nodiscard]]
+	bool contains(const key_type& k) const noexcept;
+
+
+	// Modifiers, serialized
+
+	// Clears the contents.
+	void clear();
+
+	// Inserts value at key, if key doesn't exist.
+	// Returns true if inserted.
+	bool insert(const key_type& k, const mapped_type& value);
+
+	// Inserts value at key, if key doesn't exist.
+	// Returns true if inserted.
+	bool insert(const key_type& k, mapped_type&& value);
+
+	// Inserts the value, or assigns a new value if the key already exists.
+	// Returns true if inserted, false if assigned.
+	template <class M>
+	bool insert_or_assign(const key_type& k, M&& obj);
+
+	// Constructs element in-place if the key does not exist.
+	// Returns true if inserted.
+	template <class... Args>
+	bool emplace(const key_type& k, Args&&... args);
+
+	// Constructs element in-place if the key does not exist.
+	// Returns true if inserted.
+	template <class... Args>
+	bool try_emplace(const key_type& k, Args&&... args);
+
+	// Erase element at key.
+	size_type erase(const key_type& k);
+
+	// Waits for readers and frees removed values now.
+	// Reclamation is otherwise batched.
+	void reclaim();
+
+	// Calls func(const key_type&, const mapped_type&) on every element.
+	// Blocks writers, not readers.
+	template <class Func>
+	void for_each(Func&& func) const;
+
+private:
+	struct node {
+		template <class... Args>
+		node(const key_type& k, size_type p, Args&&... args)
+				: key(k)
+				, pos(p)
+				, value(std::forward<Args>(args)...) {
+		}
+
+		key_type key;
+		// Position in _nodes, only used by writers.
+		size_type pos;
+		mapped_type value;
+	};
+
+	struct table {
+		explicit table(size_type count)
+				: size(count)
+				, slots(std::make_unique<std::atomic<node*>[]>(count)) {
+			for (size_type i = 0; i < size; ++i) {
+				slots[i].store(nullptr, std::memory_order_relaxed);
+			}
+		}
+
+		size_type size;
+		std::unique_ptr<std::atomic<node*>[]> slots;
+	};
+
+	// Reclaim once this many nodes or tables are waiting.
+	static constexpr size_type reclaim_threshold = 64u;
+
+	[[nodiscard]]
+	static underlying_key_type hash(const key_type& k) noexcept;
+
+	// Readers, must be called in a read-side critical section.
+	[[nodiscard]]
+	const node* find_node(const key_type& k) const noexcept;
+
+	// Writers, must hold _write_mutex.
+	[[nodiscard]]
+	node* mfind(underlying_key_type uk) const noexcept;
+	void mgrow(underlying_key_type uk);
+	void mretire(node* n);
+	void mretire(table* t);
+	void mreclaim();
+
+	template <class... Args>
+	bool memplace(const key_type& k, bool assign_found, Args&&... args);
+
+	detail::epoch_domain _domain;
+	std::atomic<table*> _table{ nullptr };
+	std::atomic<size_type> _size{ 0 };
+
+	// Writer side data.
+	mutable std::mutex _write_mutex;
+	std::vector<node*> _nodes;
+	std::vector<node*> _retired_nodes;
+	std::vector<table*> _retired_tables;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+namespace detail {
+size_t epoch_domain::enter() const noexcept {
+	// The epoch load and increment must be sequentially consistent with the
+	// writer flip, so a reader either is counted or sees unpublished data.
+	size_t parity = _epoch.load(std::memory_order_seq_cst) & 1u;
+	_stripes[stripe_idx()].counts[parity].fetch_add(
+			1, std::memory_order_seq_cst);
+#if FEA_DEBUG
+	readings& r = thread_readings();
+	if (r.size < readings::capacity) {
+		r.domains[r.size] = this;
+	}
+	++r.size;
+#endif
+	return parity;
+}
+
+void epoch_domain::leave(size_t ticket) const noexcept {
+#if FEA_DEBUG
+	readings& r = thread_readings();
+	assert(r.size != 0);
+	if (r.size <= readings::capacity) {
+		auto first = r.domains.begin();
+		auto last = r.domains.begin() + r.size;
+		auto it = std::find(std::make_reverse_iterator(last),
+				std::make_reverse_iterator(first), this);
+		assert(it != std::make_reverse_iterator(first));
+		std::copy(it.base(), last, std::prev(it.base()));
+	}
+	--r.size;
+#endif
+	_stripes[stripe_idx()].counts[ticket].fetch_sub(
+			1, std::memory_order_release);
+}
+
+void epoch_domain::synchronize() const noexcept {
+	// Waiting on our own read_guard never returns.
+#if FEA_DEBUG
+	const readings& r = thread_readings();
+	auto last = r.domains.begin() + (std::min)(r.size, readings::capacity);
+	assert(std::find(r.domains.begin(), last, this) == last
+			&& "concurrent_id_slotmap : cannot modify while holding a "
+			   "read_guard on this thread");
+#endif
+
+	// Flip twice, so readers which entered on either parity before the call
+	// are waited on, while new readers go to the other counter.
+	for (size_t i = 0; i < 2; ++i) {
+		size_t old_parity
+				= _epoch.fetch_add(1, std::memory_order_seq_cst) & 1u;
+		wait_drained(old_parity);
+	}
+}
+
+void epoch_domain::wait_drained(size_t parity) const noexcept {
+	for (const stripe& s : _stripes) {
+		while (s.counts[parity].load(std::memory_order_acquire) != 0) {
+			std::this_thread::yield();
+		}
+	}
+}
+} // namespace detail
+
+
+template <class Key, class T>
+concurrent_id_slotmap<Key, T>::concurrent_id_slotmap(size_t key_new_cap) {
+	reserve(key_new_cap);
+}
+
+template <class Key, class T>
+concurrent_id_slotmap<Key, T>::~concurrent_id_slotmap() {
+	// No readers may exist at this point.
+	for (node* n : _nodes) {
+		delete n;
+	}
+	for (node* n : _retired_nodes) {
+		delete n;
+	}
+	for (table* t : _retired_tables) {
+		delete t;
+	}
+	delete _table.load(std::memory_order_relaxed);
+}
+
+template <class Key, class T>
+bool concurrent_id_slotmap<Key, T>::empty() const noexcept {
+	return size() == 0;
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::size_type
+concurrent_id_slotmap<Key, T>::size() const noexcept {
+	return _size.load(std::memory_order_acquire);
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::reserve(size_type key_new_cap) {
+	if (key_new_cap == 0) {
+		return;
+	}
+
+	std::lock_guard l{ _write_mutex };
+	mgrow(underlying_key_type(key_new_cap - 1));
+}
+
+template <class Key, class T>
+const typename concurrent_id_slotmap<Key, T>::mapped_type*
+concurrent_id_slotmap<Key, T>::find(
+		const key_type& k, const read_guard&) const noexcept {
+	const node* n = find_node(k);
+	if (n == nullptr) {
+		return nullptr;
+	}
+	return &n->value;
+}
+
+template <class Key, class T>
+template <class Func>
+bool concurrent_id_slotmap<Key, T>::read(const key_type& k, Func&& func) const {
+	read_guard g{ *this };
+	const mapped_type* v = find(k, g);
+	if (v == nullptr) {
+		return false;
+	}
+	std::forward<Func>(func)(*v);
+	return true;
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::mapped_type
+concurrent_id_slotmap<Key, T>::at(const key_type& k) const {
+	read_guard g{ *this };
+	const mapped_type* v = find(k, g);
+	if (v == nullptr) {
+		fea::maybe_throw<std::out_of_range>(
+				__FUNCTION__, __LINE__, "value doesn't exist");
+	}
+	return *v;
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::size_type
+concurrent_id_slotmap<Key, T>::count(const key_type& k) const noexcept {
+	if (contains(k)) {
+		return 1;
+	}
+	return 0;
+}
+
+template <class Key, class T>
+bool concurrent_id_slotmap<Key, T>::contains(const key_type& k) const noexcept {
+	read_guard g{ *this };
+	return find_node(k) != nullptr;
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::clear() {
+	std::lock_guard l{ _write_mutex };
+	for (node* n : _nodes) {
+		underlying_key_type uk = hash(n->key);
+		_table.load(std::memory_order_relaxed)
+				->slots[uk]
+				.store(nullptr, std::memory_order_release);
+		mretire(n);
+	}
+	_nodes.clear();
+	_size.store(0, std::memory_order_release);
+}
+
+template <class Key, class T>
+bool concurrent_id_slotmap<Key, T>::insert(
+		const key_type& k, const mapped_type& value) {
+	return memplace(k, false, value);
+}
+
+template <class Key, class T>
+bool concurrent_id_slotmap<Key, T>::insert(
+		const key_type& k, mapped_type&& value) {
+	return memplace(k, false, std::move(value));
+}
+
+template <class Key, class T>
+template <class M>
+bool concurrent_id_slotmap<Key, T>::insert_or_assign(
+		const key_type& k, M&& obj) {
+	return memplace(k, true, std::forward<M>(obj));
+}
+
+template <class Key, class T>
+template <class... Args>
+bool concurrent_id_slotmap<Key, T>::emplace(
+		const key_type& k, Args&&... args) {
+	return memplace(k, false, std::forward<Args>(args)...);
+}
+
+template <class Key, class T>
+template <class... Args>
+bool concurrent_id_slotmap<Key, T>::try_emplace(
+		const key_type& k, Args&&... args) {
+	return memplace(k, false, std::forward<Args>(args)...);
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::size_type
+concurrent_id_slotmap<Key, T>::erase(const key_type& k) {
+	std::lock_guard l{ _write_mutex };
+	underlying_key_type uk = hash(k);
+	node* n = mfind(uk);
+	if (n == nullptr) {
+		return 0;
+	}
+
+	_table.load(std::memory_order_relaxed)
+			->slots[uk]
+			.store(nullptr, std::memory_order_release);
+
+	// swap & pop the writer side node list
+	size_type pos = n->pos;
+	if (pos != _nodes.size() - 1) {
+		_nodes[pos] = _nodes.back();
+		_nodes[pos]->pos = pos;
+	}
+	_nodes.pop_back();
+	_size.store(_nodes.size(), std::memory_order_release);
+
+	mretire(n);
+	return 1;
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::reclaim() {
+	std::lock_guard l{ _write_mutex };
+	mreclaim();
+}
+
+template <class Key, class T>
+template <class Func>
+void concurrent_id_slotmap<Key, T>::for_each(Func&& func) const {
+	std::lock_guard l{ _write_mutex };
+	for (const node* n : _nodes) {
+		func(n->key, n->value);
+	}
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::underlying_key_type
+concurrent_id_slotmap<Key, T>::hash(const key_type& k) noexcept {
+	return fea::id_hash<Key>{}(k);
+}
+
+template <class Key, class T>
+const typename concurrent_id_slotmap<Key, T>::node*
+concurrent_id_slotmap<Key, T>::find_node(const key_type& k) const noexcept {
+	underlying_key_type uk = hash(k);
+	const table* t = _table.load(std::memory_order_acquire);
+	if (t == nullptr || uk >= t->size) {
+		return nullptr;
+	}
+	return t->slots[uk].load(std::memory_order_acquire);
+}
+
+template <class Key, class T>
+typename concurrent_id_slotmap<Key, T>::node*
+concurrent_id_slotmap<Key, T>::mfind(underlying_key_type uk) const noexcept {
+	const table* t = _table.load(std::memory_order_relaxed);
+	if (t == nullptr || uk >= t->size) {
+		return nullptr;
+	}
+	return t->slots[uk].load(std::memory_order_relaxed);
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::mgrow(underlying_key_type uk) {
+	table* old_t = _table.load(std::memory_order_relaxed);
+	size_type old_size = old_t == nullptr ? 0u : old_t->size;
+	if (size_type(uk) < old_size) {
+		return;
+	}
+
+	size_type new_size = (std::max)(size_type(uk) + 1u, old_size * 2u);
+	table* new_t = new table{ new_size };
+	for (size_type i = 0; i < old_size; ++i) {
+		new_t->slots[i].store(old_t->slots[i].load(std::memory_order_relaxed),
+				std::memory_order_relaxed);
+	}
+
+	_table.store(new_t, std::memory_order_release);
+	if (old_t != nullptr) {
+		mretire(old_t);
+	}
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::mretire(node* n) {
+	_retired_nodes.push_back(n);
+	if (_retired_nodes.size() >= reclaim_threshold) {
+		mreclaim();
+	}
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::mretire(table* t) {
+	_retired_tables.push_back(t);
+	if (_retired_tables.size() >= reclaim_threshold) {
+		mreclaim();
+	}
+}
+
+template <class Key, class T>
+void concurrent_id_slotmap<Key, T>::mreclaim() {
+	if (_retired_nodes.empty() && _retired_tables.empty()) {
+		return;
+	}
+
+	_domain.synchronize();
+	for (node* n : _retired_nodes) {
+		delete n;
+	}
+	for (table* t : _retired_tables) {
+		delete t;
+	}
+	_retired_nodes.clear();
+	_retired_tables.clear();
+}
+
+template <class Key, class T>
+template <class... Args>
+bool concurrent_id_slotmap<Key, T>::memplace(
+		const key_type& k, bool assign_found, Args&&... args) {
+	std::lock_guard l{ _write_mutex };
+	underlying_key_type uk = hash(k);
+	node* old_n = mfind(uk);
+	if (old_n != nullptr && !assign_found) {
+		return false;
+	}
+
+	mgrow(uk);
+	size_type pos = old_n == nullptr ? _nodes.size() : old_n->pos;
+	std::unique_ptr<node> new_n
+			= std::make_unique<node>(k, pos, std::forward<Args>(args)...);
+
+	if (old_n == nullptr) {
+		_nodes.push_back(new_n.get());
+	} else {
+		_nodes[pos] = new_n.get();
+	}
+
+	// Publish, readers see the fully constructed node.
+	_table.load(std::memory_order_relaxed)
+			->slots[uk]
+			.store(new_n.release(), std::memory_order_release);
+	_size.store(_nodes.size(), std::memory_order_release);
+
+	if (old_n != nullptr) {
+		mretire(old_n);
+		return false;
+	}
+	return true;
+}
+} // namespace fea
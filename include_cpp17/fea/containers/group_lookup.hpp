@@ -0,0 +1,530 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2025, Philippe Groarke
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fea/performance/intrinsics.hpp"
+#include "fea/performance/simd.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <type_traits>
+#include <vector>
+
+/*
+Swiss table style group probing, shared by the flat hash containers.
+
+The lookup only stores indexes into the user containers, plus one control byte
+per slot. A control byte is either empty, deleted or 7 bits of the hash
+(h2). Probing compares a whole group of control bytes at once (32 with AVX2,
+16 with SSE2, 8 with NEON or the portable fallback), and only tests slots
+whose control byte matches.
+
+Define FEA_NO_SIMD_DEF to force the portable group implementation.
+*/
+
+namespace fea {
+namespace detail {
+// Control bytes. Full slots store h2, which is always positive.
+inline constexpr int8_t group_ctrl_empty = -128; // 0b1000'0000
+inline constexpr int8_t group_ctrl_deleted = -2; // 0b1111'1110
+
+// Iterates the matching lanes of a group comparison.
+// Shift is log2 of the number of bits per lane in the mask.
+template <class T, size_t Shift>
+struct group_bitmask {
+	static_assert(std::is_unsigned_v<T>, "group_bitmask : expects unsigned");
+
+	explicit operator bool() const noexcept {
+		return mask != 0;
+	}
+
+	// Index of the first matching lane.
+	[[nodiscard]]
+	size_t lowest() const noexcept {
+		return fea::countr_zero(mask) >> Shift;
+	}
+
+	// Number of non-matching lanes before the first match (from lane 0).
+	[[nodiscard]]
+	size_t trailing_zeros() const noexcept {
+		return fea::countr_zero(mask) >> Shift;
+	}
+
+	// Number of non-matching lanes after the last match.
+	[[nodiscard]]
+	size_t leading_zeros() const noexcept {
+		return fea::countl_zero(mask) >> Shift;
+	}
+
+	// Clears the first matching lane.
+	void pop() noexcept {
+		mask = T(mask & (mask - 1));
+	}
+
+	T mask = 0;
+};
+
+#if FEA_AVX2
+struct group_avx2 {
+	static constexpr size_t width = 32;
+	using bitmask = group_bitmask<uint32_t, 0>;
+
+	explicit group_avx2(const int8_t* pos) noexcept
+			: ctrl(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(pos))) {
+	}
+
+	[[nodiscard]]
+	bitmask match(int8_t h2) const noexcept {
+		__m256i cmp = _mm256_cmpeq_epi8(_mm256_set1_epi8(h2), ctrl);
+		return bitmask{ uint32_t(_mm256_movemask_epi8(cmp)) };
+	}
+
+	[[nodiscard]]
+	bitmask match_empty() const noexcept {
+		return match(group_ctrl_empty);
+	}
+
+	// Both empty and deleted have their sign bit set.
+	[[nodiscard]]
+	bitmask match_empty_or_deleted() const noexcept {
+		return bitmask{ uint32_t(_mm256_movemask_epi8(ctrl)) };
+	}
+
+	__m256i ctrl;
+};
+#endif
+
+#if FEA_SSE2
+struct group_sse2 {
+	static constexpr size_t width = 16;
+	using bitmask = group_bitmask<uint16_t, 0>;
+
+	explicit group_sse2(const int8_t* pos) noexcept
+			: ctrl(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pos))) {
+	}
+
+	[[nodiscard]]
+	bitmask match(int8_t h2) const noexcept {
+		__m128i cmp = _mm_cmpeq_epi8(_mm_set1_epi8(h2), ctrl);
+		return bitmask{ uint16_t(_mm_movemask_epi8(cmp)) };
+	}
+
+	[[nodiscard]]
+	bitmask match_empty() const noexcept {
+		return match(group_ctrl_empty);
+	}
+
+	// Both empty and deleted have their sign bit set.
+	[[nodiscard]]
+	bitmask match_empty_or_deleted() const noexcept {
+		return bitmask{ uint16_t(_mm_movemask_epi8(ctrl)) };
+	}
+
+	__m128i ctrl;
+};
+#endif
+
+#if FEA_NEON
+// NEON has no movemask, comparisons are reinterpreted as a 64 bit mask with
+// 8 bits per lane. Only the lane msb is kept.
+struct group_neon {
+	static constexpr size_t width = 8;
+	using bitmask = group_bitmask<uint64_t, 3>;
+	static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+	explicit group_neon(const int8_t* pos) noexcept
+			: ctrl(vld1_s8(pos)) {
+	}
+
+	[[nodiscard]]
+	bitmask match(int8_t h2) const noexcept {
+		uint8x8_t cmp = vceq_s8(ctrl, vdup_n_s8(h2));
+		return bitmask{ vget_lane_u64(vreinterpret_u64_u8(cmp), 0) & msbs };
+	}
+
+	[[nodiscard]]
+	bitmask match_empty() const noexcept {
+		return match(group_ctrl_empty);
+	}
+
+	[[nodiscard]]
+	bitmask match_empty_or_deleted() const noexcept {
+		uint8x8_t cmp = vclt_s8(ctrl, vdup_n_s8(0));
+		return bitmask{ vget_lane_u64(vreinterpret_u64_u8(cmp), 0) & msbs };
+	}
+
+	int8x8_t ctrl;
+};
+#endif
+
+// SWAR fallback, 8 control bytes in a uint64_t.
+// Expects little endian, like every platform fea supports.
+struct group_portable {
+	static constexpr size_t width = 8;
+	using bitmask = group_bitmask<uint64_t, 3>;
+	static constexpr uint64_t lsbs = 0x0101010101010101ull;
+	static constexpr uint64_t msbs = 0x8080808080808080ull;
+
+	explicit group_portable(const int8_t* pos) noexcept {
+		std::memcpy(&ctrl, pos, sizeof(ctrl));
+	}
+
+	// May return false positives on lanes after a true match. That is fine,
+	// keys are always compared.
+	[[nodiscard]]
+	bitmask match(int8_t h2) const noexcept {
+		uint64_t x = ctrl ^ (lsbs * uint8_t(h2));
+		return bitmask{ (x - lsbs) & ~x & msbs };
+	}
+
+	// Empty is the only control byte with msb set and bit 1 unset.
+	[[nodiscard]]
+	bitmask match_empty() const noexcept {
+		return bitmask{ ctrl & ~(ctrl << 6) & msbs };
+	}
+
+	[[nodiscard]]
+	bitmask match_empty_or_deleted() const noexcept {
+		return bitmask{ ctrl & msbs };
+	}
+
+	uint64_t ctrl = 0;
+};
+
+#if FEA_AVX2
+using group = group_avx2;
+#elif FEA_SSE2
+using group = group_sse2;
+#elif FEA_NEON
+using group = group_neon;
+#else
+using group = group_portable;
+#endif
+
+// Mixes integer keys so sequential ids spread over the whole table.
+// The top bits select the probe position (h1), the 7 low bits are the
+// control tag (h2).
+[[nodiscard]]
+constexpr uint64_t group_hash_mix(uint64_t key) noexcept {
+	uint64_t h = key * 0x9E3779B97F4A7C15ull;
+	return h ^ (h >> 32);
+}
+
+[[nodiscard]]
+constexpr size_t group_h1(uint64_t hash) noexcept {
+	return size_t(hash >> 7);
+}
+
+[[nodiscard]]
+constexpr int8_t group_h2(uint64_t hash) noexcept {
+	return int8_t(hash & 0x7F);
+}
+} // namespace detail
+} // namespace fea
+
+namespace fea {
+namespace detail {
+// Group probed lookup of indexes. The owning container stores the keys and
+// their hashes, and provides predicates to compare them.
+template <class Alloc = std::allocator<size_t>>
+struct group_lookup {
+	using size_type = std::size_t;
+	using idx_type = std::size_t;
+	using group_type = detail::group;
+	using ctrl_allocator_type = typename std::allocator_traits<
+			Alloc>::template rebind_alloc<int8_t>;
+	using idx_allocator_type = typename std::allocator_traits<
+			Alloc>::template rebind_alloc<idx_type>;
+
+	// Returned when no slot matches.
+	static constexpr size_type npos = (std::numeric_limits<size_type>::max)();
+
+	// The number of lookup slots, always a power of 2 (or 0).
+	[[nodiscard]]
+	size_type bucket_count() const noexcept {
+		return _slots.size();
+	}
+
+	// The user index stored at slot.
+	[[nodiscard]]
+	idx_type idx(size_type slot) const noexcept {
+		assert(slot < _slots.size());
+		return _slots[slot];
+	}
+
+	// Points slot to a new user index.
+	void idx(size_type slot, idx_type new_idx) noexcept {
+		assert(slot < _slots.size());
+		_slots[slot] = new_idx;
+	}
+
+	[[nodiscard]]
+	float max_load_factor() const noexcept {
+		return _max_load_factor;
+	}
+
+	void max_load_factor(float ml) noexcept {
+		assert(ml > 0.f);
+		_max_load_factor = ml;
+	}
+
+	// Returns the slot whose user index satisfies pred, or npos.
+	template <class Pred>
+	[[nodiscard]]
+	size_type find(uint64_t h, Pred&& pred) const {
+		if (_slots.empty()) {
+			return npos;
+		}
+
+		// Triangular probing over groups. With a power of 2 lookup, this
+		// visits every group once before looping.
+		const size_type mask = _slots.size() - 1;
+		const int8_t h2 = group_h2(h);
+		size_type pos = group_h1(h) & mask;
+		size_type step = 0;
+
+		while (true) {
+			group_type g{ _ctrl.data() + pos };
+			for (auto m = g.match(h2); m; m.pop()) {
+				size_type slot = (pos + m.lowest()) & mask;
+				if (pred(_slots[slot])) {
+					return slot;
+				}
+			}
+
+			if (g.match_empty()) {
+				return npos;
+			}
+
+			step += group_type::width;
+			pos = (pos + step) & mask;
+			assert(step <= _slots.size());
+		}
+	}
+
+	// Returns a free slot for a new element with hash h, growing the lookup
+	// if required. hashes must point to the hashes of the size currently
+	// stored elements, in user index order.
+	// The slot is only taken by insert, nothing needs undoing if the element
+	// isn't inserted.
+	[[nodiscard]]
+	size_type prepare_insert(
+			uint64_t h, const uint64_t* hashes, size_type size) {
+		return prepare_insert(
+				h, size, [hashes](size_type i) { return hashes[i]; });
+	}
+
+	// Same as above, hash_at(i) returns the hash of user index i.
+	// For containers which don't store their hashes.
+	template <class HashAt>
+	[[nodiscard]]
+	size_type prepare_insert(uint64_t h, size_type size, HashAt&& hash_at) {
+		if (_slots.empty()) {
+			resize(init_count(), size, hash_at);
+		}
+
+		size_type slot = find_first_non_full(h);
+		if (_growth_left == 0 && _ctrl[slot] != group_ctrl_deleted) {
+			// Out of room. If tombstones take most of it, clean them up in
+			// place, else grow.
+			size_type new_size = _slots.size();
+			if (size >= growth_capacity(new_size) / 2) {
+				new_size *= 2;
+			}
+			resize(new_size, size, hash_at);
+			slot = find_first_non_full(h);
+		}
+		return slot;
+	}
+
+	// Stores new_idx at slot returned by prepare_insert.
+	void insert(size_type slot, uint64_t h, idx_type new_idx) noexcept {
+		if (_ctrl[slot] == group_ctrl_empty) {
+			assert(_growth_left != 0);
+			--_growth_left;
+		}
+		_slots[slot] = new_idx;
+		set_ctrl(slot, group_h2(h));
+	}
+
+	// Frees the slot, leaving a tombstone if a probe sequence could go
+	// through it.
+	void erase(size_type slot) noexcept {
+		constexpr size_type width = group_type::width;
+		const size_type mask = _slots.size() - 1;
+		size_type before_slot = (slot - width) & mask;
+		auto empty_after = group_type{ _ctrl.data() + slot }.match_empty();
+		auto empty_before
+				= group_type{ _ctrl.data() + before_slot }.match_empty();
+
+		bool was_never_full = empty_before && empty_after
+				&& (empty_after.trailing_zeros() + empty_before.leading_zeros())
+						< width;
+
+		if (was_never_full) {
+			set_ctrl(slot, group_ctrl_empty);
+			++_growth_left;
+		} else {
+			set_ctrl(slot, group_ctrl_deleted);
+		}
+	}
+
+	// Empties the lookup, keeps memory.
+	void clear() noexcept {
+		std::fill(_ctrl.begin(), _ctrl.end(), group_ctrl_empty);
+		_growth_left = growth_capacity(_slots.size());
+	}
+
+	// Frees all memory.
+	void reset() noexcept {
+		_growth_left = 0;
+		_ctrl = {};
+		_slots = {};
+	}
+
+	// Rebuilds the lookup so it fits count elements.
+	// hashes must point to the hashes of the size currently stored elements.
+	void rehash(size_type count, const uint64_t* hashes, size_type size) {
+		rehash(count, size, [hashes](size_type i) { return hashes[i]; });
+	}
+
+	// Same as above, hash_at(i) returns the hash of user index i.
+	template <class HashAt>
+	void rehash(size_type count, size_type size, HashAt&& hash_at) {
+		resize(lookup_size_for((std::max)(count, size)), size, hash_at);
+	}
+
+	// How many elements fit in the current lookup.
+	[[nodiscard]]
+	size_type growth_capacity() const noexcept {
+		return growth_capacity(_slots.size());
+	}
+
+	void swap(group_lookup& other) noexcept {
+		std::swap(_max_load_factor, other._max_load_factor);
+		std::swap(_growth_left, other._growth_left);
+		_ctrl.swap(other._ctrl);
+		_slots.swap(other._slots);
+	}
+
+private:
+	[[nodiscard]]
+	static constexpr size_type init_count() noexcept {
+		// The control clones require at least one group.
+		return group_type::width;
+	}
+
+	[[nodiscard]]
+	size_type growth_capacity(size_type bucket_count) const noexcept {
+		if (bucket_count == 0) {
+			return 0;
+		}
+		size_type ret = size_type(double(bucket_count) * _max_load_factor);
+		return (std::min)(ret, bucket_count - 1);
+	}
+
+	[[nodiscard]]
+	size_type lookup_size_for(size_type count) const noexcept {
+		size_type ret = init_count();
+		while (growth_capacity(ret) < count) {
+			ret *= 2;
+		}
+		return ret;
+	}
+
+	[[nodiscard]]
+	size_type find_first_non_full(uint64_t h) const noexcept {
+		assert(!_slots.empty());
+
+		const size_type mask = _slots.size() - 1;
+		size_type pos = group_h1(h) & mask;
+		size_type step = 0;
+
+		while (true) {
+			group_type g{ _ctrl.data() + pos };
+			if (auto m = g.match_empty_or_deleted()) {
+				return (pos + m.lowest()) & mask;
+			}
+
+			step += group_type::width;
+			pos = (pos + step) & mask;
+			assert(step <= _slots.size());
+		}
+	}
+
+	void set_ctrl(size_type slot, int8_t c) noexcept {
+		assert(slot < _slots.size());
+		_ctrl[slot] = c;
+		if (slot < group_type::width) {
+			_ctrl[_slots.size() + slot] = c;
+		}
+	}
+
+	template <class HashAt>
+	void resize(size_type new_size, size_type size, HashAt& hash_at) {
+		assert(new_size >= group_type::width);
+		assert((new_size & (new_size - 1)) == 0);
+		assert(growth_capacity(new_size) >= size);
+
+		_ctrl.assign(new_size + group_type::width, group_ctrl_empty);
+		_slots.assign(new_size, idx_type(0));
+		_growth_left = growth_capacity(new_size);
+
+		for (size_type i = 0; i < size; ++i) {
+			uint64_t h = hash_at(i);
+			size_type slot = find_first_non_full(h);
+			insert(slot, h, idx_type(i));
+		}
+	}
+
+	// Same semantics as std::unordered_map.
+	// The lookup always keeps at least one empty slot.
+	float _max_load_factor = .875f;
+
+	// How many new elements can be inserted before rehashing.
+	// Tombstones (deleted control bytes) count against it.
+	size_type _growth_left = 0;
+
+	// One control byte per slot, followed by group_type::width clones of the
+	// first control bytes. This allows loading a whole group at any position
+	// without wrapping around.
+	std::vector<int8_t, ctrl_allocator_type> _ctrl;
+
+	// Indexes into the owning container.
+	std::vector<idx_type, idx_allocator_type> _slots;
+};
+} // namespace detail
+} // namespace fea
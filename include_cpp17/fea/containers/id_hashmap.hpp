@@ -0,0 +1,864 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2025, Philippe Groarke
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fea/containers/group_lookup.hpp"
+#include "fea/memory/memory.hpp"
+#include "fea/utility/error.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+fea::id_hashmap is a flat hash map for any hashable key type (strings, 128 bit
+ids, etc).
+
+It follows the unsigned_hole_hashmap design :
+	- Values are packed, so you may iterate values quickly (the map supports
+		.data()).
+	- Keys are stored in a separate packed container, in the same order as
+		values. Iterating values never touches keys.
+	- Note : This map doesn't follow the c++ standard apis very closely, as
+		iterators are on value_type, not pair<key_type, value_type>.
+
+Lookups use group probing (see group_lookup.hpp). The hash of each key is
+stored next to the keys, so growing and erasing never call the hasher again.
+
+Keys are passed by value on insertion, and moved into the map.
+*/
+
+namespace fea {
+template <class Key, class T, class Hash = std::hash<Key>,
+		class KeyEqual = std::equal_to<Key>, class Alloc = std::allocator<T>>
+struct id_hashmap {
+	// Typedefs
+	using key_type = Key;
+	using mapped_type = T;
+	using value_type = mapped_type;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+
+	using allocator_type = Alloc;
+	using key_allocator_type = typename std::allocator_traits<
+			allocator_type>::template rebind_alloc<key_type>;
+	using hash_allocator_type = typename std::allocator_traits<
+			allocator_type>::template rebind_alloc<uint64_t>;
+
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = typename std::allocator_traits<allocator_type>::pointer;
+	using const_pointer =
+			typename std::allocator_traits<allocator_type>::const_pointer;
+
+	using iterator = typename std::vector<value_type, allocator_type>::iterator;
+	using const_iterator =
+			typename std::vector<value_type, allocator_type>::const_iterator;
+	using local_iterator = iterator;
+	using const_local_iterator = const_iterator;
+
+	using const_key_iterator =
+			typename std::vector<key_type, key_allocator_type>::const_iterator;
+
+	// Ctors
+	explicit id_hashmap(size_t reserve_count, const hasher& hash = hasher{},
+			const key_equal& equal = key_equal{});
+
+	id_hashmap() = default;
+	id_hashmap(const id_hashmap&) = default;
+	id_hashmap(id_hashmap&&) noexcept = default;
+	id_hashmap& operator=(const id_hashmap&) = default;
+	id_hashmap& operator=(id_hashmap&&) noexcept = default;
+
+	explicit id_hashmap(
+			const std::initializer_list<std::pair<key_type, value_type>>& init);
+
+
+	// Iterators
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	iterator begin() noexcept;
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator begin() const noexcept;
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator cbegin() const noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	iterator end() noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator end() const noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator cend() const noexcept;
+
+	// Returns an iterator to first key. NOT pair iterators.
+	[[nodiscard]]
+	const_key_iterator key_begin() const noexcept;
+
+	// Returns an iterator past the last key. NOT pair iterators.
+	[[nodiscard]]
+	const_key_iterator key_end() const noexcept;
+
+
+	// Capacity
+
+	// checks whether the container is empty
+	[[nodiscard]]
+	bool empty() const noexcept;
+
+	// returns the number of elements
+	[[nodiscard]]
+	size_type size() const noexcept;
+
+	// returns the maximum possible number of elements
+	[[nodiscard]]
+	size_type max_size() const noexcept;
+
+	// reserves storage, including the lookup table
+	void reserve(size_type new_cap);
+
+	// returns the number of elements that can be held in currently
+	// allocated storage
+	[[nodiscard]]
+	size_type capacity() const noexcept;
+
+	// reduces memory usage by freeing unused memory
+	void shrink_to_fit();
+
+
+	// Modifiers
+
+	// Clears the contents. Keeps the lookup table allocated.
+	void clear() noexcept;
+
+	// Inserts new value at key.
+	std::pair<iterator, bool> insert(key_type key, const value_type& value);
+
+	// Inserts new value at key.
+	std::pair<iterator, bool> insert(key_type key, value_type&& value);
+
+	// Insert new key-value pairs.
+	void insert(const std::initializer_list<std::pair<key_type, value_type>>&
+					ilist);
+
+	// inserts an element or assigns to the current element if the key
+	// already exists
+	std::pair<iterator, bool> insert_or_assign(
+			key_type key, const value_type& value);
+
+	std::pair<iterator, bool> insert_or_assign(
+			key_type key, value_type&& value);
+
+	// constructs element in-place
+	template <class... Args>
+	std::pair<iterator, bool> emplace(key_type key, Args&&... args);
+
+	// inserts in-place if the key does not exist, does nothing if the key
+	// exists
+	template <class... Args>
+	std::pair<iterator, bool> try_emplace(key_type key, Args&&... args);
+
+	// Erases element at position.
+	void erase(const_iterator pos);
+
+	// Erases range of elements.
+	void erase(const_iterator first, const_iterator last);
+
+	// Erase element at key.
+	size_type erase(const key_type& k);
+
+	// swaps the contents
+	void swap(id_hashmap& other) noexcept;
+
+
+	// Lookup
+
+	// direct access to the underlying vector
+	[[nodiscard]]
+	const value_type* data() const noexcept;
+
+	// direct access to the underlying vector
+	[[nodiscard]]
+	value_type* data() noexcept;
+
+	// Direct access to the keys underlying vector.
+	// Same size as values.
+	[[nodiscard]]
+	const key_type* key_data() const noexcept;
+
+	// Access specified element with bounds checking.
+	[[nodiscard]]
+	const mapped_type& at(const key_type& k) const;
+
+	// Access specified element with bounds checking.
+	[[nodiscard]]
+	mapped_type& at(const key_type& k);
+
+	// Access specified element without any bounds checking.
+	[[nodiscard]]
+	const mapped_type& at_unchecked(const key_type& k) const;
+
+	// Access specified element without any bounds checking.
+	[[nodiscard]]
+	mapped_type& at_unchecked(const key_type& k);
+
+	// access or insert specified element
+	[[nodiscard]]
+	mapped_type& operator[](const key_type& k);
+
+	// access or insert specified element
+	[[nodiscard]]
+	mapped_type& operator[](key_type&& k);
+
+	// returns the number of elements matching specific key (which is 1 or 0,
+	// since there are no duplicates)
+	[[nodiscard]]
+	size_type count(const key_type& k) const;
+
+	// finds element with specific key
+	[[nodiscard]]
+	const_iterator find(const key_type& k) const;
+
+	// finds element with specific key
+	[[nodiscard]]
+	iterator find(const key_type& k);
+
+	// checks if the container contains element with specific key
+	[[nodiscard]]
+	bool contains(const key_type& k) const;
+
+
+	// Hash policy
+
+	// Returns average number of elements per lookup slot.
+	[[nodiscard]]
+	float load_factor() const noexcept;
+
+	// The stored maximum load factor before a rehash.
+	[[nodiscard]]
+	float max_load_factor() const noexcept;
+
+	// Set a custom load factor to control rehashing behavior.
+	// The lookup table always keeps at least one empty slot.
+	void max_load_factor(float ml);
+
+	// Rehash the container so it can hold count elements without growing.
+	void rehash(size_type count);
+
+	// The number of lookup slots, always a power of 2 (or 0).
+	[[nodiscard]]
+	size_type bucket_count() const noexcept;
+
+	// Returns the key hasher.
+	[[nodiscard]]
+	hasher hash_function() const;
+
+	// Returns the key comparison function.
+	[[nodiscard]]
+	key_equal key_eq() const;
+
+
+	// Non-member functions
+
+	// Deep comparison.
+	template <class K, class U, class H, class E, class A>
+	friend bool operator==(const id_hashmap<K, U, H, E, A>& lhs,
+			const id_hashmap<K, U, H, E, A>& rhs);
+
+	// Deep comparison.
+	template <class K, class U, class H, class E, class A>
+	friend bool operator!=(const id_hashmap<K, U, H, E, A>& lhs,
+			const id_hashmap<K, U, H, E, A>& rhs);
+
+private:
+	using lookup_type = detail::group_lookup<allocator_type>;
+	static constexpr size_type npos = lookup_type::npos;
+
+	// Hashes and mixes the key, so poor hashers (identity) still spread.
+	[[nodiscard]]
+	uint64_t hash(const key_type& k) const;
+
+	// Returns the lookup slot of key, or npos.
+	[[nodiscard]]
+	size_type find_slot(const key_type& k, uint64_t h) const;
+
+	template <class M>
+	std::pair<iterator, bool> minsert(
+			key_type&& key, M&& value, bool assign_found = false);
+
+	// try_emplace, the key is only copied or moved when inserted.
+	template <class K, class... Args>
+	std::pair<iterator, bool> memplace(K&& key, Args&&... args);
+
+	// Appends a new element, its key and hash, and stores it in the lookup.
+	// If constructing the element throws, the map is left unchanged.
+	// Returns the new element's index.
+	template <class... Args>
+	size_type push_back(key_type&& key, uint64_t h, Args&&... args);
+
+	hasher _hasher;
+	key_equal _key_equal;
+
+	// Maps hashes to indexes in the packed containers below.
+	lookup_type _lookup;
+
+	// Mixed key hashes, same order as keys.
+	std::vector<uint64_t, hash_allocator_type> _hashes;
+
+	// Packed keys, same order as values.
+	// Also used in erase for swap & pop.
+	std::vector<key_type, key_allocator_type> _keys;
+
+	// Packed user values.
+	std::vector<value_type, allocator_type> _values;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::id_hashmap(size_t reserve_count,
+		const hasher& hash, const key_equal& equal)
+		: _hasher(hash)
+		, _key_equal(equal) {
+	reserve(reserve_count);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::id_hashmap(
+		const std::initializer_list<std::pair<key_type, value_type>>& init) {
+	reserve(init.size());
+	for (const std::pair<key_type, value_type>& kv : init) {
+		insert(kv.first, kv.second);
+	}
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::begin() noexcept {
+	return _values.begin();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::begin() const noexcept {
+	return _values.begin();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::cbegin() const noexcept {
+	return _values.cbegin();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::end() noexcept {
+	return _values.end();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::end() const noexcept {
+	return _values.end();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::cend() const noexcept {
+	return _values.cend();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_key_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_begin() const noexcept {
+	return _keys.begin();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_key_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_end() const noexcept {
+	return _keys.end();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool id_hashmap<Key, T, Hash, KeyEqual, Alloc>::empty() const noexcept {
+	return _values.empty();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size() const noexcept {
+	return _values.size();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::max_size() const noexcept {
+	return (std::min)(_keys.max_size(), _values.max_size());
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::reserve(size_type new_cap) {
+	if (new_cap > _lookup.growth_capacity()) {
+		rehash(new_cap);
+	}
+	_hashes.reserve(new_cap);
+	_keys.reserve(new_cap);
+	_values.reserve(new_cap);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::capacity() const noexcept {
+	return _values.capacity();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::shrink_to_fit() {
+	if (_values.empty()) {
+		_lookup.reset();
+	} else {
+		rehash(_values.size());
+	}
+	_hashes.shrink_to_fit();
+	_keys.shrink_to_fit();
+	_values.shrink_to_fit();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::clear() noexcept {
+	_lookup.clear();
+	_hashes.clear();
+	_keys.clear();
+	_values.clear();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::insert(
+		key_type key, const value_type& value) {
+	return minsert(std::move(key), value);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::insert(
+		key_type key, value_type&& value) {
+	return minsert(std::move(key), fea::move_if_moveable(value));
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::insert(
+		const std::initializer_list<std::pair<key_type, value_type>>& ilist) {
+	reserve(size() + ilist.size());
+	for (const std::pair<key_type, value_type>& kv : ilist) {
+		insert(kv.first, kv.second);
+	}
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::insert_or_assign(
+		key_type key, const value_type& value) {
+	return minsert(std::move(key), value, true);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::insert_or_assign(
+		key_type key, value_type&& value) {
+	return minsert(std::move(key), fea::move_if_moveable(value), true);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::emplace(
+		key_type key, Args&&... args) {
+	// Standard emplace behavior doesn't apply. Use try_emplace.
+	return try_emplace(std::move(key), std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::try_emplace(
+		key_type key, Args&&... args) {
+	return memplace(std::move(key), std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::erase(const_iterator pos) {
+	size_t idx = std::distance(_values.cbegin(), pos);
+	erase(_keys[idx]);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::erase(
+		const_iterator first, const_iterator last) {
+	size_t first_idx = std::distance(_values.cbegin(), first);
+	size_t last_idx = std::distance(_values.cbegin(), last);
+
+	std::vector<key_type> to_erase;
+	to_erase.reserve(last_idx - first_idx);
+	for (auto it = _keys.begin() + first_idx; it != _keys.begin() + last_idx;
+			++it) {
+		to_erase.push_back(*it);
+	}
+
+	for (const key_type& k : to_erase) {
+		erase(k);
+	}
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::erase(const key_type& k) {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == npos) {
+		return 0;
+	}
+
+	size_type erased_idx = _lookup.idx(slot);
+	_lookup.erase(slot);
+
+	size_type last_idx = _values.size() - 1;
+	if (erased_idx != last_idx) {
+		// Point the last element's lookup to its new position.
+		// Compare indexes, no need to compare keys.
+		size_type last_slot = _lookup.find(_hashes[last_idx],
+				[&](size_type idx) { return idx == last_idx; });
+		assert(last_slot != npos);
+		_lookup.idx(last_slot, erased_idx);
+
+		// "swap" the elements
+		_values[erased_idx] = fea::move_if_moveable(_values.back());
+		_keys[erased_idx] = fea::move_if_moveable(_keys.back());
+		_hashes[erased_idx] = _hashes.back();
+	}
+
+	// delete last
+	_values.pop_back();
+	_keys.pop_back();
+	_hashes.pop_back();
+
+	assert(_values.size() == _keys.size());
+	assert(_values.size() == _hashes.size());
+	return 1;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::swap(
+		id_hashmap& other) noexcept {
+	using std::swap;
+	swap(_hasher, other._hasher);
+	swap(_key_equal, other._key_equal);
+	_lookup.swap(other._lookup);
+	_hashes.swap(other._hashes);
+	_keys.swap(other._keys);
+	_values.swap(other._values);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+const typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::value_type*
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::data() const noexcept {
+	return _values.data();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::value_type*
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::data() noexcept {
+	return _values.data();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+const typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_type*
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_data() const noexcept {
+	return _keys.data();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+const typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::at(const key_type& k) const {
+	const_iterator it = find(k);
+	if (it == end()) {
+		fea::maybe_throw<std::out_of_range>(
+				__FUNCTION__, __LINE__, "value doesn't exist");
+	}
+
+	return *it;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::at(const key_type& k) {
+	return const_cast<mapped_type&>(
+			static_cast<const id_hashmap*>(this)->at(k));
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+const typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::at_unchecked(
+		const key_type& k) const {
+	const_iterator it = find(k);
+	return *it;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::at_unchecked(const key_type& k) {
+	return const_cast<mapped_type&>(
+			static_cast<const id_hashmap*>(this)->at_unchecked(k));
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::operator[](const key_type& k) {
+	// The key is only copied when inserted.
+	return *memplace(k).first;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::mapped_type&
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::operator[](key_type&& k) {
+	return *memplace(std::move(k)).first;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::count(const key_type& k) const {
+	if (contains(k))
+		return 1;
+
+	return 0;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::const_iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::find(const key_type& k) const {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == npos) {
+		return end();
+	}
+
+	assert(_lookup.idx(slot) < _values.size());
+	return begin() + _lookup.idx(slot);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::find(const key_type& k) {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == npos) {
+		return end();
+	}
+	return begin() + _lookup.idx(slot);
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+bool id_hashmap<Key, T, Hash, KeyEqual, Alloc>::contains(
+		const key_type& k) const {
+	return find_slot(k, hash(k)) != npos;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+float id_hashmap<Key, T, Hash, KeyEqual, Alloc>::load_factor() const noexcept {
+	if (_lookup.bucket_count() == 0) {
+		return 0.f;
+	}
+	return _values.size() / float(_lookup.bucket_count());
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+float id_hashmap<Key, T, Hash, KeyEqual, Alloc>::max_load_factor()
+		const noexcept {
+	return _lookup.max_load_factor();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::max_load_factor(float ml) {
+	_lookup.max_load_factor(ml);
+	if (_lookup.bucket_count() != 0) {
+		rehash(_values.size());
+	}
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+void id_hashmap<Key, T, Hash, KeyEqual, Alloc>::rehash(size_type count) {
+	_lookup.rehash(count, _hashes.data(), _hashes.size());
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::bucket_count() const noexcept {
+	return _lookup.bucket_count();
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::hasher
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::hash_function() const {
+	return _hasher;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_equal
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::key_eq() const {
+	return _key_equal;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+uint64_t id_hashmap<Key, T, Hash, KeyEqual, Alloc>::hash(
+		const key_type& k) const {
+	return detail::group_hash_mix(uint64_t(_hasher(k)));
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::find_slot(
+		const key_type& k, uint64_t h) const {
+	return _lookup.find(h, [&](size_type idx) {
+		return _hashes[idx] == h && _key_equal(_keys[idx], k);
+	});
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::size_type
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::push_back(
+		key_type&& key, uint64_t h, Args&&... args) {
+	// May grow the lookup, which stays valid if the pushes below throw.
+	size_type slot = _lookup.prepare_insert(h, _hashes.data(), _hashes.size());
+	size_type new_pos = _values.size();
+
+	_hashes.push_back(h);
+	try {
+		_keys.push_back(std::move(key));
+		_values.emplace_back(std::forward<Args>(args)...);
+	} catch (...) {
+		if (_keys.size() == _hashes.size()) {
+			_keys.pop_back();
+		}
+		_hashes.pop_back();
+		throw;
+	}
+
+	_lookup.insert(slot, h, new_pos);
+	assert(_values.size() == _keys.size());
+	assert(_values.size() == _hashes.size());
+	return new_pos;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+template <class K, class... Args>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::memplace(
+		K&& key, Args&&... args) {
+	uint64_t h = hash(key);
+	size_type slot = find_slot(key, h);
+	if (slot != npos) {
+		// Found valid key.
+		return { _values.begin() + _lookup.idx(slot), false };
+	}
+
+	size_type new_pos = push_back(key_type(std::forward<K>(key)), h,
+			std::forward<Args>(args)...);
+	return { begin() + new_pos, true };
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+template <class M>
+std::pair<typename id_hashmap<Key, T, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashmap<Key, T, Hash, KeyEqual, Alloc>::minsert(
+		key_type&& key, M&& value, bool assign_found) {
+	uint64_t h = hash(key);
+	size_type slot = find_slot(key, h);
+	if (slot != npos) {
+		// Found valid key.
+		auto data_it = _values.begin() + _lookup.idx(slot);
+		if (assign_found) {
+			*data_it = std::forward<M>(value);
+		}
+		return { data_it, false };
+	}
+
+	size_type new_pos = push_back(std::move(key), h, std::forward<M>(value));
+	return { begin() + new_pos, true };
+}
+
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+[[nodiscard]]
+bool operator==(const id_hashmap<Key, T, Hash, KeyEqual, Alloc>& lhs,
+		const id_hashmap<Key, T, Hash, KeyEqual, Alloc>& rhs) {
+	if (lhs.size() != rhs.size())
+		return false;
+
+	for (size_t i = 0; i < lhs.size(); ++i) {
+		auto it = rhs.find(lhs._keys[i]);
+		if (it == rhs.end()) {
+			return false;
+		}
+
+		if (*it != lhs._values[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <class Key, class T, class Hash, class KeyEqual, class Alloc>
+[[nodiscard]]
+bool operator!=(const id_hashmap<Key, T, Hash, KeyEqual, Alloc>& lhs,
+		const id_hashmap<Key, T, Hash, KeyEqual, Alloc>& rhs) {
+	return !operator==(lhs, rhs);
+}
+} // namespace fea
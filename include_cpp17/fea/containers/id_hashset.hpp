@@ -0,0 +1,608 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2025, Philippe Groarke
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fea/containers/group_lookup.hpp"
+#include "fea/memory/memory.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+fea::id_hashset is a flat hash set for any hashable key type.
+
+It is the set counterpart of fea::id_hashmap :
+	- Keys are packed, so you may iterate them quickly (the set supports
+		.data()).
+	- Iteration order is insertion order, until you erase. Erasing moves the
+		last key into the hole.
+	- Lookups use group probing (see group_lookup.hpp), the hash of each key
+		is stored so growing and erasing never call the hasher again.
+*/
+
+namespace fea {
+template <class Key, class Hash = std::hash<Key>,
+		class KeyEqual = std::equal_to<Key>, class Alloc = std::allocator<Key>>
+struct id_hashset {
+	// Typedefs
+	using key_type = Key;
+	using value_type = key_type;
+	using size_type = std::size_t;
+	using difference_type = std::ptrdiff_t;
+	using hasher = Hash;
+	using key_equal = KeyEqual;
+
+	using allocator_type = Alloc;
+	using hash_allocator_type = typename std::allocator_traits<
+			allocator_type>::template rebind_alloc<uint64_t>;
+
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = typename std::allocator_traits<allocator_type>::pointer;
+	using const_pointer =
+			typename std::allocator_traits<allocator_type>::const_pointer;
+
+	using const_iterator =
+			typename std::vector<value_type, allocator_type>::const_iterator;
+	using iterator = const_iterator;
+
+	// Ctors
+	explicit id_hashset(size_t reserve_count, const hasher& hash = hasher{},
+			const key_equal& equal = key_equal{});
+
+	id_hashset() = default;
+	id_hashset(const id_hashset&) = default;
+	id_hashset(id_hashset&&) noexcept = default;
+	id_hashset& operator=(const id_hashset&) = default;
+	id_hashset& operator=(id_hashset&&) noexcept = default;
+
+	// Initializes with provided keys.
+	template <class FwdIt>
+	id_hashset(FwdIt first, FwdIt last);
+
+	// Initializes with provided keys.
+	id_hashset(std::initializer_list<key_type> ilist);
+
+
+	// Iterators
+
+	// Returns an iterator to the first key.
+	[[nodiscard]]
+	const_iterator begin() const noexcept;
+
+	// Returns an iterator to the first key.
+	[[nodiscard]]
+	const_iterator cbegin() const noexcept;
+
+	// Returns an iterator past the last key.
+	[[nodiscard]]
+	const_iterator end() const noexcept;
+
+	// Returns an iterator past the last key.
+	[[nodiscard]]
+	const_iterator cend() const noexcept;
+
+
+	// Capacity
+
+	// checks whether the container is empty
+	[[nodiscard]]
+	bool empty() const noexcept;
+
+	// returns the number of elements
+	[[nodiscard]]
+	size_type size() const noexcept;
+
+	// returns the maximum possible number of elements
+	[[nodiscard]]
+	size_type max_size() const noexcept;
+
+	// reserves storage, including the lookup table
+	void reserve(size_type new_cap);
+
+	// returns the number of elements that can be held in currently
+	// allocated storage
+	[[nodiscard]]
+	size_type capacity() const noexcept;
+
+	// reduces memory usage by freeing unused memory
+	void shrink_to_fit();
+
+
+	// Modifiers
+
+	// Clears the contents. Keeps the lookup table allocated.
+	void clear() noexcept;
+
+	// Inserts key if it doesn't exist.
+	std::pair<iterator, bool> insert(const key_type& key);
+
+	// Inserts key if it doesn't exist.
+	std::pair<iterator, bool> insert(key_type&& key);
+
+	// Inserts the range of keys.
+	template <class FwdIt>
+	void insert(FwdIt first, FwdIt last);
+
+	// Inserts the keys.
+	void insert(std::initializer_list<key_type> ilist);
+
+	// Constructs a key and inserts it if it doesn't exist.
+	template <class... Args>
+	std::pair<iterator, bool> emplace(Args&&... args);
+
+	// Erases key at position.
+	void erase(const_iterator pos);
+
+	// Erases range of keys.
+	void erase(const_iterator first, const_iterator last);
+
+	// Erase key.
+	size_type erase(const key_type& k);
+
+	// swaps the contents
+	void swap(id_hashset& other) noexcept;
+
+
+	// Lookup
+
+	// direct access to the packed keys
+	[[nodiscard]]
+	const value_type* data() const noexcept;
+
+	// returns the number of elements matching specific key (which is 1 or 0,
+	// since there are no duplicates)
+	[[nodiscard]]
+	size_type count(const key_type& k) const;
+
+	// finds element with specific key
+	[[nodiscard]]
+	const_iterator find(const key_type& k) const;
+
+	// checks if the container contains element with specific key
+	[[nodiscard]]
+	bool contains(const key_type& k) const;
+
+
+	// Hash policy
+
+	// Returns average number of elements per lookup slot.
+	[[nodiscard]]
+	float load_factor() const noexcept;
+
+	// The stored maximum load factor before a rehash.
+	[[nodiscard]]
+	float max_load_factor() const noexcept;
+
+	// Set a custom load factor to control rehashing behavior.
+	// The lookup table always keeps at least one empty slot.
+	void max_load_factor(float ml);
+
+	// Rehash the container so it can hold count elements without growing.
+	void rehash(size_type count);
+
+	// The number of lookup slots, always a power of 2 (or 0).
+	[[nodiscard]]
+	size_type bucket_count() const noexcept;
+
+	// Returns the key hasher.
+	[[nodiscard]]
+	hasher hash_function() const;
+
+	// Returns the key comparison function.
+	[[nodiscard]]
+	key_equal key_eq() const;
+
+
+	// Non-member functions
+
+	// Deep comparison, order independent.
+	template <class K, class H, class E, class A>
+	friend bool operator==(
+			const id_hashset<K, H, E, A>& lhs, const id_hashset<K, H, E, A>& rhs);
+
+	// Deep comparison, order independent.
+	template <class K, class H, class E, class A>
+	friend bool operator!=(
+			const id_hashset<K, H, E, A>& lhs, const id_hashset<K, H, E, A>& rhs);
+
+private:
+	using lookup_type = detail::group_lookup<allocator_type>;
+	static constexpr size_type npos = lookup_type::npos;
+
+	// Hashes and mixes the key, so poor hashers (identity) still spread.
+	[[nodiscard]]
+	uint64_t hash(const key_type& k) const;
+
+	// Returns the lookup slot of key, or npos.
+	[[nodiscard]]
+	size_type find_slot(const key_type& k, uint64_t h) const;
+
+	template <class K>
+	std::pair<iterator, bool> minsert(K&& key);
+
+	hasher _hasher;
+	key_equal _key_equal;
+
+	// Maps hashes to indexes in the packed keys.
+	lookup_type _lookup;
+
+	// Mixed key hashes, same order as keys.
+	std::vector<uint64_t, hash_allocator_type> _hashes;
+
+	// Packed keys.
+	std::vector<key_type, allocator_type> _keys;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class Key, class Hash, class KeyEqual, class Alloc>
+id_hashset<Key, Hash, KeyEqual, Alloc>::id_hashset(
+		size_t reserve_count, const hasher& hash, const key_equal& equal)
+		: _hasher(hash)
+		, _key_equal(equal) {
+	reserve(reserve_count);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+template <class FwdIt>
+id_hashset<Key, Hash, KeyEqual, Alloc>::id_hashset(FwdIt first, FwdIt last) {
+	insert(first, last);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+id_hashset<Key, Hash, KeyEqual, Alloc>::id_hashset(
+		std::initializer_list<key_type> ilist) {
+	insert(ilist);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::const_iterator
+id_hashset<Key, Hash, KeyEqual, Alloc>::begin() const noexcept {
+	return _keys.begin();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::const_iterator
+id_hashset<Key, Hash, KeyEqual, Alloc>::cbegin() const noexcept {
+	return _keys.cbegin();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::const_iterator
+id_hashset<Key, Hash, KeyEqual, Alloc>::end() const noexcept {
+	return _keys.end();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::const_iterator
+id_hashset<Key, Hash, KeyEqual, Alloc>::cend() const noexcept {
+	return _keys.cend();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool id_hashset<Key, Hash, KeyEqual, Alloc>::empty() const noexcept {
+	return _keys.empty();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::size() const noexcept {
+	return _keys.size();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::max_size() const noexcept {
+	return _keys.max_size();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::reserve(size_type new_cap) {
+	if (new_cap > _lookup.growth_capacity()) {
+		rehash(new_cap);
+	}
+	_hashes.reserve(new_cap);
+	_keys.reserve(new_cap);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::capacity() const noexcept {
+	return _keys.capacity();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::shrink_to_fit() {
+	if (_keys.empty()) {
+		_lookup.reset();
+	} else {
+		rehash(_keys.size());
+	}
+	_hashes.shrink_to_fit();
+	_keys.shrink_to_fit();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::clear() noexcept {
+	_lookup.clear();
+	_hashes.clear();
+	_keys.clear();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashset<Key, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashset<Key, Hash, KeyEqual, Alloc>::insert(const key_type& key) {
+	return minsert(key);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+std::pair<typename id_hashset<Key, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashset<Key, Hash, KeyEqual, Alloc>::insert(key_type&& key) {
+	return minsert(std::move(key));
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+template <class FwdIt>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::insert(FwdIt first, FwdIt last) {
+	if constexpr (std::is_base_of_v<std::forward_iterator_tag,
+						  typename std::iterator_traits<
+								  FwdIt>::iterator_category>) {
+		reserve(size() + size_type(std::distance(first, last)));
+	}
+
+	for (auto it = first; it != last; ++it) {
+		insert(*it);
+	}
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::insert(
+		std::initializer_list<key_type> ilist) {
+	insert(ilist.begin(), ilist.end());
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+template <class... Args>
+std::pair<typename id_hashset<Key, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashset<Key, Hash, KeyEqual, Alloc>::emplace(Args&&... args) {
+	return minsert(key_type(std::forward<Args>(args)...));
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::erase(const_iterator pos) {
+	size_t idx = std::distance(_keys.cbegin(), pos);
+	erase(_keys[idx]);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::erase(
+		const_iterator first, const_iterator last) {
+	size_t first_idx = std::distance(_keys.cbegin(), first);
+	size_t last_idx = std::distance(_keys.cbegin(), last);
+
+	std::vector<key_type> to_erase(
+			_keys.begin() + first_idx, _keys.begin() + last_idx);
+	for (const key_type& k : to_erase) {
+		erase(k);
+	}
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::erase(const key_type& k) {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == npos) {
+		return 0;
+	}
+
+	size_type erased_idx = _lookup.idx(slot);
+	_lookup.erase(slot);
+
+	size_type last_idx = _keys.size() - 1;
+	if (erased_idx != last_idx) {
+		// Point the last key's lookup to its new position.
+		// Compare indexes, no need to compare keys.
+		size_type last_slot = _lookup.find(_hashes[last_idx],
+				[&](size_type idx) { return idx == last_idx; });
+		assert(last_slot != npos);
+		_lookup.idx(last_slot, erased_idx);
+
+		// "swap" the keys
+		_keys[erased_idx] = fea::move_if_moveable(_keys.back());
+		_hashes[erased_idx] = _hashes.back();
+	}
+
+	// delete last
+	_keys.pop_back();
+	_hashes.pop_back();
+
+	assert(_keys.size() == _hashes.size());
+	return 1;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::swap(id_hashset& other) noexcept {
+	using std::swap;
+	swap(_hasher, other._hasher);
+	swap(_key_equal, other._key_equal);
+	_lookup.swap(other._lookup);
+	_hashes.swap(other._hashes);
+	_keys.swap(other._keys);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+const typename id_hashset<Key, Hash, KeyEqual, Alloc>::value_type*
+id_hashset<Key, Hash, KeyEqual, Alloc>::data() const noexcept {
+	return _keys.data();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::count(const key_type& k) const {
+	if (contains(k))
+		return 1;
+
+	return 0;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::const_iterator
+id_hashset<Key, Hash, KeyEqual, Alloc>::find(const key_type& k) const {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == npos) {
+		return end();
+	}
+	return begin() + _lookup.idx(slot);
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+bool id_hashset<Key, Hash, KeyEqual, Alloc>::contains(const key_type& k) const {
+	return find_slot(k, hash(k)) != npos;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+float id_hashset<Key, Hash, KeyEqual, Alloc>::load_factor() const noexcept {
+	if (_lookup.bucket_count() == 0) {
+		return 0.f;
+	}
+	return _keys.size() / float(_lookup.bucket_count());
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+float id_hashset<Key, Hash, KeyEqual, Alloc>::max_load_factor()
+		const noexcept {
+	return _lookup.max_load_factor();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::max_load_factor(float ml) {
+	_lookup.max_load_factor(ml);
+	if (_lookup.bucket_count() != 0) {
+		rehash(_keys.size());
+	}
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+void id_hashset<Key, Hash, KeyEqual, Alloc>::rehash(size_type count) {
+	_lookup.rehash(count, _hashes.data(), _hashes.size());
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::bucket_count() const noexcept {
+	return _lookup.bucket_count();
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::hasher
+id_hashset<Key, Hash, KeyEqual, Alloc>::hash_function() const {
+	return _hasher;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::key_equal
+id_hashset<Key, Hash, KeyEqual, Alloc>::key_eq() const {
+	return _key_equal;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+uint64_t id_hashset<Key, Hash, KeyEqual, Alloc>::hash(const key_type& k) const {
+	return detail::group_hash_mix(uint64_t(_hasher(k)));
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+typename id_hashset<Key, Hash, KeyEqual, Alloc>::size_type
+id_hashset<Key, Hash, KeyEqual, Alloc>::find_slot(
+		const key_type& k, uint64_t h) const {
+	return _lookup.find(h, [&](size_type idx) {
+		return _hashes[idx] == h && _key_equal(_keys[idx], k);
+	});
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+template <class K>
+std::pair<typename id_hashset<Key, Hash, KeyEqual, Alloc>::iterator, bool>
+id_hashset<Key, Hash, KeyEqual, Alloc>::minsert(K&& key) {
+	uint64_t h = hash(key);
+	size_type slot = find_slot(key, h);
+	if (slot != npos) {
+		return { begin() + _lookup.idx(slot), false };
+	}
+
+	// May grow the lookup, which stays valid if the pushes below throw.
+	size_type new_pos = _keys.size();
+	slot = _lookup.prepare_insert(h, _hashes.data(), _hashes.size());
+	_hashes.push_back(h);
+	try {
+		_keys.push_back(std::forward<K>(key));
+	} catch (...) {
+		_hashes.pop_back();
+		throw;
+	}
+	_lookup.insert(slot, h, new_pos);
+
+	assert(_keys.size() == _hashes.size());
+	return { begin() + new_pos, true };
+}
+
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+[[nodiscard]]
+bool operator==(const id_hashset<Key, Hash, KeyEqual, Alloc>& lhs,
+		const id_hashset<Key, Hash, KeyEqual, Alloc>& rhs) {
+	if (lhs.size() != rhs.size())
+		return false;
+
+	for (const Key& k : lhs) {
+		if (!rhs.contains(k)) {
+			return false;
+		}
+	}
+	return true;
+}
+
+template <class Key, class Hash, class KeyEqual, class Alloc>
+[[nodiscard]]
+bool operator!=(const id_hashset<Key, Hash, KeyEqual, Alloc>& lhs,
+		const id_hashset<Key, Hash, KeyEqual, Alloc>& rhs) {
+	return !operator==(lhs, rhs);
+}
+} // namespace fea
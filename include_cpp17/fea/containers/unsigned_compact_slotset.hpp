@@ -61,7 +61,7 @@ struct unsigned_compact_slotset {
 	// Sanity checks.
 	static_assert(std::is_unsigned_v<Key>,
 			"unsigned_compact_set : Key must be unsigned "
-			"integer. Use fea::id_set for id types.");
+			"integer. Use fea::id_hashset for id types.");
 
 	// Typedefs
 	using key_type = Key;
@@ -0,0 +1,818 @@
+/*
+BSD 3-Clause License
+
+Copyright (c) 2025, Philippe Groarke
+All rights reserved.
+
+Redistribution and use in source and binary forms, with or without
+modification, are permitted provided that the following conditions are met:
+
+* Redistributions of source code must retain the above copyright notice, this
+  list of conditions and the following disclaimer.
+
+* Redistributions in binary form must reproduce the above copyright notice,
+  this list of conditions and the following disclaimer in the documentation
+  and/or other materials provided with the distribution.
+
+* Neither the name of the copyright holder nor the names of its
+  contributors may be used to endorse or promote products derived from
+  this software without specific prior written permission.
+
+THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE ARE
+DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE LIABLE
+FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR CONSEQUENTIAL
+DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF SUBSTITUTE GOODS OR
+SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS INTERRUPTION) HOWEVER
+CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN CONTRACT, STRICT LIABILITY,
+OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
+OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
+*/
+#pragma once
+#include "fea/containers/group_lookup.hpp"
+#include "fea/memory/memory.hpp"
+#include "fea/utility/error.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*
+unsigned_group_hashmap is the group probing sibling of unsigned_hole_hashmap.
+
+It shares the same api and the same packed values (the map supports .data()
+and iterators are on value_type). Only the key lookup differs :
+	- The lookup table is a power of 2, keys are mixed and masked instead of
+		taking a prime modulo.
+	- Each lookup slot has a 1 byte control "tag" stored in a separate array.
+		The tag is either empty, deleted or 7 bits of the key's hash.
+	- Lookups compare a whole group of tags at once (32 with AVX2, 16 with
+		SSE2, 8 with NEON or the portable fallback), and only test keys whose
+		tag matches. This is the "swiss table" layout, see group_lookup.hpp.
+	- Lookup slots only store the value index, matching keys are compared
+		in the packed keys.
+
+Prefer it when lookups dominate. Erasing leaves tombstones which are cleaned
+on the next growth, so heavy insert/erase churn may rehash more often than
+unsigned_hole_hashmap.
+
+Define FEA_NO_SIMD_DEF to force the portable group implementation.
+*/
+
+namespace fea {
+
+template <class Key, class T, class Alloc = std::allocator<T>>
+struct unsigned_group_hashmap {
+	// Sanity checks
+	static_assert(std::is_unsigned_v<Key>,
+			"unsigned_group_hashmap : key must be unsigned integer");
+
+	// Typedefs
+	using key_type = Key;
+	using mapped_type = T;
+	using value_type = mapped_type;
+	using size_type = std::size_t;
+	using idx_type =
+			typename std::conditional_t<sizeof(key_type) <= sizeof(size_type),
+					key_type, size_type>;
+	using difference_type = std::ptrdiff_t;
+
+	using allocator_type = Alloc;
+	using key_allocator_type = typename std::allocator_traits<
+			allocator_type>::template rebind_alloc<key_type>;
+
+	using reference = value_type&;
+	using const_reference = const value_type&;
+	using pointer = typename std::allocator_traits<allocator_type>::pointer;
+	using const_pointer =
+			typename std::allocator_traits<allocator_type>::const_pointer;
+
+	using iterator = typename std::vector<value_type, allocator_type>::iterator;
+	using const_iterator =
+			typename std::vector<value_type, allocator_type>::const_iterator;
+	using local_iterator = iterator;
+	using const_local_iterator = const_iterator;
+
+	using const_key_iterator =
+			typename std::vector<key_type, key_allocator_type>::const_iterator;
+
+	// Ctors
+	explicit unsigned_group_hashmap(size_t reserve_count);
+	explicit unsigned_group_hashmap(
+			size_t key_reserve_count, size_t value_reserve_count);
+
+	unsigned_group_hashmap() = default;
+	unsigned_group_hashmap(const unsigned_group_hashmap&) = default;
+	unsigned_group_hashmap(unsigned_group_hashmap&&) noexcept = default;
+	unsigned_group_hashmap& operator=(const unsigned_group_hashmap&) = default;
+	unsigned_group_hashmap& operator=(unsigned_group_hashmap&&) noexcept
+			= default;
+
+	explicit unsigned_group_hashmap(
+			const std::initializer_list<std::pair<key_type, value_type>>& init);
+
+
+	// Iterators
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	iterator begin() noexcept;
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator begin() const noexcept;
+
+	// Returns an iterator to the first value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator cbegin() const noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	iterator end() noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator end() const noexcept;
+
+	// Returns an iterator past the last value. NOT pair iterators.
+	[[nodiscard]]
+	const_iterator cend() const noexcept;
+
+	// Returns an iterator to first key. NOT pair iterators.
+	[[nodiscard]]
+	const_key_iterator key_begin() const noexcept;
+
+	// Returns an iterator past the last key. NOT pair iterators.
+	[[nodiscard]]
+	const_key_iterator key_end() const noexcept;
+
+
+	// Capacity
+
+	// checks whether the container is empty
+	[[nodiscard]]
+	bool empty() const noexcept;
+
+	// returns the number of elements
+	[[nodiscard]]
+	size_type size() const noexcept;
+
+	// returns the maximum possible number of elements
+	[[nodiscard]]
+	size_type max_size() const noexcept;
+
+	// reserves storage, including the lookup table
+	void reserve(size_type new_cap);
+
+	// returns the number of elements that can be held in currently
+	// allocated storage
+	[[nodiscard]]
+	size_type capacity() const noexcept;
+
+	// reduces memory usage by freeing unused memory
+	void shrink_to_fit();
+
+
+	// Modifiers
+
+	// Clears the contents. Keeps the lookup table allocated.
+	void clear() noexcept;
+
+	// Inserts new value at key.
+	std::pair<iterator, bool> insert(key_type key, const value_type& value);
+
+	// Inserts new value at key.
+	std::pair<iterator, bool> insert(key_type key, value_type&& value);
+
+	// Insert new key-value pairs.
+	void insert(const std::initializer_list<std::pair<key_type, value_type>>&
+					ilist);
+
+	// inserts an element or assigns to the current element if the key
+	// already exists
+	std::pair<iterator, bool> insert_or_assign(
+			key_type key, const value_type& value);
+
+	std::pair<iterator, bool> insert_or_assign(
+			key_type key, value_type&& value);
+
+	// constructs element in-place
+	template <class... Args>
+	std::pair<iterator, bool> emplace(key_type key, Args&&... args);
+
+	// inserts in-place if the key does not exist, does nothing if the key
+	// exists
+	template <class... Args>
+	std::pair<iterator, bool> try_emplace(key_type key, Args&&... args);
+
+	// Erases element at position.
+	void erase(const_iterator pos);
+
+	// Erases range of elements.
+	void erase(const_iterator first, const_iterator last);
+
+	// Erase element at key.
+	size_type erase(key_type k);
+
+	// swaps the contents
+	void swap(unsigned_group_hashmap& other) noexcept;
+
+
+	// Lookup
+	// direct access to the underlying vector
+	[[nodiscard]]
+	const value_type* data() const noexcept;
+
+	// direct access to the underlying vector
+	[[nodiscard]]
+	value_type* data() noexcept;
+
+	// Direct access to the keys underlying vector.
+	// Same size as values.
+	[[nodiscard]]
+	const key_type* key_data() const noexcept;
+
+	// Access specified element with bounds checking.
+	[[nodiscard]]
+	const mapped_type& at(key_type k) const;
+
+	// Access specified element with bounds checking.
+	[[nodiscard]]
+	mapped_type& at(key_type k);
+
+	// Access specified element without any bounds checking.
+	[[nodiscard]]
+	const mapped_type& at_unchecked(key_type k) const;
+
+	// Access specified element without any bounds checking.
+	[[nodiscard]]
+	mapped_type& at_unchecked(key_type k);
+
+	// access or insert specified element
+	[[nodiscard]]
+	mapped_type& operator[](key_type k);
+
+	// returns the number of elements matching specific key (which is 1 or 0,
+	// since there are no duplicates)
+	[[nodiscard]]
+	size_type count(key_type k) const;
+
+	// finds element with specific key
+	[[nodiscard]]
+	const_iterator find(key_type k) const;
+
+	// finds element with specific key
+	[[nodiscard]]
+	iterator find(key_type k);
+
+	// checks if the container contains element with specific key
+	[[nodiscard]]
+	bool contains(key_type k) const;
+
+
+	// Hash policy
+
+	// Returns average number of elements per lookup slot.
+	[[nodiscard]]
+	float load_factor() const noexcept;
+
+	// The stored maximum load factor before a rehash.
+	[[nodiscard]]
+	float max_load_factor() const noexcept;
+
+	// Set a custom load factor to control rehashing behavior.
+	// The lookup table always keeps at least one empty slot.
+	void max_load_factor(float ml);
+
+	// Rehash the container so it can hold count elements without growing.
+	void rehash(size_type count);
+
+	// The number of lookup slots, always a power of 2 (or 0).
+	[[nodiscard]]
+	size_type bucket_count() const noexcept;
+
+
+	// Non-member functions
+
+	// Deep comparison.
+	template <class K, class U, class A>
+	friend bool operator==(const unsigned_group_hashmap<K, U, A>& lhs,
+			const unsigned_group_hashmap<K, U, A>& rhs);
+
+	// Deep comparison.
+	template <class K, class U, class A>
+	friend bool operator!=(const unsigned_group_hashmap<K, U, A>& lhs,
+			const unsigned_group_hashmap<K, U, A>& rhs);
+
+private:
+	using lookup_type = detail::group_lookup<allocator_type>;
+
+	[[nodiscard]]
+	static constexpr idx_type idx_sentinel() noexcept;
+	[[nodiscard]]
+	static constexpr uint64_t hash(key_type key) noexcept;
+
+	// Returns the lookup slot of key, or lookup_type::npos.
+	[[nodiscard]]
+	size_type find_slot(key_type key, uint64_t h) const;
+
+	// Finds a free lookup slot for a new key, grows if required.
+	[[nodiscard]]
+	size_type prepare_insert(uint64_t h);
+
+	template <class M>
+	std::pair<iterator, bool> minsert(
+			key_type key, M&& value, bool assign_found = false);
+
+	// Control bytes and indexes into _values.
+	lookup_type _lookup;
+
+	// The packed keys, used for lookup comparisons and in erase for
+	// swap & pop.
+	std::vector<key_type, key_allocator_type> _reverse_lookup;
+
+	// Packed user values.
+	std::vector<value_type, allocator_type> _values;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class Key, class T, class Alloc>
+unsigned_group_hashmap<Key, T, Alloc>::unsigned_group_hashmap(
+		size_t reserve_count) {
+	reserve(reserve_count);
+}
+
+template <class Key, class T, class Alloc>
+unsigned_group_hashmap<Key, T, Alloc>::unsigned_group_hashmap(
+		size_t key_reserve_count, size_t value_reserve_count) {
+	rehash(key_reserve_count);
+	_reverse_lookup.reserve(value_reserve_count);
+	_values.reserve(value_reserve_count);
+}
+
+template <class Key, class T, class Alloc>
+unsigned_group_hashmap<Key, T, Alloc>::unsigned_group_hashmap(
+		const std::initializer_list<std::pair<key_type, value_type>>& init) {
+	reserve(init.size());
+	for (const std::pair<key_type, value_type>& kv : init) {
+		insert(kv.first, kv.second);
+	}
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::iterator unsigned_group_hashmap<
+		Key, T, Alloc>::begin() noexcept {
+	return _values.begin();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_iterator
+unsigned_group_hashmap<Key, T, Alloc>::begin() const noexcept {
+	return _values.begin();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_iterator
+unsigned_group_hashmap<Key, T, Alloc>::cbegin() const noexcept {
+	return _values.cbegin();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::iterator unsigned_group_hashmap<
+		Key, T, Alloc>::end() noexcept {
+	return _values.end();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_iterator
+unsigned_group_hashmap<Key, T, Alloc>::end() const noexcept {
+	return _values.end();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_iterator
+unsigned_group_hashmap<Key, T, Alloc>::cend() const noexcept {
+	return _values.cend();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_key_iterator
+unsigned_group_hashmap<Key, T, Alloc>::key_begin() const noexcept {
+	return _reverse_lookup.begin();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_key_iterator
+unsigned_group_hashmap<Key, T, Alloc>::key_end() const noexcept {
+	return _reverse_lookup.end();
+}
+
+template <class Key, class T, class Alloc>
+bool unsigned_group_hashmap<Key, T, Alloc>::empty() const noexcept {
+	return _values.empty();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::size() const noexcept {
+	return _values.size();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::max_size() const noexcept {
+	// -1 due to sentinel
+	return idx_sentinel() - 1;
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::reserve(size_type new_cap) {
+	if (new_cap > _lookup.growth_capacity()) {
+		rehash(new_cap);
+	}
+	_reverse_lookup.reserve(new_cap);
+	_values.reserve(new_cap);
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::capacity() const noexcept {
+	return _values.capacity();
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::shrink_to_fit() {
+	if (_values.empty()) {
+		_lookup.reset();
+	} else {
+		rehash(0);
+	}
+	_reverse_lookup.shrink_to_fit();
+	_values.shrink_to_fit();
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::clear() noexcept {
+	_lookup.clear();
+	_reverse_lookup.clear();
+	_values.clear();
+}
+
+template <class Key, class T, class Alloc>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::insert(
+		key_type key, const value_type& value) {
+	return minsert(key, value);
+}
+
+template <class Key, class T, class Alloc>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::insert(
+		key_type key, value_type&& value) {
+	return minsert(key, fea::move_if_moveable(value));
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::insert(
+		const std::initializer_list<std::pair<key_type, value_type>>& ilist) {
+	reserve(size() + ilist.size());
+	for (const std::pair<key_type, value_type>& kv : ilist) {
+		insert(kv.first, kv.second);
+	}
+}
+
+template <class Key, class T, class Alloc>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::insert_or_assign(
+		key_type key, const value_type& value) {
+	return minsert(key, value, true);
+}
+
+template <class Key, class T, class Alloc>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::insert_or_assign(
+		key_type key, value_type&& value) {
+	return minsert(key, fea::move_if_moveable(value), true);
+}
+
+template <class Key, class T, class Alloc>
+template <class... Args>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::emplace(key_type key, Args&&... args) {
+	// Standard emplace behavior doesn't apply. Use try_emplace.
+	return try_emplace(key, std::forward<Args>(args)...);
+}
+
+template <class Key, class T, class Alloc>
+template <class... Args>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::try_emplace(
+		key_type key, Args&&... args) {
+	uint64_t h = hash(key);
+	size_type slot = find_slot(key, h);
+	if (slot != lookup_type::npos) {
+		// Found valid key.
+		return { _values.begin() + _lookup.idx(slot), false };
+	}
+
+	slot = prepare_insert(h);
+	size_type new_pos = _values.size();
+	_values.emplace_back(std::forward<Args>(args)...);
+	_reverse_lookup.push_back(key);
+	_lookup.insert(slot, h, new_pos);
+
+	assert(_reverse_lookup.size() == _values.size());
+	return { begin() + new_pos, true };
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::erase(const_iterator pos) {
+	size_t idx = std::distance(_values.cbegin(), pos);
+	erase(_reverse_lookup[idx]);
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::erase(
+		const_iterator first, const_iterator last) {
+	size_t first_idx = std::distance(_values.cbegin(), first);
+	size_t last_idx = std::distance(_values.cbegin(), last);
+
+	std::vector<key_type> to_erase;
+	to_erase.reserve(last_idx - first_idx);
+	for (auto it = _reverse_lookup.begin() + first_idx;
+			it != _reverse_lookup.begin() + last_idx; ++it) {
+		to_erase.push_back(*it);
+	}
+
+	for (key_type& k : to_erase) {
+		erase(k);
+	}
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::erase(key_type k) {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == lookup_type::npos) {
+		return 0;
+	}
+
+	size_type erased_idx = _lookup.idx(slot);
+	_lookup.erase(slot);
+
+	if (erased_idx == _values.size() - 1) {
+		// No need for swap, object is already at end.
+		_reverse_lookup.pop_back();
+		_values.pop_back();
+		assert(_values.size() == _reverse_lookup.size());
+		return 1;
+	}
+
+	// Point the last element's lookup to its new position.
+	key_type last_key = _reverse_lookup.back();
+	size_type last_slot = find_slot(last_key, hash(last_key));
+	assert(last_slot != lookup_type::npos);
+	_lookup.idx(last_slot, erased_idx);
+
+	// "swap" the elements
+	_values[erased_idx] = fea::move_if_moveable(_values.back());
+	_reverse_lookup[erased_idx] = last_key;
+
+	// delete last
+	_values.pop_back();
+	_reverse_lookup.pop_back();
+
+	assert(_values.size() == _reverse_lookup.size());
+	return 1;
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::swap(
+		unsigned_group_hashmap& other) noexcept {
+	_lookup.swap(other._lookup);
+	_reverse_lookup.swap(other._reverse_lookup);
+	_values.swap(other._values);
+}
+
+template <class Key, class T, class Alloc>
+const typename unsigned_group_hashmap<Key, T, Alloc>::value_type*
+unsigned_group_hashmap<Key, T, Alloc>::data() const noexcept {
+	return _values.data();
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::value_type*
+unsigned_group_hashmap<Key, T, Alloc>::data() noexcept {
+	return _values.data();
+}
+
+template <class Key, class T, class Alloc>
+const typename unsigned_group_hashmap<Key, T, Alloc>::key_type*
+unsigned_group_hashmap<Key, T, Alloc>::key_data() const noexcept {
+	return _reverse_lookup.data();
+}
+
+template <class Key, class T, class Alloc>
+const typename unsigned_group_hashmap<Key, T, Alloc>::mapped_type&
+unsigned_group_hashmap<Key, T, Alloc>::at(key_type k) const {
+	const_iterator it = find(k);
+	if (it == end()) {
+		fea::maybe_throw<std::out_of_range>(
+				__FUNCTION__, __LINE__, "value doesn't exist");
+	}
+
+	return *it;
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::mapped_type&
+unsigned_group_hashmap<Key, T, Alloc>::at(key_type k) {
+	return const_cast<mapped_type&>(
+			static_cast<const unsigned_group_hashmap*>(this)->at(k));
+}
+
+template <class Key, class T, class Alloc>
+const typename unsigned_group_hashmap<Key, T, Alloc>::mapped_type&
+unsigned_group_hashmap<Key, T, Alloc>::at_unchecked(key_type k) const {
+	const_iterator it = find(k);
+	return *it;
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::mapped_type&
+unsigned_group_hashmap<Key, T, Alloc>::at_unchecked(key_type k) {
+	return const_cast<mapped_type&>(
+			static_cast<const unsigned_group_hashmap*>(this)->at_unchecked(k));
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::mapped_type&
+unsigned_group_hashmap<Key, T, Alloc>::operator[](key_type k) {
+	return *try_emplace(k).first;
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::count(key_type k) const {
+	if (contains(k))
+		return 1;
+
+	return 0;
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::const_iterator
+unsigned_group_hashmap<Key, T, Alloc>::find(key_type k) const {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == lookup_type::npos) {
+		return end();
+	}
+
+	assert(_lookup.idx(slot) < _values.size());
+	return begin() + _lookup.idx(slot);
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::iterator unsigned_group_hashmap<
+		Key, T, Alloc>::find(key_type k) {
+	size_type slot = find_slot(k, hash(k));
+	if (slot == lookup_type::npos) {
+		return end();
+	}
+	return begin() + _lookup.idx(slot);
+}
+
+template <class Key, class T, class Alloc>
+bool unsigned_group_hashmap<Key, T, Alloc>::contains(key_type k) const {
+	return find_slot(k, hash(k)) != lookup_type::npos;
+}
+
+template <class Key, class T, class Alloc>
+float unsigned_group_hashmap<Key, T, Alloc>::load_factor() const noexcept {
+	if (_lookup.bucket_count() == 0) {
+		return 0.f;
+	}
+	return _values.size() / float(_lookup.bucket_count());
+}
+
+template <class Key, class T, class Alloc>
+float unsigned_group_hashmap<Key, T, Alloc>::max_load_factor() const noexcept {
+	return _lookup.max_load_factor();
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::max_load_factor(float ml) {
+	_lookup.max_load_factor(ml);
+	if (_lookup.bucket_count() != 0) {
+		rehash(0);
+	}
+}
+
+template <class Key, class T, class Alloc>
+void unsigned_group_hashmap<Key, T, Alloc>::rehash(size_type count) {
+	_lookup.rehash(count, _reverse_lookup.size(),
+			[this](size_type i) { return hash(_reverse_lookup[i]); });
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::bucket_count() const noexcept {
+	return _lookup.bucket_count();
+}
+
+template <class Key, class T, class Alloc>
+constexpr typename unsigned_group_hashmap<Key, T, Alloc>::idx_type
+unsigned_group_hashmap<Key, T, Alloc>::idx_sentinel() noexcept {
+	return (std::numeric_limits<idx_type>::max)();
+}
+
+template <class Key, class T, class Alloc>
+constexpr uint64_t unsigned_group_hashmap<Key, T, Alloc>::hash(
+		key_type key) noexcept {
+	return detail::group_hash_mix(uint64_t(key));
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::find_slot(
+		key_type key, uint64_t h) const {
+	return _lookup.find(
+			h, [&](size_type idx) { return _reverse_lookup[idx] == key; });
+}
+
+template <class Key, class T, class Alloc>
+typename unsigned_group_hashmap<Key, T, Alloc>::size_type
+unsigned_group_hashmap<Key, T, Alloc>::prepare_insert(uint64_t h) {
+	assert(_values.size() < idx_sentinel()
+			&& "container has reached max capacity");
+
+	// Keys aren't stored in the lookup, rehash them from the packed keys.
+	return _lookup.prepare_insert(h, _reverse_lookup.size(),
+			[this](size_type i) { return hash(_reverse_lookup[i]); });
+}
+
+template <class Key, class T, class Alloc>
+template <class M>
+std::pair<typename unsigned_group_hashmap<Key, T, Alloc>::iterator, bool>
+unsigned_group_hashmap<Key, T, Alloc>::minsert(
+		key_type key, M&& value, bool assign_found) {
+	uint64_t h = hash(key);
+	size_type slot = find_slot(key, h);
+	if (slot != lookup_type::npos) {
+		// Found valid key.
+		auto data_it = _values.begin() + _lookup.idx(slot);
+		if (assign_found) {
+			*data_it = std::forward<M>(value);
+		}
+		return { data_it, false };
+	}
+
+	slot = prepare_insert(h);
+	size_type new_pos = _values.size();
+	_values.push_back(std::forward<M>(value));
+	_reverse_lookup.push_back(key);
+	_lookup.insert(slot, h, new_pos);
+
+	assert(_reverse_lookup.size() == _values.size());
+	return { begin() + new_pos, true };
+}
+
+
+template <class Key, class T, class Alloc>
+[[nodiscard]]
+bool operator==(const unsigned_group_hashmap<Key, T, Alloc>& lhs,
+		const unsigned_group_hashmap<Key, T, Alloc>& rhs) {
+	if (lhs.size() != rhs.size())
+		return false;
+
+	for (size_t i = 0; i < lhs.size(); ++i) {
+		Key k = lhs._reverse_lookup[i];
+		auto it = rhs.find(k);
+		if (it == rhs.end()) {
+			return false;
+		}
+
+		if (*it != lhs._values[i]) {
+			return false;
+		}
+	}
+
+	return true;
+}
+
+template <class Key, class T, class Alloc>
+[[nodiscard]]
+bool operator!=(const unsigned_group_hashmap<Key, T, Alloc>& lhs,
+		const unsigned_group_hashmap<Key, T, Alloc>& rhs) {
+	return !operator==(lhs, rhs);
+}
+} // namespace fea
@@ -48,8 +48,8 @@ This is a more traditional-ish "hash map".
 
 - It is flat because iterators are not pairs, and user values are stored
 contiguously.
-- It is unsigned because it only accepts unsigned keys (todo : allow providing
-std::hash).
+- It is unsigned because it only accepts unsigned keys (see fea::id_hashmap
+for any hashable key type).
 - It is a hashmap because the container doesn't grow as big as the
 biggest key.
 
@@ -61,6 +61,9 @@ Its special characteristics are :
 		.data()).
 	- Note : This map doesn't follow the c++ standard apis very closely, as
 		iterators are on value_type, not pair<key_type, value_type>.
+
+See unsigned_group_hashmap for the same api with simd group probing, which is
+faster for lookup heavy workloads.
 */
 
 namespace fea {
@@ -47,8 +47,8 @@ The memory backing grows as large as biggest key.
 See fea::unsigned_compact_slotset for a version which uses less memory, but has
 higher cpu cost and isn't thread-safe.
 
-TODO: fea::id_set for a more generic equivalent capable of storing any key
-type.
+See fea::id_hashset for a more generic equivalent capable of storing any
+hashable key type.
 
 REMINDER
 to try hash algo
@@ -66,7 +66,7 @@ struct unsigned_slotset {
 	// Sanity checks.
 	static_assert(std::is_unsigned_v<Key>,
 			"unsigned_set : Key must be unsigned "
-			"integer. Use fea::id_set for id types.");
+			"integer. Use fea::id_hashset for id types.");
 
 	// Typedefs
 	using key_type = Key;
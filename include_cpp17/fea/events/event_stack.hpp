@@ -33,17 +33,27 @@
 
 #pragma once
 #include "fea/containers/id_slotmap.hpp"
+#include "fea/functional/inplace_function.hpp"
+#include "fea/meta/function_traits.hpp"
 #include "fea/meta/tuple.hpp"
 #include "fea/performance/constants.hpp"
+#include "fea/performance/profile_zone.hpp"
+#include "fea/utility/error.hpp"
 #include "fea/utility/platform.hpp"
 
 #include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <functional>
 #include <limits>
+#include <mutex>
+#include <optional>
+#include <stdexcept>
 #include <tuple>
 #include <type_traits>
 #include <utility>
+#include <vector>
 
 #if FEA_WITH_TBB
 #if FEA_WINDOWS
@@ -76,20 +86,114 @@ Your event enum must fulfill these requirements :
 
 You can then subscribe and unsubscribe callbacks.
 And you can trigger events with the appropriate function parameters.
+
+Events may also be deferred. enqueue stores the event arguments in a queue,
+from any thread. Queue nodes are recycled, so enqueueing is lock-free and
+allocation-free once the queue has grown to its working size. flush then
+executes queued events grouped by event type, each callback running over the
+whole batch of its event.
+
+Callbacks are stored in std::function by default. Use inplace_event_stack to
+store them inline in contiguous arrays, without heap allocations. Its callbacks
+must fit in fea::inplace_function_default_capacity bytes.
 */
 
 namespace fea {
+namespace detail {
+// A multi-producer, single-consumer queue of event arguments.
+// Producers push nodes on an intrusive stack, the consumer grabs the whole
+// stack at once. Pending events aren't copied.
+//
+// Nodes are recycled through a free list once flushed. Pushing is lock-free
+// and doesn't allocate while the pool has free nodes. When it runs out, the
+// pool grows by a segment under a lock, like a vector reallocation.
+// The pool never shrinks.
+template <class Func>
+struct event_queue {
+	using args_t = typename fea::function_traits<Func>::args_decay_tuple;
+
+	event_queue() = default;
+	~event_queue();
+	event_queue(const event_queue&);
+	event_queue(event_queue&& other) noexcept;
+	event_queue& operator=(const event_queue& other);
+	event_queue& operator=(event_queue&& other) noexcept;
+
+	// Thread safe.
+	template <class... Args>
+	void push(Args&&... args);
+
+	// Calls every callback in map with every queued event, in order.
+	// Callbacks are the outer loop.
+	template <class Map>
+	void flush(Map& map);
+
+private:
+	struct node {
+		std::optional<args_t> args;
+		node* next = nullptr;
+		// Next free node index, read concurrently by poppers.
+		std::atomic<uint32_t> free_next{ 0 };
+		uint32_t idx = 0;
+	};
+
+	// Segment k holds first_segment_size << k nodes.
+	static constexpr size_t first_segment_size = 64;
+	static constexpr size_t max_segments = 26;
+	static constexpr uint32_t null_idx = (std::numeric_limits<uint32_t>::max)();
+
+	// Returns the node at pool index idx.
+	[[nodiscard]]
+	node* node_at(uint32_t idx) const noexcept;
+
+	// Pops a free node, grows the pool if there are none.
+	[[nodiscard]]
+	node* pop_free();
+
+	// Pushes the chain of free nodes [first, last] on the free list.
+	void push_free(node* first, node* last) noexcept;
+
+	// Allocates the next segment, returns one of its nodes and frees the
+	// others.
+	[[nodiscard]]
+	node* grow();
+
+	// Destroys pending events and the pool.
+	void clear() noexcept;
+
+	// Pending events.
+	alignas(fea::cache_line_size) std::atomic<node*> _head{ nullptr };
+
+	// The free list head, a node index tagged with a version in the high
+	// bits. Every pop bumps the version, which prevents ABA.
+	alignas(fea::cache_line_size) std::atomic<uint64_t> _free{ null_idx };
+
+	// Stable node storage.
+	std::array<std::atomic<node*>, max_segments> _segments{};
+	size_t _num_segments = 0;
+	std::mutex _grow_mutex;
+
+	// Consumer side, reused between flushes.
+	std::vector<args_t> _batch;
+};
+} // namespace detail
+
 // An opaque callback Id.
 // Used to access or unsubscribe to a callback.
 template <class EventEnum, EventEnum e>
 struct event_id;
 
 // A container to associate callbacks with event triggers.
-template <class EventEnum, class... FuncTypes>
-struct event_stack {
+// Function is the callback storage type, for ex std::function.
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+struct basic_event_stack {
 	// Stores the callbacks.
 	using event_tuple_t
-			= std::tuple<fea::id_slotmap<size_t, std::function<FuncTypes>>...>;
+			= std::tuple<fea::id_slotmap<size_t, Function<FuncTypes>>...>;
+
+	// Stores the deferred events.
+	using queue_tuple_t = std::tuple<detail::event_queue<FuncTypes>...>;
 
 	// Stores the counters to generate ids.
 	using id_gen_tuple_t = decltype(fea::make_tuple_from_count<size_t,
@@ -107,12 +211,12 @@ struct event_stack {
 			"event_stack : tuple size must be equal to count");
 
 	// Ctors
-	event_stack() = default;
-	~event_stack() = default;
-	event_stack(const event_stack&) = default;
-	event_stack(event_stack&&) = default;
-	event_stack& operator=(const event_stack&) = default;
-	event_stack& operator=(event_stack&&) = default;
+	basic_event_stack() = default;
+	~basic_event_stack() = default;
+	basic_event_stack(const basic_event_stack&) = default;
+	basic_event_stack(basic_event_stack&&) = default;
+	basic_event_stack& operator=(const basic_event_stack&) = default;
+	basic_event_stack& operator=(basic_event_stack&&) = default;
 
 	// Element access / lookup
 
@@ -211,10 +315,50 @@ struct event_stack {
 	void trigger_mt(FuncArgs&&... func_args);
 #endif
 
+	// Deferred execution
+
+	// Queue event e with arguments func_args, executed on flush.
+	// Thread safe, may be called concurrently from any thread and while
+	// flushing. Arguments are copied.
+	template <EventEnum e, class... FuncArgs>
+	void enqueue(FuncArgs&&... func_args);
+
+	// Execute all queued events, grouped by event type.
+	// Events enqueued while flushing are executed on the next flush.
+	// Don't subscribe or unsubscribe concurrently.
+	void flush();
+
+	// Execute queued events e.
+	template <EventEnum e>
+	void flush();
+
 private:
 	event_tuple_t _stacks{};
+	queue_tuple_t _queues{};
 	id_gen_tuple_t _id_generators{};
 };
+
+namespace detail {
+template <class Func>
+using event_inplace_function = fea::inplace_function<Func>;
+} // namespace detail
+
+// Stores callbacks in std::function.
+template <class EventEnum, class... FuncTypes>
+struct event_stack
+		: basic_event_stack<std::function, EventEnum, FuncTypes...> {
+	using basic_event_stack<std::function, EventEnum,
+			FuncTypes...>::basic_event_stack;
+};
+
+// Stores callbacks inline, see fea::inplace_function.
+template <class EventEnum, class... FuncTypes>
+struct inplace_event_stack
+		: basic_event_stack<detail::event_inplace_function, EventEnum,
+				  FuncTypes...> {
+	using basic_event_stack<detail::event_inplace_function, EventEnum,
+			FuncTypes...>::basic_event_stack;
+};
 } // namespace fea
 
 
@@ -230,8 +374,8 @@ struct event_id {
 	event_id& operator=(event_id&&) = default;
 
 private:
-	template <class, class...>
-	friend struct event_stack;
+	template <template <class> class, class, class...>
+	friend struct basic_event_stack;
 
 	event_id(size_t id)
 			: _id(id) {
@@ -240,104 +384,321 @@ private:
 	size_t _id = (std::numeric_limits<size_t>::max)();
 };
 
+namespace detail {
+template <class Func>
+event_queue<Func>::~event_queue() {
+	clear();
+}
+
+template <class Func>
+event_queue<Func>::event_queue(const event_queue&) {
+}
+
+template <class Func>
+event_queue<Func>::event_queue(event_queue&& other) noexcept
+		: _head(other._head.exchange(nullptr, std::memory_order_acquire))
+		, _free(other._free.exchange(null_idx, std::memory_order_acquire))
+		, _num_segments(std::exchange(other._num_segments, 0))
+		, _batch(std::move(other._batch)) {
+	for (size_t i = 0; i < max_segments; ++i) {
+		_segments[i].store(
+				other._segments[i].exchange(nullptr, std::memory_order_relaxed),
+				std::memory_order_relaxed);
+	}
+}
+
+template <class Func>
+event_queue<Func>& event_queue<Func>::operator=(const event_queue& other) {
+	if (this != &other) {
+		clear();
+	}
+	return *this;
+}
+
+template <class Func>
+event_queue<Func>& event_queue<Func>::operator=(event_queue&& other) noexcept {
+	if (this != &other) {
+		clear();
+		_head.store(other._head.exchange(nullptr, std::memory_order_acquire),
+				std::memory_order_release);
+		_free.store(other._free.exchange(null_idx, std::memory_order_acquire),
+				std::memory_order_release);
+		for (size_t i = 0; i < max_segments; ++i) {
+			_segments[i].store(other._segments[i].exchange(
+									   nullptr, std::memory_order_relaxed),
+					std::memory_order_relaxed);
+		}
+		_num_segments = std::exchange(other._num_segments, 0);
+		_batch = std::move(other._batch);
+	}
+	return *this;
+}
+
+template <class Func>
+template <class... Args>
+void event_queue<Func>::push(Args&&... args) {
+	node* n = pop_free();
+	try {
+		n->args.emplace(std::forward<Args>(args)...);
+	} catch (...) {
+		push_free(n, n);
+		throw;
+	}
+	n->next = _head.load(std::memory_order_relaxed);
+	while (!_head.compare_exchange_weak(n->next, n, std::memory_order_release,
+			std::memory_order_relaxed)) {
+	}
+}
+
+template <class Func>
+template <class Map>
+void event_queue<Func>::flush(Map& map) {
+	node* n = _head.exchange(nullptr, std::memory_order_acquire);
+	if (n == nullptr) {
+		return;
+	}
+
+	// Take the batch, in case a callback flushes.
+	std::vector<args_t> batch = std::move(_batch);
+	batch.clear();
+
+	// Recycle the nodes as we go, they are pushed back as one chain.
+	node* first = n;
+	node* last = n;
+	while (n != nullptr) {
+		batch.push_back(std::move(*n->args));
+		n->args.reset();
+		if (n->next != nullptr) {
+			n->free_next.store(n->next->idx, std::memory_order_relaxed);
+		}
+		last = n;
+		n = n->next;
+	}
+	push_free(first, last);
+
+	// The stack is in reverse order.
+	std::reverse(batch.begin(), batch.end());
+
+	for (auto& func_pair : map) {
+		for (args_t& args : batch) {
+			std::apply(func_pair.second, args);
+		}
+	}
+
+	_batch = std::move(batch);
+}
+
+template <class Func>
+auto event_queue<Func>::node_at(uint32_t idx) const noexcept -> node* {
+	// Segment k starts at first_segment_size * (2^k - 1).
+	size_t q = size_t(idx) / first_segment_size + 1;
+	size_t k = 0;
+	while ((q >> (k + 1)) != 0) {
+		++k;
+	}
+	size_t offset = size_t(idx) - first_segment_size * ((size_t(1) << k) - 1);
+	return _segments[k].load(std::memory_order_acquire) + offset;
+}
+
+template <class Func>
+auto event_queue<Func>::pop_free() -> node* {
+	uint64_t head = _free.load(std::memory_order_acquire);
+	while (true) {
+		uint32_t idx = uint32_t(head);
+		if (idx == null_idx) {
+			return grow();
+		}
+
+		// The node may be popped and recycled concurrently, in which case
+		// the version changed and the exchange fails.
+		node* n = node_at(idx);
+		uint64_t next = n->free_next.load(std::memory_order_relaxed);
+		uint64_t version = (head >> 32) + 1;
+		if (_free.compare_exchange_weak(head, (version << 32) | next,
+					std::memory_order_acquire, std::memory_order_acquire)) {
+			return n;
+		}
+	}
+}
+
+template <class Func>
+void event_queue<Func>::push_free(node* first, node* last) noexcept {
+	uint64_t head = _free.load(std::memory_order_relaxed);
+	uint64_t desired = 0;
+	do {
+		last->free_next.store(uint32_t(head), std::memory_order_relaxed);
+		desired = (head & ~uint64_t(null_idx)) | first->idx;
+	} while (!_free.compare_exchange_weak(head, desired,
+			std::memory_order_release, std::memory_order_relaxed));
+}
+
+template <class Func>
+auto event_queue<Func>::grow() -> node* {
+	{
+		std::lock_guard<std::mutex> l{ _grow_mutex };
+		if (uint32_t(_free.load(std::memory_order_acquire)) == null_idx) {
+			size_t k = _num_segments;
+			if (k == max_segments) {
+				fea::maybe_throw<std::length_error>(__FUNCTION__, __LINE__,
+						"Event queue node pool is full.");
+			}
+
+			size_t size = first_segment_size << k;
+			size_t first_idx = first_segment_size * ((size_t(1) << k) - 1);
+			node* seg = new node[size];
+			for (size_t i = 0; i < size; ++i) {
+				seg[i].idx = uint32_t(first_idx + i);
+				seg[i].free_next.store(
+						uint32_t(first_idx + i + 1), std::memory_order_relaxed);
+			}
+			_segments[k].store(seg, std::memory_order_release);
+			++_num_segments;
+
+			// Keep the first node, free the others.
+			push_free(&seg[1], &seg[size - 1]);
+			return &seg[0];
+		}
+	}
+
+	// Someone else grew the pool while we waited.
+	return pop_free();
+}
+
+template <class Func>
+void event_queue<Func>::clear() noexcept {
+	// Pending events are destroyed with their segment.
+	_head.store(nullptr, std::memory_order_relaxed);
+	_free.store(null_idx, std::memory_order_relaxed);
+	for (size_t i = 0; i < _num_segments; ++i) {
+		delete[] _segments[i].exchange(nullptr, std::memory_order_relaxed);
+	}
+	_num_segments = 0;
+}
+} // namespace detail
+
 // template <class EventEnum, EventEnum e>
 // fea::event_id<EventEnum, e>::event_id(size_t id)
 //		: _id(id) {
 // }
 
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_stack<EventEnum, FuncTypes...>::contains(event_id<EventEnum, e> id) {
+bool basic_event_stack<Function, EventEnum, FuncTypes...>::contains(
+		event_id<EventEnum, e> id) {
 	return std::get<size_t(e)>(_stacks).contains(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-const auto& event_stack<EventEnum, FuncTypes...>::at(
+const auto& basic_event_stack<Function, EventEnum, FuncTypes...>::at(
 		event_id<EventEnum, e> id) const {
 	return std::get<size_t(e)>(_stacks).at(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-auto& event_stack<EventEnum, FuncTypes...>::at(event_id<EventEnum, e> id) {
+auto& basic_event_stack<Function, EventEnum, FuncTypes...>::at(
+		event_id<EventEnum, e> id) {
 	return std::get<size_t(e)>(_stacks).at(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-const auto& event_stack<EventEnum, FuncTypes...>::at_unchecked(
+const auto& basic_event_stack<Function, EventEnum, FuncTypes...>::at_unchecked(
 		event_id<EventEnum, e> id) const {
 	assert(contains<e>(id));
 	return std::get<size_t(e)>(_stacks).at_unchecked(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-auto& event_stack<EventEnum, FuncTypes...>::at_unchecked(
+auto& basic_event_stack<Function, EventEnum, FuncTypes...>::at_unchecked(
 		event_id<EventEnum, e> id) {
 	assert(contains<e>(id));
 	return std::get<size_t(e)>(_stacks).at_unchecked(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
-bool event_stack<EventEnum, FuncTypes...>::empty() const noexcept {
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+bool basic_event_stack<Function, EventEnum, FuncTypes...>::empty()
+		const noexcept {
 	bool ret = true;
 	tuple_for_each([&](const auto& map) { ret &= map.empty(); }, _stacks);
 	return ret;
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_stack<EventEnum, FuncTypes...>::empty() const noexcept {
+bool basic_event_stack<Function, EventEnum, FuncTypes...>::empty()
+		const noexcept {
 	return std::get<size_t(e)>(_stacks).empty();
 }
 
-template <class EventEnum, class... FuncTypes>
-size_t event_stack<EventEnum, FuncTypes...>::size() const noexcept {
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+size_t basic_event_stack<Function, EventEnum, FuncTypes...>::size()
+		const noexcept {
 	size_t ret = 0;
 	tuple_for_each([&](const auto& map) { ret += map.size(); }, _stacks);
 	return ret;
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-size_t event_stack<EventEnum, FuncTypes...>::size() const noexcept {
+size_t basic_event_stack<Function, EventEnum, FuncTypes...>::size()
+		const noexcept {
 	return std::get<size_t(e)>(_stacks).size();
 }
 
-template <class EventEnum, class... FuncTypes>
-void event_stack<EventEnum, FuncTypes...>::reserve(size_t new_cap) {
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+void basic_event_stack<Function, EventEnum, FuncTypes...>::reserve(
+		size_t new_cap) {
 	tuple_for_each([&](auto& map) { map.reserve(new_cap); }, _stacks);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_stack<EventEnum, FuncTypes...>::reserve(size_t new_cap) {
+void basic_event_stack<Function, EventEnum, FuncTypes...>::reserve(
+		size_t new_cap) {
 	std::get<size_t(e)>(_stacks).reserve(new_cap);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-size_t event_stack<EventEnum, FuncTypes...>::capacity() const noexcept {
+size_t basic_event_stack<Function, EventEnum, FuncTypes...>::capacity()
+		const noexcept {
 	return std::get<size_t(e)>(_stacks).capacity();
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_stack<EventEnum, FuncTypes...>::clear() {
+void basic_event_stack<Function, EventEnum, FuncTypes...>::clear() {
 	std::get<size_t(e)>(_stacks).clear();
 }
 
-template <class EventEnum, class... FuncTypes>
-void event_stack<EventEnum, FuncTypes...>::clear() {
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+void basic_event_stack<Function, EventEnum, FuncTypes...>::clear() {
 	tuple_for_each([](auto& map) { map.clear(); }, _stacks);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e, class Func>
-fea::event_id<EventEnum, e> event_stack<EventEnum, FuncTypes...>::subscribe(
+fea::event_id<EventEnum, e>
+basic_event_stack<Function, EventEnum, FuncTypes...>::subscribe(
 		Func&& callback) {
 	size_t& id_generator = std::get<size_t(e)>(_id_generators);
 	assert(id_generator != (std::numeric_limits<size_t>::max)());
@@ -353,17 +714,20 @@ fea::event_id<EventEnum, e> event_stack<EventEnum, FuncTypes...>::subscribe(
 	return { id_generator };
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_stack<EventEnum, FuncTypes...>::unsubscribe(
+void basic_event_stack<Function, EventEnum, FuncTypes...>::unsubscribe(
 		event_id<EventEnum, e> id) {
 	std::get<size_t(e)>(_stacks).erase(id._id);
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e, class... FuncArgs>
-void event_stack<EventEnum, FuncTypes...>::trigger(
+void basic_event_stack<Function, EventEnum, FuncTypes...>::trigger(
 		FuncArgs&&... func_args) const {
+	FEA_PROFILE_ZONE("fea::event_stack::trigger");
 	for (const auto& func_pair : std::get<size_t(e)>(_stacks)) {
 		// std::invoke is not compile time, plus it makes debugging
 		// difficult.
@@ -371,19 +735,24 @@ void event_stack<EventEnum, FuncTypes...>::trigger(
 	}
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e, class... FuncArgs>
-void event_stack<EventEnum, FuncTypes...>::trigger(FuncArgs&&... func_args) {
+void basic_event_stack<Function, EventEnum, FuncTypes...>::trigger(
+		FuncArgs&&... func_args) {
+	FEA_PROFILE_ZONE("fea::event_stack::trigger");
 	for (auto& func_pair : std::get<size_t(e)>(_stacks)) {
 		func_pair.second(std::forward<FuncArgs>(func_args)...);
 	}
 }
 
 #if FEA_WITH_TBB
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e, class... FuncArgs>
-void event_stack<EventEnum, FuncTypes...>::trigger_mt(
+void basic_event_stack<Function, EventEnum, FuncTypes...>::trigger_mt(
 		FuncArgs&&... func_args) const {
+	FEA_PROFILE_ZONE("fea::event_stack::trigger_mt");
 	const auto& map = std::get<size_t(e)>(_stacks);
 	auto eval = [&, this](const tbb::blocked_range<size_t>& range) {
 		for (size_t i = range.begin(); i < range.end(); ++i) {
@@ -399,9 +768,12 @@ void event_stack<EventEnum, FuncTypes...>::trigger_mt(
 	tbb::parallel_for(range, eval, fea::default_partitioner_t<true>{});
 }
 
-template <class EventEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
 template <EventEnum e, class... FuncArgs>
-void event_stack<EventEnum, FuncTypes...>::trigger_mt(FuncArgs&&... func_args) {
+void basic_event_stack<Function, EventEnum, FuncTypes...>::trigger_mt(
+		FuncArgs&&... func_args) {
+	FEA_PROFILE_ZONE("fea::event_stack::trigger_mt");
 	auto& map = std::get<size_t(e)>(_stacks);
 	auto eval = [&](const tbb::blocked_range<size_t>& range) {
 		for (size_t i = range.begin(); i < range.end(); ++i) {
@@ -418,5 +790,30 @@ void event_stack<EventEnum, FuncTypes...>::trigger_mt(FuncArgs&&... func_args) {
 
 #endif
 
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+template <EventEnum e, class... FuncArgs>
+void basic_event_stack<Function, EventEnum, FuncTypes...>::enqueue(
+		FuncArgs&&... func_args) {
+	std::get<size_t(e)>(_queues).push(std::forward<FuncArgs>(func_args)...);
+}
+
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+void basic_event_stack<Function, EventEnum, FuncTypes...>::flush() {
+	fea::static_for<sizeof...(FuncTypes)>([this](auto idx) {
+		constexpr EventEnum e = EventEnum(decltype(idx)::value);
+		flush<e>();
+	});
+}
+
+template <template <class> class Function, class EventEnum,
+		class... FuncTypes>
+template <EventEnum e>
+void basic_event_stack<Function, EventEnum, FuncTypes...>::flush() {
+	FEA_PROFILE_ZONE("fea::event_stack::flush");
+	std::get<size_t(e)>(_queues).flush(std::get<size_t(e)>(_stacks));
+}
+
 } // namespace fea
 
@@ -46,6 +46,8 @@ usage.
 
 TODO : compact_event_system
 
+Callbacks are stored in std::function by default. inplace_event_system stores
+them inline, see inplace_event_stack.
 */
 
 namespace fea {
@@ -67,11 +69,13 @@ struct event_sys_id;
 // The event system.
 // Register notifiers or channels.
 // Hook callbacks to either or.
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-struct event_system {
+// Function is the callback storage type, for ex std::function.
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+struct basic_event_system {
 	// Stores the channel stacks.
 	using channel_tuple_t = decltype(fea::make_tuple_from_count<
-			event_stack<EventEnum, FuncTypes...>,
+			basic_event_stack<Function, EventEnum, FuncTypes...>,
 			size_t(ChannelEnum::count)>());
 
 	static_assert(
@@ -80,11 +84,11 @@ struct event_system {
 			"ChannelEnum::count");
 
 	// Ctors
-	event_system() = default;
-	event_system(const event_system&) = default;
-	event_system(event_system&&) = default;
-	event_system& operator=(const event_system&) = default;
-	event_system& operator=(event_system&&) = default;
+	basic_event_system() = default;
+	basic_event_system(const basic_event_system&) = default;
+	basic_event_system(basic_event_system&&) = default;
+	basic_event_system& operator=(const basic_event_system&) = default;
+	basic_event_system& operator=(basic_event_system&&) = default;
 
 	// Element access / lookup
 
@@ -308,9 +312,24 @@ struct event_system {
 	void trigger_mt(Args&&... args);
 #endif
 
+	// Queue event of notifier nid, executed on flush.
+	// Thread safe, as long as notifiers aren't added or removed concurrently.
+	template <EventEnum e, class... Args>
+	void enqueue(notifier_id nid, Args&&... args);
+
+	// Queue event of specified channel, executed on flush.
+	// Thread safe.
+	template <ChannelEnum c, EventEnum e, class... Args>
+	void enqueue(Args&&... args);
+
+	// Execute all queued notifier and channel events.
+	// See event_stack::flush.
+	void flush();
+
 private:
 	// Notifier events.
-	id_slotmap<size_t, event_stack<EventEnum, FuncTypes...>> _notifier_stacks{};
+	id_slotmap<size_t, basic_event_stack<Function, EventEnum, FuncTypes...>>
+			_notifier_stacks{};
 
 	// Generates notifier ids.
 	size_t _notifier_id_generator = 0;
@@ -318,13 +337,31 @@ private:
 	// Channel events.
 	channel_tuple_t _channel_stacks{};
 };
+
+// Stores callbacks in std::function.
+template <class EventEnum, class ChannelEnum, class... FuncTypes>
+struct event_system
+		: basic_event_system<std::function, EventEnum, ChannelEnum,
+				  FuncTypes...> {
+	using basic_event_system<std::function, EventEnum, ChannelEnum,
+			FuncTypes...>::basic_event_system;
+};
+
+// Stores callbacks inline, see fea::inplace_function.
+template <class EventEnum, class ChannelEnum, class... FuncTypes>
+struct inplace_event_system
+		: basic_event_system<detail::event_inplace_function, EventEnum,
+				  ChannelEnum, FuncTypes...> {
+	using basic_event_system<detail::event_inplace_function, EventEnum,
+			ChannelEnum, FuncTypes...>::basic_event_system;
+};
 } // namespace fea
 
 
 // Implementation
 namespace fea {
-template <class, class, class...>
-struct event_system;
+template <template <class> class, class, class, class...>
+struct basic_event_system;
 
 // could be : using notifier_id = size_t;
 struct notifier_id {
@@ -336,8 +373,8 @@ struct notifier_id {
 	notifier_id& operator=(notifier_id&&) = default;
 
 private:
-	template <class, class, class...>
-	friend struct event_system;
+	template <template <class> class, class, class, class...>
+	friend struct basic_event_system;
 
 	inline notifier_id(size_t id)
 			: _id(id) {
@@ -352,8 +389,8 @@ struct event_sys_id {
 	event_sys_id() = default;
 
 private:
-	template <class, class, class...>
-	friend struct event_system;
+	template <template <class> class, class, class, class...>
+	friend struct basic_event_system;
 
 	event_sys_id(event_id<EventEnum, e> eid)
 			: _eid(eid) {
@@ -373,8 +410,8 @@ struct event_sys_id<EventEnum, e> {
 	}
 
 private:
-	template <class, class, class...>
-	friend struct event_system;
+	template <template <class> class, class, class, class...>
+	friend struct basic_event_system;
 
 	event_sys_id(notifier_id nid_, event_id<EventEnum, e> eid)
 			: _nid(nid_)
@@ -386,15 +423,19 @@ private:
 };
 
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::contains(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+bool
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::contains(
 		notifier_id nid) {
 	return _notifier_stacks.contains(nid._id);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::contains(
+bool
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::contains(
 		event_sys_id<EventEnum, e> id) {
 	if (!contains(id._nid)) {
 		return false;
@@ -402,82 +443,105 @@ bool event_system<EventEnum, ChannelEnum, FuncTypes...>::contains(
 	return _notifier_stacks.at_unchecked(id._nid._id).contains(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::contains(
+bool
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::contains(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) {
 	return std::get<size_t(c)>(_channel_stacks).contains(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::contains(
+bool
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::contains(
 		event_sys_id<EventEnum, e, ChannelEnum, ChannelEnum::count>) {
 	return false;
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-const auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at(
+const auto&
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::at(
 		event_sys_id<EventEnum, e> id) const {
 	return _notifier_stacks.at(id._nid._id).at(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at(
+auto& basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::at(
 		event_sys_id<EventEnum, e> id) {
 	return _notifier_stacks.at(id._nid._id).at(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-const auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at(
+const auto&
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::at(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) const {
 	return std::get<size_t(c)>(_channel_stacks).at(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at(
+auto& basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::at(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) {
 	return std::get<size_t(c)>(_channel_stacks).at(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-const auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at_unchecked(
+const auto&
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::at_unchecked(
 		event_sys_id<EventEnum, e> id) const {
 	assert(contains(id));
 	return _notifier_stacks.at_unchecked(id._nid._id).at_unchecked(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at_unchecked(
+auto&
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::at_unchecked(
 		event_sys_id<EventEnum, e> id) {
 	assert(contains(id));
 	return _notifier_stacks.at_unchecked(id._nid._id).at_unchecked(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-const auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at_unchecked(
+const auto&
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::at_unchecked(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) const {
 	assert(contains(id));
 	return std::get<size_t(c)>(_channel_stacks).at_unchecked(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-auto& event_system<EventEnum, ChannelEnum, FuncTypes...>::at_unchecked(
+auto&
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::at_unchecked(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) {
 	assert(contains(id));
 	return std::get<size_t(c)>(_channel_stacks).at_unchecked(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty()
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+bool basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::empty()
 		const noexcept {
 	for (const auto& stack_pair : _notifier_stacks) {
 		if (!stack_pair.second.empty()) {
@@ -491,9 +555,12 @@ bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty()
 	return ret;
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::event_empty()
+bool
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::event_empty()
 		const noexcept {
 	for (const auto& stack_pair : _notifier_stacks) {
 		if (!stack_pair.second.template empty<e>()) {
@@ -507,36 +574,42 @@ bool event_system<EventEnum, ChannelEnum, FuncTypes...>::event_empty()
 	return ret;
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+bool basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::empty(
 		notifier_id nid) const noexcept {
 	return _notifier_stacks.at(nid._id).empty();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty(
+bool basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::empty(
 		notifier_id nid) const noexcept {
 	return _notifier_stacks.at(nid._id).template empty<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty()
+bool basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::empty()
 		const noexcept {
 	return std::get<size_t(c)>(_channel_stacks).empty();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-bool event_system<EventEnum, ChannelEnum, FuncTypes...>::empty()
+bool basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::empty()
 		const noexcept {
 	return std::get<size_t(c)>(_channel_stacks).template empty<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 size_t
-event_system<EventEnum, ChannelEnum, FuncTypes...>::size() const noexcept {
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::size()
+		const noexcept {
 	size_t ret = 0;
 	for (const auto& stack_pair : _notifier_stacks) {
 		ret += stack_pair.second.size();
@@ -548,9 +621,11 @@ event_system<EventEnum, ChannelEnum, FuncTypes...>::size() const noexcept {
 	return ret;
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-size_t event_system<EventEnum, ChannelEnum, FuncTypes...>::event_size()
+size_t
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::event_size()
 		const noexcept {
 	size_t ret = 0;
 	for (const auto& stack_pair : _notifier_stacks) {
@@ -563,91 +638,117 @@ size_t event_system<EventEnum, ChannelEnum, FuncTypes...>::event_size()
 	return ret;
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-size_t event_system<EventEnum, ChannelEnum, FuncTypes...>::size(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+size_t basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::size(
 		notifier_id nid) const noexcept {
 	return _notifier_stacks.at(nid._id).size();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-size_t event_system<EventEnum, ChannelEnum, FuncTypes...>::size(
+size_t basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::size(
 		notifier_id nid) const noexcept {
 	return _notifier_stacks.at(nid._id).template size<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c>
 size_t
-event_system<EventEnum, ChannelEnum, FuncTypes...>::size() const noexcept {
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::size()
+		const noexcept {
 	return std::get<size_t(c)>(_channel_stacks).size();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
 size_t
-event_system<EventEnum, ChannelEnum, FuncTypes...>::size() const noexcept {
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::size()
+		const noexcept {
 	return std::get<size_t(c)>(_channel_stacks).template size<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::reserve(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::reserve(
 		notifier_id nid, size_t new_cap) {
 	_notifier_stacks.at(nid._id).reserve(new_cap);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::reserve(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::reserve(
 		notifier_id nid, size_t new_cap) {
 	_notifier_stacks.at(nid._id).template reserve<e>(new_cap);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::reserve(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::reserve(
 		size_t new_cap) {
 	std::get<size_t(c)>(_channel_stacks).reserve(new_cap);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::reserve(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::reserve(
 		size_t new_cap) {
 	std::get<size_t(c)>(_channel_stacks).template reserve<e>(new_cap);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-size_t event_system<EventEnum, ChannelEnum, FuncTypes...>::capacity(
+size_t
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::capacity(
 		notifier_id nid) const noexcept {
 	return _notifier_stacks.at(nid._id).template capacity<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
 size_t
-event_system<EventEnum, ChannelEnum, FuncTypes...>::capacity() const noexcept {
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::capacity()
+		const noexcept {
 	return std::get<size_t(c)>(_channel_stacks).template capacity<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear() {
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::clear()
+		{
 	_notifier_stacks.clear();
 	tuple_for_each([](auto& stack) { stack.clear(); }, _channel_stacks);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear_subscribers() {
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::clear_subscribers() {
 	for (auto& stack_pair : _notifier_stacks) {
 		stack_pair.second.clear();
 	}
 	tuple_for_each([](auto& stack) { stack.clear(); }, _channel_stacks);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::event_clear() {
+void
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::event_clear() {
 	for (auto& stack_pair : _notifier_stacks) {
 		stack_pair.second.template clear<e>();
 	}
@@ -655,33 +756,42 @@ void event_system<EventEnum, ChannelEnum, FuncTypes...>::event_clear() {
 			[](auto& stack) { stack.template clear<e>(); }, _channel_stacks);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::clear(
 		notifier_id nid) {
 	_notifier_stacks.at(nid._id).clear();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear(
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::clear(
 		notifier_id nid) {
 	_notifier_stacks.at(nid._id).template clear<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear() {
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::clear()
+		{
 	std::get<size_t(c)>(_channel_stacks).clear();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::clear() {
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::clear()
+		{
 	std::get<size_t(c)>(_channel_stacks).template clear<e>();
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-notifier_id event_system<EventEnum, ChannelEnum, FuncTypes...>::add_notifier() {
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+notifier_id
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::add_notifier() {
 	assert(_notifier_id_generator != (std::numeric_limits<size_t>::max)());
 
 	// 0 is never used, reserved for future.
@@ -691,78 +801,126 @@ notifier_id event_system<EventEnum, ChannelEnum, FuncTypes...>::add_notifier() {
 	return { _notifier_id_generator };
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::remove_notifier(
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void
+basic_event_system<Function, EventEnum, ChannelEnum,
+		FuncTypes...>::remove_notifier(
 		notifier_id nid) {
 	_notifier_stacks.erase(nid._id);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e, class Func>
 event_sys_id<EventEnum, e>
-event_system<EventEnum, ChannelEnum, FuncTypes...>::subscribe(
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::subscribe(
 		notifier_id nid, Func&& callback) {
 	return { nid, _notifier_stacks.at(nid._id).template subscribe<e>(
 						  std::forward<Func>(callback)) };
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e, class Func>
 event_sys_id<EventEnum, e, ChannelEnum, c>
-event_system<EventEnum, ChannelEnum, FuncTypes...>::subscribe(Func&& func) {
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::subscribe(
+		Func&& func) {
 	return { std::get<size_t(c)>(_channel_stacks)
 					 .template subscribe<e>(std::forward<Func>(func)) };
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::unsubscribe(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::unsubscribe(
 		event_sys_id<EventEnum, e> id) {
 	_notifier_stacks.at(id._nid._id).template unsubscribe<e>(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::unsubscribe(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::unsubscribe(
 		event_sys_id<EventEnum, e, ChannelEnum, c> id) {
 	std::get<size_t(c)>(_channel_stacks).template unsubscribe<e>(id._eid);
 }
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e, class... Args>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::trigger(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::trigger(
 		notifier_id nid, Args&&... args) {
 	_notifier_stacks.at(nid._id).template trigger<e>(
 			std::forward<Args>(args)...);
 }
 
 #if FEA_WITH_TBB
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <EventEnum e, class... Args>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::trigger_mt(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::trigger_mt(
 		notifier_id nid, Args&&... args) {
 	_notifier_stacks.at(nid._id).template trigger_mt<e>(
 			std::forward<Args>(args)...);
 }
 #endif
 
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e, class... Args>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::trigger(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::trigger(
 		Args&&... args) {
 	std::get<size_t(c)>(_channel_stacks)
 			.template trigger<e>(std::forward<Args>(args)...);
 }
 
 #if FEA_WITH_TBB
-template <class EventEnum, class ChannelEnum, class... FuncTypes>
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
 template <ChannelEnum c, EventEnum e, class... Args>
-void event_system<EventEnum, ChannelEnum, FuncTypes...>::trigger_mt(
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::trigger_mt(
 		Args&&... args) {
 	std::get<size_t(c)>(_channel_stacks)
 			.template trigger_mt<e>(std::forward<Args>(args)...);
 }
 #endif
 
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+template <EventEnum e, class... Args>
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::enqueue(
+		notifier_id nid, Args&&... args) {
+	_notifier_stacks.at(nid._id).template enqueue<e>(
+			std::forward<Args>(args)...);
+}
+
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+template <ChannelEnum c, EventEnum e, class... Args>
+void
+basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::enqueue(
+		Args&&... args) {
+	std::get<size_t(c)>(_channel_stacks)
+			.template enqueue<e>(std::forward<Args>(args)...);
+}
+
+template <template <class> class Function, class EventEnum, class ChannelEnum,
+		class... FuncTypes>
+void basic_event_system<Function, EventEnum, ChannelEnum, FuncTypes...>::flush()
+		{
+	for (auto& stack_pair : _notifier_stacks) {
+		stack_pair.second.flush();
+	}
+	tuple_for_each([](auto& stack) { stack.flush(); }, _channel_stacks);
+}
+
 } // namespace fea
 
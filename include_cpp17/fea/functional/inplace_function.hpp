@@ -0,0 +1,268 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+#include "fea/utility/platform.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstring>
+#include <functional>
+#include <new>
+#include <type_traits>
+#include <utility>
+
+/*
+fea::inplace_function is a std::function that never allocates. The callable is
+stored in a fixed size buffer inside the object, and must fit in it.
+Captures are supported, up to Capacity bytes.
+
+Use it when storing many small callbacks contiguously, to avoid heap objects and
+pointer chasing on invocation.
+*/
+
+namespace fea {
+// Default buffer size, enough for a few captured pointers.
+inline constexpr size_t inplace_function_default_capacity = 4 * sizeof(void*);
+
+template <class, size_t = inplace_function_default_capacity>
+struct inplace_function;
+
+template <class FuncRet, class... FuncArgs, size_t Capacity>
+struct inplace_function<FuncRet(FuncArgs...), Capacity> {
+	// Ctors
+	inplace_function() noexcept = default;
+	inplace_function(std::nullptr_t) noexcept;
+	~inplace_function();
+	inplace_function(const inplace_function& other);
+	inplace_function(inplace_function&& other) noexcept;
+	inplace_function& operator=(const inplace_function& other);
+	inplace_function& operator=(inplace_function&& other) noexcept;
+
+	// Stores a copy of func, which must fit in Capacity.
+	template <class Func,
+			class = std::enable_if_t<
+					!std::is_same_v<std::decay_t<Func>, inplace_function>>>
+	inplace_function(Func&& func);
+
+	// Invoke function with provided arguments.
+	FuncRet operator()(FuncArgs... func_args) const;
+
+	// Holds a callable?
+	explicit operator bool() const noexcept;
+
+private:
+	using invoke_t = FuncRet (*)(void*, FuncArgs&&...);
+
+	// Type erased operations, nullptr for trivial callables.
+	struct ops {
+		void (*copy)(void* dst, const void* src);
+		void (*move)(void* dst, void* src) noexcept;
+		void (*destroy)(void* obj) noexcept;
+	};
+
+	template <class Func>
+	static FuncRet invoke(void* obj, FuncArgs&&... func_args);
+
+	template <class Func>
+	static const ops* make_ops();
+
+	void copy_from(const inplace_function& other);
+	void move_from(inplace_function& other) noexcept;
+	void reset() noexcept;
+
+	invoke_t _invoke = nullptr;
+	const ops* _ops = nullptr;
+	alignas(std::max_align_t) mutable unsigned char _buf[Capacity];
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class R, class... A, size_t C>
+inplace_function<R(A...), C>::inplace_function(std::nullptr_t) noexcept {
+}
+
+template <class R, class... A, size_t C>
+inplace_function<R(A...), C>::~inplace_function() {
+	reset();
+}
+
+template <class R, class... A, size_t C>
+inplace_function<R(A...), C>::inplace_function(const inplace_function& other) {
+	copy_from(other);
+}
+
+template <class R, class... A, size_t C>
+inplace_function<R(A...), C>::inplace_function(
+		inplace_function&& other) noexcept {
+	move_from(other);
+}
+
+template <class R, class... A, size_t C>
+auto inplace_function<R(A...), C>::operator=(const inplace_function& other)
+		-> inplace_function& {
+	if (this != &other) {
+		reset();
+		copy_from(other);
+	}
+	return *this;
+}
+
+template <class R, class... A, size_t C>
+auto inplace_function<R(A...), C>::operator=(inplace_function&& other) noexcept
+		-> inplace_function& {
+	if (this != &other) {
+		reset();
+		move_from(other);
+	}
+	return *this;
+}
+
+template <class R, class... A, size_t C>
+template <class Func, class>
+inplace_function<R(A...), C>::inplace_function(Func&& func) {
+	using func_t = std::decay_t<Func>;
+	static_assert(std::is_invocable_r_v<R, func_t&, A...>,
+			"fea::inplace_function : callable doesn't match signature");
+	static_assert(sizeof(func_t) <= C,
+			"fea::inplace_function : callable is too large, increase "
+			"Capacity");
+	static_assert(alignof(func_t) <= alignof(std::max_align_t),
+			"fea::inplace_function : callable is over-aligned");
+	static_assert(std::is_nothrow_move_constructible_v<func_t>,
+			"fea::inplace_function : callable must be nothrow movable");
+
+	// Function references can't be null.
+	using arg_t = std::remove_reference_t<Func>;
+	if constexpr (std::is_pointer_v<arg_t> || std::is_member_pointer_v<arg_t>) {
+		if (func == nullptr) {
+			return;
+		}
+	}
+
+	new (_buf) func_t(std::forward<Func>(func));
+	_invoke = &invoke<func_t>;
+	_ops = make_ops<func_t>();
+}
+
+template <class R, class... A, size_t C>
+R inplace_function<R(A...), C>::operator()(A... func_args) const {
+	assert(_invoke != nullptr);
+	return _invoke(_buf, std::forward<A>(func_args)...);
+}
+
+template <class R, class... A, size_t C>
+inplace_function<R(A...), C>::operator bool() const noexcept {
+	return _invoke != nullptr;
+}
+
+template <class R, class... A, size_t C>
+template <class Func>
+R inplace_function<R(A...), C>::invoke(void* obj, A&&... func_args) {
+	Func& func = *std::launder(reinterpret_cast<Func*>(obj));
+	if constexpr (std::is_void_v<R>) {
+		std::invoke(func, std::forward<A>(func_args)...);
+	} else {
+		return std::invoke(func, std::forward<A>(func_args)...);
+	}
+}
+
+template <class R, class... A, size_t C>
+template <class Func>
+auto inplace_function<R(A...), C>::make_ops() -> const ops* {
+	if constexpr (std::is_trivially_copyable_v<Func>
+			&& std::is_trivially_destructible_v<Func>) {
+		return nullptr;
+	} else {
+		static constexpr ops ret{
+			[](void* dst, const void* src) {
+				const Func* f
+						= std::launder(reinterpret_cast<const Func*>(src));
+				new (dst) Func(*f);
+			},
+			[](void* dst, void* src) noexcept {
+				Func* f = std::launder(reinterpret_cast<Func*>(src));
+				new (dst) Func(std::move(*f));
+				f->~Func();
+			},
+			[](void* obj) noexcept {
+				std::launder(reinterpret_cast<Func*>(obj))->~Func();
+			},
+		};
+		return &ret;
+	}
+}
+
+template <class R, class... A, size_t C>
+void inplace_function<R(A...), C>::copy_from(const inplace_function& other) {
+	if (other._invoke == nullptr) {
+		return;
+	}
+
+	if (other._ops == nullptr) {
+		std::memcpy(_buf, other._buf, C);
+	} else {
+		other._ops->copy(_buf, other._buf);
+	}
+	_invoke = other._invoke;
+	_ops = other._ops;
+}
+
+template <class R, class... A, size_t C>
+void inplace_function<R(A...), C>::move_from(inplace_function& other) noexcept {
+	if (other._invoke == nullptr) {
+		return;
+	}
+
+	if (other._ops == nullptr) {
+		std::memcpy(_buf, other._buf, C);
+	} else {
+		other._ops->move(_buf, other._buf);
+	}
+	_invoke = other._invoke;
+	_ops = other._ops;
+	other._invoke = nullptr;
+	other._ops = nullptr;
+}
+
+template <class R, class... A, size_t C>
+void inplace_function<R(A...), C>::reset() noexcept {
+	if (_ops != nullptr) {
+		_ops->destroy(_buf);
+	}
+	_invoke = nullptr;
+	_ops = nullptr;
+}
+} // namespace fea
@@ -30,18 +30,22 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
+#include "fea/containers/flat_id_slotmap.hpp"
 #include "fea/containers/span.hpp"
 #include "fea/containers/stack_vector.hpp"
 #include "fea/functional/callback.hpp"
 #include "fea/performance/constants.hpp"
+#include "fea/performance/profile_zone.hpp"
 #include "fea/utility/error.hpp"
 #include "fea/utility/platform.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <functional>
 #include <limits>
+#include <memory>
 #include <type_traits>
 #include <unordered_map>
 #include <unordered_set>
@@ -49,6 +53,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 
 #if FEA_WITH_TBB
 #include <tbb/task_group.h>
+#else
+#include "fea/performance/thread_pool.hpp"
 #endif
 
 /*
@@ -58,6 +64,15 @@ Dirtyness propagates on compute demand, not on dirtying. This leads to faster
 modification of parents, somewhat slower dirtyness deduction for children.
 
 Use this graph if you modify parents often and compute children less often.
+
+Storage
+By default, nodes are stored in a std::unordered_map and each node owns its
+parents and children vectors. Use fea::flat_lazy_graph (or pass
+fea::flat_id_slotmap as the container) for flat storage. Nodes are then stored
+contiguously, and the graph keeps contiguous (CSR) parents and children arrays,
+rebuilt lazily after topology changes. Evaluation, dirty checks and upward
+recursion walk those arrays instead of looking up nodes.
+Flat storage requires ids compatible with fea::id_hash.
 */
 
 namespace fea {
@@ -73,6 +88,13 @@ struct choose_vector<0, T> {
 
 template <size_t N, class T>
 using choose_vector_t = typename choose_vector<N, T>::type;
+
+// Runs the multi-threaded evaluations.
+#if FEA_WITH_TBB
+using lazy_task_group = tbb::task_group;
+#else
+using lazy_task_group = fea::task_group;
+#endif
 } // namespace detail
 
 // Used internally to store a node.
@@ -130,10 +152,16 @@ struct node {
 	// It is recomputed lazily, just like everything else.
 	bool is_evaluation_graph_dirty() const;
 
+	// Also dirty if the graph topology changed since it was computed.
+	bool is_evaluation_graph_dirty(size_t topology_version) const;
+
 	// Clean and update the evaluation graph.
 	// Call this before accessing it.
 	void clean_evaluation_graph();
 
+	// Clean and remember the topology it was computed with.
+	void clean_evaluation_graph(size_t topology_version);
+
 	// A left to right graph of parents needed to update this node.
 	fea::span<const Id> evaluation_graph() const;
 	std::vector<Id>& evaluation_graph();
@@ -206,6 +234,10 @@ private:
 	// if we don't do this.
 	bool _dirty_evaluation_graph = true;
 
+	// The graph topology version the eval graph was computed with.
+	// Topology changes upstream also invalidate it.
+	size_t _evaluation_graph_topology = 0;
+
 	NodeData _node_data;
 };
 
@@ -367,12 +399,14 @@ struct lazy_graph {
 	void evaluate_dirty(Id id,
 			const fea::callback<Func, void(const callback_data_t&)>& func);
 
-#if FEA_WITH_TBB
-	// Same as evaluate_dirty but threaded breaths.
+	// Same as evaluate_dirty, but evaluates the graph breadths in parallel.
+	// A node is scheduled as soon as all its parents are evaluated, it
+	// doesn't wait on the rest of its breadth.
+	// Graphs without parallel breadths are evaluated serially.
+	// Runs on tbb if available, on fea::default_thread_pool() otherwise.
 	template <class Func>
 	void evaluate_dirty_mt(Id id,
 			const fea::callback<Func, void(const callback_data_t&)>& func);
-#endif
 
 	// Update a node.
 	// Your lambda will be called recursively from parent to child.
@@ -392,8 +426,8 @@ struct lazy_graph {
 	void clean(fea::span<const Id> ids,
 			const fea::callback<Func, void(const callback_data_t&)>& func);
 
-#if FEA_WITH_TBB
 	// Same as clean but threaded breadths.
+	// See evaluate_dirty_mt.
 	template <class Func>
 	void clean_mt(Id id,
 			const fea::callback<Func, void(const callback_data_t&)>& func);
@@ -410,7 +444,6 @@ struct lazy_graph {
 	template <class Func>
 	void clean_mt(fea::span<const Id> ids,
 			const fea::callback<Func, void(const callback_data_t&)>& func);
-#endif
 
 	// Data representing independance information for evaluation graphs.
 	struct independance_data {
@@ -443,6 +476,12 @@ struct lazy_graph {
 	// Careful with this call, you are on your own.
 	const node_t& internal_node(Id id) const;
 
+	// Flat storage only, noop otherwise.
+	// Rebuilds the contiguous adjacency arrays if the topology changed.
+	// Evaluations do this for you. Const calls (is_dirty, recurse_up) can't,
+	// they use the arrays only when they are up to date.
+	void update_topology();
+
 
 	// Recurse downward, by breadth.
 	// Your function should accept both an id and a node reference.
@@ -482,8 +521,68 @@ struct lazy_graph {
 	void recurse_breadth_up_filtered(Id id, Func&& func) const;
 
 private:
+	using parent_statuses_t
+			= detail::choose_vector_t<MaxParents, parent_status_t>;
+
+	static constexpr bool is_flat
+			= std::is_same_v<UnorderedContainer<Id, node_t>,
+					fea::flat_id_slotmap<Id, node_t>>;
+
+	// Checks a node's parents, and calls func if any of them is dirty.
+	// parent_statuses is scratch memory.
+	template <class Func>
+	void evaluate_node(Id id, node_t& n, parent_statuses_t& parent_statuses,
+			const fea::callback<Func, void(const callback_data_t&)>& func);
+
+	// Syncs the parents' versions of a node being cleaned.
+	void clean_parents(const callback_data_t& c_data);
+
+	// Storage access, flat storage doesn't use pairs.
+	node_t& insert_node(Id id);
+	const node_t* find_node(Id id) const;
+
+	// Flat storage only.
+	// The node index in the storage and topology arrays.
+	size_t node_idx(Id id) const;
+
+	// Flat storage only.
+	// Your function receives node indexes.
+	template <class Func>
+	bool recurse_up_flat(size_t idx, Func&& func) const;
+
+	// Flat storage only.
+	// Contiguous adjacency, indexed like the storage.
+	struct flat_topology {
+		// Node i's parents are at [parent_offsets[i], parent_offsets[i + 1]),
+		// in the node's parent order.
+		std::vector<size_t> parent_offsets;
+		std::vector<size_t> parents;
+
+		// For each parents entry, the child's index in the parent's children
+		// versions.
+		std::vector<size_t> version_idxes;
+
+		// Node i's children are at [child_offsets[i], child_offsets[i + 1]).
+		std::vector<size_t> child_offsets;
+		std::vector<size_t> children;
+
+		// Set on any topology change.
+		bool dirty = true;
+	};
+
 	UnorderedContainer<Id, node_t> _nodes;
+	flat_topology _topology;
+
+	// Incremented on every dependency change.
+	// Cached evaluation graphs computed with an older version are stale.
+	size_t _topology_version = 0;
 };
+
+// A lazy_graph using flat node storage and contiguous adjacency arrays.
+template <class Id, class NodeData = char, class DirtyVersion = uint64_t,
+		size_t MaxParents = 0, size_t MaxChildren = 0>
+using flat_lazy_graph = lazy_graph<Id, NodeData, DirtyVersion,
+		fea::flat_id_slotmap, MaxParents, MaxChildren>;
 } // namespace fea
 
 
@@ -573,11 +672,24 @@ bool node<FEA_NODE_TARGS>::is_evaluation_graph_dirty() const {
 	return _dirty_evaluation_graph;
 }
 
+template <FEA_NODE_TMP>
+bool node<FEA_NODE_TARGS>::is_evaluation_graph_dirty(
+		size_t topology_version) const {
+	return _dirty_evaluation_graph
+		|| _evaluation_graph_topology != topology_version;
+}
+
 template <FEA_NODE_TMP>
 void node<FEA_NODE_TARGS>::clean_evaluation_graph() {
 	_dirty_evaluation_graph = false;
 }
 
+template <FEA_NODE_TMP>
+void node<FEA_NODE_TARGS>::clean_evaluation_graph(size_t topology_version) {
+	_dirty_evaluation_graph = false;
+	_evaluation_graph_topology = topology_version;
+}
+
 template <FEA_NODE_TMP>
 fea::span<const Id> node<FEA_NODE_TARGS>::evaluation_graph() const {
 	if (_dirty_evaluation_graph) {
@@ -756,15 +868,15 @@ bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::is_invalid_child(
 	// AKA, if parent doesn't exist, it will be a root with no child.
 	// If child doesn't exist, parent doesn't already have child and there
 	// is no possibility for a loop.
-	auto parent_it = _nodes.find(parent_id);
-	auto child_it = _nodes.find(child_id);
-	if (parent_it == _nodes.end() || child_it == _nodes.end()) {
+	const node_t* parent = find_node(parent_id);
+	const node_t* child = find_node(child_id);
+	if (parent == nullptr || child == nullptr) {
 		return false;
 	}
 
 	// Already has dependency?
-	if (parent_it->second.has_child(child_id)) {
-		assert(child_it->second.has_parent(parent_id));
+	if (parent->has_child(child_id)) {
+		assert(child->has_parent(parent_id));
 		return true;
 	}
 
@@ -775,7 +887,8 @@ bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::is_invalid_child(
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
 void lazy_graph<FEA_LAZY_GRAPH_TARGS>::add_node(Id id) {
-	_nodes.insert({ id, {} });
+	insert_node(id);
+	_topology.dirty = true;
 }
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
@@ -785,7 +898,7 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::remove_node(Id id) {
 		return;
 	}
 
-	node_t& n = it->second;
+	node_t& n = _nodes.at(id);
 
 	fea::span<const Id> parents = n.parents();
 	for (Id parent_id : parents) {
@@ -798,6 +911,8 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::remove_node(Id id) {
 	}
 
 	_nodes.erase(it);
+	_topology.dirty = true;
+	++_topology_version;
 }
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
@@ -846,14 +961,16 @@ bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::add_dependency(
 	// Inserts if not already in.
 	// Invalidates iterators.
 	{
-		node_t& child = _nodes.insert({ child_id, {} }).first->second;
+		node_t& child = insert_node(child_id);
 		child.add_parent(parent_id);
 	}
 	{
-		node_t& parent = _nodes.insert({ parent_id, {} }).first->second;
+		node_t& parent = insert_node(parent_id);
 		parent.add_child(child_id);
 	}
 
+	_topology.dirty = true;
+	++_topology_version;
 	return true;
 }
 
@@ -870,6 +987,8 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::remove_dependency(
 
 	child.remove_parent(parent_id);
 	parent.remove_child(child_id);
+	_topology.dirty = true;
+	++_topology_version;
 }
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
@@ -885,6 +1004,7 @@ bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::empty() const {
 template <FEA_LAZY_GRAPH_TEMPLATE>
 void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clear() {
 	_nodes.clear();
+	_topology = {};
 }
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
@@ -938,6 +1058,24 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::make_dirty_if_not(Id id) {
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
 bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::is_dirty(Id id) const {
+	if constexpr (is_flat) {
+		if (!_topology.dirty) {
+			const node_t* nodes = _nodes.data();
+			const flat_topology& t = _topology;
+			return recurse_up_flat(node_idx(id), [&](size_t idx) {
+				for (size_t i = t.parent_offsets[idx];
+						i < t.parent_offsets[idx + 1]; ++i) {
+					const node_t& p_node = nodes[t.parents[i]];
+					if (p_node.version()
+							!= p_node.children_versions()[t.version_idxes[i]]) {
+						return true;
+					}
+				}
+				return false;
+			});
+		}
+	}
+
 	return recurse_up(id, [this](Id id, const node_t& n) {
 		fea::span<const Id> parents = n.parents();
 		for (Id pid : parents) {
@@ -962,66 +1100,24 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluate_dirty(
 	if (_nodes.at(id).is_root()) {
 		return;
 	}
+	update_topology();
 
 	// Get back to front node subgraph.
 	fea::span<const Id> graph = evaluation_graph(id);
 
 	// Stored here to reuse memory.
-	detail::choose_vector_t<MaxParents, parent_status_t> parent_statuses;
+	parent_statuses_t parent_statuses;
 
 	// Now that we have the correct evaluation graph, evaluate it.
-	// Call the user funcion with the current node id and provide it's
-	// parent ids.
 	// Since we evaluate from top to bottom here, we can check if
 	// things are clean in a faster way (still relatively slow though).
 	// All we need to check is our parents version.
 	for (size_t i = 0; i < graph.size(); ++i) {
 		Id nid = graph[i];
-		node_t& n = _nodes.at(nid);
-
-		// Nodes that don't depend on anything never need to be updated.
-		if (n.is_root()) {
-			continue;
-		}
-
-		parent_statuses.clear();
-
-		// Check all my parents to see if I am really dirty.
-		// Also reset my version while we are looping.
-		bool dirty = false;
-		fea::span<const Id> parents = n.parents();
-
-		for (Id parent_id : parents) {
-			node_t& parent_node = _nodes.at(parent_id);
-
-			parent_statuses.push_back(
-					{ parent_id, &parent_node.node_data(), false });
-
-			DirtyVersion parent_version = parent_node.version();
-			DirtyVersion child_version = parent_node.child_version(nid);
-			if (child_version != parent_version) {
-				parent_statuses.back().was_dirty = true;
-				dirty = true;
-			}
-		}
-
-		if (!dirty) {
-			continue;
-		}
-
-		callback_data_t c_data;
-		c_data.id = nid;
-		c_data.node_data = &n.node_data();
-		c_data.parents = { parent_statuses.data(), parent_statuses.size() };
-
-		// And finally, call the user lambda. Provide it with its id and
-		// parent ids.
-		func(c_data);
-		make_dirty(nid);
+		evaluate_node(nid, _nodes.at(nid), parent_statuses, func);
 	}
 }
 
-#if FEA_WITH_TBB
 template <FEA_LAZY_GRAPH_TEMPLATE>
 template <class Func>
 void lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluate_dirty_mt(
@@ -1029,111 +1125,141 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluate_dirty_mt(
 	if (_nodes.at(id).is_root()) {
 		return;
 	}
+	update_topology();
 
 	// Get back to front node subgraph.
+	// Parents are always before their children.
 	fea::span<const Id> graph = evaluation_graph(id);
+	const size_t size = graph.size();
+
+	// Work with indexes in the evaluation graph from now on.
+	std::unordered_map<Id, size_t> graph_idxes;
+	graph_idxes.reserve(size);
+	std::vector<node_t*> nodes(size);
+	for (size_t i = 0; i < size; ++i) {
+		graph_idxes.insert({ graph[i], i });
+		nodes[i] = &_nodes.at(graph[i]);
+	}
 
-
-	// We will keep a vector of currently evaluating nodes.
-	// If a child node depends on something that is evaluating, we lock
-	// since we've reached a new breadth of the graph.
-	std::vector<Id> evaluating;
-	tbb::task_group g;
-
-	// Now that we have the correct evaluation graph, evaluate it.
-	// Call the user funcion with the current node id.
-	// Since we evaluate from top to bottom here, we can check if
-	// things are clean in a faster way (still relatively slow though).
-	// All we need to check is our parents version.
-	for (size_t i = 0; i < graph.size(); ++i) {
-		Id nid = graph[i];
-		node_t& n = _nodes.at(nid);
-
-		// Nodes that don't depend on anything never need to be updated.
-		if (n.is_root()) {
-			continue;
+	// Compute the breadths (levels) and the children of each node.
+	// A node's breadth is 1 + its deepest parent's breadth.
+	// Children are stored contiguously, child_offsets[i] to
+	// child_offsets[i + 1].
+	std::vector<size_t> breadths(size, 0);
+	std::vector<size_t> child_offsets(size + 1, 0);
+	for (size_t i = 0; i < size; ++i) {
+		for (Id parent_id : nodes[i]->parents()) {
+			assert(graph_idxes.count(parent_id) != 0);
+			size_t parent_idx = graph_idxes.at(parent_id);
+			assert(parent_idx < i);
+			breadths[i] = (std::max)(breadths[i], breadths[parent_idx] + 1);
+			++child_offsets[parent_idx + 1];
 		}
+	}
+	for (size_t i = 0; i < size; ++i) {
+		child_offsets[i + 1] += child_offsets[i];
+	}
 
-		// Here, we lock if any of our parent is being evaluated.
-		// This would be both problematic for data access and dirty
-		// checking.
-		for (size_t j = 0; j < evaluating.size(); ++j) {
-			if (n.has_parent(evaluating[j])) {
-				g.wait();
-				evaluating.clear();
-				break;
+	std::vector<size_t> children(child_offsets.back());
+	{
+		std::vector<size_t> child_pos(child_offsets.begin(),
+				child_offsets.end() - 1);
+		for (size_t i = 0; i < size; ++i) {
+			for (Id parent_id : nodes[i]->parents()) {
+				children[child_pos[graph_idxes.at(parent_id)]++] = i;
 			}
 		}
+	}
 
-		// We can check the dirtyness with parents on the main thread, since
-		// we guarantee you never execute at the same time as your parents.
+	// Roots are never evaluated. If no breadth can evaluate more than 1
+	// node, threading would only add overhead.
+	{
+		std::vector<size_t> breadth_sizes(size, 0);
+		size_t max_breadth = 0;
+		for (size_t i = 0; i < size; ++i) {
+			if (breadths[i] != 0) {
+				size_t breadth_size = ++breadth_sizes[breadths[i]];
+				max_breadth = (std::max)(max_breadth, breadth_size);
+			}
+		}
 
-		// Check all my parents to see if I am really dirty.
-		// Also reset my version while we are looping.
-		bool dirty = false;
-		fea::span<const Id> parents = n.parents();
+		if (max_breadth < 2) {
+			evaluate_dirty(id, func);
+			return;
+		}
+	}
 
-		detail::choose_vector_t<MaxParents, parent_status_t> parent_statuses;
-		parent_statuses.reserve(parents.size());
+	// Number of parents left to evaluate, per node.
+	// Whoever evaluates a node's last parent schedules it.
+	std::unique_ptr<std::atomic<size_t>[]> num_waiting(
+			new std::atomic<size_t>[size]);
+	for (size_t i = 0; i < size; ++i) {
+		num_waiting[i].store(nodes[i]->parents().size(),
+				std::memory_order_relaxed);
+	}
 
-		// eh, not great. better way to pass on parents to user funcion?
-		for (Id parent_id : parents) {
-			node_t& parent_node = _nodes.at(parent_id);
+	detail::lazy_task_group g;
+
+	// Evaluates a node, then schedules its ready children.
+	// The last ready child is evaluated on this thread.
+	auto eval_task = [&](size_t idx, const auto& self) -> void {
+		parent_statuses_t parent_statuses;
+		while (true) {
+			evaluate_node(graph[idx], *nodes[idx], parent_statuses, func);
+
+			size_t next = (std::numeric_limits<size_t>::max)();
+			for (size_t j = child_offsets[idx]; j < child_offsets[idx + 1];
+					++j) {
+				size_t child_idx = children[j];
+				if (num_waiting[child_idx].fetch_sub(
+							1, std::memory_order_acq_rel)
+						!= 1) {
+					continue;
+				}
 
-			parent_statuses.push_back(
-					{ parent_id, &parent_node.node_data(), false });
+				if (next != (std::numeric_limits<size_t>::max)()) {
+					g.run([&self, next]() { self(next, self); });
+				}
+				next = child_idx;
+			}
 
-			DirtyVersion parent_version = parent_node.version();
-			DirtyVersion child_version = parent_node.child_version(nid);
-			if (child_version != parent_version) {
-				// set the callback bool to dirty
-				parent_statuses.back().was_dirty = true;
-				dirty = true;
+			if (next == (std::numeric_limits<size_t>::max)()) {
+				return;
 			}
+			idx = next;
 		}
+	};
 
-		if (!dirty) {
+	// Roots are never evaluated, release their children right away.
+	for (size_t i = 0; i < size; ++i) {
+		if (!nodes[i]->is_root()) {
 			continue;
 		}
 
-		evaluating.push_back(nid);
-		g.run([p = std::move(parent_statuses), nid, node_d = &n.node_data(),
-					  func, this]() {
-			callback_data_t c_data;
-			c_data.id = nid;
-			c_data.node_data = node_d;
-			c_data.parents = { p.data(), p.size() };
-
-			// And finally, call the user lambda. Provide it with its id.
-			func(c_data);
-			make_dirty(nid);
-		});
+		for (size_t j = child_offsets[i]; j < child_offsets[i + 1]; ++j) {
+			size_t child_idx = children[j];
+			if (num_waiting[child_idx].fetch_sub(1, std::memory_order_acq_rel)
+					== 1) {
+				g.run([&eval_task, child_idx]() {
+					eval_task(child_idx, eval_task);
+				});
+			}
+		}
 	}
 
 	g.wait();
 }
-#endif
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
 template <class Func>
 void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clean(
 		Id id, const fea::callback<Func, void(const callback_data_t&)>& func) {
+	FEA_PROFILE_ZONE("fea::lazy_graph::clean");
+
 	// Call our evaluation function, and clean nodes.
 	evaluate_dirty(
 			id, fea::make_callback([&, this](const callback_data_t& c_data) {
-				// Clean the node.
-				for (const parent_status_t& ps : c_data.parents) {
-					if (!ps.was_dirty) {
-						continue;
-					}
-
-					// Get parent node.
-					node_t& parent_node = _nodes.at(ps.parent_id);
-					DirtyVersion parent_version = parent_node.version();
-					DirtyVersion& child_version
-							= parent_node.child_version(c_data.id);
-					child_version = parent_version;
-				}
+				clean_parents(c_data);
 
 				// Call user function.
 				func(c_data);
@@ -1149,27 +1275,16 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clean(fea::span<const Id> ids,
 	}
 }
 
-#if FEA_WITH_TBB
 template <FEA_LAZY_GRAPH_TEMPLATE>
 template <class Func>
 void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clean_mt(
 		Id id, const fea::callback<Func, void(const callback_data_t&)>& func) {
+	FEA_PROFILE_ZONE("fea::lazy_graph::clean_mt");
+
 	// Call our evaluation function, and clean nodes.
 	evaluate_dirty_mt(
 			id, fea::make_callback([&, this](const callback_data_t& c_data) {
-				// Clean the node.
-				for (const parent_status_t& ps : c_data.parents) {
-					if (!ps.was_dirty) {
-						continue;
-					}
-
-					// Get parent node.
-					node_t& parent_node = _nodes.at(ps.parent_id);
-					DirtyVersion parent_version = parent_node.version();
-					DirtyVersion& child_version
-							= parent_node.child_version(c_data.id);
-					child_version = parent_version;
-				}
+				clean_parents(c_data);
 
 				// Call user function.
 				func(c_data);
@@ -1184,23 +1299,252 @@ void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clean_mt(fea::span<const Id> ids,
 	// can't.
 	auto ind_data = are_eval_graphs_independent(ids);
 
+	// Graphs are cleaned in parallel, update the shared topology first.
+	update_topology();
+
 	// 'ind_data.independent_graphs' can be updated in parallel.
-	tbb::task_group g;
+	detail::lazy_task_group g;
 	for (Id id : ind_data.independent_graphs) {
 		g.run([&, id, this]() { clean_mt(id, func); });
 	}
 
 	// 'ind_data.dependent_graphs' cannot be cleaned in parallel.
 	// But they are still independent from 'ind_data.independent_graphs'.
-	g.run_and_wait([&, this]() {
-		for (Id id : ind_data.dependent_graphs) {
-			// Clean one at a time. But you can still call clean_mt at
-			// least.
-			clean_mt(id, func);
+	for (Id id : ind_data.dependent_graphs) {
+		// Clean one at a time. But you can still call clean_mt at
+		// least.
+		clean_mt(id, func);
+	}
+	g.wait();
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+template <class Func>
+void lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluate_node(Id nid, node_t& n,
+		parent_statuses_t& parent_statuses,
+		const fea::callback<Func, void(const callback_data_t&)>& func) {
+	// Nodes that don't depend on anything never need to be updated.
+	if (n.is_root()) {
+		return;
+	}
+
+	parent_statuses.clear();
+
+	// Check all my parents to see if I am really dirty.
+	// Our parents are done evaluating, we may read them.
+	bool dirty = false;
+	fea::span<const Id> parents = n.parents();
+
+	if constexpr (is_flat) {
+		// Parents are stored in the same order in the topology.
+		assert(!_topology.dirty);
+		const flat_topology& t = _topology;
+		const node_t* nodes = _nodes.data();
+		size_t idx = size_t(&n - nodes);
+		size_t first = t.parent_offsets[idx];
+		assert(t.parent_offsets[idx + 1] - first == parents.size());
+
+		for (size_t i = 0; i < parents.size(); ++i) {
+			const node_t& parent_node = nodes[t.parents[first + i]];
+
+			parent_statuses.push_back(
+					{ parents[i], &parent_node.node_data(), false });
+
+			DirtyVersion parent_version = parent_node.version();
+			DirtyVersion child_version = parent_node.children_versions()
+					[t.version_idxes[first + i]];
+			if (child_version != parent_version) {
+				parent_statuses.back().was_dirty = true;
+				dirty = true;
+			}
 		}
-	});
+	} else {
+		for (Id parent_id : parents) {
+			node_t& parent_node = _nodes.at(parent_id);
+
+			parent_statuses.push_back(
+					{ parent_id, &parent_node.node_data(), false });
+
+			DirtyVersion parent_version = parent_node.version();
+			DirtyVersion child_version = parent_node.child_version(nid);
+			if (child_version != parent_version) {
+				parent_statuses.back().was_dirty = true;
+				dirty = true;
+			}
+		}
+	}
+
+	if (!dirty) {
+		return;
+	}
+
+	callback_data_t c_data;
+	c_data.id = nid;
+	c_data.node_data = &n.node_data();
+	c_data.parents = { parent_statuses.data(), parent_statuses.size() };
+
+	// And finally, call the user lambda. Provide it with its id and
+	// parent ids.
+	func(c_data);
+	make_dirty(nid);
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+void lazy_graph<FEA_LAZY_GRAPH_TARGS>::clean_parents(
+		const callback_data_t& c_data) {
+	if constexpr (is_flat) {
+		// Parent statuses are in the topology order.
+		assert(!_topology.dirty);
+		const flat_topology& t = _topology;
+		node_t* nodes = _nodes.data();
+		size_t first = t.parent_offsets[node_idx(c_data.id)];
+
+		for (size_t i = 0; i < c_data.parents.size(); ++i) {
+			if (!c_data.parents[i].was_dirty) {
+				continue;
+			}
+
+			node_t& parent_node = nodes[t.parents[first + i]];
+			parent_node.children_versions()[t.version_idxes[first + i]]
+					= parent_node.version();
+		}
+	} else {
+		for (const parent_status_t& ps : c_data.parents) {
+			if (!ps.was_dirty) {
+				continue;
+			}
+
+			// Get parent node.
+			node_t& parent_node = _nodes.at(ps.parent_id);
+			DirtyVersion parent_version = parent_node.version();
+			DirtyVersion& child_version = parent_node.child_version(c_data.id);
+			child_version = parent_version;
+		}
+	}
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+auto lazy_graph<FEA_LAZY_GRAPH_TARGS>::insert_node(Id id) -> node_t& {
+	if constexpr (is_flat) {
+		return *_nodes.try_emplace(id).first;
+	} else {
+		return _nodes.insert({ id, {} }).first->second;
+	}
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+auto lazy_graph<FEA_LAZY_GRAPH_TARGS>::find_node(Id id) const
+		-> const node_t* {
+	auto it = _nodes.find(id);
+	if (it == _nodes.end()) {
+		return nullptr;
+	}
+
+	if constexpr (is_flat) {
+		return &*it;
+	} else {
+		return &it->second;
+	}
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+size_t lazy_graph<FEA_LAZY_GRAPH_TARGS>::node_idx(Id id) const {
+	static_assert(is_flat, "lazy_graph : only valid with flat storage");
+	return size_t(&_nodes.at(id) - _nodes.data());
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+void lazy_graph<FEA_LAZY_GRAPH_TARGS>::update_topology() {
+	if constexpr (is_flat) {
+		if (!_topology.dirty) {
+			return;
+		}
+
+		flat_topology& t = _topology;
+		const node_t* nodes = _nodes.data();
+		const size_t size = _nodes.size();
+
+		t.parent_offsets.assign(size + 1, 0);
+		t.child_offsets.assign(size + 1, 0);
+		for (size_t i = 0; i < size; ++i) {
+			t.parent_offsets[i + 1]
+					= t.parent_offsets[i] + nodes[i].parents().size();
+			t.child_offsets[i + 1]
+					= t.child_offsets[i] + nodes[i].children().size();
+		}
+		assert(t.parent_offsets.back() == t.child_offsets.back());
+
+		// Gather all edges from the parents' side, which knows the
+		// children versions indexes. Sorted by child, a node's edges end up
+		// at its parent offset.
+		struct edge {
+			size_t child;
+			size_t parent;
+			size_t version_idx;
+		};
+		std::vector<edge> edges;
+		edges.reserve(t.child_offsets.back());
+		t.children.resize(t.child_offsets.back());
+
+		for (size_t i = 0; i < size; ++i) {
+			fea::span<const Id> children = nodes[i].children();
+			for (size_t j = 0; j < children.size(); ++j) {
+				size_t child_idx = node_idx(children[j]);
+				t.children[t.child_offsets[i] + j] = child_idx;
+				edges.push_back({ child_idx, i, j });
+			}
+		}
+
+		std::sort(edges.begin(), edges.end(),
+				[](const edge& lhs, const edge& rhs) {
+					if (lhs.child != rhs.child) {
+						return lhs.child < rhs.child;
+					}
+					return lhs.parent < rhs.parent;
+				});
+
+		// Now, store parents in each node's parent order.
+		t.parents.resize(t.parent_offsets.back());
+		t.version_idxes.resize(t.parent_offsets.back());
+
+		for (size_t i = 0; i < size; ++i) {
+			auto first = edges.begin() + t.parent_offsets[i];
+			auto last = edges.begin() + t.parent_offsets[i + 1];
+
+			fea::span<const Id> parents = nodes[i].parents();
+			for (size_t j = 0; j < parents.size(); ++j) {
+				size_t parent_idx = node_idx(parents[j]);
+				auto it = std::lower_bound(first, last, parent_idx,
+						[](const edge& e, size_t p) { return e.parent < p; });
+				assert(it != last);
+				assert(it->child == i && it->parent == parent_idx);
+
+				t.parents[t.parent_offsets[i] + j] = parent_idx;
+				t.version_idxes[t.parent_offsets[i] + j] = it->version_idx;
+			}
+		}
+
+		t.dirty = false;
+	}
+}
+
+template <FEA_LAZY_GRAPH_TEMPLATE>
+template <class Func>
+bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::recurse_up_flat(
+		size_t idx, Func&& func) const {
+	if (func(idx)) {
+		return true;
+	}
+
+	for (size_t i = _topology.parent_offsets[idx];
+			i < _topology.parent_offsets[idx + 1]; ++i) {
+		if (recurse_up_flat(_topology.parents[i], func)) {
+			return true;
+		}
+	}
+
+	return false;
 }
-#endif
 
 template <FEA_LAZY_GRAPH_TEMPLATE>
 auto lazy_graph<FEA_LAZY_GRAPH_TARGS>::are_eval_graphs_independent(
@@ -1260,7 +1604,7 @@ template <FEA_LAZY_GRAPH_TEMPLATE>
 fea::span<const Id> lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluation_graph(
 		Id node_id) {
 	node_t& n = _nodes.at(node_id);
-	if (!n.is_evaluation_graph_dirty()) {
+	if (!n.is_evaluation_graph_dirty(_topology_version)) {
 		return n.evaluation_graph();
 	}
 
@@ -1321,7 +1665,7 @@ fea::span<const Id> lazy_graph<FEA_LAZY_GRAPH_TARGS>::evaluation_graph(
 	assert(it == dup.end());
 #endif
 
-	n.clean_evaluation_graph();
+	n.clean_evaluation_graph(_topology_version);
 	return n.evaluation_graph();
 }
 
@@ -1369,6 +1713,15 @@ bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::recurse_breadth_down(
 template <FEA_LAZY_GRAPH_TEMPLATE>
 template <class Func>
 bool lazy_graph<FEA_LAZY_GRAPH_TARGS>::recurse_up(Id id, Func&& func) const {
+	if constexpr (is_flat) {
+		if (!_topology.dirty) {
+			const node_t* nodes = _nodes.data();
+			const Id* keys = _nodes.key_data();
+			return recurse_up_flat(node_idx(id),
+					[&](size_t idx) { return func(keys[idx], nodes[idx]); });
+		}
+	}
+
 	const node_t& n = _nodes.at(id);
 	if (func(id, n)) {
 		return true;
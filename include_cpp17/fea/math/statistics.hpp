@@ -109,6 +109,20 @@ template <class FwdIt>
 [[nodiscard]]
 constexpr auto median(FwdIt begin, FwdIt end);
 
+// Compute the p-th percentile (p in [0, 1]), linearly interpolated between
+// closest ranks. Provided callback must return desired value.
+// Note : This function heap allocates. Values must be sortable.
+template <class FwdIt, class T, class Func>
+[[nodiscard]]
+auto percentile(FwdIt begin, FwdIt end, T p, Func&& func);
+
+// Compute the p-th percentile (p in [0, 1]), linearly interpolated between
+// closest ranks.
+// Note : This function heap allocates. Values must be sortable.
+template <class FwdIt, class T>
+[[nodiscard]]
+auto percentile(FwdIt begin, FwdIt end, T p);
+
 // Compute the mode (the most common number in set).
 // Returns a vector of highest frequency items,
 // or an empty vector if no mode was found.
@@ -364,6 +378,39 @@ constexpr auto median(FwdIt begin, FwdIt end) {
 	return median(begin, end, [](const auto& v) -> const auto& { return v; });
 }
 
+template <class FwdIt, class T, class Func>
+auto percentile(FwdIt begin, FwdIt end, T p, Func&& func) {
+	using V = std::decay_t<decltype(func(*begin))>;
+	using cast_t = std::conditional_t<fea::is_static_castable_v<V, floatmax_t>,
+			floatmax_t, V>;
+	assert(begin != end);
+	assert(p >= T(0) && p <= T(1));
+
+	std::vector<V> vals;
+	vals.reserve(std::distance(begin, end));
+	for (auto it = begin; it != end; ++it) {
+		vals.push_back(func(*it));
+	}
+	std::sort(vals.begin(), vals.end());
+
+	cast_t rank = cast_t(p) * cast_t(vals.size() - 1);
+	size_t lo = size_t(rank);
+	if (lo + 1 >= vals.size()) {
+		return vals.back();
+	}
+
+	cast_t t = rank - cast_t(lo);
+	cast_t v1 = cast_t(vals[lo]);
+	cast_t v2 = cast_t(vals[lo + 1]);
+	return detail::maybe_round<V>(v1 + t * (v2 - v1));
+}
+
+template <class FwdIt, class T>
+auto percentile(FwdIt begin, FwdIt end, T p) {
+	return percentile(
+			begin, end, p, [](const auto& v) -> const auto& { return v; });
+}
+
 template <class FwdIt, class Func>
 auto mode(FwdIt begin, FwdIt end, Func&& func) {
 	using T = std::decay_t<decltype(func(*begin))>;
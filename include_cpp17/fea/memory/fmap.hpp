@@ -266,7 +266,7 @@ using ifmap = basic_fmap_read;
 // Implementation
 namespace fea {
 namespace detail {
-fmap_os_data::fmap_os_data(fmap_os_data&& other) noexcept
+inline fmap_os_data::fmap_os_data(fmap_os_data&& other) noexcept
 #if FEA_WINDOWS
 		: file_handle(other.file_handle)
 		, map_handle(other.map_handle)
@@ -290,7 +290,7 @@ fmap_os_data::fmap_os_data(fmap_os_data&& other) noexcept
 	other.byte_size = 0;
 }
 
-fmap_os_data& fmap_os_data::operator=(fmap_os_data&& other) noexcept {
+inline fmap_os_data& fmap_os_data::operator=(fmap_os_data&& other) noexcept {
 	if (this != &other) {
 #if FEA_WINDOWS
 		file_handle = other.file_handle;
@@ -309,7 +309,8 @@ fmap_os_data& fmap_os_data::operator=(fmap_os_data&& other) noexcept {
 	return *this;
 }
 
-fmap_os_data os_map(const std::filesystem::path& filepath, fmap_mode mode) {
+inline fmap_os_data os_map(
+		const std::filesystem::path& filepath, fmap_mode mode) {
 	if (!std::filesystem::exists(filepath)
 			|| std::filesystem::is_directory(filepath)) {
 		return {};
@@ -382,7 +383,7 @@ fmap_os_data os_map(const std::filesystem::path& filepath, fmap_mode mode) {
 	return ret;
 }
 
-void os_unmap(const fmap_os_data& os_data) {
+inline void os_unmap(const fmap_os_data& os_data) {
 	assert(os_data.ptr != nullptr);
 	assert(os_data.byte_size != 0);
 
@@ -419,11 +420,11 @@ void os_unmap(const fmap_os_data& os_data) {
 } // namespace detail
 
 
-basic_fmap_read::basic_fmap_read(const std::filesystem::path& filepath)
+inline basic_fmap_read::basic_fmap_read(const std::filesystem::path& filepath)
 		: basic_fmap_read(filepath, detail::fmap_mode::read) {
 }
 
-basic_fmap_read::~basic_fmap_read() {
+inline basic_fmap_read::~basic_fmap_read() {
 	if (!is_open()) {
 		return;
 	}
@@ -432,88 +433,88 @@ basic_fmap_read::~basic_fmap_read() {
 }
 
 
-auto basic_fmap_read::begin() const noexcept -> const_iterator {
+inline auto basic_fmap_read::begin() const noexcept -> const_iterator {
 	return _data.ptr;
 }
 
-auto basic_fmap_read::end() const noexcept -> const_iterator {
+inline auto basic_fmap_read::end() const noexcept -> const_iterator {
 	return _data.ptr + _data.byte_size;
 }
 
-auto basic_fmap_read::rbegin() const noexcept -> const_reverse_iterator {
+inline auto basic_fmap_read::rbegin() const noexcept -> const_reverse_iterator {
 	return std::reverse_iterator{ end() };
 }
 
-auto basic_fmap_read::rend() const noexcept -> const_reverse_iterator {
+inline auto basic_fmap_read::rend() const noexcept -> const_reverse_iterator {
 	return std::reverse_iterator{ begin() };
 }
 
-auto basic_fmap_read::data() const noexcept -> const_pointer {
+inline auto basic_fmap_read::data() const noexcept -> const_pointer {
 	return _data.ptr;
 }
 
-auto basic_fmap_read::operator[](size_t idx) const -> const_reference {
+inline auto basic_fmap_read::operator[](size_t idx) const -> const_reference {
 	assert(idx < _data.byte_size);
 	return _data.ptr[idx];
 }
 
-bool basic_fmap_read::is_open() const noexcept {
+inline bool basic_fmap_read::is_open() const noexcept {
 	return !empty();
 }
 
-basic_fmap_read::size_type basic_fmap_read::size() const noexcept {
+inline basic_fmap_read::size_type basic_fmap_read::size() const noexcept {
 	return _data.byte_size;
 }
 
-bool basic_fmap_read::empty() const noexcept {
+inline bool basic_fmap_read::empty() const noexcept {
 	return _data.byte_size == 0;
 }
 
-void basic_fmap_read::open(const std::filesystem::path& filepath) {
+inline void basic_fmap_read::open(const std::filesystem::path& filepath) {
 	close();
 	_data = detail::os_map(filepath, detail::fmap_mode::read);
 }
 
-void basic_fmap_read::close() {
+inline void basic_fmap_read::close() {
 	this->~basic_fmap_read();
 	_data = {};
 }
 
-basic_fmap_read::basic_fmap_read(
+inline basic_fmap_read::basic_fmap_read(
 		const std::filesystem::path& filepath, detail::fmap_mode mode)
 		: _data(detail::os_map(filepath, mode)) {
 }
 
 
-basic_fmap_write::basic_fmap_write(const std::filesystem::path& filepath)
+inline basic_fmap_write::basic_fmap_write(const std::filesystem::path& filepath)
 		: basic_fmap_read(filepath, detail::fmap_mode::write) {
 }
 
-basic_fmap_write::iterator basic_fmap_write::begin() noexcept {
+inline basic_fmap_write::iterator basic_fmap_write::begin() noexcept {
 	return const_cast<iterator>(basic_fmap_read::begin());
 }
 
-basic_fmap_write::iterator basic_fmap_write::end() noexcept {
+inline basic_fmap_write::iterator basic_fmap_write::end() noexcept {
 	return const_cast<iterator>(basic_fmap_read::end());
 }
 
-basic_fmap_write::reverse_iterator basic_fmap_write::rbegin() noexcept {
+inline basic_fmap_write::reverse_iterator basic_fmap_write::rbegin() noexcept {
 	return std::reverse_iterator{ end() };
 }
 
-basic_fmap_write::reverse_iterator basic_fmap_write::rend() noexcept {
+inline basic_fmap_write::reverse_iterator basic_fmap_write::rend() noexcept {
 	return std::reverse_iterator{ begin() };
 }
 
-basic_fmap_write::pointer basic_fmap_write::data() noexcept {
+inline basic_fmap_write::pointer basic_fmap_write::data() noexcept {
 	return const_cast<pointer>(basic_fmap_read::data());
 }
 
-basic_fmap_write::reference basic_fmap_write::operator[](size_t idx) {
+inline basic_fmap_write::reference basic_fmap_write::operator[](size_t idx) {
 	return const_cast<reference>(basic_fmap_read::operator[](idx));
 }
 
-void basic_fmap_write::open(const std::filesystem::path& filepath) {
+inline void basic_fmap_write::open(const std::filesystem::path& filepath) {
 	close();
 	_data = detail::os_map(filepath, detail::fmap_mode::write);
 }
@@ -549,12 +550,12 @@ void to_span(basic_fmap_write& ofm, span<U>& out) {
 	out = to_span<U>(ofm);
 }
 
-std::string_view to_sv(const basic_fmap_read& ifm) {
+inline std::string_view to_sv(const basic_fmap_read& ifm) {
 	return std::string_view{ reinterpret_cast<const char*>(ifm.data()),
 		ifm.size() };
 }
 
-std::wstring_view to_wsv(const basic_fmap_read& ifm) {
+inline std::wstring_view to_wsv(const basic_fmap_read& ifm) {
 	if (ifm.size() % sizeof(wchar_t) != 0) {
 		fea::maybe_throw<std::invalid_argument>(__FUNCTION__, __LINE__,
 				"Cannot convert to std::wstring_view, total size not multiple "
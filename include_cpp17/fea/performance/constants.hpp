@@ -33,6 +33,7 @@
 #pragma once
 #include "fea/utility/platform.hpp"
 
+#include <cstddef>
 #include <cstdint>
 
 #if FEA_WITH_TBB
@@ -53,6 +54,14 @@ struct default_grainsize<true> {
 */
 
 namespace fea {
+// The cache line size used to pad shared data and avoid false sharing.
+// std::hardware_destructive_interference_size isn't reliably available.
+#if FEA_MACOS && FEA_ARM
+inline constexpr size_t cache_line_size = 128u;
+#else
+inline constexpr size_t cache_line_size = 64u;
+#endif
+
 #if FEA_WITH_TBB
 template <bool Overridden>
 struct default_grainsize_small {
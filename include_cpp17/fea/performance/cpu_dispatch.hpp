@@ -0,0 +1,194 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/utility/platform.hpp"
+#if FEA_X86
+#include "fea/performance/cpu_info_t.hpp"
+#endif
+
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <type_traits>
+
+/*
+Runtime instruction set dispatch.
+
+Kernels are compiled for each isa level in the same binary, whatever the
+translation unit's -m or /arch flags. On gcc and clang, annotate kernels
+with FEA_TARGET_SSE42, FEA_TARGET_AVX2 or FEA_TARGET_AVX512, msvc emits any
+intrinsic without annotations. Wrap kernels in '#if FEA_DISPATCH'.
+
+A dispatch_table holds one kernel per level and picks the best one the cpu
+and os support. Resolve it once, in a function local static for example,
+and call through the function pointer after that.
+
+FEA_DISPATCH is 0 on non-x86 platforms, unsupported compilers or when
+FEA_NO_SIMD_DEF is defined. Only scalar kernels are used then.
+*/
+
+#undef FEA_DISPATCH
+#define FEA_DISPATCH 0
+
+#undef FEA_TARGET_SSE42
+#undef FEA_TARGET_AVX2
+#undef FEA_TARGET_AVX512
+#define FEA_TARGET_SSE42
+#define FEA_TARGET_AVX2
+#define FEA_TARGET_AVX512
+
+#if FEA_X86 && !defined(FEA_NO_SIMD_DEF)
+#if FEA_GCC || FEA_CLANG
+#undef FEA_DISPATCH
+#define FEA_DISPATCH 1
+
+#undef FEA_TARGET_SSE42
+#undef FEA_TARGET_AVX2
+#undef FEA_TARGET_AVX512
+#define FEA_TARGET_SSE42 __attribute__((target("sse4.2,popcnt")))
+#define FEA_TARGET_AVX2 __attribute__((target("avx2,bmi,bmi2,popcnt,fma")))
+#define FEA_TARGET_AVX512 \
+	__attribute__((target( \
+			"avx512f,avx512bw,avx512dq,avx512vl,avx2,bmi,bmi2,popcnt,fma")))
+#elif FEA_MSVC
+#undef FEA_DISPATCH
+#define FEA_DISPATCH 1
+#endif
+#endif
+
+// Declares every intrinsic, usable in annotated functions.
+#if FEA_DISPATCH
+#include <immintrin.h>
+#endif
+
+namespace fea {
+// Instruction set levels, each implies the previous ones.
+// avx2 also implies bmi1, bmi2 and fma.
+// avx512 is the skylake-x subset, f, bw, dq and vl.
+enum class isa : uint8_t {
+	scalar,
+	sse42,
+	avx2,
+	avx512,
+	count,
+};
+
+// The best isa level supported by the running cpu and os.
+// Computed once.
+[[nodiscard]]
+inline isa detected_isa();
+
+// The name of an isa level.
+[[nodiscard]]
+inline const char* to_string(isa level);
+
+// A kernel per isa level. Fn must be a function pointer.
+// Unimplemented levels are nullptr and fall back to the level below.
+// The scalar kernel is required.
+template <class Fn>
+struct dispatch_table {
+	static_assert(std::is_pointer_v<Fn>
+					&& std::is_function_v<std::remove_pointer_t<Fn>>,
+			"dispatch_table : Fn must be a function pointer");
+
+	// The best kernel at or below level.
+	[[nodiscard]]
+	constexpr Fn get(isa level) const;
+
+	// The best kernel for this machine.
+	[[nodiscard]]
+	Fn resolve() const;
+
+	// Indexed by isa.
+	std::array<Fn, size_t(isa::count)> kernels{};
+};
+} // namespace fea
+
+
+/**
+ * Implementation
+ */
+namespace fea {
+namespace detail {
+inline isa compute_isa() {
+#if FEA_X86
+	const cpu_info_t& info = fea::get_cpu_info();
+	if (!info.sse42() || !info.popcnt()) {
+		return isa::scalar;
+	}
+	if (!info.avx2() || !info.bmi1() || !info.bmi2() || !info.fma()
+			|| !info.os_avx()) {
+		return isa::sse42;
+	}
+	if (!info.avx512_f() || !info.avx512_bw() || !info.avx512_dq()
+			|| !info.avx512_vl() || !info.os_avx512()) {
+		return isa::avx2;
+	}
+	return isa::avx512;
+#else
+	return isa::scalar;
+#endif
+}
+} // namespace detail
+
+isa detected_isa() {
+	static const isa ret = detail::compute_isa();
+	return ret;
+}
+
+const char* to_string(isa level) {
+	constexpr std::array<const char*, size_t(isa::count)> names{
+		"scalar",
+		"sse4.2",
+		"avx2",
+		"avx-512",
+	};
+	return level < isa::count ? names[size_t(level)] : "";
+}
+
+template <class Fn>
+constexpr Fn dispatch_table<Fn>::get(isa level) const {
+	size_t i = std::min(size_t(level), kernels.size() - 1);
+	for (; i > 0; --i) {
+		if (kernels[i] != nullptr) {
+			return kernels[i];
+		}
+	}
+	return kernels[0];
+}
+
+template <class Fn>
+Fn dispatch_table<Fn>::resolve() const {
+	return get(detected_isa());
+}
+} // namespace fea
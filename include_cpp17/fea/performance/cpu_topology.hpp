@@ -0,0 +1,567 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/performance/constants.hpp"
+#include "fea/utility/platform.hpp"
+#if FEA_X86
+#include "fea/performance/cpu_info_t.hpp"
+#endif
+
+#if FEA_MACOS
+#include <sys/sysctl.h>
+#include <sys/types.h>
+#endif
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+Cache and core topology of the machine.
+
+On x86, caches and cores are read from cpuid leaves 4 (0x8000001D on amd),
+0xB and 0x1F. On linux, /sys fills in what cpuid couldn't provide, and is
+preferred for core counts since it accounts for offline and hybrid cores.
+macOS uses sysctl. Unknown values fall back to conservative defaults, one
+core, one numa node and fea::cache_line_size.
+
+Query fea::cpu_topology(), which is computed once on first use.
+*/
+
+namespace fea {
+enum class cache_type : uint8_t {
+	data,
+	instruction,
+	unified,
+	count,
+};
+
+// A cache of the first core.
+struct cache_desc {
+	// 1 for L1, 2 for L2, etc.
+	uint8_t level = 0;
+	cache_type type = cache_type::unified;
+
+	// In bytes.
+	size_t size = 0;
+	size_t line_size = 0;
+
+	// Associativity, 0 if unknown.
+	size_t ways = 0;
+
+	// The number of logical cores sharing this cache, 0 if unknown.
+	size_t shared_by = 0;
+};
+
+struct cpu_topology_t {
+	// Detects the topology, prefer fea::cpu_topology().
+	inline cpu_topology_t();
+
+	// Online logical processors (hardware threads).
+	[[nodiscard]]
+	inline size_t logical_cores() const;
+
+	// Physical cores.
+	[[nodiscard]]
+	inline size_t physical_cores() const;
+
+	// Logical cores per physical core, rounded up.
+	[[nodiscard]]
+	inline size_t threads_per_core() const;
+
+	// Sockets.
+	[[nodiscard]]
+	inline size_t packages() const;
+
+	// Numa nodes, at least 1.
+	[[nodiscard]]
+	inline size_t numa_nodes() const;
+
+	// The logical core ids of a numa node.
+	[[nodiscard]]
+	inline const std::vector<size_t>& numa_node_cpus(size_t node) const;
+
+	// The caches of the first core, sorted by level.
+	[[nodiscard]]
+	inline const std::vector<cache_desc>& caches() const;
+
+	// Returns the first data or unified cache of level, nullptr if unknown.
+	[[nodiscard]]
+	inline const cache_desc* find_cache(uint8_t level) const;
+
+	// Cache sizes in bytes, 0 if unknown.
+	[[nodiscard]]
+	inline size_t l1d_size() const;
+	[[nodiscard]]
+	inline size_t l1i_size() const;
+	[[nodiscard]]
+	inline size_t l2_size() const;
+	[[nodiscard]]
+	inline size_t l3_size() const;
+
+	// The L1 data cache line size.
+	[[nodiscard]]
+	inline size_t cache_line_size() const;
+
+	// Prints the topology to stdout.
+	inline void print() const;
+
+private:
+	inline void detect_cpuid();
+	inline void detect_os();
+
+	size_t _logical_cores = 0;
+	size_t _physical_cores = 0;
+	size_t _packages = 0;
+	std::vector<std::vector<size_t>> _numa_cpus;
+	std::vector<cache_desc> _caches;
+};
+
+// The machine topology, computed once.
+[[nodiscard]]
+inline const cpu_topology_t& cpu_topology();
+
+// The number of physical cores.
+// Memory bound work rarely benefits from hyper-threads.
+[[nodiscard]]
+inline size_t num_physical_threads();
+} // namespace fea
+
+
+/**
+ * Implementation
+ */
+namespace fea {
+namespace detail {
+// Parses linux cpu lists, "0-3,8,10-11".
+inline std::vector<size_t> parse_cpu_list(const std::string& str) {
+	std::vector<size_t> ret;
+	const char* ptr = str.c_str();
+	while (*ptr != '\0') {
+		char* end = nullptr;
+		size_t first = size_t(std::strtoul(ptr, &end, 10));
+		if (end == ptr) {
+			break;
+		}
+		size_t last = first;
+		ptr = end;
+		if (*ptr == '-') {
+			++ptr;
+			last = size_t(std::strtoul(ptr, &end, 10));
+			if (end == ptr || last < first) {
+				break;
+			}
+			ptr = end;
+		}
+		for (size_t i = first; i <= last; ++i) {
+			ret.push_back(i);
+		}
+		if (*ptr != ',') {
+			break;
+		}
+		++ptr;
+	}
+	return ret;
+}
+
+// Parses linux sizes, "48K", "2048K", "32M".
+inline size_t parse_size(const std::string& str) {
+	char* end = nullptr;
+	size_t ret = size_t(std::strtoull(str.c_str(), &end, 10));
+	switch (*end) {
+	case 'K': {
+		return ret * 1024u;
+	} break;
+	case 'M': {
+		return ret * 1024u * 1024u;
+	} break;
+	case 'G': {
+		return ret * 1024u * 1024u * 1024u;
+	} break;
+	default: {
+	} break;
+	}
+	return ret;
+}
+
+#if FEA_LINUX
+// Reads a small /sys file, empty on failure.
+inline std::string read_sys_file(const std::string& path) {
+	std::FILE* file = std::fopen(path.c_str(), "r");
+	if (file == nullptr) {
+		return {};
+	}
+
+	std::string ret(256, '\0');
+	size_t read = std::fread(ret.data(), 1, ret.size(), file);
+	std::fclose(file);
+	ret.resize(read);
+	while (!ret.empty() && (ret.back() == '\n' || ret.back() == ' ')) {
+		ret.pop_back();
+	}
+	return ret;
+}
+#endif
+
+#if FEA_X86
+// Extracts count bits starting at first.
+inline size_t cpuid_bits(const std::bitset<32>& b, size_t first, size_t count) {
+	return size_t((b.to_ulong() >> first) & ((1ul << count) - 1ul));
+}
+#endif
+} // namespace detail
+
+cpu_topology_t::cpu_topology_t() {
+#if FEA_X86
+	detect_cpuid();
+#endif
+	detect_os();
+
+	// Defaults.
+	if (_logical_cores == 0) {
+		_logical_cores = (std::max)(
+				size_t(std::thread::hardware_concurrency()), size_t(1));
+	}
+	if (_physical_cores == 0 || _physical_cores > _logical_cores) {
+		_physical_cores = _logical_cores;
+	}
+	if (_packages == 0 || _packages > _physical_cores) {
+		_packages = 1;
+	}
+	if (_numa_cpus.empty()) {
+		_numa_cpus.emplace_back();
+		for (size_t i = 0; i < _logical_cores; ++i) {
+			_numa_cpus.back().push_back(i);
+		}
+	}
+
+	std::stable_sort(_caches.begin(), _caches.end(),
+			[](const cache_desc& lhs, const cache_desc& rhs) {
+				return lhs.level < rhs.level;
+			});
+}
+
+size_t cpu_topology_t::logical_cores() const {
+	return _logical_cores;
+}
+
+size_t cpu_topology_t::physical_cores() const {
+	return _physical_cores;
+}
+
+size_t cpu_topology_t::threads_per_core() const {
+	return (_logical_cores + _physical_cores - 1) / _physical_cores;
+}
+
+size_t cpu_topology_t::packages() const {
+	return _packages;
+}
+
+size_t cpu_topology_t::numa_nodes() const {
+	return _numa_cpus.size();
+}
+
+const std::vector<size_t>& cpu_topology_t::numa_node_cpus(size_t node) const {
+	return _numa_cpus.at(node);
+}
+
+const std::vector<cache_desc>& cpu_topology_t::caches() const {
+	return _caches;
+}
+
+const cache_desc* cpu_topology_t::find_cache(uint8_t level) const {
+	for (const cache_desc& c : _caches) {
+		if (c.level == level && c.type != cache_type::instruction) {
+			return &c;
+		}
+	}
+	return nullptr;
+}
+
+size_t cpu_topology_t::l1d_size() const {
+	const cache_desc* c = find_cache(1);
+	return c != nullptr ? c->size : 0;
+}
+
+size_t cpu_topology_t::l1i_size() const {
+	for (const cache_desc& c : _caches) {
+		if (c.level == 1 && c.type == cache_type::instruction) {
+			return c.size;
+		}
+	}
+	return 0;
+}
+
+size_t cpu_topology_t::l2_size() const {
+	const cache_desc* c = find_cache(2);
+	return c != nullptr ? c->size : 0;
+}
+
+size_t cpu_topology_t::l3_size() const {
+	const cache_desc* c = find_cache(3);
+	return c != nullptr ? c->size : 0;
+}
+
+size_t cpu_topology_t::cache_line_size() const {
+	const cache_desc* c = find_cache(1);
+	if (c == nullptr || c->line_size == 0) {
+		return fea::cache_line_size;
+	}
+	return c->line_size;
+}
+
+void cpu_topology_t::print() const {
+	printf("%-18s%zu\n", "logical_cores", logical_cores());
+	printf("%-18s%zu\n", "physical_cores", physical_cores());
+	printf("%-18s%zu\n", "threads_per_core", threads_per_core());
+	printf("%-18s%zu\n", "packages", packages());
+	printf("%-18s%zu\n", "numa_nodes", numa_nodes());
+	printf("%-18s%zu\n", "cache_line_size", cache_line_size());
+	printf("\n");
+
+	constexpr const char* type_names[] = { "data", "instruction", "unified" };
+	for (const cache_desc& c : _caches) {
+		printf("L%u %-12s%8zu KiB, %zu B lines, %zu ways, shared by %zu\n",
+				unsigned(c.level), type_names[size_t(c.type)], c.size / 1024u,
+				c.line_size, c.ways, c.shared_by);
+	}
+}
+
+void cpu_topology_t::detect_cpuid() {
+#if FEA_X86
+	using detail::cpuid_bits;
+
+	cpu_id leaf0{ 0 };
+	const uint32_t highest_leaf = uint32_t(leaf0.eax.to_ulong());
+	const uint32_t highest_ext = uint32_t(cpu_id{ 0x80000000 }.eax.to_ulong());
+	// "Genu" and "Auth", the start of GenuineIntel and AuthenticAMD.
+	const bool is_intel = leaf0.ebx.to_ulong() == 0x756e6547ul;
+	const bool is_amd = leaf0.ebx.to_ulong() == 0x68747541ul;
+
+	// Deterministic cache parameters.
+	uint32_t cache_leaf = 0;
+	if (is_intel && highest_leaf >= 4) {
+		cache_leaf = 4;
+	} else if (is_amd && highest_ext >= 0x8000001D
+			&& cpu_id{ 0x80000001 }.ecx[22]) {
+		// Topology extensions.
+		cache_leaf = 0x8000001D;
+	}
+
+	if (cache_leaf != 0) {
+		for (uint32_t sub = 0; sub < 32; ++sub) {
+			cpu_id id{ cache_leaf, sub };
+			size_t type = cpuid_bits(id.eax, 0, 5);
+			if (type == 0) {
+				break;
+			}
+
+			cache_desc c;
+			c.level = uint8_t(cpuid_bits(id.eax, 5, 3));
+			if (type == 1) {
+				c.type = cache_type::data;
+			} else if (type == 2) {
+				c.type = cache_type::instruction;
+			}
+			c.line_size = cpuid_bits(id.ebx, 0, 12) + 1;
+			size_t partitions = cpuid_bits(id.ebx, 12, 10) + 1;
+			c.ways = cpuid_bits(id.ebx, 22, 10) + 1;
+			size_t sets = size_t(id.ecx.to_ulong()) + 1;
+			c.size = c.ways * partitions * c.line_size * sets;
+			c.shared_by = cpuid_bits(id.eax, 14, 12) + 1;
+			_caches.push_back(c);
+		}
+	}
+
+	// Extended topology, prefer v2 (0x1F) which also describes dies.
+	uint32_t topo_leaf = 0;
+	if (highest_leaf >= 0x1F && cpu_id{ 0x1F }.ebx.to_ulong() != 0) {
+		topo_leaf = 0x1F;
+	} else if (highest_leaf >= 0xB && cpu_id{ 0xB }.ebx.to_ulong() != 0) {
+		topo_leaf = 0xB;
+	}
+
+	if (topo_leaf != 0) {
+		size_t smt_count = 0;
+		size_t package_count = 0;
+		for (uint32_t sub = 0; sub < 8; ++sub) {
+			cpu_id id{ topo_leaf, sub };
+			size_t level_type = cpuid_bits(id.ecx, 8, 8);
+			if (level_type == 0) {
+				break;
+			}
+
+			// Logical processors at this level, the last is the package.
+			size_t count = cpuid_bits(id.ebx, 0, 16);
+			if (level_type == 1) {
+				smt_count = count;
+			}
+			package_count = count;
+		}
+
+		_logical_cores = (std::max)(
+				size_t(std::thread::hardware_concurrency()), size_t(1));
+		if (smt_count != 0) {
+			_physical_cores = (std::max)(_logical_cores / smt_count, size_t(1));
+		}
+		if (package_count != 0) {
+			_packages = (_logical_cores + package_count - 1) / package_count;
+		}
+	}
+#endif
+}
+
+void cpu_topology_t::detect_os() {
+#if FEA_LINUX
+	using detail::read_sys_file;
+	const std::string cpu_dir = "/sys/devices/system/cpu/";
+
+	std::vector<size_t> cpus
+			= detail::parse_cpu_list(read_sys_file(cpu_dir + "online"));
+	if (!cpus.empty()) {
+		_logical_cores = cpus.size();
+
+		// Unique cores and packages.
+		std::vector<std::pair<std::string, std::string>> cores;
+		std::vector<std::string> packages;
+		for (size_t cpu : cpus) {
+			std::string dir = cpu_dir + "cpu" + std::to_string(cpu);
+			std::string package
+					= read_sys_file(dir + "/topology/physical_package_id");
+			std::string core = read_sys_file(dir + "/topology/core_id");
+			if (package.empty() || core.empty()) {
+				cores.clear();
+				break;
+			}
+			cores.push_back({ package, core });
+			packages.push_back(package);
+		}
+
+		if (!cores.empty()) {
+			std::sort(cores.begin(), cores.end());
+			std::sort(packages.begin(), packages.end());
+			_physical_cores = size_t(std::distance(cores.begin(),
+					std::unique(cores.begin(), cores.end())));
+			_packages = size_t(std::distance(packages.begin(),
+					std::unique(packages.begin(), packages.end())));
+		}
+	}
+
+	if (_caches.empty() && !cpus.empty()) {
+		std::string dir = cpu_dir + "cpu" + std::to_string(cpus.front())
+				+ "/cache/index";
+		for (size_t idx = 0; idx < 32; ++idx) {
+			std::string index_dir = dir + std::to_string(idx) + "/";
+			std::string level = read_sys_file(index_dir + "level");
+			if (level.empty()) {
+				break;
+			}
+
+			cache_desc c;
+			c.level = uint8_t(std::strtoul(level.c_str(), nullptr, 10));
+			std::string type = read_sys_file(index_dir + "type");
+			if (type == "Data") {
+				c.type = cache_type::data;
+			} else if (type == "Instruction") {
+				c.type = cache_type::instruction;
+			}
+			c.size = detail::parse_size(read_sys_file(index_dir + "size"));
+			c.line_size = detail::parse_size(
+					read_sys_file(index_dir + "coherency_line_size"));
+			c.ways = detail::parse_size(
+					read_sys_file(index_dir + "ways_of_associativity"));
+			std::string shared = read_sys_file(index_dir + "shared_cpu_list");
+			c.shared_by = detail::parse_cpu_list(shared).size();
+			_caches.push_back(c);
+		}
+	}
+
+	const std::string node_dir = "/sys/devices/system/node/";
+	std::vector<size_t> nodes
+			= detail::parse_cpu_list(read_sys_file(node_dir + "online"));
+	for (size_t node : nodes) {
+		std::vector<size_t> node_cpus = detail::parse_cpu_list(read_sys_file(
+				node_dir + "node" + std::to_string(node) + "/cpulist"));
+		// Memory only nodes.
+		if (!node_cpus.empty()) {
+			_numa_cpus.push_back(std::move(node_cpus));
+		}
+	}
+
+#elif FEA_MACOS
+	auto get = [](const char* name) {
+		int64_t ret = 0;
+		size_t size = sizeof(ret);
+		if (sysctlbyname(name, &ret, &size, nullptr, 0) != 0) {
+			return size_t(0);
+		}
+		return size_t(ret);
+	};
+
+	if (size_t logical = get("hw.logicalcpu")) {
+		_logical_cores = logical;
+		_physical_cores = get("hw.physicalcpu");
+		_packages = get("hw.packages");
+	}
+
+	if (_caches.empty()) {
+		size_t line_size = get("hw.cachelinesize");
+		auto push = [&](uint8_t level, cache_type type, const char* name) {
+			if (size_t size = get(name)) {
+				_caches.push_back({ level, type, size, line_size, 0, 0 });
+			}
+		};
+		push(1, cache_type::data, "hw.l1dcachesize");
+		push(1, cache_type::instruction, "hw.l1icachesize");
+		push(2, cache_type::unified, "hw.l2cachesize");
+		push(3, cache_type::unified, "hw.l3cachesize");
+	}
+#endif
+}
+
+const cpu_topology_t& cpu_topology() {
+	static const cpu_topology_t ret;
+	return ret;
+}
+
+size_t num_physical_threads() {
+	return cpu_topology().physical_cores();
+}
+} // namespace fea
@@ -0,0 +1,432 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/performance/constants.hpp"
+#include "fea/performance/profile_zone.hpp"
+#include "fea/utility/file.hpp"
+#include "fea/utility/platform.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#if FEA_X86
+#if FEA_WINDOWS
+#include <intrin.h>
+#else
+#include <x86intrin.h>
+#endif
+#endif
+
+/*
+Scoped profiling zones, for instrumenting hot paths.
+
+FEA_PROFILE_ZONE("name") records the begin and end timestamps of the
+enclosing scope. Zones are written to a per-thread ring buffer, without
+locks or allocations. Once full, the oldest zones are overwritten.
+Collect zones or export them as Chrome trace-event json from any thread.
+Open the trace in chrome://tracing or https://ui.perfetto.dev.
+
+Zones compile to nothing unless FEA_PROFILE_DEF is defined (cmake option
+FEA_PROFILE). Define it for the whole program, mixing instrumented and
+uninstrumented translation units breaks the one definition rule. The
+types and export functions are always available.
+
+Instrumented library headers include fea/performance/profile_zone.hpp, which
+only pulls in this header when profiling is enabled.
+
+A thread's buffer is allocated by its first zone. When the thread exits,
+the buffer is freed once its zones have been cleared. Zones recorded by
+thread_local destructors which run after that get a buffer which is never
+freed.
+
+Timestamps use rdtsc on x86 and steady_clock elsewhere. Ticks are
+converted to nanoseconds against steady_clock when collecting.
+
+Zone names must outlive the profiler, use string literals.
+*/
+
+namespace fea {
+namespace profile {
+namespace detail {
+struct thread_buffer;
+}
+
+// Number of zones kept per thread, for threads recording after this call.
+// Rounded up to a power of 2. Defaults to 65536.
+inline void buffer_capacity(size_t capacity);
+
+// Names the calling thread in exported traces.
+inline void thread_name(const std::string& name);
+
+// A collected zone. Times are in nanoseconds since the profiler started.
+struct zone_record {
+	const char* name = nullptr;
+	uint32_t thread_id = 0;
+	double begin = 0.0;
+	double end = 0.0;
+};
+
+// Copies recorded zones of all threads, in thread, then begin order.
+// Can be called while other threads record.
+[[nodiscard]]
+inline std::vector<zone_record> collect();
+
+// Drops recorded zones of all threads.
+// Frees the buffers of exited threads.
+inline void clear();
+
+// Writes recorded zones as Chrome trace-event json.
+// Returns false on failure.
+inline bool write_chrome_trace(const std::filesystem::path& path);
+
+// Writes recorded zones as Chrome trace-event json.
+inline void write_chrome_trace(std::FILE* stream);
+
+// Records the lifetime of this object. Prefer FEA_PROFILE_ZONE.
+// The first zone of a thread allocates its buffer, which may throw.
+struct zone {
+	inline explicit zone(const char* name);
+	inline ~zone();
+
+	zone(const zone&) = delete;
+	zone(zone&&) = delete;
+	zone& operator=(const zone&) = delete;
+	zone& operator=(zone&&) = delete;
+
+private:
+	const char* _name;
+	detail::thread_buffer* _buffer;
+	uint64_t _begin;
+};
+} // namespace profile
+} // namespace fea
+
+
+/**
+ * Implementation
+ */
+namespace fea {
+namespace profile {
+namespace detail {
+[[nodiscard]]
+inline uint64_t ticks() noexcept {
+#if FEA_X86
+	return uint64_t(__rdtsc());
+#else
+	return uint64_t(
+			std::chrono::steady_clock::now().time_since_epoch().count());
+#endif
+}
+
+// Written by the owning thread, read concurrently by collectors.
+struct event {
+	std::atomic<const char*> name{ nullptr };
+	std::atomic<uint64_t> begin{ 0 };
+	std::atomic<uint64_t> end{ 0 };
+};
+
+// Single producer ring buffer.
+struct thread_buffer {
+	thread_buffer(size_t capacity, uint32_t id)
+			: events(capacity)
+			, mask(capacity - 1)
+			, thread_id(id) {
+	}
+
+	void push(const char* name, uint64_t begin, uint64_t end) noexcept {
+		uint64_t h = head.load(std::memory_order_relaxed);
+		event& e = events[size_t(h) & mask];
+
+		// Release, so collectors that see this overwrite also see the
+		// previous head. Plain stores on x86.
+		e.name.store(name, std::memory_order_release);
+		e.begin.store(begin, std::memory_order_release);
+		e.end.store(end, std::memory_order_release);
+		head.store(h + 1, std::memory_order_release);
+	}
+
+	std::vector<event> events;
+	size_t mask;
+	alignas(fea::cache_line_size) std::atomic<uint64_t> head{ 0 };
+
+	// Collector side, guarded by the registry mutex.
+	alignas(fea::cache_line_size) uint64_t tail = 0;
+	uint32_t thread_id;
+	std::string name;
+
+	// The owning thread exited, freed by the next clear.
+	bool exited = false;
+};
+
+struct registry {
+	std::mutex mutex;
+	std::vector<std::unique_ptr<thread_buffer>> buffers;
+	size_t capacity = size_t(1) << 16;
+	uint32_t next_thread_id = 0;
+	const uint64_t start_ticks = ticks();
+	const std::chrono::steady_clock::time_point start_time
+			= std::chrono::steady_clock::now();
+};
+
+inline registry& get_registry() {
+	static registry ret;
+	return ret;
+}
+
+// Constant initialized, avoids the thread_local guard on every access.
+inline thread_local thread_buffer* tls_buffer = nullptr;
+
+// Set once this thread's buffer was released.
+inline thread_local bool tls_exited = false;
+
+// Frees the buffer if nothing is left to collect, else flags it for the
+// next clear.
+inline void release_thread(thread_buffer* buf) {
+	registry& reg = get_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	if (buf->tail != buf->head.load(std::memory_order_acquire)) {
+		buf->exited = true;
+		return;
+	}
+
+	auto it = std::find_if(reg.buffers.begin(), reg.buffers.end(),
+			[&](const std::unique_ptr<thread_buffer>& b) {
+				return b.get() == buf;
+			});
+	assert(it != reg.buffers.end());
+	reg.buffers.erase(it);
+}
+
+// Releases the thread's buffer on thread exit.
+struct thread_reaper {
+	~thread_reaper() {
+		tls_exited = true;
+		if (tls_buffer != nullptr) {
+			release_thread(tls_buffer);
+			tls_buffer = nullptr;
+		}
+	}
+};
+
+inline thread_buffer* register_thread() {
+	thread_buffer* ret = nullptr;
+	{
+		registry& reg = get_registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+		reg.buffers.push_back(std::make_unique<thread_buffer>(
+				reg.capacity, reg.next_thread_id++));
+		ret = reg.buffers.back().get();
+
+		// If the reaper already ran, zones are recorded by other
+		// thread_local destructors. Nothing tells when the thread stops
+		// writing, so the buffer is never flagged and lives as long as the
+		// registry.
+	}
+
+	if (!tls_exited) {
+		thread_local thread_reaper reaper;
+	}
+	return ret;
+}
+
+inline thread_buffer& this_thread_buffer() {
+	if (tls_buffer == nullptr) {
+		tls_buffer = register_thread();
+	}
+	return *tls_buffer;
+}
+
+inline void write_string(std::FILE* stream, const char* str) {
+	std::fputc('"', stream);
+	for (; *str != '\0'; ++str) {
+		char c = *str;
+		if (c == '"' || c == '\\') {
+			std::fputc('\\', stream);
+			std::fputc(c, stream);
+		} else if (static_cast<unsigned char>(c) < 0x20) {
+			std::fprintf(stream, "\\u%04x", unsigned(c));
+		} else {
+			std::fputc(c, stream);
+		}
+	}
+	std::fputc('"', stream);
+}
+} // namespace detail
+
+void buffer_capacity(size_t capacity) {
+	size_t pow2 = 1;
+	while (pow2 < capacity) {
+		pow2 <<= 1;
+	}
+
+	detail::registry& reg = detail::get_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	reg.capacity = pow2;
+}
+
+void thread_name(const std::string& name) {
+	detail::thread_buffer& buf = detail::this_thread_buffer();
+	std::lock_guard<std::mutex> lock(detail::get_registry().mutex);
+	buf.name = name;
+}
+
+std::vector<zone_record> collect() {
+	detail::registry& reg = detail::get_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+
+	// Ticks to nanoseconds, measured over the profiler lifetime.
+	const uint64_t now_ticks = detail::ticks();
+	const std::chrono::duration<double, std::nano> elapsed
+			= std::chrono::steady_clock::now() - reg.start_time;
+	double ns_per_tick = 1.0;
+	if (now_ticks > reg.start_ticks) {
+		ns_per_tick = elapsed.count() / double(now_ticks - reg.start_ticks);
+	}
+	auto to_ns = [&](uint64_t t) {
+		return double(int64_t(t - reg.start_ticks)) * ns_per_tick;
+	};
+
+	std::vector<zone_record> ret;
+	for (const std::unique_ptr<detail::thread_buffer>& buf_ptr : reg.buffers) {
+		detail::thread_buffer& buf = *buf_ptr;
+		const uint64_t capacity = buf.events.size();
+		const size_t first_idx = ret.size();
+
+		uint64_t h = buf.head.load(std::memory_order_acquire);
+		uint64_t first = (std::max)(buf.tail, h > capacity ? h - capacity : 0);
+		for (uint64_t i = first; i < h; ++i) {
+			const detail::event& e = buf.events[size_t(i) & buf.mask];
+			// Acquire, so the head check below happens after.
+			ret.push_back(zone_record{
+					e.name.load(std::memory_order_acquire),
+					buf.thread_id,
+					to_ns(e.begin.load(std::memory_order_acquire)),
+					to_ns(e.end.load(std::memory_order_acquire)),
+			});
+		}
+
+		// Drop zones overwritten while copying, including one in flight.
+		uint64_t h2 = buf.head.load(std::memory_order_relaxed);
+		if (h2 + 1 > first + capacity) {
+			size_t num_torn = size_t(
+					(std::min)(h2 + 1 - capacity - first, h - first));
+			ret.erase(ret.begin() + first_idx,
+					ret.begin() + first_idx + num_torn);
+		}
+
+		std::sort(ret.begin() + first_idx, ret.end(),
+				[](const zone_record& lhs, const zone_record& rhs) {
+					return lhs.begin < rhs.begin;
+				});
+	}
+	return ret;
+}
+
+void clear() {
+	detail::registry& reg = detail::get_registry();
+	std::lock_guard<std::mutex> lock(reg.mutex);
+	for (const std::unique_ptr<detail::thread_buffer>& buf : reg.buffers) {
+		buf->tail = buf->head.load(std::memory_order_acquire);
+	}
+
+	using buf_ptr = std::unique_ptr<detail::thread_buffer>;
+	reg.buffers.erase(std::remove_if(reg.buffers.begin(), reg.buffers.end(),
+							  [](const buf_ptr& b) { return b->exited; }),
+			reg.buffers.end());
+}
+
+bool write_chrome_trace(const std::filesystem::path& path) {
+	std::FILE* f = fea::fopen(path, "wb");
+	if (f == nullptr) {
+		return false;
+	}
+	write_chrome_trace(f);
+	return std::fclose(f) == 0;
+}
+
+void write_chrome_trace(std::FILE* stream) {
+	std::vector<zone_record> zones = collect();
+
+	std::fprintf(stream, "{\n\"traceEvents\": [");
+	const char* sep = "\n";
+
+	{
+		detail::registry& reg = detail::get_registry();
+		std::lock_guard<std::mutex> lock(reg.mutex);
+		for (const std::unique_ptr<detail::thread_buffer>& buf : reg.buffers) {
+			if (buf->name.empty()) {
+				continue;
+			}
+			std::fprintf(stream,
+					"%s{ \"name\": \"thread_name\", \"ph\": \"M\", \"pid\": 0, "
+					"\"tid\": %u, \"args\": { \"name\": ",
+					sep, buf->thread_id);
+			detail::write_string(stream, buf->name.c_str());
+			std::fprintf(stream, " } }");
+			sep = ",\n";
+		}
+	}
+
+	// Complete events, in microseconds.
+	for (const zone_record& z : zones) {
+		std::fprintf(stream, "%s{ \"name\": ", sep);
+		detail::write_string(stream, z.name);
+		std::fprintf(stream,
+				", \"ph\": \"X\", \"pid\": 0, \"tid\": %u, \"ts\": %.3f, "
+				"\"dur\": %.3f }",
+				z.thread_id, z.begin / 1'000.0, (z.end - z.begin) / 1'000.0);
+		sep = ",\n";
+	}
+	std::fprintf(stream, "\n],\n\"displayTimeUnit\": \"ns\"\n}\n");
+}
+
+zone::zone(const char* name)
+		: _name(name)
+		, _buffer(&detail::this_thread_buffer())
+		, _begin(detail::ticks()) {
+}
+
+zone::~zone() {
+	_buffer->push(_name, _begin, detail::ticks());
+}
+} // namespace profile
+} // namespace fea
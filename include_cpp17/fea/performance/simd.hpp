@@ -0,0 +1,121 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+#include "fea/utility/platform.hpp"
+
+/*
+Compile-time instruction set detection.
+
+Each define is always set to 0 or 1, so use '#if FEA_AVX2' rather than
+'#ifdef'. These reflect what the compiler is allowed to emit for the current
+translation unit (for ex, -mavx2 or /arch:AVX2), not what the running cpu
+supports. Use fea::cpu_info for runtime queries.
+
+Define FEA_NO_SIMD_DEF to force the scalar fallbacks everywhere.
+*/
+
+#undef FEA_SSE2
+#undef FEA_SSSE3
+#undef FEA_SSE42
+#undef FEA_AVX2
+#undef FEA_AVX512
+#undef FEA_NEON
+#undef FEA_SIMD
+#define FEA_SSE2 0
+#define FEA_SSSE3 0
+#define FEA_SSE42 0
+#define FEA_AVX2 0
+#define FEA_AVX512 0
+#define FEA_NEON 0
+#define FEA_SIMD 0
+
+#if !defined(FEA_NO_SIMD_DEF)
+#if FEA_X86
+// MSVC doesn't define __SSE2__, but x64 always has it.
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) \
+		|| (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#undef FEA_SSE2
+#define FEA_SSE2 1
+#endif
+
+// MSVC only exposes /arch:AVX and up, which imply SSSE3 and SSE4.2.
+#if defined(__SSSE3__) || (FEA_MSVC && defined(__AVX__))
+#undef FEA_SSSE3
+#define FEA_SSSE3 1
+#endif
+
+#if defined(__SSE4_2__) || (FEA_MSVC && defined(__AVX__))
+#undef FEA_SSE42
+#define FEA_SSE42 1
+#endif
+
+#if defined(__AVX2__)
+#undef FEA_AVX2
+#define FEA_AVX2 1
+#endif
+
+#if defined(__AVX512F__) && defined(__AVX512BW__)
+#undef FEA_AVX512
+#define FEA_AVX512 1
+#endif
+#endif // FEA_X86
+
+#if FEA_ARM
+#if defined(__ARM_NEON) || defined(__ARM_NEON__) || defined(_M_ARM64)
+#undef FEA_NEON
+#define FEA_NEON 1
+#endif
+#endif // FEA_ARM
+#endif // !FEA_NO_SIMD_DEF
+
+#if FEA_SSE2 || FEA_NEON
+#undef FEA_SIMD
+#define FEA_SIMD 1
+#endif
+
+#if FEA_SSE2
+#include <emmintrin.h>
+#endif
+#if FEA_SSSE3
+#include <tmmintrin.h>
+#endif
+#if FEA_SSE42
+#include <nmmintrin.h>
+#endif
+#if FEA_AVX2 || FEA_AVX512
+#include <immintrin.h>
+#endif
+#if FEA_NEON
+#include <arm_neon.h>
+#endif
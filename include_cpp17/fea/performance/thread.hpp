@@ -33,8 +33,10 @@
 
 #pragma once
 #include "fea/memory/memory.hpp"
+#include "fea/performance/thread_pool.hpp"
 
 #include <algorithm>
+#include <atomic>
 #include <chrono>
 #include <functional>
 #include <mutex>
@@ -45,6 +47,7 @@
 #include <vector>
 
 // If you don't feel like linking to tbb.
+// Loops and tasks execute on the persistent fea::default_thread_pool().
 namespace fea {
 [[nodiscard]]
 inline size_t num_threads() {
@@ -52,6 +55,10 @@ inline size_t num_threads() {
 	return concurrency <= 0 ? 1 : concurrency;
 }
 
+// Chunked scheduling.
+// Splits the loop in num_threads() contiguous chunks. func receives the chunk
+// range [first, second) and the chunk index. The calling thread executes the
+// first chunk, and helps with the others.
 inline void parallel_for(size_t loop_count,
 		const std::function<void(const std::pair<size_t, size_t>&, size_t)>&
 				func) {
@@ -69,53 +76,57 @@ inline void parallel_for(size_t loop_count,
 		}
 	}
 
-	std::vector<std::thread> threads;
-	threads.reserve(num_t);
-	for (size_t i = 0; i < num_t; ++i) {
-		threads.emplace_back(func, index_ranges[i], i);
-	}
-
-	for (auto& t : threads) {
-		t.join();
+	fea::task_group g;
+	for (size_t i = 1; i < num_t; ++i) {
+		g.run([&, i]() { func(index_ranges[i], i); });
 	}
+	func(index_ranges[0], 0);
+	g.wait();
 }
 
-inline void parallel_tasks(std::vector<std::function<void()>>&& tasks) {
-	using namespace std::chrono_literals;
-	if (tasks.empty())
+// Dynamic scheduling.
+// Threads repeatedly grab grain_size iterations until the loop is done.
+// func receives the range [first, second) to execute.
+// Use this when iterations have uneven costs.
+inline void parallel_for(size_t loop_count, size_t grain_size,
+		const std::function<void(const std::pair<size_t, size_t>&)>& func) {
+	if (loop_count == 0) {
 		return;
-
-	size_t thread_count = std::min(num_threads(), tasks.size());
-	std::vector<std::thread> threads;
-	threads.reserve(thread_count);
-
-	for (size_t i = 0; i < thread_count; ++i) {
-		threads.emplace_back(std::move(tasks.back()));
-		tasks.pop_back();
 	}
+	grain_size = (std::max)(grain_size, size_t(1));
 
-	while (threads.size() > 0) {
-		std::this_thread::sleep_for(0.01s);
+	std::atomic<size_t> next{ 0 };
+	auto work = [&]() {
+		while (true) {
+			size_t first = next.fetch_add(grain_size, std::memory_order_relaxed);
+			if (first >= loop_count) {
+				return;
+			}
+			func({ first, (std::min)(first + grain_size, loop_count) });
+		}
+	};
 
-		for (size_t i = 0; i < threads.size(); ++i) {
-			if (!threads[i].joinable())
-				continue;
+	fea::task_group g;
+	const size_t num_grains = (loop_count + grain_size - 1) / grain_size;
+	const size_t num_tasks = (std::min)(g.pool().concurrency(), num_grains);
+	for (size_t i = 1; i < num_tasks; ++i) {
+		g.run(work);
+	}
+	work();
+	g.wait();
+}
 
-			threads[i].join();
+// Executes the tasks in parallel and waits for them.
+inline void parallel_tasks(std::vector<std::function<void()>>&& tasks) {
+	if (tasks.empty())
+		return;
 
-			if (tasks.size() > 0) {
-				threads[i] = std::thread{ std::move(tasks.back()) };
-				tasks.pop_back();
-			} else if (i == threads.size() - 1) {
-				// edge case: pop last
-				threads.pop_back();
-			} else {
-				// erase thread : swap & pop
-				threads[i] = std::move(threads.back());
-				threads.pop_back();
-			}
-		}
+	fea::task_group g;
+	for (std::function<void()>& t : tasks) {
+		g.run(std::move(t));
 	}
+	tasks.clear();
+	g.wait();
 }
 
 template <class T>
@@ -0,0 +1,416 @@
+﻿/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/performance/constants.hpp"
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+/*
+fea::thread_pool is a persistent work-stealing thread pool.
+
+Every worker owns a task deque. Workers push and pop their own tasks from the
+back (LIFO, cache friendly) and steal other workers' tasks from the front.
+Tasks submitted from outside the pool go to a shared injection queue.
+
+Tasks are submitted and waited on through a fea::task_group. Threads waiting
+on a task group execute queued tasks instead of blocking, so nested
+parallelism doesn't deadlock. A pool with 0 workers executes everything on
+the waiting thread.
+
+fea::parallel_for and fea::parallel_tasks (thread.hpp) use the
+default_thread_pool().
+*/
+
+namespace fea {
+struct task_group;
+
+struct thread_pool {
+	// Creates a pool with num_workers threads.
+	// The thread waiting on a task group helps, so the default creates
+	// hardware_concurrency - 1 workers.
+	inline explicit thread_pool(size_t num_workers);
+	inline thread_pool();
+
+	// Executes remaining tasks and joins the workers.
+	inline ~thread_pool();
+
+	thread_pool(const thread_pool&) = delete;
+	thread_pool(thread_pool&&) = delete;
+	thread_pool& operator=(const thread_pool&) = delete;
+	thread_pool& operator=(thread_pool&&) = delete;
+
+	// The number of worker threads.
+	[[nodiscard]]
+	inline size_t num_workers() const noexcept;
+
+	// The number of threads which execute tasks, workers + 1 waiting thread.
+	[[nodiscard]]
+	inline size_t concurrency() const noexcept;
+
+	// Returns true if the calling thread is one of this pool's workers.
+	[[nodiscard]]
+	inline bool is_worker() const noexcept;
+
+private:
+	friend struct task_group;
+
+	struct task {
+		std::function<void()> func;
+		task_group* group = nullptr;
+	};
+
+	struct alignas(fea::cache_line_size) task_queue {
+		std::mutex mutex;
+		std::deque<task> tasks;
+	};
+
+	// Pushes to the calling worker's queue, or the injection queue.
+	inline void push(task&& t);
+
+	// Pops from the calling thread's queue, the injection queue, or steals.
+	[[nodiscard]]
+	inline bool try_pop(task& t);
+
+	// Runs the task and notifies its group.
+	inline void execute(task& t);
+
+	inline void worker_loop(size_t worker_idx);
+
+	// The calling thread's queue index, or the injection queue index.
+	[[nodiscard]]
+	inline size_t queue_idx() const noexcept;
+
+	// Calling thread data.
+	struct thread_data {
+		const thread_pool* pool = nullptr;
+		size_t worker_idx = 0;
+	};
+	[[nodiscard]]
+	static thread_data& this_thread_data() noexcept {
+		thread_local thread_data data;
+		return data;
+	}
+
+	// One queue per worker, the last queue is the injection queue.
+	std::vector<std::unique_ptr<task_queue>> _queues;
+	std::vector<std::thread> _threads;
+
+	alignas(fea::cache_line_size) std::atomic<size_t> _num_queued{ 0 };
+	std::mutex _sleep_mutex;
+	std::condition_variable _sleep_cv;
+	// Wakes threads waiting on a task group, when a group is done or new
+	// tasks are queued.
+	std::condition_variable _group_cv;
+	bool _stop = false;
+};
+
+// The pool used by fea::parallel_for and fea::parallel_tasks.
+// Created on first use.
+[[nodiscard]]
+inline thread_pool& default_thread_pool() {
+	static thread_pool pool;
+	return pool;
+}
+
+// A group of tasks executed on a thread pool, which you may wait on.
+// Groups may be created and waited on from inside tasks.
+struct task_group {
+	inline explicit task_group(thread_pool& pool);
+	inline task_group();
+
+	// Waits on remaining tasks. Exceptions are lost, call wait() to get them.
+	inline ~task_group();
+
+	task_group(const task_group&) = delete;
+	task_group(task_group&&) = delete;
+	task_group& operator=(const task_group&) = delete;
+	task_group& operator=(task_group&&) = delete;
+
+	// Queues func for execution.
+	template <class Func>
+	void run(Func&& func);
+
+	// Executes tasks until all of this group's tasks are done.
+	// Rethrows the first exception thrown by a task, if any.
+	inline void wait();
+
+	// The pool executing tasks.
+	[[nodiscard]]
+	inline thread_pool& pool() const noexcept;
+
+private:
+	friend struct thread_pool;
+
+	// Helps executing tasks until the group is done. Doesn't throw.
+	inline void help_until_done() noexcept;
+
+	thread_pool* _pool;
+	std::atomic<size_t> _num_pending{ 0 };
+	std::mutex _exception_mutex;
+	std::exception_ptr _exception;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+thread_pool::thread_pool(size_t num_workers) {
+	_queues.reserve(num_workers + 1);
+	for (size_t i = 0; i < num_workers + 1; ++i) {
+		_queues.push_back(std::make_unique<task_queue>());
+	}
+
+	_threads.reserve(num_workers);
+	for (size_t i = 0; i < num_workers; ++i) {
+		_threads.emplace_back([this, i]() { worker_loop(i); });
+	}
+}
+
+thread_pool::thread_pool()
+		: thread_pool((std::max)(size_t(std::thread::hardware_concurrency()),
+								  size_t(1))
+				- 1) {
+}
+
+thread_pool::~thread_pool() {
+	{
+		std::lock_guard l{ _sleep_mutex };
+		_stop = true;
+	}
+	_sleep_cv.notify_all();
+
+	for (std::thread& t : _threads) {
+		t.join();
+	}
+
+	// Without workers, nobody executed the stragglers.
+	task t;
+	while (try_pop(t)) {
+		execute(t);
+	}
+}
+
+size_t thread_pool::num_workers() const noexcept {
+	return _threads.size();
+}
+
+size_t thread_pool::concurrency() const noexcept {
+	return _threads.size() + 1;
+}
+
+bool thread_pool::is_worker() const noexcept {
+	return this_thread_data().pool == this;
+}
+
+void thread_pool::push(task&& t) {
+	{
+		task_queue& q = *_queues[queue_idx()];
+		std::lock_guard l{ q.mutex };
+		q.tasks.push_back(std::move(t));
+	}
+	_num_queued.fetch_add(1, std::memory_order_release);
+
+	// Lock so a thread going to sleep can't miss the notification.
+	std::unique_lock l{ _sleep_mutex };
+	l.unlock();
+	if (!_threads.empty()) {
+		_sleep_cv.notify_one();
+	}
+	_group_cv.notify_all();
+}
+
+bool thread_pool::try_pop(task& t) {
+	if (_num_queued.load(std::memory_order_acquire) == 0) {
+		return false;
+	}
+
+	const size_t num_queues = _queues.size();
+	const size_t injection_idx = num_queues - 1;
+	const size_t own_idx = queue_idx();
+
+	// Own tasks first, newest first.
+	if (own_idx != injection_idx) {
+		task_queue& q = *_queues[own_idx];
+		std::lock_guard l{ q.mutex };
+		if (!q.tasks.empty()) {
+			t = std::move(q.tasks.back());
+			q.tasks.pop_back();
+			_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+
+	// Then the injection queue and other workers, oldest first.
+	for (size_t i = 0; i < num_queues; ++i) {
+		size_t idx = (injection_idx + i) % num_queues;
+		if (idx == own_idx && own_idx != injection_idx) {
+			continue;
+		}
+
+		task_queue& q = *_queues[idx];
+		std::lock_guard l{ q.mutex };
+		if (!q.tasks.empty()) {
+			t = std::move(q.tasks.front());
+			q.tasks.pop_front();
+			_num_queued.fetch_sub(1, std::memory_order_relaxed);
+			return true;
+		}
+	}
+	return false;
+}
+
+void thread_pool::execute(task& t) {
+	task_group* g = t.group;
+	try {
+		t.func();
+	} catch (...) {
+		std::lock_guard l{ g->_exception_mutex };
+		if (!g->_exception) {
+			g->_exception = std::current_exception();
+		}
+	}
+
+	// Release captures before notifying, the group may be destroyed
+	// right after.
+	t.func = nullptr;
+	if (g->_num_pending.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+		std::unique_lock l{ _sleep_mutex };
+		l.unlock();
+		_group_cv.notify_all();
+	}
+}
+
+void thread_pool::worker_loop(size_t worker_idx) {
+	thread_data& data = this_thread_data();
+	data.pool = this;
+	data.worker_idx = worker_idx;
+
+	while (true) {
+		task t;
+		if (try_pop(t)) {
+			execute(t);
+			continue;
+		}
+
+		std::unique_lock l{ _sleep_mutex };
+		_sleep_cv.wait(l, [this]() {
+			return _stop || _num_queued.load(std::memory_order_acquire) != 0;
+		});
+
+		if (_stop && _num_queued.load(std::memory_order_acquire) == 0) {
+			return;
+		}
+	}
+}
+
+size_t thread_pool::queue_idx() const noexcept {
+	const thread_data& data = this_thread_data();
+	if (data.pool == this) {
+		return data.worker_idx;
+	}
+	return _queues.size() - 1;
+}
+
+
+task_group::task_group(thread_pool& pool)
+		: _pool(&pool) {
+}
+
+task_group::task_group()
+		: task_group(fea::default_thread_pool()) {
+}
+
+task_group::~task_group() {
+	help_until_done();
+}
+
+template <class Func>
+void task_group::run(Func&& func) {
+	thread_pool::task t{ std::forward<Func>(func), this };
+
+	// Count the task before it can execute, but not if queueing it failed.
+	_num_pending.fetch_add(1, std::memory_order_relaxed);
+	try {
+		_pool->push(std::move(t));
+	} catch (...) {
+		_num_pending.fetch_sub(1, std::memory_order_relaxed);
+		throw;
+	}
+}
+
+void task_group::wait() {
+	help_until_done();
+
+	std::exception_ptr ex;
+	{
+		std::lock_guard l{ _exception_mutex };
+		std::swap(ex, _exception);
+	}
+	if (ex) {
+		std::rethrow_exception(ex);
+	}
+}
+
+thread_pool& task_group::pool() const noexcept {
+	return *_pool;
+}
+
+void task_group::help_until_done() noexcept {
+	while (_num_pending.load(std::memory_order_acquire) != 0) {
+		thread_pool::task t;
+		if (_pool->try_pop(t)) {
+			_pool->execute(t);
+			continue;
+		}
+
+		// Our remaining tasks are executing on other threads.
+		// Sleep until they are done, or new tasks need help.
+		std::unique_lock l{ _pool->_sleep_mutex };
+		_pool->_group_cv.wait(l, [this]() {
+			return _num_pending.load(std::memory_order_acquire) == 0
+				|| _pool->_num_queued.load(std::memory_order_acquire) != 0;
+		});
+	}
+}
+} // namespace fea
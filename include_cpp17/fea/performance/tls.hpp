@@ -33,8 +33,12 @@
 #pragma once
 #include "fea/containers/deque_list.hpp"
 #include "fea/meta/traits.hpp"
+#include "fea/performance/constants.hpp"
 #include "fea/utility/error.hpp"
 
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <cassert>
 #include <cstdint>
 #include <deque>
@@ -69,12 +73,28 @@ Unique Behavior
 - fea::tls does NOT destroy objects on thread destruction.
 - fea::tls is recursive, allowing storage to be used in
 	nested tbb calls.
+
+Modes
+- search : Default. Threads search the storage for their slot when locking.
+- cached : Threads remember their slot in a small thread_local cache, keyed
+	per tls instance. Once a thread has its slot, locking is lock free and
+	doesn't search. Recursive locks fall back to searching.
+- padded / cached_padded : Thread values are padded to a cache line,
+	so threads writing their values don't false-share.
 */
 
 namespace fea {
 using std_thread_id_t = decltype(std::this_thread::get_id());
 
-template <class T, class = std::allocator<T>>
+// How tls finds and stores thread values.
+enum class tls_mode : uint8_t {
+	search,
+	cached,
+	padded,
+	cached_padded,
+};
+
+template <class T, class = std::allocator<T>, tls_mode = tls_mode::search>
 struct tls;
 
 // A lock to thread data.
@@ -85,7 +105,8 @@ struct tls_lock {
 
 	// Create a lock for tls storage.
 	// std::lock_guard symmetry.
-	explicit tls_lock(tls<T, Alloc>& storage);
+	template <tls_mode Mode>
+	explicit tls_lock(tls<T, Alloc, Mode>& storage);
 
 	// Move lock ownership.
 	explicit tls_lock(tls_lock&& other) noexcept;
@@ -108,20 +129,53 @@ struct tls_lock {
 	T& local() &;
 
 private:
-	template <class, class>
+	template <class, class, tls_mode>
 	friend struct tls;
 
 	// Creates a lock, used internally.
 	tls_lock(std_thread_id_t tid, size_type data_idx, T& value,
-			tls<T, Alloc>& storage) noexcept;
+			bool& locked) noexcept;
 
 	std_thread_id_t _tid = (std::numeric_limits<std_thread_id_t>::max)();
 	size_type _idx = (std::numeric_limits<size_type>::max)();
 	T& _value;
-	tls<T, Alloc>& _storage;
+	bool* _locked = nullptr;
+};
+
+namespace detail {
+// Pads a value to its own cache line.
+template <class T>
+struct alignas(fea::cache_line_size) tls_padded {
+	T value{};
+};
+
+// A thread's slot in a cached tls.
+struct tls_cache_entry {
+	uint64_t uid = 0;
+	size_t idx = 0;
+	void* value = nullptr;
+	bool* locked = nullptr;
 };
 
-template <class T, class Alloc /*= std::allocator<T>*/>
+// Per thread, most recently used first.
+// Entries of destroyed or cleared storages are never matched again and
+// eventually get evicted.
+inline constexpr size_t tls_cache_size = 8u;
+
+inline std::array<tls_cache_entry, tls_cache_size>& tls_cache() noexcept;
+
+// Returns this thread's entry for the storage uid, or nullptr.
+inline tls_cache_entry* tls_cache_find(uint64_t uid) noexcept;
+
+// Adds an entry, evicting the least recently used one.
+inline void tls_cache_insert(const tls_cache_entry& entry) noexcept;
+
+// Storage uids are never reused, so caches can't confuse storages.
+inline uint64_t tls_next_uid() noexcept;
+} // namespace detail
+
+template <class T, class Alloc /*= std::allocator<T>*/,
+		tls_mode Mode /*= tls_mode::search*/>
 struct tls {
 	using value_type = T;
 	using allocator_type = Alloc;
@@ -130,6 +184,12 @@ struct tls {
 	using reference = T&;
 	using pointer = typename std::allocator_traits<Alloc>::pointer;
 
+	static constexpr tls_mode mode = Mode;
+	static constexpr bool is_cached
+			= Mode == tls_mode::cached || Mode == tls_mode::cached_padded;
+	static constexpr bool is_padded
+			= Mode == tls_mode::padded || Mode == tls_mode::cached_padded;
+
 	// Ctors
 	tls() = default;
 	~tls();
@@ -145,6 +205,7 @@ struct tls {
 	tls_lock<T, Alloc> lock();
 
 	// Unlocks the thread.
+	// tls_lock already does this, prefer it.
 	void unlock(std_thread_id_t tid, size_type data_idx);
 
 	// Do we contain any thread data?
@@ -178,12 +239,38 @@ private:
 		bool locked = false;
 	};
 
+	template <class U>
+	using storage_t = std::conditional_t<is_padded, detail::tls_padded<U>, U>;
+	using data_t = storage_t<T>;
+	using info_t = storage_t<thread_info>;
+
+	// A found or created thread slot.
+	struct slot {
+		size_type idx = 0;
+		data_t* data = nullptr;
+		info_t* info = nullptr;
+	};
+
+	template <class U>
+	static U& unpad(storage_t<U>& v) noexcept;
+
+	template <class U>
+	static const U& unpad(const storage_t<U>& v) noexcept;
+
+	// Searches for a free slot for this thread, or creates one.
+	// Marks it locked.
+	slot lock_slot(std_thread_id_t tid);
+
+	// Identifies this storage in thread caches.
+	// Renewed on clear, which invalidates all cached slots.
+	std::atomic<uint64_t> _uid{ detail::tls_next_uid() };
+
 	// Used only in exclusive mode currently.
 	mutable std::shared_mutex _mutex{};
 
 	// The thread's values, stored in a stable container to prevent
 	// invalidating references.
-	fea::deque_list<T, 128> _datas{};
+	fea::deque_list<data_t, 128> _datas{};
 
 	// Stores the lock state of a given thread data, and its index in the
 	// stable container.
@@ -191,7 +278,7 @@ private:
 	// This allows us to search for free data quickly, without locking.
 	// The same thread_id can recursively lock data, so there may be more than 1
 	// thread_info for a tid in this container.
-	fea::deque_list<thread_info, 128> _locks{};
+	fea::deque_list<info_t, 128> _locks{};
 };
 
 } // namespace fea
@@ -199,8 +286,44 @@ private:
 
 // Implementation
 namespace fea {
+namespace detail {
+std::array<tls_cache_entry, tls_cache_size>& tls_cache() noexcept {
+	thread_local std::array<tls_cache_entry, tls_cache_size> cache{};
+	return cache;
+}
+
+tls_cache_entry* tls_cache_find(uint64_t uid) noexcept {
+	std::array<tls_cache_entry, tls_cache_size>& cache = tls_cache();
+	if (cache[0].uid == uid) {
+		return &cache[0];
+	}
+
+	for (size_t i = 1; i < cache.size(); ++i) {
+		if (cache[i].uid == uid) {
+			std::rotate(
+					cache.begin(), cache.begin() + i, cache.begin() + i + 1);
+			return &cache[0];
+		}
+	}
+	return nullptr;
+}
+
+void tls_cache_insert(const tls_cache_entry& entry) noexcept {
+	std::array<tls_cache_entry, tls_cache_size>& cache = tls_cache();
+	std::rotate(cache.begin(), cache.end() - 1, cache.end());
+	cache[0] = entry;
+}
+
+uint64_t tls_next_uid() noexcept {
+	// 0 is reserved for empty cache entries.
+	static std::atomic<uint64_t> counter{ 1u };
+	return counter.fetch_add(1u, std::memory_order_relaxed);
+}
+} // namespace detail
+
 template <class T, class Alloc>
-tls_lock<T, Alloc>::tls_lock(tls<T, Alloc>& storage)
+template <tls_mode Mode>
+tls_lock<T, Alloc>::tls_lock(tls<T, Alloc, Mode>& storage)
 		: tls_lock(std::move(storage.lock())) {
 }
 
@@ -209,9 +332,10 @@ tls_lock<T, Alloc>::tls_lock(tls_lock&& other) noexcept
 		: _tid(other._tid)
 		, _idx(other._idx)
 		, _value(other._value)
-		, _storage(other._storage) {
+		, _locked(other._locked) {
 	other._tid = std_thread_id_t{};
 	other._idx = (std::numeric_limits<uint32_t>::max)();
+	other._locked = nullptr;
 	assert(_tid == std::this_thread::get_id());
 	assert(_tid != std_thread_id_t{});
 	assert(_idx != (std::numeric_limits<uint32_t>::max)());
@@ -219,11 +343,11 @@ tls_lock<T, Alloc>::tls_lock(tls_lock&& other) noexcept
 
 template <class T, class Alloc>
 tls_lock<T, Alloc>::tls_lock(std_thread_id_t tid, size_type idx, T& value,
-		tls<T, Alloc>& storage) noexcept
+		bool& locked) noexcept
 		: _tid(tid)
 		, _idx(idx)
 		, _value(value)
-		, _storage(storage) {
+		, _locked(&locked) {
 	assert(_tid == std::this_thread::get_id());
 	assert(_tid != std_thread_id_t{});
 	assert(_idx != (std::numeric_limits<uint32_t>::max)());
@@ -234,7 +358,14 @@ tls_lock<T, Alloc>::~tls_lock() {
 	if (_tid != std_thread_id_t{}) {
 		assert(_tid == std::this_thread::get_id());
 		assert(_idx != (std::numeric_limits<uint32_t>::max)());
-		_storage.unlock(_tid, _idx);
+		assert(_locked != nullptr);
+
+		// Slots are stable and only ever unlocked by their owning thread.
+		if (!*_locked) {
+			fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
+					"Trying to unlock tls that isn't locked.");
+		}
+		*_locked = false;
 	}
 }
 
@@ -255,13 +386,13 @@ T& tls_lock<T, Alloc>::local() & {
 	return _value;
 }
 
-template <class T, class Alloc>
-tls<T, Alloc>::~tls() {
+template <class T, class Alloc, tls_mode Mode>
+tls<T, Alloc, Mode>::~tls() {
 	std::lock_guard<std::shared_mutex> g{ _mutex };
 	assert(_locks.size() == _datas.size());
 
-	for (const thread_info& ti : _locks) {
-		if (ti.locked) {
+	for (const info_t& ti : _locks) {
+		if (unpad<thread_info>(ti).locked) {
 			fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
 					"Destroying storage with unreleased locks. Make sure "
 					"all your threads are done working before destroying "
@@ -270,10 +401,55 @@ tls<T, Alloc>::~tls() {
 	}
 }
 
-template <class T, class Alloc>
-tls_lock<T, Alloc> tls<T, Alloc>::lock() {
+template <class T, class Alloc, tls_mode Mode>
+tls_lock<T, Alloc> tls<T, Alloc, Mode>::lock() {
 	std_thread_id_t tid = std::this_thread::get_id();
 
+	if constexpr (is_cached) {
+		// Fast path, our slot is cached and we aren't recursing.
+		// Only this thread ever locks or unlocks its slot, no need for
+		// synchronization.
+		uint64_t uid = _uid.load(std::memory_order_relaxed);
+		detail::tls_cache_entry* entry = detail::tls_cache_find(uid);
+		if (entry != nullptr && !*entry->locked) {
+			*entry->locked = true;
+			return tls_lock<T, Alloc>{
+				tid,
+				entry->idx,
+				unpad<T>(*static_cast<data_t*>(entry->value)),
+				*entry->locked,
+			};
+		}
+
+		slot s = lock_slot(tid);
+		if (entry == nullptr) {
+			// Recursive slots aren't cached, the first one is ours.
+			detail::tls_cache_insert(detail::tls_cache_entry{
+					uid,
+					s.idx,
+					static_cast<void*>(s.data),
+					&unpad<thread_info>(*s.info).locked,
+			});
+		}
+		return tls_lock<T, Alloc>{
+			tid,
+			s.idx,
+			unpad<T>(*s.data),
+			unpad<thread_info>(*s.info).locked,
+		};
+	} else {
+		slot s = lock_slot(tid);
+		return tls_lock<T, Alloc>{
+			tid,
+			s.idx,
+			unpad<T>(*s.data),
+			unpad<thread_info>(*s.info).locked,
+		};
+	}
+}
+
+template <class T, class Alloc, tls_mode Mode>
+auto tls<T, Alloc, Mode>::lock_slot(std_thread_id_t tid) -> slot {
 	// Optimization.
 	// We are guaranteed atomic for this thread id.
 	// That is, the same thread cannot re-enter this function (or any other),
@@ -287,36 +463,26 @@ tls_lock<T, Alloc> tls<T, Alloc>::lock() {
 	{
 		size_type size = _locks.size();
 		auto begin_it = _locks.begin();
+		auto data_it = _datas.begin();
 
 		size_type i = 0;
 		for (; i < size; ++i) {
-			const thread_info& info = *begin_it;
+			const thread_info& info = unpad<thread_info>(*begin_it);
 			if (info.thread_id == tid && info.locked == false) {
 				break;
 			}
 			++begin_it;
+			++data_it;
 		}
 
-		// auto end_it = std::next(begin_it, size);
-
-		// auto it = std::find_if(begin_it, end_it, [&](const thread_info& info)
-		// { 	return info.thread_id == tid && info.locked == false;
-		// });
-
 		// End iterator could have changed, compare with our cached size.
-		// if (idx != size) {
 		if (i < size) {
 			// Found free thread slot.
-			thread_info& info = *begin_it;
+			thread_info& info = unpad<thread_info>(*begin_it);
 			assert(!info.locked);
 
 			info.locked = true;
-			return tls_lock<T, Alloc>{
-				tid,
-				uint32_t(i),
-				*std::next(_datas.begin(), i),
-				*this,
-			};
+			return slot{ i, &*data_it, &*begin_it };
 		}
 	}
 
@@ -328,19 +494,14 @@ tls_lock<T, Alloc> tls<T, Alloc>::lock() {
 	// Create new lock + data slot, then update valid size.
 	size_t idx = _locks.size();
 	_datas.push_back({});
-	_locks.push_back(thread_info{ tid, true });
+	_locks.push_back(info_t{ thread_info{ tid, true } });
 	assert(_locks.size() == _datas.size());
 
-	return tls_lock<T, Alloc>{
-		tid,
-		idx,
-		*std::next(_datas.begin(), idx),
-		*this,
-	};
+	return slot{ idx, &_datas.back(), &_locks.back() };
 }
 
-template <class T, class Alloc>
-void tls<T, Alloc>::unlock(
+template <class T, class Alloc, tls_mode Mode>
+void tls<T, Alloc, Mode>::unlock(
 		[[maybe_unused]] std_thread_id_t tid, size_type idx) {
 	// Since the lock should have been created already, no need for locking.
 	// Just use our cached valid size.
@@ -350,38 +511,37 @@ void tls<T, Alloc>::unlock(
 				"Trying to unlock tls that doesn't exist.");
 	}
 
-	thread_info& info = *std::next(_locks.begin(), idx);
+	thread_info& info = unpad<thread_info>(*std::next(_locks.begin(), idx));
 	assert(info.thread_id == tid);
 
-	// thread_info& info = _locks[idx];
 	if (!info.locked) {
 		fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
 				"Trying to unlock tls that isn't locked.");
 	}
 
-	// Unlock it.
+	// Unlock it, the same flag tls_lock releases.
 	info.locked = false;
 }
 
-template <class T, class Alloc>
-bool tls<T, Alloc>::empty() const {
+template <class T, class Alloc, tls_mode Mode>
+bool tls<T, Alloc, Mode>::empty() const {
 	assert(_locks.size() == _datas.size());
 	return _locks.empty();
 }
 
-template <class T, class Alloc>
-auto tls<T, Alloc>::size() const -> size_type {
+template <class T, class Alloc, tls_mode Mode>
+auto tls<T, Alloc, Mode>::size() const -> size_type {
 	assert(_locks.size() == _datas.size());
 	return _locks.size();
 }
 
-template <class T, class Alloc>
-void tls<T, Alloc>::clear() {
+template <class T, class Alloc, tls_mode Mode>
+void tls<T, Alloc, Mode>::clear() {
 	std::lock_guard<std::shared_mutex> g{ _mutex };
 	assert(_locks.size() == _datas.size());
 
-	for (const thread_info& info : _locks) {
-		if (info.locked) {
+	for (const info_t& info : _locks) {
+		if (unpad<thread_info>(info).locked) {
 			fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
 					"Cannot clear storage, at least 1 thread currently "
 					"owns a lock on storage.");
@@ -390,44 +550,65 @@ void tls<T, Alloc>::clear() {
 
 	_datas.clear();
 	_locks.clear();
+	_uid.store(detail::tls_next_uid(), std::memory_order_relaxed);
 	assert(_locks.size() == _datas.size());
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, tls_mode Mode>
 template <class Func>
-void tls<T, Alloc>::combine_each(Func&& func) const {
+void tls<T, Alloc, Mode>::combine_each(Func&& func) const {
 	std::lock_guard<std::shared_mutex> g{ _mutex };
 	assert(_locks.size() == _datas.size());
 
-	for (const thread_info& info : _locks) {
-		if (info.locked) {
+	for (const info_t& info : _locks) {
+		if (unpad<thread_info>(info).locked) {
 			fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
 					"Cannot combine storage, at least 1 thread still holds "
 					"a lock.");
 		}
 	}
 
-	for (const T& t : _datas) {
-		func(t);
+	for (const data_t& t : _datas) {
+		func(unpad<T>(t));
 	}
 }
 
-template <class T, class Alloc>
+template <class T, class Alloc, tls_mode Mode>
 template <class Func>
-void tls<T, Alloc>::combine_each(Func&& func) {
+void tls<T, Alloc, Mode>::combine_each(Func&& func) {
 	std::lock_guard<std::shared_mutex> g{ _mutex };
 	assert(_locks.size() == _datas.size());
 
-	for (const thread_info& info : _locks) {
-		if (info.locked) {
+	for (const info_t& info : _locks) {
+		if (unpad<thread_info>(info).locked) {
 			fea::maybe_throw<std::runtime_error>(__FUNCTION__, __LINE__,
 					"Cannot combine storage, at least 1 thread still holds "
 					"a lock.");
 		}
 	}
 
-	for (T& t : _datas) {
-		func(t);
+	for (data_t& t : _datas) {
+		func(unpad<T>(t));
+	}
+}
+
+template <class T, class Alloc, tls_mode Mode>
+template <class U>
+U& tls<T, Alloc, Mode>::unpad(storage_t<U>& v) noexcept {
+	if constexpr (is_padded) {
+		return v.value;
+	} else {
+		return v;
+	}
+}
+
+template <class T, class Alloc, tls_mode Mode>
+template <class U>
+const U& tls<T, Alloc, Mode>::unpad(const storage_t<U>& v) noexcept {
+	if constexpr (is_padded) {
+		return v.value;
+	} else {
+		return v;
 	}
 }
 } // namespace fea
@@ -0,0 +1,503 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/containers/span.hpp"
+#include "fea/performance/thread.hpp"
+
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <vector>
+
+/*
+fea::lz : A small, self-contained LZ block compressor.
+
+Data is split in blocks, which are compressed independently. The _mt functions
+compress and decompress blocks in parallel. It favors decompression speed over
+compression ratio, and is meant to sit between fea::serializer::extract and
+the file write, and between the file read and fea::deserializer.
+
+Frame :
+[uint32_t magic][uint32_t block size][uint64_t raw size]
+[uint32_t stored size * block count][blocks]
+Blocks that don't compress are stored as-is, their stored size is their raw
+size.
+
+Blocks are sequences of :
+[token][literal length+][literals][uint16_t offset][match length+]
+The token holds 4 bits of literal length and 4 bits of match length (minus 4).
+Lengths of 15 continue with bytes, until a byte isn't 255. The last sequence
+has literals only.
+*/
+
+namespace fea {
+// The default block size.
+// Bigger blocks compress a little better, smaller blocks parallelize more.
+inline constexpr size_t lz_default_block_size = 256 * 1024;
+
+// Compresses data.
+[[nodiscard]]
+inline std::vector<std::byte> lz_compress(fea::span<const std::byte> data,
+		size_t block_size = lz_default_block_size);
+
+// Compresses data, blocks are compressed in parallel.
+[[nodiscard]]
+inline std::vector<std::byte> lz_compress_mt(fea::span<const std::byte> data,
+		size_t block_size = lz_default_block_size);
+
+// Decompresses data compressed with lz_compress, into out.
+// Returns false if the data is corrupted.
+[[nodiscard]]
+inline bool lz_decompress(
+		fea::span<const std::byte> data, std::vector<std::byte>& out);
+
+// Decompresses data, blocks are decompressed in parallel.
+// Returns false if the data is corrupted.
+[[nodiscard]]
+inline bool lz_decompress_mt(
+		fea::span<const std::byte> data, std::vector<std::byte>& out);
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+namespace detail {
+inline constexpr uint32_t lz_magic = 0x315a4c46; // "FLZ1"
+inline constexpr size_t lz_header_size = 16;
+inline constexpr size_t lz_min_match = 4;
+inline constexpr size_t lz_max_offset = 65535;
+inline constexpr size_t lz_hash_bits = 14;
+// Matches stop before the last bytes of a block, which are literals.
+inline constexpr size_t lz_last_literals = 8;
+// The most bytes one compressed byte can decompress to.
+// Each extended length byte adds at most 255 bytes to a match.
+inline constexpr size_t lz_max_expansion = 255;
+
+// The maximum compressed size of a block.
+[[nodiscard]]
+inline size_t lz_bound(size_t size) {
+	return size + size / 255 + 16;
+}
+
+[[nodiscard]]
+inline uint32_t lz_read32(const std::byte* ptr) {
+	uint32_t ret;
+	std::memcpy(&ret, ptr, sizeof(ret));
+	return ret;
+}
+
+[[nodiscard]]
+inline uint32_t lz_hash(const std::byte* p) {
+	uint64_t v;
+	std::memcpy(&v, p, 8);
+	return uint32_t(((v << 24) * 889523592379ull) >> (64 - lz_hash_bits));
+}
+
+// Writes the extended part of a length.
+inline std::byte* lz_write_length(size_t len, std::byte* out) {
+	while (len >= 255) {
+		*out++ = std::byte(255);
+		len -= 255;
+	}
+	*out++ = std::byte(uint8_t(len));
+	return out;
+}
+
+// Reads the extended part of a length.
+[[nodiscard]]
+inline bool lz_read_length(
+		const std::byte*& in, const std::byte* in_end, size_t& len) {
+	uint8_t b = 255;
+	while (b == 255) {
+		if (in == in_end) {
+			return false;
+		}
+		b = uint8_t(*in++);
+		len += b;
+	}
+	return true;
+}
+
+// Writes literals [lit_first, lit_last) and a match.
+// Match length 0 means literals only.
+inline std::byte* lz_write_sequence(const std::byte* lit_first,
+		const std::byte* lit_last, size_t offset, size_t match_len,
+		std::byte* out) {
+	std::byte* token = out++;
+	size_t lit_len = size_t(lit_last - lit_first);
+	uint8_t tok = 0;
+
+	if (lit_len >= 15) {
+		tok = 0xf0;
+		out = lz_write_length(lit_len - 15, out);
+	} else {
+		tok = uint8_t(lit_len << 4);
+	}
+
+	std::memcpy(out, lit_first, lit_len);
+	out += lit_len;
+
+	if (match_len != 0) {
+		*out++ = std::byte(uint8_t(offset));
+		*out++ = std::byte(uint8_t(offset >> 8));
+
+		size_t len = match_len - lz_min_match;
+		if (len >= 15) {
+			tok = uint8_t(tok | 0x0f);
+			out = lz_write_length(len - 15, out);
+		} else {
+			tok = uint8_t(tok | len);
+		}
+	}
+
+	*token = std::byte(tok);
+	return out;
+}
+
+// Compresses a block to out, which holds lz_bound(size) bytes.
+// Returns the compressed size.
+inline size_t lz_compress_block(
+		const std::byte* src, size_t size, std::byte* out) {
+	std::byte* op = out;
+	const std::byte* anchor = src;
+	const std::byte* end = src + size;
+
+	if (size > lz_last_literals + lz_min_match) {
+		std::array<uint32_t, size_t(1) << lz_hash_bits> table{};
+		const std::byte* match_limit = end - lz_last_literals;
+		const std::byte* ip = src + 1;
+
+		while (ip + lz_min_match <= match_limit) {
+			uint32_t seq = lz_read32(ip);
+			uint32_t& slot = table[lz_hash(ip)];
+			const std::byte* ref = src + slot;
+			slot = uint32_t(ip - src);
+
+			if (ref >= ip || size_t(ip - ref) > lz_max_offset
+					|| lz_read32(ref) != seq) {
+				// Skip faster through incompressible data.
+				ip += 1 + (size_t(ip - anchor) >> 6);
+				continue;
+			}
+
+			// Extend backwards, then forwards.
+			while (ip > anchor && ref > src && ip[-1] == ref[-1]) {
+				--ip;
+				--ref;
+			}
+
+			const std::byte* mp = ip + lz_min_match;
+			const std::byte* rp = ref + lz_min_match;
+			while (mp + 8 <= match_limit && std::memcmp(mp, rp, 8) == 0) {
+				mp += 8;
+				rp += 8;
+			}
+			while (mp < match_limit && *mp == *rp) {
+				++mp;
+				++rp;
+			}
+
+			op = lz_write_sequence(
+					anchor, ip, size_t(ip - ref), size_t(mp - ip), op);
+			ip = mp;
+			anchor = ip;
+
+			// Seed the table from the end of the match.
+			table[lz_hash(ip - 2)] = uint32_t(ip - 2 - src);
+		}
+	}
+
+	op = lz_write_sequence(anchor, end, 0, 0, op);
+	return size_t(op - out);
+}
+
+// Copies a match of match_len bytes at offset, op must have match_len + 8
+// bytes available. May write past the match, it is overwritten later.
+inline void lz_copy_match(std::byte* op, size_t offset, size_t match_len) {
+	const std::byte* ref = op - offset;
+	if (offset >= 8) {
+		// 8 byte chunks are at least 8 bytes apart, overlaps are fine.
+		std::memcpy(op, ref, 8);
+		std::memcpy(op + 8, ref + 8, 8);
+		for (size_t i = 16; i < match_len; i += 8) {
+			std::memcpy(op + i, ref + i, 8);
+		}
+		return;
+	}
+
+	// Short offsets repeat a pattern. Copy the first 8 bytes one at a time,
+	// then continue from a multiple of the pattern at least 8 bytes back.
+	for (size_t i = 0; i < 8; ++i) {
+		op[i] = ref[i];
+	}
+	size_t period = offset * ((8 + offset - 1) / offset);
+	for (size_t i = 8; i < match_len; i += 8) {
+		std::memcpy(op + i, op + i - period, 8);
+	}
+}
+
+// Decompresses a block to out, which must be exactly out_size once
+// decompressed. Returns false if the data is corrupted.
+[[nodiscard]]
+inline bool lz_decompress_block(const std::byte* src, size_t size,
+		std::byte* out, size_t out_size) {
+	const std::byte* ip = src;
+	const std::byte* in_end = src + size;
+	std::byte* op = out;
+	std::byte* out_end = out + out_size;
+
+	while (ip != in_end) {
+		uint8_t tok = uint8_t(*ip++);
+		size_t lit_len = size_t(tok >> 4);
+		if (lit_len != 15 && in_end - ip >= 16 && out_end - op >= 16) {
+			// Short literals, copy a fixed size.
+			std::memcpy(op, ip, 16);
+		} else {
+			if (lit_len == 15 && !lz_read_length(ip, in_end, lit_len)) {
+				return false;
+			}
+
+			if (lit_len > size_t(in_end - ip)
+					|| lit_len > size_t(out_end - op)) {
+				return false;
+			}
+			std::memcpy(op, ip, lit_len);
+		}
+		op += lit_len;
+		ip += lit_len;
+
+		if (ip == in_end) {
+			// Last sequence.
+			return op == out_end;
+		}
+
+		if (in_end - ip < 2) {
+			return false;
+		}
+		size_t offset = size_t(uint8_t(ip[0])) | size_t(uint8_t(ip[1])) << 8;
+		ip += 2;
+
+		size_t match_len = size_t(tok & 0x0f);
+		if (match_len == 15 && !lz_read_length(ip, in_end, match_len)) {
+			return false;
+		}
+		match_len += lz_min_match;
+
+		if (offset == 0 || offset > size_t(op - out)
+				|| match_len > size_t(out_end - op)) {
+			return false;
+		}
+
+		if (size_t(out_end - op) >= match_len + 16) {
+			lz_copy_match(op, offset, match_len);
+		} else {
+			// End of the block, no room to write past the match.
+			const std::byte* ref = op - offset;
+			for (size_t i = 0; i < match_len; ++i) {
+				op[i] = ref[i];
+			}
+		}
+		op += match_len;
+	}
+	return false;
+}
+
+inline std::vector<std::byte> lz_compress(
+		fea::span<const std::byte> data, size_t block_size, bool mt) {
+	assert(block_size != 0);
+	assert(block_size <= (std::numeric_limits<uint32_t>::max)());
+
+	const size_t num_blocks = (data.size() + block_size - 1) / block_size;
+	const size_t table_size = sizeof(uint32_t) * num_blocks;
+	const size_t slot_size = lz_bound(block_size);
+
+	// Blocks are compressed in fixed slots, then packed.
+	std::vector<std::byte> ret(
+			lz_header_size + table_size + slot_size * num_blocks);
+	std::byte* table = ret.data() + lz_header_size;
+	std::byte* slots = table + table_size;
+
+	auto compress = [&](const std::pair<size_t, size_t>& range) {
+		for (size_t i = range.first; i < range.second; ++i) {
+			const std::byte* src = data.data() + i * block_size;
+			size_t raw_size
+					= (std::min)(block_size, data.size() - i * block_size);
+			std::byte* slot = slots + i * slot_size;
+
+			size_t stored_size = lz_compress_block(src, raw_size, slot);
+			if (stored_size >= raw_size) {
+				std::memcpy(slot, src, raw_size);
+				stored_size = raw_size;
+			}
+
+			uint32_t stored = uint32_t(stored_size);
+			std::memcpy(
+					table + i * sizeof(uint32_t), &stored, sizeof(stored));
+		}
+	};
+
+	if (mt) {
+		fea::parallel_for(num_blocks, 1, compress);
+	} else {
+		compress({ 0, num_blocks });
+	}
+
+	uint32_t magic = lz_magic;
+	uint32_t bsize = uint32_t(block_size);
+	uint64_t raw_size = uint64_t(data.size());
+	std::memcpy(ret.data(), &magic, sizeof(magic));
+	std::memcpy(ret.data() + 4, &bsize, sizeof(bsize));
+	std::memcpy(ret.data() + 8, &raw_size, sizeof(raw_size));
+
+	std::byte* packed = slots;
+	for (size_t i = 0; i < num_blocks; ++i) {
+		uint32_t stored = 0;
+		std::memcpy(&stored, table + i * sizeof(uint32_t), sizeof(stored));
+		std::memmove(packed, slots + i * slot_size, stored);
+		packed += stored;
+	}
+	ret.resize(size_t(packed - ret.data()));
+	return ret;
+}
+
+inline bool lz_decompress(fea::span<const std::byte> data,
+		std::vector<std::byte>& out, bool mt) {
+	out.clear();
+	if (data.size() < lz_header_size) {
+		return false;
+	}
+
+	uint32_t magic = 0;
+	uint32_t block_size = 0;
+	uint64_t raw_size = 0;
+	std::memcpy(&magic, data.data(), sizeof(magic));
+	std::memcpy(&block_size, data.data() + 4, sizeof(block_size));
+	std::memcpy(&raw_size, data.data() + 8, sizeof(raw_size));
+	if (magic != lz_magic || block_size == 0) {
+		return false;
+	}
+
+	// Blocks compress to at least a token.
+	const uint64_t num_blocks = (raw_size + block_size - 1) / block_size;
+	if (num_blocks > (data.size() - lz_header_size) / (sizeof(uint32_t) + 1)) {
+		return false;
+	}
+
+	// The stored bytes can't decompress to more than this.
+	const size_t table_size = sizeof(uint32_t) * size_t(num_blocks);
+	const size_t payload_size = data.size() - lz_header_size - table_size;
+	if (raw_size > uint64_t(payload_size) * lz_max_expansion) {
+		return false;
+	}
+
+	// Block offsets in data.
+	const std::byte* table = data.data() + lz_header_size;
+	std::vector<size_t> offsets(size_t(num_blocks) + 1);
+	offsets[0] = lz_header_size + table_size;
+	for (size_t i = 0; i < size_t(num_blocks); ++i) {
+		uint32_t stored = 0;
+		std::memcpy(&stored, table + i * sizeof(uint32_t), sizeof(stored));
+
+		// Blocks never store more than their raw size, and stored bytes
+		// must be able to produce it.
+		uint64_t raw_block_size = (std::min)(
+				uint64_t(block_size), raw_size - i * uint64_t(block_size));
+		if (stored > raw_block_size
+				|| raw_block_size > uint64_t(stored) * lz_max_expansion) {
+			return false;
+		}
+		offsets[i + 1] = offsets[i] + stored;
+	}
+	if (offsets.back() != data.size()) {
+		return false;
+	}
+
+	out.resize(size_t(raw_size));
+	std::atomic<bool> ok{ true };
+	auto decompress = [&](const std::pair<size_t, size_t>& range) {
+		for (size_t i = range.first; i < range.second; ++i) {
+			const std::byte* src = data.data() + offsets[i];
+			size_t stored_size = offsets[i + 1] - offsets[i];
+			std::byte* dst = out.data() + i * block_size;
+			size_t raw_block_size = (std::min)(
+					size_t(block_size), out.size() - i * block_size);
+
+			if (stored_size == raw_block_size) {
+				std::memcpy(dst, src, stored_size);
+			} else if (!lz_decompress_block(
+							   src, stored_size, dst, raw_block_size)) {
+				ok.store(false, std::memory_order_relaxed);
+				return;
+			}
+		}
+	};
+
+	if (mt) {
+		fea::parallel_for(size_t(num_blocks), 1, decompress);
+	} else {
+		decompress({ 0, size_t(num_blocks) });
+	}
+
+	if (!ok.load()) {
+		out.clear();
+		return false;
+	}
+	return true;
+}
+} // namespace detail
+
+
+std::vector<std::byte> lz_compress(
+		fea::span<const std::byte> data, size_t block_size) {
+	return detail::lz_compress(data, block_size, false);
+}
+
+std::vector<std::byte> lz_compress_mt(
+		fea::span<const std::byte> data, size_t block_size) {
+	return detail::lz_compress(data, block_size, true);
+}
+
+bool lz_decompress(
+		fea::span<const std::byte> data, std::vector<std::byte>& out) {
+	return detail::lz_decompress(data, out, false);
+}
+
+bool lz_decompress_mt(
+		fea::span<const std::byte> data, std::vector<std::byte>& out) {
+	return detail::lz_decompress(data, out, true);
+}
+} // namespace fea
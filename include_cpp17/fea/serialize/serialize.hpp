@@ -31,6 +31,7 @@
  * POSSIBILITY OF SUCH DAMAGE.
  **/
 #pragma once
+#include "fea/containers/span.hpp"
 #include "fea/memory/memory.hpp"
 #include "fea/meta/traits.hpp"
 #include "fea/meta/tuple.hpp"
@@ -38,7 +39,9 @@
 #include "fea/utility/platform.hpp"
 
 #include <iterator>
+#include <string_view>
 #include <type_traits>
+#include <vector>
 
 // Special snow-flakes.
 #include <queue>
@@ -76,6 +79,23 @@ fea::serialize cannot differentiate between your passed in refs and refs
 themselved. As such, it will serialize the references in place. When
 deserializing, the original reference will be filled with data.
 Not ideal, but good enough.
+
+On views.
+Contiguous containers of trivially copyable types may be deserialized to
+fea::span<const T> or std::basic_string_view. When the data is aligned for T
+and stored raw, views point in place, into the deserializer data (or file
+mapping), and no copy is made. Otherwise (misaligned data, compact integers),
+they point to a copy owned by the deserializer. Either way, they are valid as
+long as the deserializer is alive.
+
+On compact encoding.
+In compact archives, non-contiguous containers of integers (std::set, etc) are
+written as one buffer, so sorted containers are delta encoded.
+
+On sections.
+serialize_section and deserialize_section write and read top-level named
+sections of indexed archives. Sections can be read in any order, without
+parsing the data before them.
 */
 
 namespace fea {
@@ -94,6 +114,14 @@ template <class T, class... Args>
 [[nodiscard]]
 bool deserialize(fea::deserializer&, std::queue<T, Args...>&);
 
+template <class T>
+[[nodiscard]]
+bool deserialize(fea::deserializer&, fea::span<const T>&);
+
+template <class CharT, class Traits>
+[[nodiscard]]
+bool deserialize(fea::deserializer&, std::basic_string_view<CharT, Traits>&);
+
 namespace detail {
 
 // c++20 has contiguous_iterator_tag
@@ -103,6 +131,19 @@ struct contiguous_iterator_tag : public std::random_access_iterator_tag {};
 using contiguous_iterator_tag = std::contiguous_iterator_tag;
 #endif
 
+// Views are trivially copyable, but we serialize the data they point to.
+template <class T>
+inline constexpr bool is_view_v = false;
+template <class T, size_t Extent>
+inline constexpr bool is_view_v<fea::span<T, Extent>> = true;
+template <class CharT, class Traits>
+inline constexpr bool is_view_v<std::basic_string_view<CharT, Traits>> = true;
+
+// Can be written and read as raw bytes.
+template <class T>
+inline constexpr bool is_flat_v
+		= std::is_trivially_copyable_v<T> && !is_view_v<T>;
+
 // Can't expose this because of contiguous_iterator_tag detection.
 // template <class Iter>
 // void serialize(Iter begin, Iter end, fea::serializer& os);
@@ -111,10 +152,23 @@ template <class Iter>
 void serialize(
 		Iter begin, Iter end, fea::serializer& os, std::input_iterator_tag) {
 
+	using val_t = typename std::iterator_traits<Iter>::value_type;
 	using msize_t = FEA_SERIALIZE_SIZE_T;
 	msize_t size = msize_t(std::distance(begin, end));
 
 	os.write_unvalidated(size);
+	if constexpr (detail::is_varint_v<val_t>) {
+		if (os.encoding() == fea::serialize_encoding::compact) {
+			// Written as one buffer, so sorted containers are delta encoded.
+			if (size != 0) {
+				std::vector<val_t> vals(begin, end);
+				os.write(vals.data(), vals.size());
+			}
+			os.write_unvalidated(size);
+			return;
+		}
+	}
+
 	using fea::serialize;
 	for (Iter it = begin; it != end; ++it) {
 		serialize(*it, os);
@@ -156,13 +210,31 @@ bool deserialize(fea::deserializer& is, T& t, std::input_iterator_tag) {
 	static_assert(std::is_default_constructible_v<val_t>,
 			"fea::deserialize : type must be default constructible");
 
-	for (size_t i = 0; i < size_t(size); ++i) {
-		decltype(get_pair_type<val_t>()) v;
-		using fea::deserialize;
-		if (!deserialize(is, v)) {
-			return false;
+	bool compact = false;
+	if constexpr (detail::is_varint_v<val_t>) {
+		compact = is.encoding() == fea::serialize_encoding::compact;
+		if (compact && size != 0) {
+			// Written as one buffer.
+			std::vector<val_t> vals;
+			vals.resize(size_t(size));
+			if (!is.read(vals.data(), vals.size())) {
+				return false;
+			}
+			for (const val_t& v : vals) {
+				std::inserter(t, std::end(t)) = v;
+			}
+		}
+	}
+
+	if (!compact) {
+		for (size_t i = 0; i < size_t(size); ++i) {
+			decltype(get_pair_type<val_t>()) v;
+			using fea::deserialize;
+			if (!deserialize(is, v)) {
+				return false;
+			}
+			std::inserter(t, std::end(t)) = fea::move_if_moveable(v);
 		}
-		std::inserter(t, std::end(t)) = fea::move_if_moveable(v);
 	}
 
 	msize_t size2 = 0;
@@ -190,7 +262,7 @@ void serialize(
 
 	os.write_unvalidated(size);
 	if (size != 0) {
-		if constexpr (std::is_trivially_copyable_v<val_t>) {
+		if constexpr (is_flat_v<val_t>) {
 			os.write(std::addressof(*begin), std::distance(begin, end));
 		} else {
 			using fea::serialize;
@@ -227,7 +299,7 @@ bool deserialize(fea::deserializer& is, T& t, contiguous_iterator_tag) {
 			}
 		}
 
-		if constexpr (std::is_trivially_copyable_v<val_t>) {
+		if constexpr (is_flat_v<val_t>) {
 			if (!is.read(std::addressof(*std::begin(t)), size_t(size))) {
 				return false;
 			}
@@ -253,6 +325,36 @@ bool deserialize(fea::deserializer& is, T& t, contiguous_iterator_tag) {
 	return true;
 }
 
+template <class T>
+[[nodiscard]]
+bool deserialize_view(fea::deserializer& is, const T*& ptr, size_t& size) {
+	using msize_t = FEA_SERIALIZE_SIZE_T;
+
+	msize_t msize = 0;
+	if (!is.read_unvalidated(msize)) {
+		return false;
+	}
+
+	ptr = nullptr;
+	size = size_t(msize);
+	if (size != 0) {
+		if (!is.read_view(ptr, size)) {
+			return false;
+		}
+	}
+
+	msize_t msize2 = 0;
+	if (!is.read_unvalidated(msize2)) {
+		return false;
+	}
+
+	if (msize != msize2) {
+		assert(false);
+		return false;
+	}
+	return true;
+}
+
 template <class... Args, template <class...> class Tup>
 void serialize_tup(const Tup<Args...>& t, fea::serializer& os) {
 	fea::tuple_for_each(
@@ -344,6 +446,54 @@ bool deserialize(fea::deserializer& is, T& t) {
 	}
 }
 
+// Deserialize a contiguous container in place, without copying.
+template <class T>
+[[nodiscard]]
+bool deserialize(fea::deserializer& is, fea::span<const T>& t) {
+	const T* ptr = nullptr;
+	size_t size = 0;
+	if (!detail::deserialize_view(is, ptr, size)) {
+		return false;
+	}
+	t = fea::span<const T>{ ptr, size };
+	return true;
+}
+
+// Deserialize a string in place, without copying.
+template <class CharT, class Traits>
+[[nodiscard]]
+bool deserialize(
+		fea::deserializer& is, std::basic_string_view<CharT, Traits>& t) {
+	const CharT* ptr = nullptr;
+	size_t size = 0;
+	if (!detail::deserialize_view(is, ptr, size)) {
+		return false;
+	}
+	t = std::basic_string_view<CharT, Traits>{ ptr, size };
+	return true;
+}
+
+// Starts a new section and serializes t in it.
+template <class T>
+void serialize_section(std::string_view name, const T& t, fea::serializer& os) {
+	os.begin_section(name);
+	using fea::serialize;
+	serialize(t, os);
+}
+
+// Seeks to section and deserializes t.
+// Returns false if the section doesn't exist.
+template <class T>
+[[nodiscard]]
+bool deserialize_section(
+		fea::deserializer& is, std::string_view name, T& t) {
+	if (!is.seek(name)) {
+		return false;
+	}
+	using fea::deserialize;
+	return deserialize(is, t);
+}
+
 // Helpers for snow-flake library types.
 template <class T, class... Args>
 void serialize(const std::queue<T, Args...>& t, fea::serializer& os) {
@@ -31,6 +31,8 @@
  * POSSIBILITY OF SUCH DAMAGE.
  **/
 #pragma once
+#include "fea/memory/fmap.hpp"
+#include "fea/serialize/varint.hpp"
 #include "fea/utility/file.hpp"
 #include "fea/utility/platform.hpp"
 #include "fea/utility/scope.hpp"
@@ -40,8 +42,14 @@
 #include <cassert>
 #include <cerrno>
 #include <cstdio>
+#include <cstdint>
 #include <cstring>
 #include <filesystem>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include <utility>
 #include <vector>
 
 /*
@@ -51,11 +59,40 @@ checks to make sure your deserialization structures match the serialized
 structures.
 
 When constructing the serializer structs with file paths, the serializer will
-write to file on destruction or if the user calls flush. Whichever comes first.
+write to file when the user calls close, or on destruction. Call close to get
+write errors, the destructor can only print them.
+
+When constructing the serializer with a file path and a buffer size, the
+serializer streams to file. It keeps at most buffer_size bytes of data and
+size table in memory, and writes chunks to file when the buffer is full.
+Writes bigger than the buffer go straight to file. Memory usage stays constant,
+whatever the total size. The deserializer detects streamed files.
+
+When constructing the deserializer with a memory-mapped file (fea::ifmap), it
+reads straight from the mapping without copying the file. Use read_view, or
+deserialize to fea::span<const T> and std::string_view, to access contiguous
+data in place. Data which isn't aligned for its type is copied instead.
+Views are valid as long as the deserializer is alive.
 
 When constructing the serializer with the default constructor, it will not do
 anything with the data. You must call 'extract()' to retrieve the serialized
 data. The destructor will check you emptied the serializer.
+
+Indexed archives.
+Call begin_section on the serializer to start a top-level section, named or
+not. Sections are recorded in a table of contents, and the deserializer can
+seek to any section by index or name and read it without parsing what comes
+before. Indexed archives always use the chunked (streamed) format, with the
+table of contents as the last chunk. When streaming, it is written on
+destruction.
+
+Compact encoding.
+Construct the serializer with serialize_encoding::compact to write integers
+as LEB128 varints. This includes sizes, container sentinels and the size
+table. Signed integers are zigzag encoded, and sorted integer buffers are
+delta encoded. Compact archives use the chunked format, the deserializer
+detects them. Integer views (read_view) from compact archives are decoded to
+storage owned by the deserializer.
 */
 
 // #define FEA_THROW_MSG(x) std::string{ __FUNCTION__ } + " : " + x
@@ -65,6 +102,51 @@ static_assert(std::is_unsigned_v<FEA_SERIALIZE_SIZE_T>,
 
 namespace fea {
 namespace detail {
+// Streamed files start with this, in place of the size table count.
+// Archives whose size table doesn't fit one count also use chunks.
+// They are followed by chunks of :
+// [count][size_token * count][uint64_t data size][data]
+// Indexed archives end with a table of contents chunk :
+// [sentinel][uint64_t section count]
+// [uint64_t table index, uint64_t data offset, uint64_t name size, name] * n
+template <class MSizeT>
+inline constexpr MSizeT stream_sentinel = (std::numeric_limits<MSizeT>::max)();
+
+// Compact archives start with this, and are otherwise streamed archives.
+// Size tokens are varints, and so is integer data.
+template <class MSizeT>
+inline constexpr MSizeT compact_sentinel = stream_sentinel<MSizeT> - 1;
+
+// Size table counts never reach the sentinels. Bigger tables are split in
+// chunks.
+template <class MSizeT>
+inline constexpr MSizeT max_table_count = compact_sentinel<MSizeT> - 1;
+
+// Integers written as varints in compact archives.
+// Single bytes and characters are written as-is.
+template <class T>
+inline constexpr bool is_varint_v = std::is_integral_v<T> && sizeof(T) > 1
+		&& !std::is_same_v<T, wchar_t> && !std::is_same_v<T, char16_t>
+		&& !std::is_same_v<T, char32_t>;
+
+template <class T>
+constexpr std::make_unsigned_t<T> to_varint(T v) noexcept {
+	if constexpr (std::is_signed_v<T>) {
+		return fea::zigzag_encode(v);
+	} else {
+		return v;
+	}
+}
+
+template <class T>
+constexpr T from_varint(std::make_unsigned_t<T> u) noexcept {
+	if constexpr (std::is_signed_v<T>) {
+		return fea::zigzag_decode<T>(u);
+	} else {
+		return u;
+	}
+}
+
 struct size_token {
 	// The size of a given objects.
 	FEA_SERIALIZE_SIZE_T size = 0;
@@ -73,8 +155,25 @@ struct size_token {
 };
 static_assert(std::is_trivially_copyable_v<detail::size_token>,
 		"fea::serializer : something has gone horribly wrong");
+
+struct section_token {
+	std::string name;
+	// The first size token of the section, in the whole size table.
+	uint64_t table_idx = 0;
+	// The section's byte offset, in the whole data.
+	uint64_t data_offset = 0;
+};
 } // namespace detail
 
+// How integers are written.
+enum class serialize_encoding : uint8_t {
+	// As-is, fixed width.
+	fixed,
+	// LEB128 varints, zigzag and delta encoded.
+	compact,
+	count,
+};
+
 // Builds data in memory and serializes to file or makes it available to user.
 struct serializer {
 	using msize_t = FEA_SERIALIZE_SIZE_T;
@@ -82,11 +181,50 @@ struct serializer {
 	// Serialize data only.
 	serializer() = default;
 
+	// Serialize data only, with the provided encoding.
+	explicit serializer(serialize_encoding encoding)
+			: _encoding(encoding) {
+	}
+
 	// Serialize to file.
-	serializer(const std::filesystem::path& filepath)
-			: _filepath(filepath) {
+	serializer(const std::filesystem::path& filepath,
+			serialize_encoding encoding = serialize_encoding::fixed)
+			: _filepath(filepath)
+			, _encoding(encoding) {
 	}
 
+	// Stream to file, buffering at most buffer_size bytes.
+	serializer(const std::filesystem::path& filepath, size_t buffer_size,
+			serialize_encoding encoding = serialize_encoding::fixed)
+			: _filepath(filepath)
+			, _buffer_size(buffer_size)
+			, _encoding(encoding) {
+		assert(_buffer_size != 0);
+		_file = fea::fopen(_filepath, "wb");
+		if (_file == nullptr) {
+			fea::maybe_throw(__FUNCTION__, __LINE__,
+					"Couldn't open file '" + _filepath.string() + "'.");
+			return;
+		}
+
+		msize_t sentinel = is_compact() ? detail::compact_sentinel<msize_t>
+										: detail::stream_sentinel<msize_t>;
+		if (!write_file(&sentinel, sizeof(sentinel))) {
+			// The destructor doesn't run if we throw.
+			std::fclose(_file);
+			_file = nullptr;
+			fea::maybe_throw(__FUNCTION__, __LINE__,
+					"Couldn't write to file '" + _filepath.string() + "'.");
+			return;
+		}
+		_data.reserve(_buffer_size);
+	}
+
+	serializer(const serializer&) = delete;
+	serializer& operator=(const serializer&) = delete;
+
+	// Writes to file if you haven't called close.
+	// Destructors can't throw, errors are only printed.
 	~serializer() {
 		if (_filepath.empty()) {
 			// Make sure user extracted data, or else pointless.
@@ -95,20 +233,32 @@ struct serializer {
 			return;
 		}
 
-		std::FILE* ofs = fea::fopen(_filepath, "wb");
-		if (ofs == nullptr) {
-			fea::print_error_message(__FUNCTION__, __LINE__,
-					"Couldn't open file '" + _filepath.string() + "'.");
+		if (_is_closed) {
 			return;
 		}
 
-		fea::on_exit e{ [&ofs]() { std::fclose(ofs); } };
+		bool written = false;
+		try {
+			written = finish();
+		} catch (...) {
+		}
 
-		std::vector<std::byte> data = extract();
-		size_t written = std::fwrite(
-				data.data(), sizeof(data.front()), data.size(), ofs);
+		if (!written) {
+			fea::print_error_message(__FUNCTION__, __LINE__,
+					"Couldn't write to file '" + _filepath.string() + "'.");
+		}
+	}
 
-		if (written != data.size()) {
+	// Writes everything to file and closes it. When streaming, writes the
+	// buffered data and the table of contents.
+	// Call this to handle errors, which the destructor can't report.
+	// Does nothing when serializing data only. Don't write after closing.
+	void close() {
+		if (_filepath.empty() || _is_closed) {
+			return;
+		}
+
+		if (!finish()) {
 			fea::maybe_throw(__FUNCTION__, __LINE__,
 					"Couldn't write to file '" + _filepath.string() + "'.");
 		}
@@ -123,8 +273,17 @@ struct serializer {
 				"You must implement 'friend void serialize(const T&, "
 				"fea::serializer&);'");
 
+		if constexpr (detail::is_varint_v<T>) {
+			if (is_compact()) {
+				std::byte buf[fea::varint_max_size<std::make_unsigned_t<T>>];
+				std::byte* end = fea::varint_encode(detail::to_varint(t), buf);
+				push_data(buf, size_t(end - buf));
+				return;
+			}
+		}
+
 		// No count sentinel for single objects.
-		push_back(&t, 1, &_data);
+		push_data(&t, sizeof(T));
 	}
 
 	// Overload for single objects.
@@ -144,12 +303,59 @@ struct serializer {
 				"You must implement 'friend void serialize(const T&, "
 				"fea::serializer&);'");
 
-		push_back(ts, count, &_data);
+		if constexpr (detail::is_varint_v<T>) {
+			if (is_compact()) {
+				push_varints(ts, count);
+				push_size_token(sizeof(T));
+				return;
+			}
+		}
+
+		push_data(ts, sizeof(T) * count);
 		push_size_token(sizeof(T));
 	}
 
+	// Returns how integers are written.
+	[[nodiscard]] serialize_encoding encoding() const noexcept {
+		return _encoding;
+	}
+
+	// Starts a new top-level section, which can be read directly by the
+	// deserializer. Sections are numbered in order, names are optional.
+	void begin_section(std::string_view name = {}) {
+		_sections.push_back({ std::string{ name },
+				uint64_t(_size_table_base + _size_table.size()),
+				uint64_t(_data_base + _data.size()) });
+		_section_break = true;
+	}
+
+	// Is this serializer streaming to file?
+	[[nodiscard]] bool is_streaming() const noexcept {
+		return _file != nullptr;
+	}
+
+	// When streaming, writes buffered data to file.
+	// Otherwise, does nothing, data is written on close or destruction.
+	void flush() {
+		if (!is_streaming()) {
+			return;
+		}
+
+		if (!write_buffered() || std::fflush(_file) != 0) {
+			fea::maybe_throw(__FUNCTION__, __LINE__,
+					"Couldn't write to file '" + _filepath.string() + "'.");
+		}
+	}
+
 	// Moves out the serialized data. Serializer is left empty.
+	// Unavailable when streaming.
 	[[nodiscard]] std::vector<std::byte> extract() {
+		if (is_streaming()) {
+			fea::maybe_throw(__FUNCTION__, __LINE__,
+					"Cannot extract data from a streaming serializer.");
+			return {};
+		}
+
 		if (_data.empty()) {
 			assert(_size_table.empty());
 			return {};
@@ -159,6 +365,9 @@ struct serializer {
 		fea::on_exit e{ [this]() {
 			_size_table.clear();
 			_data.clear();
+			_splits.clear();
+			_sections.clear();
+			_section_break = false;
 		} };
 
 		// size_table data + 2 count sentinels.
@@ -168,6 +377,34 @@ struct serializer {
 		std::vector<std::byte> ret;
 		ret.reserve(table_byte_size + _data.size());
 
+		if (!_sections.empty() || is_compact() || !_splits.empty()) {
+			// Indexed, compact or too big for one size table, write as
+			// chunks followed by the toc.
+			msize_t sentinel = is_compact() ? detail::compact_sentinel<msize_t>
+											: detail::stream_sentinel<msize_t>;
+			push_back(&sentinel, 1, &ret);
+
+			_splits.push_back({ _size_table.size(), _data.size() });
+			size_t table_begin = 0;
+			size_t data_begin = 0;
+			for (const std::pair<size_t, size_t>& split : _splits) {
+				msize_t table_count = msize_t(split.first - table_begin);
+				uint64_t data_size = uint64_t(split.second - data_begin);
+				push_back(&table_count, 1, &ret);
+				push_table(table_begin, split.first, &ret);
+				push_back(&data_size, 1, &ret);
+				push_back(_data.data() + data_begin, size_t(data_size), &ret);
+				table_begin = split.first;
+				data_begin = split.second;
+			}
+
+			if (!_sections.empty()) {
+				std::vector<std::byte> toc = toc_bytes();
+				push_back(toc.data(), toc.size(), &ret);
+			}
+			return ret;
+		}
+
 		// Write size_table to beginning of data stream.
 
 		// Sentinel for deserializing.
@@ -183,17 +420,229 @@ struct serializer {
 
 	// Reserve more memory, in bytes.
 	// Don't need to call this when serializing containers.
+	// Does nothing when streaming.
 	void reserve(size_t new_cap_bytes) {
+		if (is_streaming()) {
+			return;
+		}
 		_data.reserve(_data.capacity() + new_cap_bytes);
 	}
 
 	// Overload that computes reserve bytes for T and count.
 	template <class T>
 	void reserve(size_t count) {
-		_data.reserve(_data.capacity() + sizeof(T) * count);
+		reserve(sizeof(T) * count);
 	}
 
 private:
+	[[nodiscard]] bool is_compact() const noexcept {
+		return _encoding == serialize_encoding::compact;
+	}
+
+	// Appends integers as varints. Sorted buffers are delta encoded.
+	// Prefixed with a delta flag byte.
+	// The encoded size is computed first, then varints are encoded directly
+	// in the data buffer, or in small chunks to file when streaming big
+	// buffers. Scratch memory doesn't grow with the buffer.
+	template <class T>
+	void push_varints(const T* ts, size_t count) {
+		using U = std::make_unsigned_t<T>;
+		const bool delta = count > 1 && std::is_sorted(ts, ts + count);
+		auto value_at = [&](size_t i) {
+			return delta && i != 0 ? U(U(ts[i]) - U(ts[i - 1]))
+								   : U(detail::to_varint(ts[i]));
+		};
+
+		size_t byte_size = 1;
+		for (size_t i = 0; i < count; ++i) {
+			byte_size += fea::varint_size(value_at(i));
+		}
+
+		if (is_streaming()) {
+			size_t buffered = _data.size()
+					+ _size_table.size() * sizeof(detail::size_token);
+			if (buffered + byte_size > _buffer_size) {
+				flush();
+			}
+
+			if (byte_size > _buffer_size) {
+				// Write in fixed size chunks, in one archive chunk.
+				constexpr size_t chunk_size = 4'096;
+				std::byte buf[chunk_size];
+				std::byte* out = buf;
+				*out++ = std::byte(uint8_t(delta));
+
+				bool ok = write_chunk_header(byte_size);
+				for (size_t i = 0; i < count; ++i) {
+					if (size_t(buf + chunk_size - out) < varint_max_size<U>) {
+						ok = write_file(buf, size_t(out - buf)) && ok;
+						out = buf;
+					}
+					out = fea::varint_encode(value_at(i), out);
+				}
+				ok = write_file(buf, size_t(out - buf)) && ok;
+
+				if (!ok) {
+					fea::maybe_throw(__FUNCTION__, __LINE__,
+							"Couldn't write to file '" + _filepath.string()
+									+ "'.");
+				}
+				return;
+			}
+		}
+
+		size_t begin = _data.size();
+		_data.resize(begin + byte_size);
+		std::byte* out = _data.data() + begin;
+		*out++ = std::byte(uint8_t(delta));
+		for (size_t i = 0; i < count; ++i) {
+			out = fea::varint_encode(value_at(i), out);
+		}
+		assert(out == _data.data() + _data.size());
+	}
+
+	// Appends size tokens [first, last) to out, as varints when compact.
+	void push_table(size_t first, size_t last, std::vector<std::byte>* out)
+			const {
+		assert(first <= last && last <= _size_table.size());
+		if (!is_compact()) {
+			push_back(_size_table.data() + first, last - first, out);
+			return;
+		}
+
+		size_t begin = out->size();
+		out->resize(begin + (last - first) * 2 * fea::varint_max_size<msize_t>);
+		std::byte* it = out->data() + begin;
+		for (size_t i = first; i < last; ++i) {
+			it = fea::varint_encode(_size_table[i].size, it);
+			it = fea::varint_encode(_size_table[i].count, it);
+		}
+		out->resize(size_t(it - out->data()));
+	}
+
+	// Appends bytes to data. When streaming, flushes if the buffer is full
+	// and writes big buffers directly.
+	void push_data(const void* src, size_t byte_size) {
+		if (is_streaming()) {
+			size_t buffered = _data.size()
+					+ _size_table.size() * sizeof(detail::size_token);
+			if (buffered + byte_size > _buffer_size) {
+				flush();
+			}
+
+			if (byte_size > _buffer_size) {
+				if (!write_chunk(src, byte_size)) {
+					fea::maybe_throw(__FUNCTION__, __LINE__,
+							"Couldn't write to file '" + _filepath.string()
+									+ "'.");
+				}
+				return;
+			}
+		}
+
+		size_t begin = _data.size();
+		_data.resize(_data.size() + byte_size);
+		std::memcpy(_data.data() + begin, src, byte_size);
+	}
+
+	// Writes a chunk with the current size table and provided data.
+	// Clears the size table. Returns false if writing failed.
+	[[nodiscard]] bool write_chunk(const void* data, size_t byte_size) {
+		bool ret = write_chunk_header(byte_size);
+		return write_file(data, byte_size) && ret;
+	}
+
+	// Writes a chunk's size table and data size, the byte_size data bytes
+	// must be written next. Clears the size table. Returns false if writing
+	// failed.
+	[[nodiscard]] bool write_chunk_header(size_t byte_size) {
+		assert(is_streaming());
+		msize_t table_count = msize_t(_size_table.size());
+		uint64_t data_size = uint64_t(byte_size);
+		bool ret = write_file(&table_count, sizeof(table_count));
+		if (is_compact()) {
+			std::vector<std::byte> table;
+			push_table(0, _size_table.size(), &table);
+			ret = write_file(table.data(), table.size()) && ret;
+		} else {
+			ret = write_file(_size_table.data(),
+						  sizeof(detail::size_token) * _size_table.size())
+					&& ret;
+		}
+		ret = write_file(&data_size, sizeof(data_size)) && ret;
+		_size_table_base += _size_table.size();
+		_data_base += byte_size;
+		_size_table.clear();
+		return ret;
+	}
+
+	// When streaming, writes the buffered data and size table as a chunk.
+	// Returns false if writing failed.
+	[[nodiscard]] bool write_buffered() {
+		if (_data.empty() && _size_table.empty()) {
+			return true;
+		}
+
+		bool ret = write_chunk(_data.data(), _data.size());
+		_data.clear();
+		return ret;
+	}
+
+	// Writes everything left to file and closes it.
+	// Returns false on failure, doesn't report errors.
+	[[nodiscard]] bool finish() {
+		assert(!_filepath.empty());
+		_is_closed = true;
+
+		if (is_streaming()) {
+			bool ret = write_buffered();
+			if (!_sections.empty()) {
+				std::vector<std::byte> toc = toc_bytes();
+				ret = write_file(toc.data(), toc.size()) && ret;
+			}
+			ret = std::fclose(_file) == 0 && ret;
+			_file = nullptr;
+			return ret;
+		}
+
+		std::FILE* ofs = fea::fopen(_filepath, "wb");
+		if (ofs == nullptr) {
+			return false;
+		}
+
+		std::vector<std::byte> data = extract();
+		size_t written = std::fwrite(
+				data.data(), sizeof(data.front()), data.size(), ofs);
+		return std::fclose(ofs) == 0 && written == data.size();
+	}
+
+	// The table of contents chunk.
+	[[nodiscard]] std::vector<std::byte> toc_bytes() const {
+		std::vector<std::byte> ret;
+		msize_t sentinel = detail::stream_sentinel<msize_t>;
+		uint64_t section_count = uint64_t(_sections.size());
+		push_back(&sentinel, 1, &ret);
+		push_back(&section_count, 1, &ret);
+		for (const detail::section_token& sec : _sections) {
+			uint64_t name_size = uint64_t(sec.name.size());
+			push_back(&sec.table_idx, 1, &ret);
+			push_back(&sec.data_offset, 1, &ret);
+			push_back(&name_size, 1, &ret);
+			push_back(sec.name.data(), sec.name.size(), &ret);
+		}
+		return ret;
+	}
+
+	// Returns false if writing failed.
+	[[nodiscard]] bool write_file(const void* data, size_t byte_size) {
+		if (byte_size == 0) {
+			return true;
+		}
+
+		size_t written = std::fwrite(data, 1, byte_size, _file);
+		return written == byte_size;
+	}
+
 	template <class T>
 	static void push_back(
 			const T* ts, size_t count, std::vector<std::byte>* vec) {
@@ -204,15 +653,34 @@ private:
 
 	void push_size_token(size_t obj_size) {
 		assert(obj_size != 0);
-
-		if (!_size_table.empty() && _size_table.back().size == obj_size) {
+		assert(obj_size <= (std::numeric_limits<msize_t>::max)()
+				&& "fea::serializer : object too big for FEA_SERIALIZE_SIZE_T");
+
+		// Sections start with a new token, so they can be read directly.
+		if (!_section_break && !_size_table.empty()
+				&& _size_table.back().size == obj_size
+				&& _size_table.back().count
+						!= (std::numeric_limits<msize_t>::max)()) {
 			// Previous objects were same size, increment count.
 			++_size_table.back().count;
 			return;
 		}
 
-		// If not, add new size token.
+		// The table count would collide with the format sentinels, start a
+		// new chunk. Data writes are whole, so any token is a valid split.
+		size_t table_begin = _splits.empty() ? 0 : _splits.back().first;
+		if (_size_table.size() - table_begin
+				== detail::max_table_count<msize_t>) {
+			if (is_streaming()) {
+				flush();
+			} else {
+				_splits.push_back({ _size_table.size(), _data.size() });
+			}
+		}
+
+		// Add new size token.
 		_size_table.push_back({ msize_t(obj_size), msize_t(1) });
+		_section_break = false;
 	}
 
 	// The file to write.
@@ -225,8 +693,30 @@ private:
 	std::vector<detail::size_token> _size_table;
 
 	// The data to serialize. First stored in vector and written to file in one
-	// go.
+	// go. When streaming, this is the bounded buffer.
 	std::vector<std::byte> _data;
+
+	// When streaming, the opened file and maximum buffered bytes.
+	std::FILE* _file = nullptr;
+	size_t _buffer_size = 0;
+
+	// Set once data is written to file, by close or the destructor.
+	bool _is_closed = false;
+
+	// When streaming, the size tokens and bytes already written to file.
+	size_t _size_table_base = 0;
+	size_t _data_base = 0;
+
+	// When not streaming, where the size table and data are split in
+	// chunks [size token, data offset). Only used by huge size tables.
+	std::vector<std::pair<size_t, size_t>> _splits;
+
+	// Indexed archive sections.
+	std::vector<detail::section_token> _sections;
+	bool _section_break = false;
+
+	// How integers are written.
+	serialize_encoding _encoding = serialize_encoding::fixed;
 };
 
 struct deserializer {
@@ -235,19 +725,13 @@ struct deserializer {
 	// Deserialize from memory.
 	deserializer(const std::vector<std::byte>& data)
 			: _data(data) {
-		if (!deserialize_size_table()) {
-			_is_gucci = false;
-			clear();
-		}
+		init(_data.data(), _data.size());
 	}
 
 	// Deserialize from memory.
 	deserializer(std::vector<std::byte>&& data)
 			: _data(std::move(data)) {
-		if (!deserialize_size_table()) {
-			_is_gucci = false;
-			clear();
-		}
+		init(_data.data(), _data.size());
 	}
 
 	// Deserialize from file.
@@ -276,12 +760,28 @@ struct deserializer {
 					"Problem reading file '" + _filepath.string() + "'.");
 		}
 
-		if (!deserialize_size_table()) {
+		init(_data.data(), _data.size());
+	}
+
+	// Deserialize from a memory-mapped file, without copying it.
+	// Takes ownership of the mapping.
+	explicit deserializer(fea::basic_fmap_read&& mapped)
+			: _map(std::move(mapped)) {
+		if (!_map.is_open()) {
+			fea::print_error_message(
+					__FUNCTION__, __LINE__, "File map isn't open.");
 			_is_gucci = false;
-			clear();
+			return;
 		}
+
+		init(_map.data(), _map.size());
 	}
 
+	deserializer(deserializer&&) noexcept = default;
+	deserializer& operator=(deserializer&&) noexcept = default;
+	deserializer(const deserializer&) = delete;
+	deserializer& operator=(const deserializer&) = delete;
+
 	// Check if constructors executed correctly.
 	[[nodiscard]] bool is_gucci() const noexcept {
 		return _is_gucci;
@@ -292,8 +792,81 @@ struct deserializer {
 		_size_table.clear();
 		_deserialized_counts.clear();
 		_data.clear();
+		_map.close();
+		_bytes = nullptr;
+		_view_copies.clear();
+		_chunks.clear();
+		_sections.clear();
+		_encoding = serialize_encoding::fixed;
 		_size_table_idx = 0;
+		_read_begin = 0;
+		_chunk_idx = 0;
 		_data_idx = 0;
+		_data_end = 0;
+	}
+
+	// Returns how integers were written.
+	[[nodiscard]] serialize_encoding encoding() const noexcept {
+		return _encoding;
+	}
+
+	// Returns the number of sections in an indexed archive.
+	[[nodiscard]] size_t section_count() const noexcept {
+		return _sections.size();
+	}
+
+	// Returns the name of a section, may be empty.
+	[[nodiscard]] std::string_view section_name(size_t section_idx) const {
+		assert(section_idx < _sections.size());
+		return _sections[section_idx].name;
+	}
+
+	// Moves reading to the beginning of a section.
+	// Returns false if the section doesn't exist.
+	[[nodiscard]] bool seek(size_t section_idx) {
+		if (section_idx >= _sections.size()) {
+			return false;
+		}
+
+		// Reset the counts read since the last seek.
+		size_t read_end
+				= (std::min)(_size_table_idx + 1, _deserialized_counts.size());
+		std::fill(_deserialized_counts.begin() + _read_begin,
+				_deserialized_counts.begin() + read_end, msize_t(0));
+
+		const section_info& sec = _sections[section_idx];
+		_size_table_idx = sec.table_idx;
+		_read_begin = sec.table_idx;
+		if (_size_table_idx != _size_table.size()
+				&& (_size_table[_size_table_idx].size == 0
+						|| _size_table[_size_table_idx].count == 0)) {
+			assert(false);
+			return false;
+		}
+
+		if (sec.chunk_idx == _chunks.size()) {
+			// Empty section at the end.
+			_chunk_idx = _chunks.size();
+			_data_idx = 0;
+			_data_end = 0;
+			return true;
+		}
+
+		_chunk_idx = sec.chunk_idx + 1;
+		_data_idx = sec.data_idx;
+		_data_end = _chunks[sec.chunk_idx].second;
+		return true;
+	}
+
+	// Moves reading to the beginning of the first section with this name.
+	// Returns false if the section doesn't exist.
+	[[nodiscard]] bool seek(std::string_view name) {
+		auto it = std::find_if(_sections.begin(), _sections.end(),
+				[&](const section_info& sec) { return sec.name == name; });
+		if (it == _sections.end()) {
+			return false;
+		}
+		return seek(size_t(it - _sections.begin()));
 	}
 
 	// Doesn't register type sizes. Used for sentinels.
@@ -304,6 +877,12 @@ struct deserializer {
 				"type. "
 				"You must implement 'friend bool deserialize(T&, "
 				"fea::deserializer&);'");
+
+		if constexpr (detail::is_varint_v<T>) {
+			if (is_compact()) {
+				return pop_varint(t);
+			}
+		}
 		return pop_front(&t, 1);
 	}
 
@@ -335,11 +914,69 @@ struct deserializer {
 		}
 
 		// Size matches, deserialize.
+		if constexpr (detail::is_varint_v<T>) {
+			if (is_compact()) {
+				return pop_varints(t, count);
+			}
+		}
 		return pop_front(t, count);
 	}
 
+	// Overload for object buffers, without copying.
+	// Points t to count objects in the deserializer's data. If the data
+	// isn't aligned for T, or for integers in compact archives, the objects
+	// are copied to storage owned by the deserializer instead.
+	template <class T>
+	[[nodiscard]] bool read_view(const T*& t, size_t count) {
+		static_assert(std::is_trivially_copyable_v<T>,
+				"fea::deserializer : Cannot deserialize non-trivially copyable "
+				"type. "
+				"You must implement 'friend bool deserialize(T&, "
+				"fea::deserializer&);'");
+
+		if (!validate_size<T>()) {
+			return false;
+		}
+
+		if constexpr (detail::is_varint_v<T>) {
+			if (is_compact()) {
+				T* copy = view_storage<T>(count);
+				if (!pop_varints(copy, count)) {
+					return false;
+				}
+				t = copy;
+				return true;
+			}
+		}
+
+		const std::byte* ptr = pop_bytes<T>(count);
+		if (ptr == nullptr) {
+			return false;
+		}
+
+		if (reinterpret_cast<std::uintptr_t>(ptr) % alignof(T) != 0) {
+			T* copy = view_storage<T>(count);
+			std::memcpy(static_cast<void*>(copy), ptr, sizeof(T) * count);
+			t = copy;
+			return true;
+		}
+
+		t = reinterpret_cast<const T*>(ptr);
+		return true;
+	}
+
 
 private:
+	// Reads the size table of bytes and prepares deserialization.
+	void init(const std::byte* bytes, size_t byte_size) {
+		_bytes = bytes;
+		_data_end = byte_size;
+		if (!deserialize_size_table()) {
+			_is_gucci = false;
+			clear();
+		}
+	}
+
 	// Deserializes data into memory.
 	// Prepares structure.
 	[[nodiscard]] bool deserialize_size_table() {
@@ -348,6 +985,15 @@ private:
 			return false;
 		}
 
+		if (size_table_count == detail::stream_sentinel<msize_t>) {
+			return deserialize_chunks();
+		}
+
+		if (size_table_count == detail::compact_sentinel<msize_t>) {
+			_encoding = serialize_encoding::compact;
+			return deserialize_chunks();
+		}
+
 		_size_table.resize(size_table_count);
 		if (!pop_front(_size_table.data(), _size_table.size())) {
 			return false;
@@ -364,6 +1010,151 @@ private:
 			return false;
 		}
 
+		return validate_size_table();
+	}
+
+	// Streamed data. Gathers chunk size tables and the position of chunk
+	// data. Single writes never span chunks, so data is read in place.
+	[[nodiscard]] bool deserialize_chunks() {
+		while (_data_idx != _data_end) {
+			msize_t table_count = 0;
+			if (!pop_front(&table_count, 1)) {
+				return false;
+			}
+
+			if (table_count == detail::stream_sentinel<msize_t>) {
+				if (!deserialize_toc()) {
+					return false;
+				}
+				break;
+			}
+
+			// Compact tokens are at least 2 bytes.
+			size_t min_token_size
+					= is_compact() ? 2 : sizeof(detail::size_token);
+			if (table_count > (_data_end - _data_idx) / min_token_size) {
+				// Corrupted data.
+				assert(false);
+				return false;
+			}
+
+			size_t table_begin = _size_table.size();
+			_size_table.resize(table_begin + table_count);
+			if (is_compact()) {
+				for (size_t i = table_begin; i < _size_table.size(); ++i) {
+					if (!pop_varint(_size_table[i].size)
+							|| !pop_varint(_size_table[i].count)) {
+						return false;
+					}
+				}
+			} else if (table_count != 0
+					&& !pop_front(_size_table.data() + table_begin,
+							table_count)) {
+				return false;
+			}
+
+			uint64_t data_size = 0;
+			if (!pop_front(&data_size, 1)) {
+				return false;
+			}
+
+			if (data_size > _data_end - _data_idx) {
+				// Corrupted data.
+				assert(false);
+				return false;
+			}
+
+			if (data_size != 0) {
+				_chunks.push_back(
+						{ _data_idx, _data_idx + size_t(data_size) });
+			}
+			_data_idx += size_t(data_size);
+		}
+
+		// Everything is consumed, the next read moves to the first chunk.
+		return validate_size_table();
+	}
+
+	// Reads the table of contents, the last chunk of indexed archives.
+	// Resolves section data offsets to chunk positions.
+	[[nodiscard]] bool deserialize_toc() {
+		uint64_t section_count = 0;
+		if (!pop_front(&section_count, 1)) {
+			return false;
+		}
+
+		// Sections are at least 3 uint64_t.
+		if (section_count
+				> (_data_end - _data_idx) / (sizeof(uint64_t) * 3)) {
+			// Corrupted data.
+			assert(false);
+			return false;
+		}
+		_sections.reserve(size_t(section_count));
+
+		// Sections are in order, walk the chunks once.
+		size_t chunk_idx = 0;
+		size_t chunk_offset = 0;
+		for (uint64_t i = 0; i < section_count; ++i) {
+			uint64_t toc[3]{};
+			if (!pop_front(toc, 3)) {
+				return false;
+			}
+
+			uint64_t table_idx = toc[0];
+			uint64_t data_offset = toc[1];
+			uint64_t name_size = toc[2];
+			if (table_idx > _size_table.size() || data_offset < chunk_offset
+					|| name_size > _data_end - _data_idx) {
+				// Corrupted data.
+				assert(false);
+				return false;
+			}
+
+			std::string_view name{
+				reinterpret_cast<const char*>(_bytes + _data_idx),
+				size_t(name_size),
+			};
+			_data_idx += size_t(name_size);
+
+			while (chunk_idx != _chunks.size()) {
+				size_t chunk_size
+						= _chunks[chunk_idx].second - _chunks[chunk_idx].first;
+				if (data_offset < chunk_offset + chunk_size) {
+					break;
+				}
+				chunk_offset += chunk_size;
+				++chunk_idx;
+			}
+
+			size_t data_idx = 0;
+			if (chunk_idx != _chunks.size()) {
+				data_idx = _chunks[chunk_idx].first
+						+ size_t(data_offset - chunk_offset);
+			} else if (data_offset != chunk_offset) {
+				// Corrupted data.
+				assert(false);
+				return false;
+			}
+
+			_sections.push_back(
+					{ name, size_t(table_idx), chunk_idx, data_idx });
+		}
+
+		// The toc is the last chunk.
+		if (_data_idx != _data_end) {
+			assert(false);
+			return false;
+		}
+		return true;
+	}
+
+	// Checks the first size token and prepares deserialization.
+	[[nodiscard]] bool validate_size_table() {
+		if (_size_table.empty()) {
+			return false;
+		}
+
 		// Special check for first one.
 		if (_size_table[_size_table_idx].size == 0) {
 			assert(false);
@@ -381,23 +1172,127 @@ private:
 
 	template <class T>
 	[[nodiscard]] bool pop_front(T* t, size_t count) {
-		if (_data_idx >= _data.size()) {
-			assert(false);
+		const std::byte* ptr = pop_bytes<T>(count);
+		if (ptr == nullptr) {
 			return false;
 		}
 
-		std::memcpy(static_cast<void*>(t), _data.data() + _data_idx,
-				sizeof(T) * count);
+		std::memcpy(static_cast<void*>(t), ptr, sizeof(T) * count);
+		return true;
+	}
+
+	// Returns the position of count T and advances, or nullptr if there
+	// isn't enough data.
+	template <class T>
+	[[nodiscard]] const std::byte* pop_bytes(size_t count) {
+		next_chunk();
+		if (_data_idx >= _data_end
+				|| count > (_data_end - _data_idx) / sizeof(T)) {
+			assert(false);
+			return nullptr;
+		}
+
+		const std::byte* ret = _bytes + _data_idx;
 		_data_idx += sizeof(T) * count;
+		return ret;
+	}
+
+	// Moves to the next chunk if the current one is consumed.
+	void next_chunk() noexcept {
+		if (_data_idx == _data_end && _chunk_idx < _chunks.size()) {
+			_data_idx = _chunks[_chunk_idx].first;
+			_data_end = _chunks[_chunk_idx].second;
+			++_chunk_idx;
+		}
+	}
+
+	[[nodiscard]] bool is_compact() const noexcept {
+		return _encoding == serialize_encoding::compact;
+	}
+
+	template <class T>
+	[[nodiscard]] bool pop_varint(T& t) {
+		next_chunk();
+		std::make_unsigned_t<T> u = 0;
+		const std::byte* end = fea::varint_decode(
+				_bytes + _data_idx, _bytes + _data_end, u);
+		if (end == nullptr) {
+			assert(false);
+			return false;
+		}
+
+		_data_idx = size_t(end - _bytes);
+		t = detail::from_varint<T>(u);
 		return true;
 	}
 
+	// Reads varints written by serializer::push_varints.
+	template <class T>
+	[[nodiscard]] bool pop_varints(T* t, size_t count) {
+		using U = std::make_unsigned_t<T>;
+
+		uint8_t delta = 0;
+		if (!pop_front(&delta, 1) || delta > 1) {
+			assert(false);
+			return false;
+		}
+
+		// Signed and unsigned integers may alias.
+		U* us = reinterpret_cast<U*>(t);
+		const std::byte* end = fea::varint_decode(
+				_bytes + _data_idx, _bytes + _data_end, us, count);
+		if (end == nullptr) {
+			assert(false);
+			return false;
+		}
+		_data_idx = size_t(end - _bytes);
+
+		if (count == 0) {
+			return true;
+		}
+
+		if (delta != 0) {
+			U prev = us[0];
+			t[0] = detail::from_varint<T>(prev);
+			prev = U(t[0]);
+			for (size_t i = 1; i < count; ++i) {
+				prev = U(prev + us[i]);
+				t[i] = T(prev);
+			}
+		} else if constexpr (std::is_signed_v<T>) {
+			for (size_t i = 0; i < count; ++i) {
+				t[i] = detail::from_varint<T>(us[i]);
+			}
+		}
+		return true;
+	}
+
+	// Returns aligned storage for count T, which lives as long as the
+	// deserializer. Used by views which can't point in the data.
+	template <class T>
+	[[nodiscard]] T* view_storage(size_t count) {
+		std::vector<std::byte>& buf = _view_copies.emplace_back();
+		buf.resize(sizeof(T) * count + alignof(T) - 1);
+		std::uintptr_t addr = reinterpret_cast<std::uintptr_t>(buf.data());
+		size_t offset = size_t((alignof(T) - addr % alignof(T)) % alignof(T));
+		return reinterpret_cast<T*>(buf.data() + offset);
+	}
+
 	template <class T>
 	[[nodiscard]] bool validate_size() {
+		if (_size_table_idx == _size_table.size()) {
+			assert(false);
+			return false;
+		}
+
 		// Check if we need to bump index.
 		if (_size_table[_size_table_idx].count
 				== _deserialized_counts[_size_table_idx]) {
 			++_size_table_idx;
+			if (_size_table_idx == _size_table.size()) {
+				assert(false);
+				return false;
+			}
 
 			// _size_table_idx 0 checks are done in ctor.
 			if (_size_table[_size_table_idx].size == 0) {
@@ -432,9 +1327,40 @@ private:
 	// The deserialized data. Read in one go from file.
 	std::vector<std::byte> _data;
 
-	// Indexes of read data.
+	// The mapped file, used instead of _data when deserializing from a map.
+	fea::basic_fmap_read _map;
+
+	// The bytes we read, either _data or _map.
+	const std::byte* _bytes = nullptr;
+
+	// Copies of views which couldn't point in _bytes.
+	// Inner buffers don't move, so views stay valid.
+	std::vector<std::vector<std::byte>> _view_copies;
+
+	// Streamed files are read chunk per chunk. Chunk data [begin, end).
+	std::vector<std::pair<size_t, size_t>> _chunks;
+
+	// Indexed archive sections.
+	struct section_info {
+		std::string_view name;
+		// First size token.
+		size_t table_idx = 0;
+		// The chunk and position of the section data.
+		size_t chunk_idx = 0;
+		size_t data_idx = 0;
+	};
+	std::vector<section_info> _sections;
+
+	// How integers were written.
+	serialize_encoding _encoding = serialize_encoding::fixed;
+
+	// Indexes of read data. _data_end is the end of the current chunk.
+	// _read_begin is the size token of the last seek.
 	size_t _size_table_idx = 0;
+	size_t _read_begin = 0;
+	size_t _chunk_idx = 0;
 	size_t _data_idx = 0;
+	size_t _data_end = 0;
 
 	bool _is_gucci = true;
 }; // namespace fea
@@ -0,0 +1,513 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/performance/cpu_dispatch.hpp"
+#include "fea/performance/intrinsics.hpp"
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits>
+
+/*
+LEB128 variable length integers, and zigzag encoding for signed integers.
+
+Varints store 7 bits per byte, the high bit flags a following byte. Small
+values take few bytes, 0 to 127 take one. Zigzag maps signed integers to
+unsigned, so small negative values are small too.
+
+The bulk decoder is runtime dispatched (see cpu_dispatch.hpp). The simd
+kernels are "masked vbyte" style : a movemask of the continuation bits gives
+the length of the next 4 varints, which selects a shuffle that spreads their
+bytes in 32 bit lanes. The 7 bit groups are then merged with shifts and masks.
+Runs of single byte varints are widened 16 (sse4.2) or 32 (avx2) at a time.
+Varints longer than 4 bytes use the scalar decoder.
+*/
+
+namespace fea {
+// The maximum encoded byte size of unsigned integer type U.
+template <class U>
+inline constexpr size_t varint_max_size = (sizeof(U) * 8 + 6) / 7;
+
+// Maps signed integers to unsigned, -1 -> 1, 1 -> 2, -2 -> 3, etc.
+template <class T>
+[[nodiscard]]
+constexpr std::make_unsigned_t<T> zigzag_encode(T v) noexcept;
+
+// Maps zigzag encoded unsigned integers back to signed.
+template <class T>
+[[nodiscard]]
+constexpr T zigzag_decode(std::make_unsigned_t<T> u) noexcept;
+
+// Returns the encoded byte size of v.
+template <class U>
+[[nodiscard]]
+constexpr size_t varint_size(U v) noexcept;
+
+// Encodes v to out, which must hold varint_max_size<U> bytes.
+// Returns the end of written bytes.
+template <class U>
+std::byte* varint_encode(U v, std::byte* out) noexcept;
+
+// Decodes one varint from [first, last).
+// Returns the end of read bytes, or nullptr if the varint is truncated or
+// doesn't fit in U.
+template <class U>
+[[nodiscard]]
+const std::byte* varint_decode(
+		const std::byte* first, const std::byte* last, U& out) noexcept;
+
+// Decodes count varints from [first, last).
+// Returns the end of read bytes, or nullptr if the data is corrupted.
+template <class U>
+[[nodiscard]]
+const std::byte* varint_decode(const std::byte* first, const std::byte* last,
+		U* out, size_t count) noexcept;
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class T>
+constexpr std::make_unsigned_t<T> zigzag_encode(T v) noexcept {
+	static_assert(std::is_signed_v<T>, "fea::zigzag_encode : T must be signed");
+	using U = std::make_unsigned_t<T>;
+	return U(U(U(v) << 1) ^ (v < 0 ? U(~U(0)) : U(0)));
+}
+
+template <class T>
+constexpr T zigzag_decode(std::make_unsigned_t<T> u) noexcept {
+	static_assert(std::is_signed_v<T>, "fea::zigzag_decode : T must be signed");
+	using U = std::make_unsigned_t<T>;
+	return T(U(u >> 1) ^ U(U(0) - U(u & 1u)));
+}
+
+template <class U>
+constexpr size_t varint_size(U v) noexcept {
+	static_assert(
+			std::is_unsigned_v<U>, "fea::varint_size : U must be unsigned");
+	size_t ret = 1;
+	while (v >= U(0x80)) {
+		++ret;
+		v = U(v >> 7);
+	}
+	return ret;
+}
+
+template <class U>
+std::byte* varint_encode(U v, std::byte* out) noexcept {
+	static_assert(
+			std::is_unsigned_v<U>, "fea::varint_encode : U must be unsigned");
+	while (v >= U(0x80)) {
+		*out++ = std::byte(uint8_t(uint8_t(v) | 0x80u));
+		v = U(v >> 7);
+	}
+	*out++ = std::byte(uint8_t(v));
+	return out;
+}
+
+template <class U>
+const std::byte* varint_decode(
+		const std::byte* first, const std::byte* last, U& out) noexcept {
+	static_assert(
+			std::is_unsigned_v<U>, "fea::varint_decode : U must be unsigned");
+	U ret = 0;
+	for (size_t shift = 0; first != last; shift += 7) {
+		if (shift >= sizeof(U) * 8) {
+			return nullptr;
+		}
+
+		uint8_t b = uint8_t(*first++);
+		if (shift + 7 > sizeof(U) * 8
+				&& ((b & 0x7fu) >> (sizeof(U) * 8 - shift)) != 0) {
+			// Overflows U.
+			return nullptr;
+		}
+		ret = U(ret | U(U(b & 0x7fu) << shift));
+		if ((b & 0x80u) == 0) {
+			out = ret;
+			return first;
+		}
+	}
+	return nullptr;
+}
+
+namespace detail {
+template <class U>
+using varint_decode_fn = const std::byte* (*)(const std::byte* first,
+		const std::byte* last, U* out, size_t count);
+
+template <class U>
+const std::byte* varint_decode_scalar(const std::byte* first,
+		const std::byte* last, U* out, size_t count) noexcept {
+	for (size_t i = 0; i < count; ++i) {
+		first = fea::varint_decode(first, last, out[i]);
+		if (first == nullptr) {
+			return nullptr;
+		}
+	}
+	return first;
+}
+
+// Shuffles which spread 4 varints of 1 to 4 bytes in 32 bit lanes.
+// Indexed by (len0 - 1) | (len1 - 1) << 2 | (len2 - 1) << 4 | (len3 - 1) << 6.
+struct varint_shuffle_table {
+	constexpr varint_shuffle_table() noexcept {
+		for (size_t idx = 0; idx < 256; ++idx) {
+			size_t offset = 0;
+			for (size_t k = 0; k < 4; ++k) {
+				size_t len = ((idx >> (2 * k)) & 3u) + 1;
+				for (size_t b = 0; b < 4; ++b) {
+					// 0x80 zeroes the byte.
+					masks[idx][4 * k + b]
+							= b < len ? uint8_t(offset + b) : uint8_t(0x80);
+				}
+				offset += len;
+			}
+		}
+	}
+
+	alignas(16) uint8_t masks[256][16]{};
+};
+inline constexpr varint_shuffle_table varint_shuffles{};
+
+// Finds the next 4 varints in a 16 byte window. ends has a bit set for the
+// last byte of each varint. Returns false if one is longer than max_len, or
+// doesn't end in the window.
+[[nodiscard]]
+inline bool varint_group(uint32_t ends, size_t max_len, size_t& shuffle_idx,
+		size_t& byte_size) noexcept {
+	ends &= 0xFFFFu;
+	shuffle_idx = 0;
+	byte_size = 0;
+	for (size_t k = 0; k < 4; ++k) {
+		if (ends == 0) {
+			return false;
+		}
+		size_t end = fea::countr_zero(ends) + 1;
+		size_t len = end - byte_size;
+		if (len > max_len) {
+			return false;
+		}
+		shuffle_idx |= (len - 1) << (2 * k);
+		byte_size = end;
+		ends &= ends - 1;
+	}
+	return true;
+}
+
+// Longest varint decoded in simd. Longer ones may overflow U or 32 bits.
+template <class U>
+inline constexpr size_t varint_simd_max_len
+		= varint_max_size<U> < 4 ? varint_max_size<U> : 4;
+
+#if FEA_DISPATCH
+// Merges the 7 bit groups of 4 bytes lanes.
+FEA_TARGET_SSE42
+inline __m128i varint_merge_sse42(__m128i x) noexcept {
+	__m128i ret = _mm_and_si128(x, _mm_set1_epi32(0x7F));
+	ret = _mm_or_si128(ret,
+			_mm_and_si128(_mm_srli_epi32(x, 1), _mm_set1_epi32(0x3F80)));
+	ret = _mm_or_si128(ret,
+			_mm_and_si128(_mm_srli_epi32(x, 2), _mm_set1_epi32(0x1FC000)));
+	ret = _mm_or_si128(ret,
+			_mm_and_si128(_mm_srli_epi32(x, 3), _mm_set1_epi32(0xFE00000)));
+	return ret;
+}
+
+// Stores 4 decoded 32 bit lanes to out.
+// Returns false if a value doesn't fit in U.
+template <class U>
+FEA_TARGET_SSE42 inline bool varint_store4_sse42(U* out, __m128i v) noexcept {
+	if constexpr (sizeof(U) == 2) {
+		if (!_mm_testz_si128(v, _mm_set1_epi32(int(0xFFFF0000)))) {
+			return false;
+		}
+		_mm_storel_epi64(
+				reinterpret_cast<__m128i*>(out), _mm_packus_epi32(v, v));
+	} else if constexpr (sizeof(U) == 4) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out), v);
+	} else {
+		_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(out), _mm_cvtepu32_epi64(v));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(out + 2),
+				_mm_cvtepu32_epi64(_mm_srli_si128(v, 8)));
+	}
+	return true;
+}
+
+// Widens 16 single byte varints to out.
+template <class U>
+FEA_TARGET_SSE42 inline void varint_store16_sse42(
+		U* out, __m128i b) noexcept {
+	__m128i* dst = reinterpret_cast<__m128i*>(out);
+	if constexpr (sizeof(U) == 2) {
+		_mm_storeu_si128(dst, _mm_cvtepu8_epi16(b));
+		_mm_storeu_si128(dst + 1, _mm_cvtepu8_epi16(_mm_srli_si128(b, 8)));
+	} else if constexpr (sizeof(U) == 4) {
+		_mm_storeu_si128(dst, _mm_cvtepu8_epi32(b));
+		_mm_storeu_si128(dst + 1, _mm_cvtepu8_epi32(_mm_srli_si128(b, 4)));
+		_mm_storeu_si128(dst + 2, _mm_cvtepu8_epi32(_mm_srli_si128(b, 8)));
+		_mm_storeu_si128(dst + 3, _mm_cvtepu8_epi32(_mm_srli_si128(b, 12)));
+	} else {
+		_mm_storeu_si128(dst, _mm_cvtepu8_epi64(b));
+		_mm_storeu_si128(dst + 1, _mm_cvtepu8_epi64(_mm_srli_si128(b, 2)));
+		_mm_storeu_si128(dst + 2, _mm_cvtepu8_epi64(_mm_srli_si128(b, 4)));
+		_mm_storeu_si128(dst + 3, _mm_cvtepu8_epi64(_mm_srli_si128(b, 6)));
+		_mm_storeu_si128(dst + 4, _mm_cvtepu8_epi64(_mm_srli_si128(b, 8)));
+		_mm_storeu_si128(dst + 5, _mm_cvtepu8_epi64(_mm_srli_si128(b, 10)));
+		_mm_storeu_si128(dst + 6, _mm_cvtepu8_epi64(_mm_srli_si128(b, 12)));
+		_mm_storeu_si128(dst + 7, _mm_cvtepu8_epi64(_mm_srli_si128(b, 14)));
+	}
+}
+
+// Decodes up to 16 varints from 16 readable bytes.
+// Returns the number of varints decoded, 0 if the group must be decoded by
+// the scalar decoder. Sets error if a value doesn't fit in U.
+template <class U>
+FEA_TARGET_SSE42 inline size_t varint_step_sse42(const std::byte* first,
+		U* out, size_t count, size_t& byte_size, bool& error) noexcept {
+	__m128i b = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+	uint32_t ends = ~uint32_t(_mm_movemask_epi8(b)) & 0xFFFFu;
+	if (ends == 0xFFFFu && count >= 16) {
+		varint_store16_sse42(out, b);
+		byte_size = 16;
+		return 16;
+	}
+
+	size_t idx = 0;
+	if (count < 4
+			|| !varint_group(ends, varint_simd_max_len<U>, idx, byte_size)) {
+		return 0;
+	}
+
+	__m128i shuf = _mm_load_si128(
+			reinterpret_cast<const __m128i*>(varint_shuffles.masks[idx]));
+	__m128i v = varint_merge_sse42(_mm_shuffle_epi8(b, shuf));
+	error = !varint_store4_sse42(out, v);
+	return 4;
+}
+
+template <class U>
+FEA_TARGET_SSE42 const std::byte* varint_decode_sse42(const std::byte* first,
+		const std::byte* last, U* out, size_t count) noexcept {
+	size_t i = 0;
+	while (i != count) {
+		if (size_t(last - first) >= 16) {
+			size_t byte_size = 0;
+			bool error = false;
+			size_t n = varint_step_sse42(
+					first, out + i, count - i, byte_size, error);
+			if (error) {
+				return nullptr;
+			}
+			if (n != 0) {
+				first += byte_size;
+				i += n;
+				continue;
+			}
+		}
+
+		first = fea::varint_decode(first, last, out[i]);
+		if (first == nullptr) {
+			return nullptr;
+		}
+		++i;
+	}
+	return first;
+}
+
+FEA_TARGET_AVX2
+inline __m256i varint_merge_avx2(__m256i x) noexcept {
+	__m256i ret = _mm256_and_si256(x, _mm256_set1_epi32(0x7F));
+	ret = _mm256_or_si256(ret,
+			_mm256_and_si256(
+					_mm256_srli_epi32(x, 1), _mm256_set1_epi32(0x3F80)));
+	ret = _mm256_or_si256(ret,
+			_mm256_and_si256(
+					_mm256_srli_epi32(x, 2), _mm256_set1_epi32(0x1FC000)));
+	ret = _mm256_or_si256(ret,
+			_mm256_and_si256(
+					_mm256_srli_epi32(x, 3), _mm256_set1_epi32(0xFE00000)));
+	return ret;
+}
+
+// Stores 8 decoded 32 bit lanes to out.
+// Returns false if a value doesn't fit in U.
+template <class U>
+FEA_TARGET_AVX2 inline bool varint_store8_avx2(U* out, __m256i v) noexcept {
+	if constexpr (sizeof(U) == 2) {
+		if (!_mm256_testz_si256(v, _mm256_set1_epi32(int(0xFFFF0000)))) {
+			return false;
+		}
+		// Packs per 128 bit lane, gather the low halves.
+		__m256i p = _mm256_permute4x64_epi64(
+				_mm256_packus_epi32(v, v), 0b1000);
+		_mm_storeu_si128(
+				reinterpret_cast<__m128i*>(out), _mm256_castsi256_si128(p));
+	} else if constexpr (sizeof(U) == 4) {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out), v);
+	} else {
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out),
+				_mm256_cvtepu32_epi64(_mm256_castsi256_si128(v)));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(out + 4),
+				_mm256_cvtepu32_epi64(_mm256_extracti128_si256(v, 1)));
+	}
+	return true;
+}
+
+// Widens 32 single byte varints to out.
+template <class U>
+FEA_TARGET_AVX2 inline void varint_store32_avx2(U* out, __m256i b) noexcept {
+	__m128i lo = _mm256_castsi256_si128(b);
+	__m128i hi = _mm256_extracti128_si256(b, 1);
+	__m256i* dst = reinterpret_cast<__m256i*>(out);
+	if constexpr (sizeof(U) == 2) {
+		_mm256_storeu_si256(dst, _mm256_cvtepu8_epi16(lo));
+		_mm256_storeu_si256(dst + 1, _mm256_cvtepu8_epi16(hi));
+	} else if constexpr (sizeof(U) == 4) {
+		_mm256_storeu_si256(dst, _mm256_cvtepu8_epi32(lo));
+		_mm256_storeu_si256(
+				dst + 1, _mm256_cvtepu8_epi32(_mm_srli_si128(lo, 8)));
+		_mm256_storeu_si256(dst + 2, _mm256_cvtepu8_epi32(hi));
+		_mm256_storeu_si256(
+				dst + 3, _mm256_cvtepu8_epi32(_mm_srli_si128(hi, 8)));
+	} else {
+		for (int j = 0; j < 4; ++j) {
+			__m128i half = j < 2 ? lo : hi;
+			__m128i quarter = (j & 1) == 0 ? half : _mm_srli_si128(half, 8);
+			_mm256_storeu_si256(dst + 2 * j, _mm256_cvtepu8_epi64(quarter));
+			_mm256_storeu_si256(dst + 2 * j + 1,
+					_mm256_cvtepu8_epi64(_mm_srli_si128(quarter, 4)));
+		}
+	}
+}
+
+template <class U>
+FEA_TARGET_AVX2 const std::byte* varint_decode_avx2(const std::byte* first,
+		const std::byte* last, U* out, size_t count) noexcept {
+	size_t i = 0;
+	while (i != count) {
+		if (size_t(last - first) >= 32 && count - i >= 8) {
+			__m256i b = _mm256_loadu_si256(
+					reinterpret_cast<const __m256i*>(first));
+			uint32_t ends = ~uint32_t(_mm256_movemask_epi8(b));
+			if (ends == 0xFFFF'FFFFu && count - i >= 32) {
+				varint_store32_avx2(out + i, b);
+				first += 32;
+				i += 32;
+				continue;
+			}
+
+			// Two groups of 4, one per 128 bit lane.
+			size_t idx0 = 0;
+			size_t idx1 = 0;
+			size_t size0 = 0;
+			size_t size1 = 0;
+			if (varint_group(ends, varint_simd_max_len<U>, idx0, size0)
+					&& varint_group(ends >> size0, varint_simd_max_len<U>,
+							idx1, size1)) {
+				const __m128i* second
+						= reinterpret_cast<const __m128i*>(first + size0);
+				__m256i bytes = _mm256_inserti128_si256(
+						b, _mm_loadu_si128(second), 1);
+				__m256i shuf = _mm256_inserti128_si256(
+						_mm256_castsi128_si256(
+								_mm_load_si128(reinterpret_cast<const __m128i*>(
+										varint_shuffles.masks[idx0]))),
+						_mm_load_si128(reinterpret_cast<const __m128i*>(
+								varint_shuffles.masks[idx1])),
+						1);
+				__m256i v = varint_merge_avx2(_mm256_shuffle_epi8(bytes, shuf));
+				if (!varint_store8_avx2(out + i, v)) {
+					return nullptr;
+				}
+				first += size0 + size1;
+				i += 8;
+				continue;
+			}
+		}
+
+		if (size_t(last - first) >= 16) {
+			size_t byte_size = 0;
+			bool error = false;
+			size_t n = varint_step_sse42(
+					first, out + i, count - i, byte_size, error);
+			if (error) {
+				return nullptr;
+			}
+			if (n != 0) {
+				first += byte_size;
+				i += n;
+				continue;
+			}
+		}
+
+		first = fea::varint_decode(first, last, out[i]);
+		if (first == nullptr) {
+			return nullptr;
+		}
+		++i;
+	}
+	return first;
+}
+#endif
+
+// Resolved once per integer type.
+template <class U>
+[[nodiscard]]
+varint_decode_fn<U> varint_decode_kernel() {
+	if constexpr (sizeof(U) == 1) {
+		return &varint_decode_scalar<U>;
+	} else {
+		static constexpr dispatch_table<varint_decode_fn<U>> table{ {
+			&varint_decode_scalar<U>,
+#if FEA_DISPATCH
+			&varint_decode_sse42<U>,
+			&varint_decode_avx2<U>,
+#endif
+		} };
+		static const varint_decode_fn<U> ret = table.resolve();
+		return ret;
+	}
+}
+} // namespace detail
+
+template <class U>
+const std::byte* varint_decode(const std::byte* first, const std::byte* last,
+		U* out, size_t count) noexcept {
+	static_assert(
+			std::is_unsigned_v<U>, "fea::varint_decode : U must be unsigned");
+	return detail::varint_decode_kernel<U>()(first, last, out, count);
+}
+} // namespace fea
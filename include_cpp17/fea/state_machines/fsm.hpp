@@ -30,6 +30,7 @@ OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE) ARISING IN ANY WAY OUT OF THE USE
 OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
+#include "fea/performance/profile_zone.hpp"
 #include "fea/utility/bitmask.hpp"
 #include "fea/utility/error.hpp"
 
@@ -654,6 +655,7 @@ void fsm<FEA_FSM_SPEC>::reset() {
 template <FEA_FSM_TMP>
 template <TransitionEnum Transition>
 void fsm<FEA_FSM_SPEC>::trigger(FuncArgs... func_args) {
+	FEA_PROFILE_ZONE("fea::fsm::trigger");
 	maybe_init(func_args...);
 
 	StateEnum from_state_e = _current_state;
@@ -689,6 +691,7 @@ void fsm<FEA_FSM_SPEC>::trigger(FuncArgs... func_args) {
 
 template <FEA_FSM_TMP>
 auto fsm<FEA_FSM_SPEC>::update(FuncArgs... func_args) -> FuncRet {
+	FEA_PROFILE_ZONE("fea::fsm::update");
 	maybe_init(func_args...);
 
 	return get_state(_current_state)
@@ -31,6 +31,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 */
 #pragma once
 #include "fea/meta/static_for.hpp"
+#include "fea/performance/profile_zone.hpp"
 #include "fea/utility/error.hpp"
 #include "fea/utility/platform.hpp"
 #include "fea/utility/scope.hpp"
@@ -689,6 +690,7 @@ struct hfsm {
 	void trigger(FuncArgs... func_args) {
 		static_assert(Transition != TransitionEnum::count,
 				"hfsm : invalid transition");
+		FEA_PROFILE_ZONE("fea::hfsm::trigger");
 		auto g = fea::on_exit{ [this]() { _in_transition_guard = false; } };
 
 		maybe_init(func_args...);
@@ -734,6 +736,7 @@ struct hfsm {
 	}
 
 	void update(FuncArgs... func_args) {
+		FEA_PROFILE_ZONE("fea::hfsm::update");
 		maybe_init(func_args...);
 
 		if (_print) {
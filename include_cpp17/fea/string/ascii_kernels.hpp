@@ -0,0 +1,134 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+#pragma once
+#include "fea/performance/cpu_dispatch.hpp"
+
+#include <cstddef>
+#include <cstdint>
+
+/*
+Runtime dispatched ascii kernels, used by fea/string.
+Each kernel has a scalar, sse4.2, avx2 and avx-512 version.
+*/
+
+namespace fea {
+namespace detail {
+// Flips the case of bytes in [first, first + 26), in place.
+// Pass 'A' to lower case, 'a' to upper case.
+using ascii_flip_case_fn = void (*)(char* str, size_t size, char first);
+
+inline void ascii_flip_case_scalar(char* str, size_t size, char first) {
+	for (size_t i = 0; i < size; ++i) {
+		if (uint8_t(str[i] - first) < 26u) {
+			str[i] = char(str[i] ^ 0x20);
+		}
+	}
+}
+
+#if FEA_DISPATCH
+FEA_TARGET_SSE42
+inline void ascii_flip_case_sse42(char* str, size_t size, char first) {
+	const __m128i lo = _mm_set1_epi8(first);
+	const __m128i max = _mm_set1_epi8(25);
+	const __m128i bit = _mm_set1_epi8(0x20);
+
+	size_t i = 0;
+	for (; i + 16 <= size; i += 16) {
+		__m128i* ptr = reinterpret_cast<__m128i*>(str + i);
+		__m128i c = _mm_loadu_si128(ptr);
+		// Unsigned c - first <= 25.
+		__m128i x = _mm_sub_epi8(c, lo);
+		__m128i mask = _mm_cmpeq_epi8(_mm_min_epu8(x, max), x);
+		_mm_storeu_si128(ptr, _mm_xor_si128(c, _mm_and_si128(mask, bit)));
+	}
+	ascii_flip_case_scalar(str + i, size - i, first);
+}
+
+FEA_TARGET_AVX2
+inline void ascii_flip_case_avx2(char* str, size_t size, char first) {
+	const __m256i lo = _mm256_set1_epi8(first);
+	const __m256i max = _mm256_set1_epi8(25);
+	const __m256i bit = _mm256_set1_epi8(0x20);
+
+	size_t i = 0;
+	for (; i + 32 <= size; i += 32) {
+		__m256i* ptr = reinterpret_cast<__m256i*>(str + i);
+		__m256i c = _mm256_loadu_si256(ptr);
+		__m256i x = _mm256_sub_epi8(c, lo);
+		__m256i mask = _mm256_cmpeq_epi8(_mm256_min_epu8(x, max), x);
+		_mm256_storeu_si256(
+				ptr, _mm256_xor_si256(c, _mm256_and_si256(mask, bit)));
+	}
+	ascii_flip_case_sse42(str + i, size - i, first);
+}
+
+FEA_TARGET_AVX512
+inline void ascii_flip_case_avx512(char* str, size_t size, char first) {
+	const __m512i lo = _mm512_set1_epi8(first);
+	const __m512i len = _mm512_set1_epi8(26);
+	const __m512i bit = _mm512_set1_epi8(0x20);
+
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64) {
+		__m512i c = _mm512_loadu_si512(str + i);
+		__mmask64 m = _mm512_cmplt_epu8_mask(_mm512_sub_epi8(c, lo), len);
+		_mm512_mask_storeu_epi8(str + i, m, _mm512_xor_si512(c, bit));
+	}
+
+	// Masked tail, never touches bytes past the end.
+	if (i != size) {
+		__mmask64 tail = (uint64_t(1) << (size - i)) - 1u;
+		__m512i c = _mm512_maskz_loadu_epi8(tail, str + i);
+		__mmask64 m = _mm512_mask_cmplt_epu8_mask(
+				tail, _mm512_sub_epi8(c, lo), len);
+		_mm512_mask_storeu_epi8(str + i, m, _mm512_xor_si512(c, bit));
+	}
+}
+#endif
+
+// Resolved once.
+[[nodiscard]]
+inline ascii_flip_case_fn ascii_flip_case() {
+	static constexpr dispatch_table<ascii_flip_case_fn> table{ {
+		&ascii_flip_case_scalar,
+#if FEA_DISPATCH
+		&ascii_flip_case_sse42,
+		&ascii_flip_case_avx2,
+		&ascii_flip_case_avx512,
+#endif
+	} };
+	static const ascii_flip_case_fn ret = table.resolve();
+	return ret;
+}
+} // namespace detail
+} // namespace fea
@@ -34,6 +34,8 @@
 #pragma once
 #include "fea/containers/span.hpp"
 #include "fea/macros/literals.hpp"
+#include "fea/meta/traits.hpp"
+#include "fea/string/ascii_kernels.hpp"
 #include "fea/string/conversions.hpp"
 #include "fea/string/details.hpp"
 #include "fea/string/split.hpp"
@@ -42,6 +44,7 @@
 #include <algorithm>
 #include <cctype>
 #include <cstring>
+#include <iterator>
 #include <locale>
 #include <string>
 #include <string_view>
@@ -49,6 +52,7 @@
 
 #if FEA_CPP20
 #include <compare>
+#include <type_traits>
 #endif
 
 /*
@@ -153,10 +157,37 @@ constexpr CharT to_lower_ascii(CharT ch) {
 	return ch;
 }
 
+namespace detail {
+// Can the simd kernels flip the case of Str in place?
+template <class Str, class CharT>
+inline constexpr bool ascii_flip_case_inplace_v
+		= sizeof(CharT) == 1 && fea::is_contiguous_v<Str&>;
+
+// Simd kernels can't run at compile time.
+[[nodiscard]]
+constexpr bool ascii_is_constant_evaluated() noexcept {
+#if FEA_CPP20
+	return std::is_constant_evaluated();
+#else
+	return false;
+#endif
+}
+} // namespace detail
+
 // Lower case ASCII string (without copying).
 template <template <class, class, class...> class Str, class CharT,
 		template <class> class Traits, class... Args>
 constexpr void to_lower_ascii_inplace(Str<CharT, Traits<CharT>, Args...>& out) {
+	using str_t = Str<CharT, Traits<CharT>, Args...>;
+	if constexpr (detail::ascii_flip_case_inplace_v<str_t, CharT>) {
+		if (!detail::ascii_is_constant_evaluated()) {
+			// Runtime dispatched simd.
+			detail::ascii_flip_case()(reinterpret_cast<char*>(std::data(out)),
+					std::size(out), 'A');
+			return;
+		}
+	}
+
 	for (CharT& c : out) {
 		c = to_lower_ascii(c);
 	}
@@ -169,7 +200,6 @@ auto to_lower_ascii(const Str& str) {
 	using CharT = typename detail::str_view<Str>::char_type;
 	using Traits = typename detail::str_view<Str>::traits_type;
 	std::basic_string<CharT, Traits> ret{ str };
-
 	to_lower_ascii_inplace(ret);
 	return ret;
 }
@@ -193,6 +223,16 @@ constexpr CharT to_upper_ascii(CharT ch) {
 template <template <class, class, class...> class Str, class CharT,
 		template <class> class Traits, class... Args>
 constexpr void to_upper_ascii_inplace(Str<CharT, Traits<CharT>, Args...>& out) {
+	using str_t = Str<CharT, Traits<CharT>, Args...>;
+	if constexpr (detail::ascii_flip_case_inplace_v<str_t, CharT>) {
+		if (!detail::ascii_is_constant_evaluated()) {
+			// Runtime dispatched simd.
+			detail::ascii_flip_case()(reinterpret_cast<char*>(std::data(out)),
+					std::size(out), 'a');
+			return;
+		}
+	}
+
 	for (CharT& c : out) {
 		c = to_upper_ascii(c);
 	}
@@ -205,7 +245,6 @@ auto to_upper_ascii(const Str& str) {
 	using CharT = typename detail::str_view<Str>::char_type;
 	using Traits = typename detail::str_view<Str>::traits_type;
 	std::basic_string<CharT, Traits> ret{ str };
-
 	to_upper_ascii_inplace(ret);
 	return ret;
 }
@@ -0,0 +1,320 @@
+/**
+ * BSD 3-Clause License
+ *
+ * Copyright (c) 2025, Philippe Groarke
+ * All rights reserved.
+ *
+ * Redistribution and use in source and binary forms, with or without
+ * modification, are permitted provided that the following conditions are met:
+ *
+ * * Redistributions of source code must retain the above copyright notice, this
+ *   list of conditions and the following disclaimer.
+ *
+ * * Redistributions in binary form must reproduce the above copyright notice,
+ *   this list of conditions and the following disclaimer in the documentation
+ *   and/or other materials provided with the distribution.
+ *
+ * * Neither the name of the copyright holder nor the names of its
+ *   contributors may be used to endorse or promote products derived from
+ *   this software without specific prior written permission.
+ *
+ * THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+ * AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+ * IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+ * ARE DISCLAIMED. IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+ * LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+ * CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+ * SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+ * INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+ * CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+ * ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+ * POSSIBILITY OF SUCH DAMAGE.
+ **/
+
+#pragma once
+#include "fea/utility/platform.hpp"
+
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <utility>
+#include <vector>
+
+/*
+timeout_queue holds values which expire at a deadline Key. It is a 4-ary
+min-heap of deadlines, with the values stored aside in stable slots.
+
+Insertion and cancellation are O(log4 n), and checking for expired values is
+O(1) when nothing is due. Heap nodes only hold the deadline and a slot index,
+so sifting stays cache friendly whatever the value type.
+
+Key must be less-than comparable. T must be default constructible and movable.
+Values with equal deadlines pop in unspecified order.
+*/
+
+namespace fea {
+// An opaque id, used to cancel a timeout.
+// Queues with different Tags return different id types, so an id can't be
+// used to cancel a value of another queue.
+template <class Tag = void>
+struct basic_timeout_id {
+	basic_timeout_id() = default;
+
+	friend bool operator==(
+			const basic_timeout_id& lhs, const basic_timeout_id& rhs) {
+		return lhs._slot == rhs._slot && lhs._generation == rhs._generation;
+	}
+	friend bool operator!=(
+			const basic_timeout_id& lhs, const basic_timeout_id& rhs) {
+		return !(lhs == rhs);
+	}
+
+private:
+	template <class, class, class>
+	friend struct timeout_queue;
+
+	basic_timeout_id(uint32_t slot, uint32_t generation)
+			: _slot(slot)
+			, _generation(generation) {
+	}
+
+	uint32_t _slot = (std::numeric_limits<uint32_t>::max)();
+	uint32_t _generation = 0;
+};
+
+using timeout_id = basic_timeout_id<>;
+
+template <class Key, class T, class Tag = void>
+struct timeout_queue {
+	using key_type = Key;
+	using mapped_type = T;
+	using size_type = size_t;
+	using id_type = basic_timeout_id<Tag>;
+
+	// Capacity
+
+	// Checks if the queue is empty.
+	[[nodiscard]]
+	bool empty() const noexcept;
+
+	// Returns the number of pending values.
+	[[nodiscard]]
+	size_t size() const noexcept;
+
+	// Reserve storage for new_cap values.
+	void reserve(size_t new_cap);
+
+	// Lookup
+
+	// Is the value still pending?
+	[[nodiscard]]
+	bool contains(id_type id) const noexcept;
+
+	// The earliest deadline. Queue mustn't be empty.
+	[[nodiscard]]
+	const Key& top_key() const;
+
+	// Modifiers
+
+	// Remove all values.
+	void clear();
+
+	// Insert value v, which expires at deadline k.
+	// Returns an id to cancel it.
+	id_type push(const Key& k, T v);
+
+	// Remove a pending value. Returns false if it already expired or was
+	// cancelled.
+	bool cancel(id_type id);
+
+	// Remove every value with a deadline <= k, in deadline order, and
+	// call func(T&&) on each one. Returns the number of expired values.
+	// func may push new values.
+	template <class Func>
+	size_t pop_until(const Key& k, Func&& func);
+
+private:
+	static constexpr size_t arity = 4;
+	static constexpr uint32_t invalid_idx
+			= (std::numeric_limits<uint32_t>::max)();
+
+	struct node {
+		Key key;
+		uint32_t slot;
+	};
+
+	struct slot {
+		T value{};
+		uint32_t heap_idx = invalid_idx;
+		uint32_t generation = 0;
+	};
+
+	// Moves node n to heap_idx and updates its slot.
+	void place(size_t heap_idx, node&& n);
+	void sift_up(size_t heap_idx, node&& n);
+	void sift_down(size_t heap_idx, node&& n);
+
+	// Removes the heap node at heap_idx and frees its slot.
+	// Returns the slot value.
+	T remove(size_t heap_idx);
+
+	std::vector<node> _heap;
+	std::vector<slot> _slots;
+	std::vector<uint32_t> _free_slots;
+};
+} // namespace fea
+
+
+// Implementation
+namespace fea {
+template <class Key, class T, class Tag>
+bool timeout_queue<Key, T, Tag>::empty() const noexcept {
+	return _heap.empty();
+}
+
+template <class Key, class T, class Tag>
+size_t timeout_queue<Key, T, Tag>::size() const noexcept {
+	return _heap.size();
+}
+
+template <class Key, class T, class Tag>
+void timeout_queue<Key, T, Tag>::reserve(size_t new_cap) {
+	_heap.reserve(new_cap);
+	_slots.reserve(new_cap);
+}
+
+template <class Key, class T, class Tag>
+bool timeout_queue<Key, T, Tag>::contains(
+		basic_timeout_id<Tag> id) const noexcept {
+	return id._slot < _slots.size()
+		&& _slots[id._slot].generation == id._generation
+		&& _slots[id._slot].heap_idx != invalid_idx;
+}
+
+template <class Key, class T, class Tag>
+const Key& timeout_queue<Key, T, Tag>::top_key() const {
+	assert(!empty());
+	return _heap.front().key;
+}
+
+template <class Key, class T, class Tag>
+void timeout_queue<Key, T, Tag>::clear() {
+	while (!_heap.empty()) {
+		remove(_heap.size() - 1);
+	}
+}
+
+template <class Key, class T, class Tag>
+basic_timeout_id<Tag> timeout_queue<Key, T, Tag>::push(const Key& k, T v) {
+	uint32_t slot_idx = 0;
+	if (_free_slots.empty()) {
+		assert(_slots.size() < size_t(invalid_idx));
+		slot_idx = uint32_t(_slots.size());
+		_slots.push_back({});
+	} else {
+		slot_idx = _free_slots.back();
+		_free_slots.pop_back();
+	}
+
+	slot& s = _slots[slot_idx];
+	s.value = std::move(v);
+
+	_heap.push_back({ k, slot_idx });
+	sift_up(_heap.size() - 1, std::move(_heap.back()));
+	return { slot_idx, s.generation };
+}
+
+template <class Key, class T, class Tag>
+bool timeout_queue<Key, T, Tag>::cancel(basic_timeout_id<Tag> id) {
+	if (!contains(id)) {
+		return false;
+	}
+	remove(_slots[id._slot].heap_idx);
+	return true;
+}
+
+template <class Key, class T, class Tag>
+template <class Func>
+size_t timeout_queue<Key, T, Tag>::pop_until(const Key& k, Func&& func) {
+	size_t ret = 0;
+	while (!_heap.empty() && !(k < _heap.front().key)) {
+		func(remove(0));
+		++ret;
+	}
+	return ret;
+}
+
+template <class Key, class T, class Tag>
+void timeout_queue<Key, T, Tag>::place(size_t heap_idx, node&& n) {
+	_slots[n.slot].heap_idx = uint32_t(heap_idx);
+	_heap[heap_idx] = std::move(n);
+}
+
+template <class Key, class T, class Tag>
+void timeout_queue<Key, T, Tag>::sift_up(size_t heap_idx, node&& n) {
+	node tmp = std::move(n);
+	while (heap_idx != 0) {
+		size_t parent = (heap_idx - 1) / arity;
+		if (!(tmp.key < _heap[parent].key)) {
+			break;
+		}
+		place(heap_idx, std::move(_heap[parent]));
+		heap_idx = parent;
+	}
+	place(heap_idx, std::move(tmp));
+}
+
+template <class Key, class T, class Tag>
+void timeout_queue<Key, T, Tag>::sift_down(size_t heap_idx, node&& n) {
+	node tmp = std::move(n);
+	const size_t size = _heap.size();
+	while (true) {
+		size_t first = heap_idx * arity + 1;
+		if (first >= size) {
+			break;
+		}
+
+		// Find the smallest child.
+		size_t last = first + arity < size ? first + arity : size;
+		size_t min_child = first;
+		for (size_t i = first + 1; i < last; ++i) {
+			if (_heap[i].key < _heap[min_child].key) {
+				min_child = i;
+			}
+		}
+
+		if (!(_heap[min_child].key < tmp.key)) {
+			break;
+		}
+		place(heap_idx, std::move(_heap[min_child]));
+		heap_idx = min_child;
+	}
+	place(heap_idx, std::move(tmp));
+}
+
+template <class Key, class T, class Tag>
+T timeout_queue<Key, T, Tag>::remove(size_t heap_idx) {
+	assert(heap_idx < _heap.size());
+	uint32_t slot_idx = _heap[heap_idx].slot;
+
+	// Fill the hole with the last node.
+	node last = std::move(_heap.back());
+	_heap.pop_back();
+	if (heap_idx != _heap.size()) {
+		if (heap_idx != 0 && last.key < _heap[(heap_idx - 1) / arity].key) {
+			sift_up(heap_idx, std::move(last));
+		} else {
+			sift_down(heap_idx, std::move(last));
+		}
+	}
+
+	// Free the slot, invalidating ids.
+	slot& s = _slots[slot_idx];
+	T ret = std::move(s.value);
+	s.value = T{};
+	s.heap_idx = invalid_idx;
+	++s.generation;
+	_free_slots.push_back(slot_idx);
+	return ret;
+}
+} // namespace fea
@@ -38,9 +38,12 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include "fea/state_machines/fsm.hpp"
 #include "fea/time/high_range_duration.hpp"
 #include "fea/time/time.hpp"
+#include "fea/time/timeout_queue.hpp"
 #include "fea/utility/error.hpp"
 
 #include <cassert>
+#include <functional>
+#include <vector>
 
 #if FEA_WITH_TBB
 #if FEA_WINDOWS
@@ -94,6 +97,10 @@ You can subscribe to:
 	- Elapsed callbacks (ex. callback after x seconds).
 	- Specific time callbacks (ex. callback at 01/01/2021 3:30pm).
 
+Elapsed and specific time callbacks are kept in timeout queues (4-ary heaps),
+so an update only looks at the callbacks which are due. They can be cancelled
+with the id returned when subscribing.
+
 
 Imprecision Behavior
 If your ratio is too high, and you've subscribed to time event callbacks that
@@ -125,6 +132,16 @@ enum class timer_event : uint8_t {
 	count,
 };
 
+namespace detail {
+struct timer_elapsed_tag {};
+struct timer_time_tag {};
+} // namespace detail
+
+// Ids returned by subscribe_elapsed and subscribe_time.
+// They are distinct types, an id can only unsubscribe from its own queue.
+using timer_elapsed_id = basic_timeout_id<detail::timer_elapsed_tag>;
+using timer_time_id = basic_timeout_id<detail::timer_time_tag>;
+
 template <class, class = std::chrono::steady_clock, bool = false>
 struct timer;
 
@@ -310,8 +327,9 @@ public:
 	}
 
 	// Will execute your callback after e has elapsed. Local time.
+	// Returns an id to unsubscribe the callback.
 	// TODO : Add subscribe with high_range_duration.
-	void subscribe_elapsed(
+	timer_elapsed_id subscribe_elapsed(
 			dseconds e, const std::function<void(EventArgs...)>& func) {
 		assert(e > elapsed()); // asserts nice when threading.
 		if (e <= elapsed()) {
@@ -319,12 +337,13 @@ public:
 					"subscribing callback that will never be called");
 		}
 
-		_elapsed_callbacks.push_back({ e, func });
+		return _elapsed_callbacks.push(high_range_duration{ e }, func);
 	}
 
 	// Will execute your callback at time t. Absolute time.
+	// Returns an id to unsubscribe the callback.
 	// TODO : Add subscribe with high_range_duration.
-	void subscribe_time(dclock_seconds<Clock> t,
+	timer_time_id subscribe_time(dclock_seconds<Clock> t,
 			const std::function<void(EventArgs...)>& func) {
 		assert(t > time());
 		if (t <= time()) {
@@ -333,7 +352,25 @@ public:
 		}
 
 		// TODO : high_range_timepoint
-		_time_callbacks.push_back({ t.time_since_epoch(), func });
+		return _time_callbacks.push(
+				high_range_duration{ t.time_since_epoch() }, func);
+	}
+
+	// Removes a pending elapsed callback.
+	// Returns false if it was already called or removed.
+	bool unsubscribe_elapsed(timer_elapsed_id id) {
+		return _elapsed_callbacks.cancel(id);
+	}
+
+	// Removes a pending time callback.
+	// Returns false if it was already called or removed.
+	bool unsubscribe_time(timer_time_id id) {
+		return _time_callbacks.cancel(id);
+	}
+
+	// Number of pending elapsed and time callbacks.
+	size_t pending_callbacks() const {
+		return _elapsed_callbacks.size() + _time_callbacks.size();
 	}
 
 private:
@@ -493,68 +530,38 @@ private:
 		high_range_duration current_time = time_precise();
 		high_range_duration current_elapsed_time = elapsed_precise();
 
-		// Gather events that need to be executed and removed.
-		auto new_end = std::remove_if(_elapsed_callbacks.begin(),
-				_elapsed_callbacks.end(), [&](auto& callback_p) {
-					if (callback_p.first <= current_elapsed_time) {
-						return true;
-					}
-					return false;
-				});
-
-		if constexpr (MultiThreaded && FEA_WITH_TBB) {
-#if FEA_WITH_TBB
-			size_t start_idx = new_end - _elapsed_callbacks.begin();
-			auto eval = [&, this](const tbb::blocked_range<size_t>& range) {
-				for (size_t i = range.begin(); i < range.end(); ++i) {
-					_elapsed_callbacks[i].second(event_args...);
-				}
-			};
-			tbb::blocked_range<size_t> range{
-				start_idx,
-				_elapsed_callbacks.size(),
-				fea::default_grainsize_small_v<true>,
-			};
-			tbb::parallel_for(range, eval, fea::default_partitioner_t<true>{});
-#endif
-		} else {
-			for (auto it = new_end; it != _elapsed_callbacks.end(); ++it) {
-				it->second(event_args...);
-			}
-		}
-
-		_elapsed_callbacks.erase(new_end, _elapsed_callbacks.end());
-
-		auto new_end2 = std::remove_if(_time_callbacks.begin(),
-				_time_callbacks.end(), [&](auto& callback_p) {
-					if (callback_p.first <= current_time) {
-						return true;
-					}
-					return false;
-				});
+		// Gather callbacks that are due. Only looks at the due ones.
+		// Take the vector, in case a callback updates the timer.
+		std::vector<std::function<void(EventArgs...)>> due
+				= std::move(_due_callbacks);
+		auto gather = [&](std::function<void(EventArgs...)>&& func) {
+			due.push_back(std::move(func));
+		};
+		_elapsed_callbacks.pop_until(current_elapsed_time, gather);
+		_time_callbacks.pop_until(current_time, gather);
 
 		if constexpr (MultiThreaded && FEA_WITH_TBB) {
 #if FEA_WITH_TBB
-			size_t start_idx = new_end2 - _time_callbacks.begin();
-			auto eval = [&, this](const tbb::blocked_range<size_t>& range) {
+			auto eval = [&](const tbb::blocked_range<size_t>& range) {
 				for (size_t i = range.begin(); i < range.end(); ++i) {
-					_time_callbacks[i].second(event_args...);
+					due[i](event_args...);
 				}
 			};
 			tbb::blocked_range<size_t> range{
-				start_idx,
-				_time_callbacks.size(),
+				0,
+				due.size(),
 				fea::default_grainsize_small_v<true>,
 			};
 			tbb::parallel_for(range, eval, fea::default_partitioner_t<true>{});
 #endif
 		} else {
-			for (auto it = new_end2; it != _time_callbacks.end(); ++it) {
-				it->second(event_args...);
+			for (std::function<void(EventArgs...)>& func : due) {
+				func(event_args...);
 			}
 		}
 
-		_time_callbacks.erase(new_end2, _time_callbacks.end());
+		due.clear();
+		_due_callbacks = std::move(due);
 	}
 
 	// Elapsed time.
@@ -587,12 +594,15 @@ private:
 	fsm_t _smachine;
 
 	// The elapsed and timepoint callbacks.
-	std::vector<
-			std::pair<high_range_duration, std::function<void(EventArgs...)>>>
+	timeout_queue<high_range_duration, std::function<void(EventArgs...)>,
+			detail::timer_elapsed_tag>
 			_elapsed_callbacks;
-	std::vector<
-			std::pair<high_range_duration, std::function<void(EventArgs...)>>>
+	timeout_queue<high_range_duration, std::function<void(EventArgs...)>,
+			detail::timer_time_tag>
 			_time_callbacks;
+
+	// Scratch, callbacks executed this update.
+	std::vector<std::function<void(EventArgs...)>> _due_callbacks;
 };
 
 // Multithreaded version of steady_clock timer.
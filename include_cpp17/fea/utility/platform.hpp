@@ -190,6 +190,15 @@ inline constexpr bool nothrow_build = true;
 inline constexpr bool nothrow_build = false;
 #endif
 
+// Enables FEA_PROFILE_ZONE instrumentation, see fea/performance/profiler.hpp.
+#undef FEA_PROFILE
+#define FEA_PROFILE 0
+
+#if defined(FEA_PROFILE_DEF)
+#undef FEA_PROFILE
+#define FEA_PROFILE 1
+#endif
+
 // Allows using MSVC regions without causing errors on other OSes.
 #define FEA_REGION(...)
 
@@ -32,14 +32,27 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include "fea/memory/memory.hpp"
 #include "fea/meta/traits.hpp"
+#include "fea/performance/cpu_dispatch.hpp"
+#include "fea/performance/simd.hpp"
 #include "fea/utility/platform.hpp"
 
+#include <algorithm>
 #include <array>
 #include <bit>
 #include <cassert>
+#include <cstddef>
+#include <cstdint>
 #include <iterator>
+#include <memory>
+#include <span>
+#include <string_view>
 #include <type_traits>
 
+/*
+Contiguous inputs use vectorized kernels, ssse3 and avx2 selected at runtime
+on x86 and neon on arm64. The scalar loops remain the fallback.
+*/
+
 namespace fea {
 // Encodes the data pointed at by the input iterators into a base64 string.
 // Outputs chars to the output iterator.
@@ -50,6 +63,42 @@ void to_base64(FwdIt first, FwdIt last, OutIt out) noexcept;
 // Supports an output iterator, a single pointer, an iterator to types T, etc.
 template <std::forward_iterator FwdIt, class OutIt>
 void from_base64(FwdIt first, FwdIt last, OutIt out);
+
+// The number of base64 characters encoding byte_size bytes, with padding.
+[[nodiscard]]
+constexpr size_t base64_encoded_size(size_t byte_size) noexcept;
+
+// The number of bytes decoded from a padded base64 string.
+// Exact for valid strings, an upper bound otherwise.
+[[nodiscard]]
+constexpr size_t base64_decoded_size(std::string_view str) noexcept;
+
+// The result of a checked decode.
+struct base64_result {
+	static constexpr size_t npos = size_t(-1);
+
+	// The number of decoded bytes.
+	size_t size = 0;
+
+	// The index of the first invalid character, npos if the input is valid.
+	// Misplaced padding is invalid. A truncated input reports its size.
+	size_t invalid_idx = npos;
+
+	[[nodiscard]]
+	constexpr bool valid() const noexcept {
+		return invalid_idx == npos;
+	}
+};
+
+// Encodes bytes to padded base64.
+// out must fit base64_encoded_size(in.size()) chars.
+inline void to_base64(std::span<const std::byte> in, char* out) noexcept;
+
+// Decodes and validates padded base64.
+// out must fit base64_decoded_size(in) bytes. Its content past the first
+// invalid character is unspecified.
+[[nodiscard]]
+inline base64_result from_base64(std::string_view in, std::byte* out) noexcept;
 } // namespace fea
 
 
@@ -76,8 +125,439 @@ constexpr inline std::array<uint8_t, 256> base64_rlut{ 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0,
 	0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0, 0 };
+
+// char to 6 bit part, 0xFF for invalid characters.
+constexpr inline std::array<uint8_t, 256> base64_rlut_strict = []() {
+	std::array<uint8_t, 256> ret{};
+	ret.fill(0xFF);
+	for (size_t i = 0; i < base64_lut.size(); ++i) {
+		ret[uint8_t(base64_lut[i])] = uint8_t(i);
+	}
+	return ret;
+}();
+
+// Kernels process whole blocks and return the input consumed.
+// Encoders consume multiples of 3 bytes, output 4 chars per 3 bytes.
+// Decoders consume multiples of 4 chars and stop before a block containing
+// invalid characters or padding. They never write past size / 4 * 3 bytes.
+using base64_encode_fn = size_t (*)(const uint8_t* src, size_t size, char* dst);
+using base64_decode_fn = size_t (*)(const char* src, size_t size, uint8_t* dst);
+
+// The scalar loops do all the work.
+inline size_t base64_encode_none(const uint8_t*, size_t, char*) {
+	return 0;
+}
+inline size_t base64_decode_none(const char*, size_t, uint8_t*) {
+	return 0;
+}
+
+// Encodes everything, with padding.
+inline void base64_encode_scalar(
+		const uint8_t* src, size_t size, char* dst) noexcept {
+	size_t i = 0;
+	for (; i + 3 <= size; i += 3, dst += 4) {
+		uint32_t v = (uint32_t(src[i]) << 16) | (uint32_t(src[i + 1]) << 8)
+				| uint32_t(src[i + 2]);
+		dst[0] = base64_lut[v >> 18];
+		dst[1] = base64_lut[(v >> 12) & 0b0011'1111];
+		dst[2] = base64_lut[(v >> 6) & 0b0011'1111];
+		dst[3] = base64_lut[v & 0b0011'1111];
+	}
+
+	if (i == size) {
+		return;
+	}
+
+	uint32_t v = uint32_t(src[i]) << 16;
+	if (i + 2 == size) {
+		v |= uint32_t(src[i + 1]) << 8;
+	}
+	dst[0] = base64_lut[v >> 18];
+	dst[1] = base64_lut[(v >> 12) & 0b0011'1111];
+	dst[2] = i + 2 == size ? base64_lut[(v >> 6) & 0b0011'1111] : '=';
+	dst[3] = '=';
+}
+
+#if FEA_DISPATCH
+// Wojciech Muła and Daniel Lemire, "Faster Base64 Encoding and Decoding
+// Using AVX2 Instructions". Ssse3 kernels use the sse4.2 level.
+
+// 6 bit indexes to ascii.
+FEA_TARGET_SSE42
+inline __m128i base64_encode_lookup_ssse3(__m128i idx) {
+	const __m128i offsets = _mm_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0);
+
+	// 0 for [26, 51], 1 to 12 for [52, 63], 13 for [0, 25].
+	__m128i r = _mm_subs_epu8(idx, _mm_set1_epi8(51));
+	__m128i less = _mm_cmpgt_epi8(_mm_set1_epi8(26), idx);
+	r = _mm_or_si128(r, _mm_and_si128(less, _mm_set1_epi8(13)));
+	return _mm_add_epi8(_mm_shuffle_epi8(offsets, r), idx);
+}
+
+// 3 bytes per 32 bits to 4 6 bit indexes.
+FEA_TARGET_SSE42
+inline __m128i base64_encode_split_ssse3(__m128i in) {
+	const __m128i shuf = _mm_setr_epi8(
+			1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+	in = _mm_shuffle_epi8(in, shuf);
+	__m128i t0 = _mm_mulhi_epu16(_mm_and_si128(in, _mm_set1_epi32(0x0fc0fc00)),
+			_mm_set1_epi32(0x04000040));
+	__m128i t1 = _mm_mullo_epi16(_mm_and_si128(in, _mm_set1_epi32(0x003f03f0)),
+			_mm_set1_epi32(0x01000010));
+	return _mm_or_si128(t0, t1);
+}
+
+FEA_TARGET_SSE42
+inline size_t base64_encode_ssse3(const uint8_t* src, size_t size, char* dst) {
+	// Loads 16 bytes, uses 12.
+	size_t i = 0;
+	for (; i + 16 <= size; i += 12, dst += 16) {
+		__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i out = base64_encode_lookup_ssse3(base64_encode_split_ssse3(in));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), out);
+	}
+	return i;
+}
+
+// 6 bit indexes to ascii.
+FEA_TARGET_AVX2
+inline __m256i base64_encode_lookup_avx2(__m256i idx) {
+	const __m256i offsets = _mm256_setr_epi8('a' - 26, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0, 0, 'a' - 26,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52, '0' - 52,
+			'0' - 52, '0' - 52, '0' - 52, '0' - 52, '+' - 62, '/' - 63, 'A', 0,
+			0);
+
+	__m256i r = _mm256_subs_epu8(idx, _mm256_set1_epi8(51));
+	__m256i less = _mm256_cmpgt_epi8(_mm256_set1_epi8(26), idx);
+	r = _mm256_or_si256(r, _mm256_and_si256(less, _mm256_set1_epi8(13)));
+	return _mm256_add_epi8(_mm256_shuffle_epi8(offsets, r), idx);
+}
+
+FEA_TARGET_AVX2
+inline size_t base64_encode_avx2(const uint8_t* src, size_t size, char* dst) {
+	const __m256i shuf = _mm256_setr_epi8(1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7,
+			10, 9, 11, 10, 1, 0, 2, 1, 4, 3, 5, 4, 7, 6, 8, 7, 10, 9, 11, 10);
+
+	// 12 bytes per lane, the high lane loads 4 bytes past the block.
+	size_t i = 0;
+	for (; i + 28 <= size; i += 24, dst += 32) {
+		__m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i hi = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(src + i + 12));
+		__m256i in = _mm256_inserti128_si256(_mm256_castsi128_si256(lo), hi, 1);
+		in = _mm256_shuffle_epi8(in, shuf);
+
+		__m256i t0 = _mm256_mulhi_epu16(
+				_mm256_and_si256(in, _mm256_set1_epi32(0x0fc0fc00)),
+				_mm256_set1_epi32(0x04000040));
+		__m256i t1 = _mm256_mullo_epi16(
+				_mm256_and_si256(in, _mm256_set1_epi32(0x003f03f0)),
+				_mm256_set1_epi32(0x01000010));
+		__m256i out = base64_encode_lookup_avx2(_mm256_or_si256(t0, t1));
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), out);
+	}
+	return i;
+}
+
+FEA_TARGET_SSE42
+inline size_t base64_decode_ssse3(const char* src, size_t size, uint8_t* dst) {
+	// Classifies characters by nibbles, lo & hi is non-zero when invalid.
+	const __m128i lut_lo = _mm_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m128i lut_hi = _mm_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04, 0x08,
+			0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10);
+	// Ascii to 6 bit offsets, by high nibble. '/' uses index 1.
+	const __m128i lut_roll = _mm_setr_epi8(
+			0, 16, 19, 4, -65, -65, -71, -71, 0, 0, 0, 0, 0, 0, 0, 0);
+	const __m128i pack = _mm_setr_epi8(
+			2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1, -1, -1);
+	const __m128i nibble = _mm_set1_epi8(0x0F);
+
+	// Stores 16 bytes for 12.
+	size_t i = 0;
+	for (; i + 24 <= size; i += 16, dst += 12) {
+		__m128i in = _mm_loadu_si128(reinterpret_cast<const __m128i*>(src + i));
+		__m128i hi_nibbles = _mm_and_si128(_mm_srli_epi32(in, 4), nibble);
+		__m128i lo = _mm_shuffle_epi8(lut_lo, _mm_and_si128(in, nibble));
+		__m128i hi = _mm_shuffle_epi8(lut_hi, hi_nibbles);
+		if (!_mm_testz_si128(lo, hi)) {
+			break;
+		}
+
+		__m128i eq_slash = _mm_cmpeq_epi8(in, _mm_set1_epi8('/'));
+		__m128i roll = _mm_shuffle_epi8(
+				lut_roll, _mm_add_epi8(eq_slash, hi_nibbles));
+		__m128i v = _mm_add_epi8(in, roll);
+
+		// Pack 4 6 bit values per 32 bits, then 3 bytes per 32 bits.
+		v = _mm_maddubs_epi16(v, _mm_set1_epi32(0x01400140));
+		v = _mm_madd_epi16(v, _mm_set1_epi32(0x00011000));
+		v = _mm_shuffle_epi8(v, pack);
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(dst), v);
+	}
+	return i;
+}
+
+FEA_TARGET_AVX2
+inline size_t base64_decode_avx2(const char* src, size_t size, uint8_t* dst) {
+	const __m256i lut_lo = _mm256_setr_epi8(0x15, 0x11, 0x11, 0x11, 0x11,
+			0x11, 0x11, 0x11, 0x11, 0x11, 0x13, 0x1A, 0x1B, 0x1B, 0x1B, 0x1A,
+			0x15, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x11, 0x13,
+			0x1A, 0x1B, 0x1B, 0x1B, 0x1A);
+	const __m256i lut_hi = _mm256_setr_epi8(0x10, 0x10, 0x01, 0x02, 0x04,
+			0x08, 0x04, 0x08, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x01, 0x02, 0x04, 0x08, 0x04, 0x08, 0x10, 0x10, 0x10,
+			0x10, 0x10, 0x10, 0x10, 0x10);
+	const __m256i lut_roll = _mm256_setr_epi8(0, 16, 19, 4, -65, -65, -71,
+			-71, 0, 0, 0, 0, 0, 0, 0, 0, 0, 16, 19, 4, -65, -65, -71, -71, 0,
+			0, 0, 0, 0, 0, 0, 0);
+	const __m256i pack = _mm256_setr_epi8(2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13,
+			12, -1, -1, -1, -1, 2, 1, 0, 6, 5, 4, 10, 9, 8, 14, 13, 12, -1, -1,
+			-1, -1);
+	// Joins the 12 bytes of each lane.
+	const __m256i join = _mm256_setr_epi32(0, 1, 2, 4, 5, 6, 3, 7);
+	const __m256i nibble = _mm256_set1_epi8(0x0F);
+
+	// Stores 32 bytes for 24.
+	size_t i = 0;
+	for (; i + 48 <= size; i += 32, dst += 24) {
+		__m256i in
+				= _mm256_loadu_si256(reinterpret_cast<const __m256i*>(src + i));
+		__m256i hi_nibbles
+				= _mm256_and_si256(_mm256_srli_epi32(in, 4), nibble);
+		__m256i lo
+				= _mm256_shuffle_epi8(lut_lo, _mm256_and_si256(in, nibble));
+		__m256i hi = _mm256_shuffle_epi8(lut_hi, hi_nibbles);
+		if (!_mm256_testz_si256(lo, hi)) {
+			break;
+		}
+
+		__m256i eq_slash = _mm256_cmpeq_epi8(in, _mm256_set1_epi8('/'));
+		__m256i roll = _mm256_shuffle_epi8(
+				lut_roll, _mm256_add_epi8(eq_slash, hi_nibbles));
+		__m256i v = _mm256_add_epi8(in, roll);
+
+		v = _mm256_maddubs_epi16(v, _mm256_set1_epi32(0x01400140));
+		v = _mm256_madd_epi16(v, _mm256_set1_epi32(0x00011000));
+		v = _mm256_shuffle_epi8(v, pack);
+		v = _mm256_permutevar8x32_epi32(v, join);
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(dst), v);
+	}
+	return i;
+}
+#endif
+
+#if FEA_NEON && (defined(__aarch64__) || defined(_M_ARM64))
+#define FEA_BASE64_NEON 1
+
+// Loads 64 table bytes.
+inline uint8x16x4_t base64_load_table(const uint8_t* data) {
+	uint8x16x4_t ret;
+	ret.val[0] = vld1q_u8(data);
+	ret.val[1] = vld1q_u8(data + 16);
+	ret.val[2] = vld1q_u8(data + 32);
+	ret.val[3] = vld1q_u8(data + 48);
+	return ret;
+}
+
+inline size_t base64_encode_neon(const uint8_t* src, size_t size, char* dst) {
+	const uint8x16x4_t lut = base64_load_table(
+			reinterpret_cast<const uint8_t*>(base64_lut.data()));
+	const uint8x16_t mask = vdupq_n_u8(0b0011'1111);
+
+	// Deinterleaving loads and stores, 48 bytes to 64 chars.
+	size_t i = 0;
+	for (; i + 48 <= size; i += 48, dst += 64) {
+		uint8x16x3_t in = vld3q_u8(src + i);
+		uint8x16x4_t out;
+		out.val[0] = vshrq_n_u8(in.val[0], 2);
+		out.val[1] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[1], 4),
+									  vshlq_n_u8(in.val[0], 4)),
+				mask);
+		out.val[2] = vandq_u8(vorrq_u8(vshrq_n_u8(in.val[2], 6),
+									  vshlq_n_u8(in.val[1], 2)),
+				mask);
+		out.val[3] = vandq_u8(in.val[2], mask);
+		for (uint8x16_t& v : out.val) {
+			v = vqtbl4q_u8(lut, v);
+		}
+		vst4q_u8(reinterpret_cast<uint8_t*>(dst), out);
+	}
+	return i;
+}
+
+inline size_t base64_decode_neon(const char* src, size_t size, uint8_t* dst) {
+	// Ascii 0 to 127, chars above are out of both tables.
+	const uint8x16x4_t lut_lo = base64_load_table(base64_rlut_strict.data());
+	const uint8x16x4_t lut_hi
+			= base64_load_table(base64_rlut_strict.data() + 64);
+	const uint8x16_t offset = vdupq_n_u8(64);
+
+	size_t i = 0;
+	for (; i + 64 <= size; i += 64, dst += 48) {
+		uint8x16x4_t in = vld4q_u8(reinterpret_cast<const uint8_t*>(src + i));
+
+		// Invalid values and chars above 127 have their top bit set.
+		uint8x16_t err = vdupq_n_u8(0);
+		uint8x16x4_t v;
+		for (size_t j = 0; j < 4; ++j) {
+			v.val[j] = vqtbx4q_u8(vqtbl4q_u8(lut_lo, in.val[j]), lut_hi,
+					vsubq_u8(in.val[j], offset));
+			err = vorrq_u8(err, vorrq_u8(v.val[j], in.val[j]));
+		}
+		if ((vmaxvq_u8(err) & 0x80) != 0) {
+			break;
+		}
+
+		uint8x16x3_t out;
+		out.val[0] = vorrq_u8(
+				vshlq_n_u8(v.val[0], 2), vshrq_n_u8(v.val[1], 4));
+		out.val[1] = vorrq_u8(
+				vshlq_n_u8(v.val[1], 4), vshrq_n_u8(v.val[2], 2));
+		out.val[2] = vorrq_u8(vshlq_n_u8(v.val[2], 6), v.val[3]);
+		vst3q_u8(dst, out);
+	}
+	return i;
+}
+#else
+#define FEA_BASE64_NEON 0
+#endif
+
+// Iterators written or read as contiguous chars.
+template <class It>
+concept base64_char_iterator
+		= std::contiguous_iterator<It> && sizeof(std::iter_value_t<It>) == 1;
+
+// Resolved once.
+[[nodiscard]]
+inline base64_encode_fn base64_encode_kernel() {
+	static constexpr dispatch_table<base64_encode_fn> table{ {
+#if FEA_BASE64_NEON
+			&base64_encode_neon,
+#else
+			&base64_encode_none,
+#endif
+#if FEA_DISPATCH
+			&base64_encode_ssse3,
+			&base64_encode_avx2,
+#endif
+	} };
+	static const base64_encode_fn ret = table.resolve();
+	return ret;
+}
+
+// Resolved once.
+[[nodiscard]]
+inline base64_decode_fn base64_decode_kernel() {
+	static constexpr dispatch_table<base64_decode_fn> table{ {
+#if FEA_BASE64_NEON
+			&base64_decode_neon,
+#else
+			&base64_decode_none,
+#endif
+#if FEA_DISPATCH
+			&base64_decode_ssse3,
+			&base64_decode_avx2,
+#endif
+	} };
+	static const base64_decode_fn ret = table.resolve();
+	return ret;
+}
 } // namespace detail
 
+constexpr size_t base64_encoded_size(size_t byte_size) noexcept {
+	return (byte_size + 2) / 3 * 4;
+}
+
+constexpr size_t base64_decoded_size(std::string_view str) noexcept {
+	size_t quads_end = str.size() / 4 * 4;
+	if (quads_end == 0) {
+		return 0;
+	}
+
+	size_t ret = quads_end / 4 * 3;
+	if (str[quads_end - 1] == '=') {
+		--ret;
+		if (str[quads_end - 2] == '=') {
+			--ret;
+		}
+	}
+	return ret;
+}
+
+void to_base64(std::span<const std::byte> in, char* out) noexcept {
+	const uint8_t* src = reinterpret_cast<const uint8_t*>(in.data());
+	size_t i = detail::base64_encode_kernel()(src, in.size(), out);
+	detail::base64_encode_scalar(src + i, in.size() - i, out + i / 3 * 4);
+}
+
+base64_result from_base64(std::string_view in, std::byte* out) noexcept {
+	const std::array<uint8_t, 256>& rlut = detail::base64_rlut_strict;
+	const char* src = in.data();
+	uint8_t* dst = reinterpret_cast<uint8_t*>(out);
+
+	// The last quad may contain padding, decode it separately.
+	const size_t quads_end = in.size() / 4 * 4;
+	const size_t body_end = quads_end == 0 ? 0 : quads_end - 4;
+
+	base64_result ret;
+	auto fail = [&](size_t first, size_t count) {
+		ret.size = size_t(dst - reinterpret_cast<uint8_t*>(out));
+		ret.invalid_idx = first + count;
+		for (size_t i = first; i < first + count; ++i) {
+			if (rlut[uint8_t(src[i])] == 0xFF) {
+				ret.invalid_idx = i;
+				break;
+			}
+		}
+		return ret;
+	};
+
+	size_t i = detail::base64_decode_kernel()(src, body_end, dst);
+	dst += i / 4 * 3;
+	for (; i < body_end; i += 4, dst += 3) {
+		uint32_t a = rlut[uint8_t(src[i])];
+		uint32_t b = rlut[uint8_t(src[i + 1])];
+		uint32_t c = rlut[uint8_t(src[i + 2])];
+		uint32_t d = rlut[uint8_t(src[i + 3])];
+		if (((a | b | c | d) & 0x80) != 0) {
+			return fail(i, 4);
+		}
+
+		uint32_t v = (a << 18) | (b << 12) | (c << 6) | d;
+		dst[0] = uint8_t(v >> 16);
+		dst[1] = uint8_t(v >> 8);
+		dst[2] = uint8_t(v);
+	}
+
+	if (quads_end != 0) {
+		const char* q = src + body_end;
+		size_t pad = q[3] != '=' ? 0 : q[2] != '=' ? 1 : 2;
+
+		uint32_t v = 0;
+		for (size_t j = 0; j < 4 - pad; ++j) {
+			uint32_t part = rlut[uint8_t(q[j])];
+			if (part == 0xFF) {
+				return fail(body_end + j, 1);
+			}
+			v |= part << (18 - j * 6);
+		}
+		for (size_t j = 0; j < 3 - pad; ++j) {
+			*dst++ = uint8_t(v >> (16 - j * 8));
+		}
+	}
+
+	ret.size = size_t(dst - reinterpret_cast<uint8_t*>(out));
+	if (quads_end != in.size()) {
+		ret.invalid_idx = in.size();
+	}
+	return ret;
+}
+
 template <std::forward_iterator FwdIt, std::output_iterator<char> OutIt>
 void to_base64(FwdIt first, FwdIt last, OutIt out) noexcept {
 	using value_t = typename std::iterator_traits<FwdIt>::value_type;
@@ -90,6 +570,30 @@ void to_base64(FwdIt first, FwdIt last, OutIt out) noexcept {
 		return;
 	}
 
+	if constexpr (std::contiguous_iterator<FwdIt>) {
+		std::span<const std::byte> bytes{
+			reinterpret_cast<const std::byte*>(std::to_address(first)),
+			size_t(std::distance(first, last)) * sizeof(value_t),
+		};
+
+		if constexpr (detail::base64_char_iterator<OutIt>) {
+			fea::to_base64(
+					bytes, reinterpret_cast<char*>(std::to_address(out)));
+		} else {
+			// Encode blocks, then copy to the output iterator.
+			std::array<char, 1'024> buf;
+			constexpr size_t block_size = buf.size() / 4 * 3;
+			for (size_t i = 0; i < bytes.size(); i += block_size) {
+				std::span<const std::byte> block = bytes.subspan(
+						i, (std::min)(block_size, bytes.size() - i));
+				fea::to_base64(block, buf.data());
+				out = std::copy_n(
+						buf.begin(), base64_encoded_size(block.size()), out);
+			}
+		}
+		return;
+	}
+
 	// Stage the encoding in 4 bytes.
 	// When the staging is full, flush to output and clear.
 	constexpr int insert_idx_init = 2;
@@ -178,11 +682,10 @@ void from_base64(FwdIt first, FwdIt last, OutIt out) noexcept {
 		// Check that we can fit a perfect amount of Ts inside the base64
 		// encoding.
 		size_t byte_size = (count / 4) * 3;
-		FwdIt tmp_last = last - 1;
-		if (char(*tmp_last) == '=') {
+		if (char(*std::next(first, count - 1)) == '=') {
 			--byte_size;
 
-			if (tmp_last != first && char(*--tmp_last) == '=') {
+			if (count > 1 && char(*std::next(first, count - 2)) == '=') {
 				--byte_size;
 			}
 		}
@@ -190,6 +693,42 @@ void from_base64(FwdIt first, FwdIt last, OutIt out) noexcept {
 		assert(byte_size % sizeof(value_t) == 0);
 	}
 
+	if constexpr (detail::base64_char_iterator<FwdIt>) {
+		std::string_view in{
+			reinterpret_cast<const char*>(std::to_address(first)),
+			size_t(std::distance(first, last)),
+		};
+
+		if constexpr (std::contiguous_iterator<OutIt>) {
+			// Decode directly in the objects' bytes.
+			std::byte* dst = reinterpret_cast<std::byte*>(std::to_address(out));
+			if (fea::from_base64(in, dst).valid()) {
+				return;
+			}
+		} else if constexpr (sizeof(value_t) == 1) {
+			// Decode blocks, then copy to the output iterator.
+			std::array<std::byte, 768> buf;
+			constexpr size_t block_size = buf.size() / 3 * 4;
+			size_t i = 0;
+			for (; i < in.size(); i += block_size) {
+				std::string_view block = in.substr(i, block_size);
+				base64_result res = fea::from_base64(block, buf.data());
+				bool last_block = i + block_size >= in.size();
+				if (!res.valid() || (!last_block && res.size != buf.size())) {
+					break;
+				}
+				out = std::transform(buf.begin(), buf.begin() + res.size, out,
+						[](std::byte b) { return value_t(b); });
+			}
+
+			if (i >= in.size()) {
+				return;
+			}
+			std::advance(first, i);
+		}
+		// Invalid input, the lenient decoder below handles it.
+	}
+
 	// We store 4 "byte parts" (6bit portions) in a staging area.
 	// Once the staging is full, we flush the staging to a temporary data
 	// buffer.
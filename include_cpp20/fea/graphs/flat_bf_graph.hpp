@@ -32,6 +32,8 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #pragma once
 #include "fea/containers/flat_id_slotmap.hpp"
 #include "fea/containers/id_slot_lookup.hpp"
+#include "fea/performance/thread.hpp"
+#include "fea/utility/error.hpp"
 
 #include <algorithm>
 #include <cassert>
@@ -40,6 +42,7 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 #include <memory>
 #include <ranges>
 #include <span>
+#include <stdexcept>
 #include <type_traits>
 #include <utility>
 #include <vector>
@@ -50,6 +53,14 @@ OF THIS SOFTWARE, EVEN IF ADVISED OF THE POSSIBILITY OF SUCH DAMAGE.
 flat_bf_graph is a flat breadth-first constant graph. It is slow to construct
 and modify (topology), but fast to evaluate. It is ordered.
 
+Small topology changes (inserting, erasing or reparenting subtrees) are
+recorded in a flat_bf_graph_patch and applied in one pass. Breadths above the
+first modified one aren't touched, the rest is relocated in place.
+
+Each breadth only depends on the previous one. evaluate_parallel and
+for_each_breadth_parallel process breadths in order, splitting each one
+across the default thread pool.
+
 On full iteration, ids and node data are contiguous. On sub-graph iterations,
 there are memory jumps every breadth.
 
@@ -517,9 +528,99 @@ private:
 };
 
 
+// Records topology changes to apply on a flat_bf_graph.
+// Operations are resolved in order, when applied.
+template <class Key, class Value, class Alloc = std::allocator<Value>>
+struct flat_bf_graph_patch {
+	using key_type = Key;
+	using value_type = Value;
+	using size_type = std::size_t;
+	using allocator_type = Alloc;
+
+	// Invalid sentinel. Set as parent for roots.
+	static constexpr key_type invalid_sentinel
+			= flat_bf_graph_builder<Key, Value, Alloc>::invalid_sentinel;
+
+	/**
+	 * Element access
+	 */
+
+	// Get the parent key used to identify root nodes.
+	[[nodiscard]]
+	static constexpr const key_type& root_key() noexcept {
+		return invalid_sentinel;
+	}
+
+	/**
+	 * Capacity
+	 */
+
+	// Are there any recorded operations?
+	[[nodiscard]]
+	bool empty() const noexcept {
+		return _ops.empty();
+	}
+
+	// Recorded operation count.
+	[[nodiscard]]
+	size_type size() const noexcept {
+		return _ops.size();
+	}
+
+	/**
+	 * Modifiers
+	 */
+	void clear() {
+		_ops.clear();
+		_values.clear();
+	}
+
+	// Insert a new node, as the last child of parent_key.
+	// Use root_key() as parent to insert a root.
+	// Insert subtrees parents first.
+	template <class T>
+		requires(std::is_same_v<std::decay_t<T>, Value>)
+	void push_back(const key_type& parent_key, const key_type& key, T&& v) {
+		assert(key != invalid_sentinel);
+		_ops.push_back({ op_type::insert, key, parent_key });
+		_values.push_back(std::forward<T>(v));
+	}
+
+	// Move a node and its subtree, as the last child of new_parent_key.
+	// Use root_key() as parent to make it a root.
+	void reparent(const key_type& key, const key_type& new_parent_key) {
+		_ops.push_back({ op_type::reparent, key, new_parent_key });
+	}
+
+	// Remove a node and its subtree.
+	void erase(const key_type& key) {
+		_ops.push_back({ op_type::erase, key, invalid_sentinel });
+	}
+
+private:
+	friend fea::experimental::flat_bf_graph<Key, Value, Alloc>;
+
+	enum class op_type : uint8_t { insert, reparent, erase };
+
+	struct op {
+		op_type type;
+		key_type key;
+		key_type parent;
+	};
+
+	// Recorded operations, in order.
+	std::vector<op> _ops{};
+
+	// Inserted values, in insertion order.
+	std::vector<value_type, allocator_type> _values{};
+};
+
+
 namespace detail {
 template <class Key, class Value, class VAlloc, class KeyAlloc, class SpanAlloc>
 struct flat_bf_graph_data {
+	flat_bf_graph_data() = default;
+
 	// template <class UKeyT, class PairAlloc>
 	flat_bf_graph_data(fea::id_slot_lookup<Key, KeyAlloc>&& mlookup,
 			std::vector<Key, KeyAlloc>&& mkeys,
@@ -557,22 +658,22 @@ struct flat_bf_graph_data {
 
 
 	// Key -> vector index.
-	const fea::id_slot_lookup<Key, KeyAlloc> lookup{};
+	fea::id_slot_lookup<Key, KeyAlloc> lookup{};
 
 	// Our keys, ordered vertically.
-	const std::vector<Key, KeyAlloc> keys{};
+	std::vector<Key, KeyAlloc> keys{};
 
 	// Our values, ordered vertically.
 	std::vector<Value, VAlloc> values{};
 
 	// Our parents, ordered vertically.
-	const std::vector<Key, KeyAlloc> parents{};
+	std::vector<Key, KeyAlloc> parents{};
 
 	// Our children (without sub-children).
-	const std::vector<std::span<const Key>, SpanAlloc> children_keys{};
+	std::vector<std::span<const Key>, SpanAlloc> children_keys{};
 
 	// The graph breadths, ordered from first to last.
-	const std::vector<std::span<const Key>, SpanAlloc> breadths{};
+	std::vector<std::span<const Key>, SpanAlloc> breadths{};
 };
 
 template <class Key, class Value, class Alloc, class Func>
@@ -711,6 +812,7 @@ struct flat_bf_graph {
 			typename std::vector<key_type, key_allocator_type>::const_iterator;
 
 	using builder_t = flat_bf_graph_builder<Key, Value, VAlloc>;
+	using patch_t = flat_bf_graph_patch<Key, Value, VAlloc>;
 	using data_t = detail::flat_bf_graph_data<key_type, value_type,
 			allocator_type, key_allocator_type, span_allocator_type>;
 
@@ -975,6 +1077,84 @@ struct flat_bf_graph {
 		return end();
 	}
 
+	/**
+	 * Evaluation
+	 */
+
+	// Default number of nodes per parallel task.
+	static constexpr size_type default_grain_size = 1024;
+
+	// Calls func(std::span<const key_type>, std::span<value_type>) on each
+	// breadth, root to leaf.
+	template <class Func>
+	void for_each_breadth(Func&& func) {
+		for (size_type b = 0; b < breadth_size(); ++b) {
+			const size_type first = breadth_offset(b);
+			const size_type count = _data.breadths[b].size();
+			func(std::span<const key_type>{
+						 _data.keys.data() + first, count },
+					std::span<value_type>{
+							_data.values.data() + first, count });
+		}
+	}
+
+	// Calls func(std::span<const key_type>, std::span<value_type>) on
+	// contiguous ranges of each breadth, root to leaf.
+	// A breadth's ranges are processed in parallel, and it is completed
+	// before the next breadth starts. Breadths of grain_size nodes or less
+	// are processed on the calling thread.
+	template <class Func>
+	void for_each_breadth_parallel(
+			Func&& func, size_type grain_size = default_grain_size) {
+		for (size_type b = 0; b < breadth_size(); ++b) {
+			const size_type first = breadth_offset(b);
+			const size_type count = _data.breadths[b].size();
+			if (count <= grain_size) {
+				func(std::span<const key_type>{
+							 _data.keys.data() + first, count },
+						std::span<value_type>{
+								_data.values.data() + first, count });
+				continue;
+			}
+
+			fea::parallel_for(count, grain_size,
+					[&](const std::pair<size_t, size_t>& r) {
+						const size_type f = first + r.first;
+						const size_type c = r.second - r.first;
+						func(std::span<const key_type>{
+									 _data.keys.data() + f, c },
+								std::span<value_type>{
+										_data.values.data() + f, c });
+					});
+		}
+	}
+
+	// Calls func(const key_type&, value_type&, const value_type* parent) on
+	// every node, parents before children. parent is nullptr for roots.
+	template <class Func>
+	void evaluate(Func&& func) {
+		for_each_breadth([&](std::span<const key_type> mkeys,
+								 std::span<value_type> mvalues) {
+			evaluate_range(mkeys, mvalues, func);
+		});
+	}
+
+	// Calls func(const key_type&, value_type&, const value_type* parent) on
+	// every node, parents before children. parent is nullptr for roots.
+	// Breadths are processed in parallel, see for_each_breadth_parallel.
+	// func may read other nodes of previous breadths, and only modify the
+	// node it receives.
+	template <class Func>
+	void evaluate_parallel(
+			Func&& func, size_type grain_size = default_grain_size) {
+		for_each_breadth_parallel(
+				[&](std::span<const key_type> mkeys,
+						std::span<value_type> mvalues) {
+					evaluate_range(mkeys, mvalues, func);
+				},
+				grain_size);
+	}
+
 	/**
 	 * Capacity
 	 */
@@ -1037,10 +1217,385 @@ struct flat_bf_graph {
 		return _data.keys.capacity();
 	}
 
+	// Reserves storage, so patches can grow the graph without reallocating.
+	// Invalidates spans, pointers and iterators if storage grows.
+	void reserve(size_type new_cap) {
+		if (new_cap > capacity()) {
+			grow(new_cap);
+		}
+	}
+
+	/**
+	 * Modifiers
+	 */
+
+	// Apply recorded topology changes.
+	// Breadths above the first modified one are left untouched. The following
+	// ones are relocated in place, in a single pass. Keys and values stay
+	// contiguous.
+	// Invalidates spans, pointers and iterators past the first modified
+	// breadth, or all of them if storage grows.
+	void apply(patch_t&& patch) {
+		patch_state st{};
+		size_type value_idx = 0;
+
+		for (const typename patch_t::op& o : patch._ops) {
+			if (o.type == patch_t::op_type::insert) {
+				if (patch_contains(st, o.key)) {
+					fea::maybe_throw<std::invalid_argument>(__FUNCTION__,
+							__LINE__, "key already exists");
+				}
+				if (o.parent != root_key() && !patch_contains(st, o.parent)) {
+					fea::maybe_throw<std::invalid_argument>(
+							__FUNCTION__, __LINE__, "parent doesn't exist");
+				}
+
+				st.inserted.insert(o.key, value_idx++);
+				st.parents.insert(o.key, o.parent);
+				patch_children(st, o.parent).push_back(o.key);
+				continue;
+			}
+
+			if (!patch_contains(st, o.key)) {
+				fea::maybe_throw<std::invalid_argument>(
+						__FUNCTION__, __LINE__, "key doesn't exist");
+			}
+
+			if (o.type == patch_t::op_type::erase) {
+				patch_erase(st, o.key);
+				continue;
+			}
+
+			assert(o.type == patch_t::op_type::reparent);
+			if (o.parent != root_key() && !patch_contains(st, o.parent)) {
+				fea::maybe_throw<std::invalid_argument>(
+						__FUNCTION__, __LINE__, "parent doesn't exist");
+			}
+			for (key_type p = o.parent; p != root_key();
+					p = patch_parent(st, p)) {
+				if (p == o.key) {
+					fea::maybe_throw<std::invalid_argument>(__FUNCTION__,
+							__LINE__, "cannot reparent to own subtree");
+				}
+			}
+
+			patch_detach(st, o.key);
+			patch_children(st, o.parent).push_back(o.key);
+			st.parents.insert_or_assign(o.key, o.parent);
+		}
+
+		patch_rebuild(st, patch._values);
+		patch.clear();
+	}
+
 private:
+	template <class Func>
+	void evaluate_range(std::span<const key_type> mkeys,
+			std::span<value_type> mvalues, Func& func) {
+		const size_type first = size_type(mkeys.data() - _data.keys.data());
+		for (size_type i = 0; i < mkeys.size(); ++i) {
+			const key_type& parent_key = _data.parents[first + i];
+			const value_type* parent = nullptr;
+			if (parent_key != root_key()) {
+				parent = &_data.values[_data.lookup.at_unchecked(parent_key)];
+			}
+			func(mkeys[i], mvalues[i], parent);
+		}
+	}
+
+	// Topology changes, resolved while applying a patch.
+	struct patch_state {
+		// Current parents of inserted and moved nodes.
+		fea::flat_id_slotmap<key_type, key_type> parents{};
+
+		// Modified children lists.
+		fea::flat_id_slotmap<key_type, std::vector<key_type>> children{};
+
+		// Inserted node keys, to their index in the patch values.
+		// A key erased then reinserted is both here and in erased.
+		fea::flat_id_slotmap<key_type, size_type> inserted{};
+
+		// Erased graph nodes, whole subtrees.
+		fea::flat_id_slotmap<key_type, bool> erased{};
+
+		// Modified roots, if roots_dirty.
+		std::vector<key_type> roots{};
+		bool roots_dirty = false;
+
+		// The first breadth which must be rebuilt.
+		size_type first_breadth = (std::numeric_limits<size_type>::max)();
+	};
+
+	// Index of the first key in breadth b. Accepts breadth_size().
+	[[nodiscard]]
+	size_type breadth_offset(size_type b) const noexcept {
+		if (b == _data.breadths.size()) {
+			return _data.keys.size();
+		}
+		return size_type(_data.breadths[b].data() - _data.keys.data());
+	}
+
+	// The breadth containing the key at index idx.
+	[[nodiscard]]
+	size_type breadth_of(size_type idx) const noexcept {
+		auto it = std::upper_bound(_data.breadths.begin(),
+				_data.breadths.end(), idx,
+				[&](size_type i, const std::span<const key_type>& b) {
+					return i < size_type(b.data() - _data.keys.data());
+				});
+		assert(it != _data.breadths.begin());
+		return size_type(it - _data.breadths.begin()) - 1u;
+	}
+
+	// The parent of k, with the patch changes so far.
+	[[nodiscard]]
+	key_type patch_parent(const patch_state& st, const key_type& k) const {
+		auto it = st.parents.find(k);
+		if (it != st.parents.end()) {
+			return *it;
+		}
+		return _data.parents[_data.lookup.at_unchecked(k)];
+	}
+
+	// Is k in the graph, with the patch changes so far?
+	[[nodiscard]]
+	bool patch_contains(const patch_state& st, const key_type& k) const {
+		return (contains(k) && !st.erased.contains(k))
+				|| st.inserted.contains(k);
+	}
+
+	// The children of k, with the patch changes so far.
+	// Invalidated by patch_children.
+	[[nodiscard]]
+	std::span<const key_type> patch_children_of(
+			const patch_state& st, const key_type& k) const {
+		auto it = st.children.find(k);
+		if (it != st.children.end()) {
+			return { *it };
+		}
+		if (st.inserted.contains(k)) {
+			return {};
+		}
+		return _data.children_keys[_data.lookup.at_unchecked(k)];
+	}
+
+	// Get a modifiable children list, copied from the graph on first access.
+	// Invalidated by the next call.
+	std::vector<key_type>& patch_children(
+			patch_state& st, const key_type& parent_key) {
+		if (parent_key == root_key()) {
+			if (!st.roots_dirty && !_data.breadths.empty()) {
+				st.roots.assign(_data.breadths.front().begin(),
+						_data.breadths.front().end());
+			}
+			st.roots_dirty = true;
+			st.first_breadth = 0;
+			return st.roots;
+		}
+
+		auto it = st.children.find(parent_key);
+		if (it != st.children.end()) {
+			return *it;
+		}
+
+		std::vector<key_type> children;
+		if (contains(parent_key) && !st.inserted.contains(parent_key)) {
+			size_type idx = _data.lookup.at_unchecked(parent_key);
+			const std::span<const key_type>& c = _data.children_keys[idx];
+			children.assign(c.begin(), c.end());
+			st.first_breadth
+					= (std::min)(st.first_breadth, breadth_of(idx) + 1);
+		}
+		return *st.children.insert(parent_key, std::move(children)).first;
+	}
+
+	// Remove k from its current parent's children.
+	void patch_detach(patch_state& st, const key_type& k) {
+		std::vector<key_type>& siblings
+				= patch_children(st, patch_parent(st, k));
+		auto it = std::find(siblings.begin(), siblings.end(), k);
+		assert(it != siblings.end());
+		siblings.erase(it);
+	}
+
+	// Detach k and remove its whole subtree. Graph nodes are marked erased,
+	// nodes inserted by the patch are forgotten.
+	void patch_erase(patch_state& st, const key_type& k) {
+		patch_detach(st, k);
+
+		std::vector<key_type> stack{ k };
+		while (!stack.empty()) {
+			key_type d = stack.back();
+			stack.pop_back();
+
+			std::span<const key_type> children = patch_children_of(st, d);
+			stack.insert(stack.end(), children.begin(), children.end());
+			st.children.erase(d);
+			st.parents.erase(d);
+
+			if (st.inserted.contains(d)) {
+				st.inserted.erase(d);
+			} else {
+				st.erased.insert(d, true);
+			}
+		}
+	}
+
+	// Regenerate the breadths from st.first_breadth onwards.
+	void patch_rebuild(
+			patch_state& st, std::vector<value_type, allocator_type>& values) {
+		if (st.first_breadth == (std::numeric_limits<size_type>::max)()) {
+			return;
+		}
+
+		const size_type first_b = st.first_breadth;
+		const size_type old_size = _data.keys.size();
+		const size_type prefix = breadth_offset(first_b);
+		assert(first_b <= _data.breadths.size());
+
+		// Children spans are rewritten starting from the parents breadth.
+		size_type span_b = first_b == 0 ? 0 : first_b - 1;
+
+		// The new keys, parents and value sources, ordered breadth-first.
+		// Sources past old_size index the patch values.
+		std::vector<key_type> mkeys;
+		std::vector<key_type> mparents;
+		std::vector<size_type> msources;
+
+		// Children counts of nodes from span_b, and breadth sizes from span_b.
+		std::vector<size_type> counts;
+		std::vector<size_type> bsizes;
+
+		auto push_children = [&](const key_type& parent_key,
+									 std::span<const key_type> children) {
+			for (const key_type& k : children) {
+				mkeys.push_back(k);
+				mparents.push_back(parent_key);
+
+				auto it = st.inserted.find(k);
+				if (it != st.inserted.end()) {
+					msources.push_back(old_size + *it);
+				} else {
+					msources.push_back(_data.lookup.at_unchecked(k));
+					assert(msources.back() >= prefix);
+				}
+			}
+		};
+
+		if (first_b == 0) {
+			assert(st.roots_dirty);
+			push_children(root_key(), st.roots);
+		} else {
+			bsizes.push_back(_data.breadths[span_b].size());
+			for (const key_type& k : _data.breadths[span_b]) {
+				std::span<const key_type> children = patch_children_of(st, k);
+				counts.push_back(children.size());
+				push_children(k, children);
+			}
+		}
+
+		size_type b_begin = 0;
+		size_type b_end = mkeys.size();
+		while (b_begin != b_end) {
+			bsizes.push_back(b_end - b_begin);
+			for (size_type i = b_begin; i < b_end; ++i) {
+				key_type k = mkeys[i];
+				std::span<const key_type> children = patch_children_of(st, k);
+				counts.push_back(children.size());
+				push_children(k, children);
+			}
+			b_begin = b_end;
+			b_end = mkeys.size();
+		}
+
+		// Relocated and erased keys are reinserted below.
+		for (size_type i = prefix; i < old_size; ++i) {
+			_data.lookup.invalidate(_data.keys[i]);
+		}
+
+		std::vector<value_type, allocator_type> mvalues;
+		mvalues.reserve(msources.size());
+		for (size_type src : msources) {
+			if (src < old_size) {
+				mvalues.push_back(std::move(_data.values[src]));
+			} else {
+				mvalues.push_back(std::move(values[src - old_size]));
+			}
+		}
+
+		const size_type new_size = prefix + mkeys.size();
+		if (new_size > _data.keys.capacity()) {
+			grow((std::max)(new_size, _data.keys.capacity() * 2u));
+		}
+
+		_data.keys.resize(prefix);
+		_data.keys.insert(_data.keys.end(), mkeys.begin(), mkeys.end());
+		_data.parents.resize(prefix);
+		_data.parents.insert(
+				_data.parents.end(), mparents.begin(), mparents.end());
+		_data.values.erase(_data.values.begin() + prefix, _data.values.end());
+		_data.values.insert(_data.values.end(),
+				std::make_move_iterator(mvalues.begin()),
+				std::make_move_iterator(mvalues.end()));
+		_data.children_keys.resize(new_size);
+		_data.breadths.resize(span_b + bsizes.size());
+
+		for (size_type i = prefix; i < new_size; ++i) {
+			_data.lookup.insert(_data.keys[i], i);
+		}
+
+		respan(span_b, counts, bsizes);
+	}
+
+	// Reallocate storage and rewrite all spans.
+	void grow(size_type new_cap) {
+		std::vector<size_type> counts(_data.children_keys.size());
+		for (size_type i = 0; i < counts.size(); ++i) {
+			counts[i] = _data.children_keys[i].size();
+		}
+		std::vector<size_type> bsizes(_data.breadths.size());
+		for (size_type i = 0; i < bsizes.size(); ++i) {
+			bsizes[i] = _data.breadths[i].size();
+		}
+
+		_data.keys.reserve(new_cap);
+		_data.values.reserve(new_cap);
+		_data.parents.reserve(new_cap);
+		_data.children_keys.reserve(new_cap);
+		_data.lookup.reserve((std::max)(new_cap, _data.lookup.capacity()));
+		respan(0, counts, bsizes);
+	}
+
+	// Rewrite breadth and children spans, from breadth first_b onwards.
+	// counts holds the children count of every node from that breadth,
+	// bsizes every breadth size.
+	void respan(size_type first_b, std::span<const size_type> counts,
+			std::span<const size_type> bsizes) {
+		assert(_data.breadths.size() == first_b + bsizes.size());
+		const key_type* base = _data.keys.data();
+		const size_type first = first_b == 0 ? 0 : breadth_offset(first_b);
+
+		size_type pos = first;
+		for (size_type i = 0; i < bsizes.size(); ++i) {
+			_data.breadths[first_b + i] = { base + pos, bsizes[i] };
+			pos += bsizes[i];
+		}
+		assert(pos == _data.keys.size());
+
+		// Children of breadth b nodes are stored in breadth b + 1, in order.
+		pos = bsizes.empty() ? first : first + bsizes.front();
+		for (size_type i = 0; i < counts.size(); ++i) {
+			_data.children_keys[first + i] = { base + pos, counts[i] };
+			pos += counts[i];
+		}
+		assert(first + counts.size() == _data.keys.size());
+		assert(pos == _data.keys.size());
+	}
+
 	// Our internal lookup and vectors.
 	// All vectors are vertically aligned in soa fashion.
-	// All data is const except values, which can be modified but not reordered.
+	// Only values may be modified (not reordered), topology changes go
+	// through apply.
 	data_t _data{};
 };
 
@@ -1,11 +1,15 @@
 #include <algorithm>
+#include <array>
 #include <fea/algorithm/sort.hpp>
+#include <fea/algorithm/sort_mt.hpp>
 #include <fea/benchmark/benchmark.hpp>
 #include <fea/numerics/random.hpp>
 #include <fea/utility/error.hpp>
 #include <fea/utility/platform.hpp>
 #include <gtest/gtest.h>
+#include <limits>
 #include <numeric>
+#include <string>
 #include <thread>
 #include <vector>
 
@@ -669,6 +673,310 @@ TEST(sort, radix_floats) {
 	}
 }
 
+template <class T>
+void test_radix_variants(size_t count, T min, T max) {
+	std::vector<T> in(count);
+	fea::random_fill(in.begin(), in.end(), min, max);
+	std::vector<T> cmp = in;
+	std::sort(cmp.begin(), cmp.end());
+
+	std::vector<T> scratch(count);
+
+	std::vector<T> vals = in;
+	fea::radix_sort(vals.begin(), vals.end());
+	EXPECT_EQ(vals, cmp);
+
+	vals = in;
+	fea::radix_sort(vals.begin(), vals.end(),
+			fea::span<T>{ scratch.data(), scratch.size() });
+	EXPECT_EQ(vals, cmp);
+
+	vals = in;
+	fea::radix_sort_mt(vals.begin(), vals.end());
+	EXPECT_EQ(vals, cmp);
+
+	vals = in;
+	fea::radix_sort_mt(vals.begin(), vals.end(),
+			fea::span<T>{ scratch.data(), scratch.size() });
+	EXPECT_EQ(vals, cmp);
+
+	// Already sorted.
+	fea::radix_sort_mt(vals.begin(), vals.end());
+	EXPECT_EQ(vals, cmp);
+}
+
+template <class T>
+void test_radix_variants(T min, T max) {
+	// Insertion sort, single threaded radix, multi-threaded radix.
+	for (size_t count : { size_t(2), size_t(17), size_t(63), size_t(64),
+				 size_t(1'000), size_t(100'000) }) {
+		test_radix_variants<T>(count, min, max);
+	}
+}
+
+TEST(sort, radix_variants) {
+	test_radix_variants<uint8_t>(0, 255);
+	test_radix_variants<int8_t>(-128, 127);
+	test_radix_variants<uint16_t>(0, 65535);
+	test_radix_variants<int16_t>(-32768, 32767);
+	test_radix_variants<uint32_t>(0, (std::numeric_limits<uint32_t>::max)());
+	test_radix_variants<int>(
+			(std::numeric_limits<int>::lowest)(), (std::numeric_limits<int>::max)());
+	test_radix_variants<uint64_t>(0, (std::numeric_limits<uint64_t>::max)());
+	test_radix_variants<int64_t>((std::numeric_limits<int64_t>::lowest)(),
+			(std::numeric_limits<int64_t>::max)());
+	test_radix_variants<float>(-100000.f, 100000.f);
+	test_radix_variants<double>(-100000.0, 100000.0);
+
+	// Few unique values, some passes are skipped.
+	test_radix_variants<uint32_t>(100'000, 0, 3);
+	test_radix_variants<int64_t>(100'000, -2, 2);
+
+	// Scratch too small.
+	std::vector<int> vals(10);
+	std::vector<int> scratch(9);
+#if FEA_DEBUG || FEA_NOTHROW
+	EXPECT_DEATH(fea::radix_sort(vals.begin(), vals.end(),
+						 fea::span<int>{ scratch.data(), scratch.size() }),
+			"");
+	EXPECT_DEATH(fea::radix_sort_mt(vals.begin(), vals.end(),
+						 fea::span<int>{ scratch.data(), scratch.size() }),
+			"");
+#else
+	EXPECT_THROW(fea::radix_sort(vals.begin(), vals.end(),
+						 fea::span<int>{ scratch.data(), scratch.size() }),
+			std::invalid_argument);
+	EXPECT_THROW(fea::radix_sort_mt(vals.begin(), vals.end(),
+						 fea::span<int>{ scratch.data(), scratch.size() }),
+			std::invalid_argument);
+#endif
+}
+
+struct record {
+	int64_t time = 0;
+	float weight = 0.f;
+	uint32_t id = 0;
+	std::string name;
+};
+
+TEST(sort, radix_sort_by) {
+	std::vector<record> in;
+	for (uint32_t i = 0; i < 10'000; ++i) {
+		record r;
+		r.time = fea::random_val<int64_t>(-500, 500);
+		r.weight = fea::random_val(-1000.f, 1000.f);
+		r.id = i;
+		r.name = std::to_string(i);
+		in.push_back(std::move(r));
+	}
+
+	// Member pointer projection.
+	{
+		std::vector<record> vals = in;
+		std::vector<record> cmp = in;
+		fea::radix_sort_by(vals.begin(), vals.end(), &record::time);
+		std::stable_sort(cmp.begin(), cmp.end(),
+				[](const record& lhs, const record& rhs) {
+					return lhs.time < rhs.time;
+				});
+
+		// Stable, equal times keep their original order.
+		for (size_t i = 0; i < vals.size(); ++i) {
+			EXPECT_EQ(vals[i].time, cmp[i].time);
+			EXPECT_EQ(vals[i].id, cmp[i].id);
+			EXPECT_EQ(vals[i].name, std::to_string(vals[i].id));
+		}
+	}
+
+	// Callable projection, user scratch.
+	{
+		std::vector<record> vals = in;
+		std::vector<record> scratch(vals.size());
+		fea::radix_sort_by(
+				vals.begin(), vals.end(),
+				[](const record& r) { return r.weight; },
+				fea::span<record>{ scratch.data(), scratch.size() });
+		EXPECT_TRUE(std::is_sorted(vals.begin(), vals.end(),
+				[](const record& lhs, const record& rhs) {
+					return lhs.weight < rhs.weight;
+				}));
+		for (const record& r : vals) {
+			EXPECT_EQ(r.name, std::to_string(r.id));
+		}
+
+		// Already sorted, by unsigned key.
+		fea::radix_sort_by(vals.begin(), vals.end(), &record::id);
+		for (size_t i = 0; i < vals.size(); ++i) {
+			EXPECT_EQ(vals[i].id, uint32_t(i));
+		}
+		fea::radix_sort_by(vals.begin(), vals.end(), &record::id);
+		for (size_t i = 0; i < vals.size(); ++i) {
+			EXPECT_EQ(vals[i].id, uint32_t(i));
+		}
+	}
+
+	// Tiny.
+	{
+		std::vector<record> vals(1);
+		fea::radix_sort_by(vals.begin(), vals.end(), &record::time);
+		vals.clear();
+		fea::radix_sort_by(vals.begin(), vals.end(), &record::time);
+	}
+}
+
+TEST(sort, radix_sort_paired) {
+	constexpr size_t count = 10'000;
+	std::vector<double> keys(count);
+	fea::random_fill(keys.begin(), keys.end(), -1000.0, 1000.0);
+	std::vector<std::string> payload;
+	for (size_t i = 0; i < count; ++i) {
+		payload.push_back(std::to_string(keys[i]));
+	}
+
+	std::vector<double> cmp = keys;
+	std::sort(cmp.begin(), cmp.end());
+
+	fea::radix_sort_paired(
+			keys.begin(), keys.end(), payload.begin(), payload.end());
+	EXPECT_EQ(keys, cmp);
+	for (size_t i = 0; i < count; ++i) {
+		EXPECT_EQ(payload[i], std::to_string(keys[i]));
+	}
+
+	// Stable.
+	std::vector<uint8_t> small_keys{ 3, 1, 3, 1, 2, 2 };
+	std::vector<int> small_payload{ 0, 1, 2, 3, 4, 5 };
+	fea::radix_sort_paired(small_keys.begin(), small_keys.end(),
+			small_payload.begin(), small_payload.end());
+	EXPECT_EQ(small_keys, (std::vector<uint8_t>{ 1, 1, 2, 2, 3, 3 }));
+	EXPECT_EQ(small_payload, (std::vector<int>{ 1, 3, 4, 5, 0, 2 }));
+
+	small_payload.pop_back();
+#if FEA_DEBUG || FEA_NOTHROW
+	EXPECT_DEATH(fea::radix_sort_paired(small_keys.begin(), small_keys.end(),
+						 small_payload.begin(), small_payload.end()),
+			"");
+#else
+	EXPECT_THROW(fea::radix_sort_paired(small_keys.begin(), small_keys.end(),
+						 small_payload.begin(), small_payload.end()),
+			std::invalid_argument);
+#endif
+}
+
+#if FEA_RELEASE
+TEST(sort, radix_mt_benchmarks) {
+	using t = float;
+	constexpr size_t count = 10'000'000;
+	std::vector<t> in(count);
+	fea::random_fill(in.begin(), in.end(), -100000.f, 100000.f);
+	std::vector<t> vals = in;
+	std::vector<t> scratch(count);
+
+	fea::bench::suite suite;
+	suite.title("Radix Sort, 10 million floats");
+	constexpr size_t avg = 5;
+	suite.average(avg);
+
+	auto reset = [&]() { std::copy(in.begin(), in.end(), vals.begin()); };
+	auto check = [&]() {
+		if (!std::is_sorted(vals.begin(), vals.end())) {
+			fea::maybe_throw<std::invalid_argument>(
+					__FUNCTION__, __LINE__, "Failed to sort.");
+		}
+		reset();
+	};
+
+	suite.benchmark(
+			"std::sort",
+			[&]() { std::sort(vals.begin(), vals.end()); }, check);
+	suite.benchmark(
+			"fea::radix_sort",
+			[&]() { fea::radix_sort(vals.begin(), vals.end()); }, check);
+	suite.benchmark(
+			"fea::radix_sort : scratch",
+			[&]() {
+				fea::radix_sort(vals.begin(), vals.end(),
+						fea::span<t>{ scratch.data(), scratch.size() });
+			},
+			check);
+	suite.benchmark(
+			"fea::radix_sort_mt",
+			[&]() { fea::radix_sort_mt(vals.begin(), vals.end()); }, check);
+	suite.benchmark(
+			"fea::radix_sort_mt : scratch",
+			[&]() {
+				fea::radix_sort_mt(vals.begin(), vals.end(),
+						fea::span<t>{ scratch.data(), scratch.size() });
+			},
+			check);
+	suite.print();
+}
+
+TEST(sort, radix_sort_by_benchmarks) {
+	struct event {
+		double time = 0.0;
+		uint64_t id = 0;
+		std::array<uint8_t, 16> data{};
+	};
+
+	constexpr size_t count = 1'000'000;
+	std::vector<event> in(count);
+	for (size_t i = 0; i < count; ++i) {
+		in[i].time = fea::random_val(0.0, 1000.0);
+		in[i].id = i;
+	}
+	std::vector<event> vals = in;
+
+	fea::bench::suite suite;
+	suite.title("Radix Sort By, 1 million events");
+	suite.average(5);
+
+	auto check = [&]() {
+		if (!std::is_sorted(vals.begin(), vals.end(),
+					[](const event& lhs, const event& rhs) {
+						return lhs.time < rhs.time;
+					})) {
+			fea::maybe_throw<std::invalid_argument>(
+					__FUNCTION__, __LINE__, "Failed to sort.");
+		}
+		std::copy(in.begin(), in.end(), vals.begin());
+	};
+
+	suite.benchmark(
+			"std::stable_sort",
+			[&]() {
+				std::stable_sort(vals.begin(), vals.end(),
+						[](const event& lhs, const event& rhs) {
+							return lhs.time < rhs.time;
+						});
+			},
+			check);
+
+	std::vector<double> times(count);
+	std::vector<size_t> idxes(count);
+	suite.benchmark(
+			"fea::radix_sort_idxes + gather",
+			[&]() {
+				for (size_t i = 0; i < count; ++i) {
+					times[i] = vals[i].time;
+				}
+				std::iota(idxes.begin(), idxes.end(), size_t(0));
+				fea::radix_sort_idxes(
+						times.begin(), times.end(), idxes.begin(), idxes.end());
+				sort_vals(idxes, &vals);
+			},
+			check);
+
+	suite.benchmark(
+			"fea::radix_sort_by",
+			[&]() {
+				fea::radix_sort_by(vals.begin(), vals.end(), &event::time);
+			},
+			check);
+	suite.print();
+}
+#endif
+
 #if 0 && FEA_RELEASE
 TEST(sort, radix_benchmarks) {
 	using t = float;
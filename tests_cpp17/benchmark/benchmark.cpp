@@ -1,12 +1,21 @@
 ﻿#include <chrono>
 #include <cstdio>
 #include <fea/benchmark/benchmark.hpp>
+#include <fea/utility/file.hpp>
+#include <filesystem>
 #include <gtest/gtest.h>
 #include <thread>
+#include <vector>
 
+extern const char* argv0;
 using namespace std::chrono_literals;
 
 namespace {
+std::filesystem::path filepath(const char* filename) {
+	const std::filesystem::path dir = fea::executable_dir(argv0) / "tests_data";
+	std::filesystem::create_directory(dir);
+	return dir / filename;
+}
 
 TEST(fea_benchmark, basics) {
 	// TODO : This tests nothing, rewrite.
@@ -55,4 +64,192 @@ TEST(fea_benchmark, basics) {
 	// suite.print();
 }
 
+TEST(fea_benchmark, statistics) {
+	fea::bench::suite suite;
+	suite.title("suite statistics");
+
+	size_t num_calls = 0;
+	size_t in_between = 0;
+	suite.warmup(3);
+	suite.average(20);
+	suite.benchmark(
+			"count", [&]() { ++num_calls; }, [&]() { ++in_between; });
+	EXPECT_EQ(num_calls, 23u);
+	EXPECT_EQ(in_between, 23u);
+
+	ASSERT_EQ(suite.results().size(), 1u);
+	{
+		const fea::bench::result& r = suite.results()[0];
+		EXPECT_EQ(r.suite, "suite statistics");
+		EXPECT_EQ(r.name, "count");
+		EXPECT_EQ(r.samples, 20u);
+		EXPECT_EQ(r.iterations, 1u);
+		EXPECT_EQ(r.outliers, 0u);
+		EXPECT_LE(r.min, r.median);
+		EXPECT_LE(r.median, r.p90);
+		EXPECT_LE(r.p90, r.p99);
+		EXPECT_LE(r.p99, r.max);
+		EXPECT_LE(r.min, r.mean);
+		EXPECT_LE(r.mean, r.max);
+	}
+
+	// Calibration runs short functions many times per sample.
+	num_calls = 0;
+	suite.warmup(0);
+	suite.average(4);
+	suite.calibrate(1ms);
+	suite.benchmark("calibrated", [&]() {
+		++num_calls;
+		fea::bench::clobber();
+	});
+	ASSERT_EQ(suite.results().size(), 2u);
+	{
+		const fea::bench::result& r = suite.results()[1];
+		EXPECT_GT(r.iterations, 1u);
+		EXPECT_EQ(r.samples, 4u);
+		EXPECT_GE(num_calls, r.iterations * 4);
+	}
+
+	// A single very slow sample is rejected.
+	suite.calibrate(0ns);
+	suite.average(20);
+	suite.reject_outliers(3.0);
+	num_calls = 0;
+	suite.benchmark("outlier", [&]() {
+		if (num_calls++ == 10) {
+			std::this_thread::sleep_for(50ms);
+		}
+	});
+	ASSERT_EQ(suite.results().size(), 3u);
+	{
+		const fea::bench::result& r = suite.results()[2];
+		EXPECT_EQ(r.outliers, 1u);
+		EXPECT_EQ(r.samples, 19u);
+		EXPECT_LT(r.max, 0.05);
+	}
+
+	// There is always at least one sample.
+	{
+		fea::bench::suite s2;
+		s2.average(0);
+		s2.benchmark("one", []() {});
+		ASSERT_EQ(s2.results().size(), 1u);
+		EXPECT_EQ(s2.results()[0].samples, 1u);
+		EXPECT_EQ(s2.results()[0].min, s2.results()[0].max);
+	}
+}
+
+TEST(fea_benchmark, reports) {
+	fea::bench::result r1;
+	r1.suite = "a \"quoted\" suite";
+	r1.name = "name, with\ttab";
+	r1.samples = 10;
+	r1.iterations = 100;
+	r1.outliers = 1;
+	r1.mean = 0.5;
+	r1.min = 0.1;
+	r1.median = 0.4;
+	r1.p90 = 0.8;
+	r1.p99 = 0.9;
+	r1.max = 1.0 / 3.0;
+	r1.stddev = 0.01;
+	r1.counters[size_t(fea::bench::perf_counter::instructions)] = 42.5;
+
+	fea::bench::result r2;
+	r2.name = "other";
+
+	const std::vector<fea::bench::result> results{ r1, r2 };
+	const std::filesystem::path json_path = filepath("bench.json");
+	ASSERT_TRUE(fea::bench::write_json(json_path, results));
+	EXPECT_TRUE(fea::bench::write_csv(filepath("bench.csv"), results));
+
+	std::vector<fea::bench::result> read;
+	ASSERT_TRUE(fea::bench::read_json(json_path, read));
+	ASSERT_EQ(read.size(), 2u);
+	EXPECT_EQ(read[0].suite, r1.suite);
+	EXPECT_EQ(read[0].name, r1.name);
+	EXPECT_EQ(read[0].samples, r1.samples);
+	EXPECT_EQ(read[0].iterations, r1.iterations);
+	EXPECT_EQ(read[0].outliers, r1.outliers);
+	EXPECT_EQ(read[0].mean, r1.mean);
+	EXPECT_EQ(read[0].min, r1.min);
+	EXPECT_EQ(read[0].median, r1.median);
+	EXPECT_EQ(read[0].p90, r1.p90);
+	EXPECT_EQ(read[0].p99, r1.p99);
+	EXPECT_EQ(read[0].max, r1.max);
+	EXPECT_EQ(read[0].stddev, r1.stddev);
+	EXPECT_EQ(read[0].counters, r1.counters);
+	EXPECT_EQ(read[1].counters, r2.counters);
+	EXPECT_EQ(read[1].suite, "");
+	EXPECT_EQ(read[1].name, "other");
+
+	EXPECT_FALSE(fea::bench::read_json(filepath("bench.csv"), read));
+	EXPECT_FALSE(fea::bench::read_json(filepath("doesnt_exist.json"), read));
+	EXPECT_EQ(read.size(), 2u);
+
+	EXPECT_TRUE(fea::bench::write_json(json_path, {}));
+	EXPECT_TRUE(fea::bench::read_json(json_path, read));
+	EXPECT_TRUE(read.empty());
+}
+
+TEST(fea_benchmark, regressions) {
+	fea::bench::result base;
+	base.samples = 10;
+	base.mean = 1.0;
+	base.stddev = 0.1;
+
+	// Within threshold.
+	fea::bench::result cur = base;
+	cur.mean = 1.04;
+	EXPECT_FALSE(fea::bench::is_regression(base, cur, 0.05));
+
+	// Above threshold, but noise.
+	cur.mean = 1.1;
+	cur.stddev = 0.3;
+	EXPECT_FALSE(fea::bench::is_regression(base, cur, 0.05));
+
+	// Significant.
+	cur.stddev = 0.05;
+	EXPECT_TRUE(fea::bench::is_regression(base, cur, 0.05));
+
+	// Faster is never a regression.
+	cur.mean = 0.5;
+	EXPECT_FALSE(fea::bench::is_regression(base, cur, 0.05));
+
+	// Single samples only use the threshold.
+	base.samples = 1;
+	cur.mean = 1.1;
+	EXPECT_TRUE(fea::bench::is_regression(base, cur, 0.05));
+
+	// Printed suites are compared against the loaded baseline.
+	base.suite = "regressions";
+	base.name = "slow";
+	base.samples = 10;
+	base.mean = 1e-6;
+	base.stddev = 0.0;
+	const std::filesystem::path json_path = filepath("baseline.json");
+	ASSERT_TRUE(fea::bench::write_json(json_path, { base }));
+	ASSERT_TRUE(fea::bench::load_baseline(json_path));
+
+	size_t num_regressions = fea::bench::num_regressions();
+	size_t report_size = fea::bench::report().size();
+
+	fea::bench::suite suite;
+	suite.title("regressions");
+	suite.average(10);
+	suite.benchmark("slow", []() { std::this_thread::sleep_for(1ms); });
+	suite.benchmark("not in baseline", []() {});
+
+	std::FILE* null_stream = std::tmpfile();
+	ASSERT_NE(null_stream, nullptr);
+	suite.print(null_stream);
+	std::fclose(null_stream);
+
+	EXPECT_TRUE(suite.results().empty());
+	EXPECT_EQ(fea::bench::num_regressions(), num_regressions + 1);
+	ASSERT_EQ(fea::bench::report().size(), report_size + 2);
+	EXPECT_EQ(fea::bench::report().back().name, "slow");
+	EXPECT_FALSE(fea::bench::load_baseline(filepath("doesnt_exist.json")));
+}
+
 } // namespace
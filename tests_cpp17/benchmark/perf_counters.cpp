@@ -0,0 +1,108 @@
+#include <cstdint>
+#include <fea/benchmark/benchmark.hpp>
+#include <fea/benchmark/perf_counters.hpp>
+#include <gtest/gtest.h>
+#include <string>
+#include <vector>
+
+namespace {
+using fea::bench::perf_counter;
+
+uint64_t work(size_t count) {
+	uint64_t ret = 0;
+	for (size_t i = 0; i < count; ++i) {
+		ret += i * i;
+		fea::bench::clobber();
+	}
+	return ret;
+}
+
+TEST(perf_counters, basics) {
+	EXPECT_EQ(std::string(fea::bench::to_string(perf_counter::cycles)),
+			"cycles");
+	EXPECT_EQ(std::string(fea::bench::to_string(perf_counter::tlb_misses)),
+			"tlb_misses");
+
+	fea::bench::perf_counters counters;
+
+	// Nothing was measured yet.
+	{
+		fea::bench::perf_values values = counters.read();
+		for (size_t i = 0; i < size_t(perf_counter::count); ++i) {
+			EXPECT_FALSE(values.has(perf_counter(i)));
+		}
+	}
+
+	counters.start();
+	uint64_t v = work(1'000'000);
+	fea::bench::perf_values values = counters.stop();
+	EXPECT_NE(v, 0u);
+
+	// Unavailable or unscheduled counters fall back to 0.
+	for (size_t i = 0; i < size_t(perf_counter::count); ++i) {
+		perf_counter c = perf_counter(i);
+		if (values.has(c)) {
+			EXPECT_TRUE(counters.available(c));
+		} else {
+			EXPECT_EQ(values[c], 0u);
+		}
+	}
+
+	if (!values.has(perf_counter::instructions)) {
+		EXPECT_EQ(values.ipc(), 0.0);
+		return;
+	}
+	EXPECT_GE(values[perf_counter::instructions], 1'000'000u);
+
+	// Disabled counters don't count, enabled ones accumulate.
+	work(1'000'000);
+	fea::bench::perf_values values2 = counters.read();
+	EXPECT_EQ(values2[perf_counter::instructions],
+			values[perf_counter::instructions]);
+
+	counters.enable();
+	work(1'000'000);
+	counters.disable();
+	values2 = counters.read();
+	EXPECT_GT(values2[perf_counter::instructions],
+			values[perf_counter::instructions]);
+
+	counters.reset();
+	values2 = counters.read();
+	EXPECT_EQ(values2[perf_counter::instructions], 0u);
+}
+
+TEST(perf_counters, suite) {
+	fea::bench::perf_counters counters;
+
+	fea::bench::suite suite;
+	suite.counters(true);
+	suite.average(4);
+	suite.benchmark("work", []() { work(100'000); });
+
+	size_t in_between = 0;
+	suite.benchmark(
+			"work in-between", []() { work(100'000); },
+			[&]() { ++in_between; });
+	EXPECT_EQ(in_between, 4u);
+
+	ASSERT_EQ(suite.results().size(), 2u);
+	for (const fea::bench::result& r : suite.results()) {
+		for (size_t i = 0; i < r.counters.size(); ++i) {
+			EXPECT_EQ(r.counters[i] >= 0.0,
+					counters.available(perf_counter(i)));
+		}
+		if (counters.available(perf_counter::instructions)) {
+			EXPECT_GE(r.counters[size_t(perf_counter::instructions)],
+					100'000.0);
+		}
+	}
+
+	// Without counters, nothing is measured.
+	suite.counters(false);
+	suite.benchmark("no counters", []() { work(100'000); });
+	for (double c : suite.results().back().counters) {
+		EXPECT_LT(c, 0.0);
+	}
+}
+} // namespace
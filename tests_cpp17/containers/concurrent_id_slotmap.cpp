@@ -0,0 +1,260 @@
+﻿#include <fea/containers/concurrent_id_slotmap.hpp>
+#include <fea/utility/platform.hpp>
+#include <fea/utility/unused.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <memory>
+#include <optional>
+#include <random>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace {
+struct test {
+	test() = default;
+	test(size_t v)
+			: val(v)
+			, check(~v) {
+	}
+
+	size_t val = 42;
+	size_t check = ~size_t(42);
+};
+
+TEST(concurrent_id_slotmap, basics) {
+	constexpr size_t small_num = 10;
+
+	fea::concurrent_id_slotmap<size_t, test> map1{ small_num };
+	EXPECT_TRUE(map1.empty());
+	EXPECT_EQ(map1.size(), 0u);
+	EXPECT_FALSE(map1.contains(1));
+	EXPECT_EQ(map1.count(1), 0u);
+	EXPECT_EQ(map1.erase(1), 0u);
+
+	for (size_t i = 0; i < small_num; ++i) {
+		EXPECT_TRUE(map1.insert(i, test{ i }));
+	}
+	EXPECT_EQ(map1.size(), small_num);
+	EXPECT_FALSE(map1.empty());
+
+	for (size_t i = 0; i < small_num; ++i) {
+		EXPECT_TRUE(map1.contains(i));
+		EXPECT_EQ(map1.count(i), 1u);
+		EXPECT_EQ(map1.at(i).val, i);
+
+		size_t v = 0;
+		EXPECT_TRUE(map1.read(i, [&](const test& t) { v = t.val; }));
+		EXPECT_EQ(v, i);
+
+		decltype(map1)::read_guard g{ map1 };
+		const test* t = map1.find(i, g);
+		ASSERT_NE(t, nullptr);
+		EXPECT_EQ(t->val, i);
+	}
+
+	// Doesn't overwrite.
+	EXPECT_FALSE(map1.insert(0, test{ 42 }));
+	EXPECT_FALSE(map1.emplace(0, size_t(42)));
+	EXPECT_FALSE(map1.try_emplace(0, size_t(42)));
+	EXPECT_EQ(map1.at(0).val, 0u);
+
+	// Assigns.
+	EXPECT_FALSE(map1.insert_or_assign(0, test{ 42 }));
+	EXPECT_EQ(map1.at(0).val, 42u);
+	EXPECT_EQ(map1.size(), small_num);
+
+	// Grows lookup.
+	EXPECT_TRUE(map1.emplace(1000, size_t(1000)));
+	EXPECT_TRUE(map1.insert_or_assign(500, test{ 500 }));
+	EXPECT_EQ(map1.size(), small_num + 2);
+	EXPECT_EQ(map1.at(1000).val, 1000u);
+	EXPECT_EQ(map1.at(500).val, 500u);
+
+	EXPECT_EQ(map1.erase(1000), 1u);
+	EXPECT_EQ(map1.erase(1000), 0u);
+	EXPECT_FALSE(map1.contains(1000));
+	EXPECT_FALSE(map1.read(1000, [](const test&) {}));
+	EXPECT_EQ(map1.size(), small_num + 1);
+
+	test ttt;
+#if FEA_DEBUG || FEA_NOTHROW
+	EXPECT_DEATH(ttt = map1.at(1000), "");
+#else
+	EXPECT_THROW(ttt = map1.at(1000), std::out_of_range);
+#endif
+	fea::unused(ttt);
+
+	size_t num_visited = 0;
+	map1.for_each([&](size_t k, const test& t) {
+		++num_visited;
+		if (k == 0) {
+			EXPECT_EQ(t.val, 42u);
+		} else {
+			EXPECT_EQ(t.val, k);
+		}
+	});
+	EXPECT_EQ(num_visited, map1.size());
+
+	map1.reclaim();
+	map1.clear();
+	EXPECT_TRUE(map1.empty());
+	for (size_t i = 0; i < small_num; ++i) {
+		EXPECT_FALSE(map1.contains(i));
+	}
+	map1.for_each([](size_t, const test&) { ADD_FAILURE(); });
+
+	EXPECT_TRUE(map1.insert(3, test{ 3 }));
+	EXPECT_EQ(map1.at(3).val, 3u);
+
+	// Reclaiming while this thread reads would deadlock.
+#if FEA_DEBUG
+	EXPECT_EQ(map1.erase(3), 1u);
+	EXPECT_DEATH(
+			{
+				decltype(map1)::read_guard g{ map1 };
+				map1.reclaim();
+			},
+			"");
+#endif
+	{
+		decltype(map1)::read_guard g1{ map1 };
+		decltype(map1)::read_guard g2{ map1 };
+	}
+	map1.reclaim();
+
+	// Guards released out of order, and nested deeper than the debug
+	// tracking.
+	{
+		decltype(map1) map2;
+		std::optional<decltype(map1)::read_guard> g1{ std::in_place, map1 };
+		{
+			decltype(map2)::read_guard g2{ map2 };
+			g1.reset();
+			map1.reclaim();
+		}
+		map2.reclaim();
+
+		std::vector<std::unique_ptr<decltype(map1)::read_guard>> guards;
+		for (size_t i = 0; i < 40; ++i) {
+			guards.push_back(
+					std::make_unique<decltype(map1)::read_guard>(map2));
+		}
+		map1.reclaim();
+		guards.clear();
+		map2.reclaim();
+	}
+}
+
+TEST(concurrent_id_slotmap, uniqueptr) {
+	fea::concurrent_id_slotmap<size_t, std::unique_ptr<size_t>> map;
+	for (size_t i = 0; i < 100; ++i) {
+		EXPECT_TRUE(map.insert(i, std::make_unique<size_t>(i)));
+	}
+	for (size_t i = 0; i < 100; i += 2) {
+		EXPECT_EQ(map.erase(i), 1u);
+	}
+	for (size_t i = 0; i < 100; ++i) {
+		bool found = map.read(i, [&](const std::unique_ptr<size_t>& p) {
+			EXPECT_EQ(*p, i);
+		});
+		EXPECT_EQ(found, i % 2 == 1);
+	}
+}
+
+TEST(concurrent_id_slotmap, fuzzing) {
+	std::mt19937_64 gen(42);
+	std::uniform_int_distribution<size_t> dis(0, 2000);
+
+	fea::concurrent_id_slotmap<size_t, size_t> map;
+	std::unordered_map<size_t, size_t> umap;
+
+	for (size_t i = 0; i < 20'000; ++i) {
+		size_t k = dis(gen);
+		switch (i % 3) {
+		case 0: {
+			EXPECT_EQ(map.erase(k), umap.erase(k));
+		} break;
+		case 1: {
+			EXPECT_EQ(map.insert_or_assign(k, i),
+					umap.insert_or_assign(k, i).second);
+		} break;
+		default: {
+			EXPECT_EQ(map.insert(k, i), umap.insert({ k, i }).second);
+		} break;
+		}
+		ASSERT_EQ(map.size(), umap.size());
+	}
+
+	for (const std::pair<const size_t, size_t>& kv : umap) {
+		EXPECT_EQ(map.at(kv.first), kv.second);
+	}
+	map.for_each([&](size_t k, size_t v) { EXPECT_EQ(umap.at(k), v); });
+}
+
+TEST(concurrent_id_slotmap, threaded) {
+	constexpr size_t num_keys = 1'000;
+	constexpr size_t num_writes = 20'000;
+	constexpr size_t num_readers = 4;
+
+	fea::concurrent_id_slotmap<size_t, test> map;
+	for (size_t i = 0; i < num_keys; i += 2) {
+		map.insert(i, test{ i });
+	}
+
+	std::atomic<bool> done{ false };
+	std::atomic<size_t> num_errors{ 0 };
+	std::atomic<size_t> num_found{ 0 };
+
+	std::vector<std::thread> readers;
+	for (size_t t = 0; t < num_readers; ++t) {
+		readers.emplace_back([&, t]() {
+			std::mt19937_64 rgen(t);
+			std::uniform_int_distribution<size_t> rdis(0, num_keys * 2);
+			size_t found = 0;
+			while (!done.load()) {
+				size_t k = rdis(rgen);
+				decltype(map)::read_guard g{ map };
+				const test* v = map.find(k, g);
+				if (v == nullptr) {
+					continue;
+				}
+
+				// Values are never torn or freed under us.
+				++found;
+				if (v->check != ~v->val || v->val % num_keys != k % num_keys) {
+					++num_errors;
+				}
+			}
+			num_found += found;
+		});
+	}
+
+	std::mt19937_64 gen(42);
+	std::uniform_int_distribution<size_t> dis(0, num_keys * 2);
+	for (size_t i = 0; i < num_writes; ++i) {
+		size_t k = dis(gen);
+		switch (i % 3) {
+		case 0: {
+			map.erase(k);
+		} break;
+		case 1: {
+			map.insert_or_assign(k, test{ k + num_keys * (i % 7) });
+		} break;
+		default: {
+			map.insert(k, test{ k });
+		} break;
+		}
+	}
+
+	done = true;
+	for (std::thread& t : readers) {
+		t.join();
+	}
+
+	EXPECT_EQ(num_errors.load(), 0u);
+	map.for_each([&](size_t k, const test& v) {
+		EXPECT_EQ(v.val % num_keys, k % num_keys);
+	});
+}
+} // namespace
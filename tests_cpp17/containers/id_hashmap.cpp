@@ -0,0 +1,372 @@
+﻿#include <fea/containers/id_hashmap.hpp>
+#include <fea/utility/platform.hpp>
+#include <fea/utility/unused.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <random>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+
+namespace {
+struct id128 {
+	uint64_t hi = 0;
+	uint64_t lo = 0;
+};
+bool operator==(const id128& lhs, const id128& rhs) {
+	return lhs.hi == rhs.hi && lhs.lo == rhs.lo;
+}
+
+// Purposefully bad, only uses the low bits.
+struct id128_hash {
+	size_t operator()(const id128& id) const {
+		return size_t(id.lo);
+	}
+};
+
+struct id128_eq {
+	bool operator()(const id128& lhs, const id128& rhs) const {
+		return lhs == rhs;
+	}
+};
+
+TEST(id_hashmap, basics) {
+	constexpr size_t small_num = 10;
+
+	fea::id_hashmap<std::string, size_t> map1{ small_num };
+	map1.reserve(100);
+	EXPECT_EQ(map1.capacity(), 100u);
+	map1.shrink_to_fit();
+	EXPECT_EQ(map1.capacity(), 0u);
+	EXPECT_EQ(map1.bucket_count(), 0u);
+	EXPECT_TRUE(map1.empty());
+	EXPECT_EQ(map1.size(), 0u);
+	EXPECT_FALSE(map1.contains("1"));
+	EXPECT_EQ(map1.count("1"), 0u);
+	EXPECT_EQ(map1.find("1"), map1.end());
+
+	for (size_t i = 0; i < small_num; ++i) {
+		auto ret_pair = map1.insert(std::to_string(i), i);
+		EXPECT_TRUE(ret_pair.second);
+		EXPECT_EQ(*ret_pair.first, i);
+	}
+
+	EXPECT_EQ(size_t(std::distance(map1.begin(), map1.end())), small_num);
+	EXPECT_EQ(
+			size_t(std::distance(map1.key_begin(), map1.key_end())), small_num);
+	EXPECT_EQ(map1.size(), small_num);
+	EXPECT_FALSE(map1.empty());
+
+	for (size_t i = 0; i < small_num; ++i) {
+		std::string k = std::to_string(i);
+		EXPECT_TRUE(map1.contains(k));
+		EXPECT_EQ(map1.count(k), 1u);
+		EXPECT_EQ(map1.at(k), i);
+		EXPECT_EQ(map1.at_unchecked(k), i);
+		EXPECT_EQ(*map1.find(k), i);
+
+		// Packed and in insertion order.
+		EXPECT_EQ(map1.data()[i], i);
+		EXPECT_EQ(map1.key_data()[i], k);
+	}
+
+	// Doesn't insert duplicates.
+	{
+		auto ret_pair = map1.insert("0", 42);
+		EXPECT_FALSE(ret_pair.second);
+		EXPECT_EQ(*ret_pair.first, 0u);
+		EXPECT_EQ(map1.size(), small_num);
+
+		ret_pair = map1.insert_or_assign("0", 42);
+		EXPECT_FALSE(ret_pair.second);
+		EXPECT_EQ(*ret_pair.first, 42u);
+		EXPECT_EQ(map1.at("0"), 42u);
+		map1["0"] = 0;
+		EXPECT_EQ(map1.at("0"), 0u);
+
+		ret_pair = map1.try_emplace("1", 42u);
+		EXPECT_FALSE(ret_pair.second);
+		EXPECT_EQ(*ret_pair.first, 1u);
+	}
+
+	// operator[] inserts default.
+	EXPECT_EQ(map1["new"], 0u);
+	EXPECT_EQ(map1.size(), small_num + 1);
+	EXPECT_EQ(map1.erase("new"), 1u);
+	EXPECT_EQ(map1.erase("new"), 0u);
+	EXPECT_EQ(map1.size(), small_num);
+
+	size_t ttt = 0;
+#if FEA_DEBUG || FEA_NOTHROW
+	EXPECT_DEATH(ttt = map1.at("nope"), "");
+#else
+	EXPECT_THROW(ttt = map1.at("nope"), std::out_of_range);
+#endif
+	fea::unused(ttt);
+
+	// Erase swaps the last element in the hole.
+	map1.erase("0");
+	EXPECT_EQ(map1.size(), small_num - 1);
+	EXPECT_EQ(map1.data()[0], small_num - 1);
+	EXPECT_EQ(map1.key_data()[0], std::to_string(small_num - 1));
+	for (size_t i = 1; i < small_num; ++i) {
+		std::string k = std::to_string(i);
+		EXPECT_TRUE(map1.contains(k));
+		EXPECT_EQ(map1.at(k), i);
+		EXPECT_EQ(map1.key_data()[map1.find(k) - map1.begin()], k);
+	}
+
+	map1.erase(map1.begin());
+	EXPECT_EQ(map1.size(), small_num - 2);
+	EXPECT_FALSE(map1.contains(std::to_string(small_num - 1)));
+
+	map1.erase(map1.begin(), map1.begin() + 2);
+	EXPECT_EQ(map1.size(), small_num - 4);
+	for (const std::string* it = map1.key_data();
+			it != map1.key_data() + map1.size(); ++it) {
+		EXPECT_EQ(map1.at(*it), std::stoul(*it));
+	}
+
+	fea::id_hashmap<std::string, size_t> map2 = map1;
+	EXPECT_EQ(map1, map2);
+	map2["0"] = 0;
+	EXPECT_NE(map1, map2);
+	map2.erase("0");
+	EXPECT_EQ(map1, map2);
+	map2.at(map2.key_data()[0]) = 42;
+	EXPECT_NE(map1, map2);
+
+	map2.clear();
+	EXPECT_TRUE(map2.empty());
+	EXPECT_NE(map2.bucket_count(), 0u);
+	map2.swap(map1);
+	EXPECT_TRUE(map1.empty());
+	EXPECT_EQ(map2.size(), small_num - 4);
+
+	fea::id_hashmap<std::string, size_t> map3{ { "a", 0u }, { "b", 1u } };
+	EXPECT_EQ(map3.size(), 2u);
+	EXPECT_EQ(map3.at("a"), 0u);
+	EXPECT_EQ(map3.at("b"), 1u);
+	map3.insert({ { "b", 42u }, { "c", 2u } });
+	EXPECT_EQ(map3.size(), 3u);
+	EXPECT_EQ(map3.at("b"), 1u);
+	EXPECT_EQ(map3.at("c"), 2u);
+}
+
+TEST(id_hashmap, custom_hasher) {
+	// All keys share the same low bits, only high bits differ.
+	// Every key collides, the map must still work.
+	fea::id_hashmap<id128, size_t, id128_hash, id128_eq> map;
+	for (size_t i = 0; i < 100; ++i) {
+		map.insert(id128{ i, 42 }, i);
+	}
+	EXPECT_EQ(map.size(), 100u);
+	for (size_t i = 0; i < 100; ++i) {
+		EXPECT_EQ(map.at(id128{ i, 42 }), i);
+	}
+	EXPECT_FALSE(map.contains(id128{ 100, 42 }));
+
+	for (size_t i = 0; i < 100; i += 2) {
+		EXPECT_EQ(map.erase(id128{ i, 42 }), 1u);
+	}
+	EXPECT_EQ(map.size(), 50u);
+	for (size_t i = 0; i < 100; ++i) {
+		EXPECT_EQ(map.contains(id128{ i, 42 }), i % 2 == 1);
+	}
+
+	// Spread keys.
+	fea::id_hashmap<id128, size_t, id128_hash, id128_eq> map2;
+	for (size_t i = 0; i < 1000; ++i) {
+		map2[id128{ 0, i * 1024 }] = i;
+	}
+	for (size_t i = 0; i < 1000; ++i) {
+		EXPECT_EQ(map2.at(id128{ 0, i * 1024 }), i);
+	}
+}
+
+TEST(id_hashmap, uniqueptr) {
+	fea::id_hashmap<std::string, std::unique_ptr<size_t>> map;
+	for (size_t i = 0; i < 100; ++i) {
+		map.insert(std::to_string(i), std::make_unique<size_t>(i));
+	}
+	map.emplace("100", std::make_unique<size_t>(100));
+	EXPECT_EQ(map.size(), 101u);
+
+	for (size_t i = 0; i < 100; i += 3) {
+		map.erase(std::to_string(i));
+	}
+	for (size_t i = 0; i <= 100; ++i) {
+		std::string k = std::to_string(i);
+		if (i % 3 == 0 && i != 100) {
+			EXPECT_FALSE(map.contains(k));
+		} else {
+			EXPECT_EQ(*map.at(k), i);
+		}
+	}
+
+	fea::id_hashmap<std::string, std::unique_ptr<size_t>> map2
+			= std::move(map);
+	EXPECT_EQ(*map2.at("100"), 100u);
+}
+
+TEST(id_hashmap, fuzzing) {
+	std::mt19937_64 gen(42);
+	std::uniform_int_distribution<uint64_t> dis(0, 2000);
+
+	fea::id_hashmap<std::string, uint64_t> map;
+	std::unordered_map<std::string, uint64_t> umap;
+
+	for (size_t i = 0; i < 20'000; ++i) {
+		uint64_t v = dis(gen);
+		std::string k = std::to_string(v);
+		switch (v % 3) {
+		case 0: {
+			EXPECT_EQ(map.erase(k), umap.erase(k));
+		} break;
+		case 1: {
+			auto p = map.insert_or_assign(k, i);
+			auto up = umap.insert_or_assign(k, i);
+			EXPECT_EQ(p.second, up.second);
+		} break;
+		default: {
+			auto p = map.insert(k, i);
+			auto up = umap.insert({ k, i });
+			EXPECT_EQ(p.second, up.second);
+			EXPECT_EQ(*p.first, up.first->second);
+		} break;
+		}
+		ASSERT_EQ(map.size(), umap.size());
+	}
+
+	for (const std::pair<const std::string, uint64_t>& kv : umap) {
+		EXPECT_EQ(map.at(kv.first), kv.second);
+	}
+	for (size_t i = 0; i < map.size(); ++i) {
+		EXPECT_EQ(umap.at(map.key_data()[i]), map.data()[i]);
+	}
+}
+
+TEST(id_hashmap, rehash) {
+	fea::id_hashmap<std::string, size_t> map;
+	map.reserve(1000);
+	size_t buckets = map.bucket_count();
+	EXPECT_GE(size_t(buckets * map.max_load_factor()), 1000u);
+
+	for (size_t i = 0; i < 1000; ++i) {
+		map.insert(std::to_string(i), i);
+	}
+	EXPECT_EQ(map.bucket_count(), buckets);
+
+	map.max_load_factor(0.25f);
+	EXPECT_GT(map.bucket_count(), buckets);
+	EXPECT_LE(map.load_factor(), 0.25f);
+	for (size_t i = 0; i < 1000; ++i) {
+		EXPECT_EQ(map.at(std::to_string(i)), i);
+	}
+
+	map.clear();
+	EXPECT_NE(map.bucket_count(), 0u);
+	map.shrink_to_fit();
+	EXPECT_EQ(map.bucket_count(), 0u);
+}
+
+struct throws_on {
+	throws_on() = default;
+	explicit throws_on(int v)
+			: val(v) {
+		if (v < 0) {
+			throw std::runtime_error{ "throws_on" };
+		}
+	}
+	throws_on(const throws_on& other)
+			: throws_on(other.val) {
+	}
+	throws_on& operator=(const throws_on&) = default;
+	int val = 0;
+};
+
+TEST(id_hashmap, throwing_value) {
+	fea::id_hashmap<std::string, throws_on> map;
+	for (int i = 0; i < 100; ++i) {
+		map.try_emplace(std::to_string(i), i);
+	}
+
+	// Failed inserts leave the map unchanged, including across growth.
+	// They don't use up room either.
+	const size_t bucket_count = map.bucket_count();
+	throws_on bad;
+	bad.val = -1;
+	for (int i = 100; i < 200; ++i) {
+		EXPECT_THROW(map.try_emplace(std::to_string(i), -1), std::runtime_error);
+		EXPECT_THROW(map.insert(std::to_string(i), bad), std::runtime_error);
+		EXPECT_EQ(map.size(), 100u);
+		EXPECT_FALSE(map.contains(std::to_string(i)));
+	}
+	EXPECT_EQ(map.bucket_count(), bucket_count);
+
+	for (int i = 0; i < 100; ++i) {
+		std::string k = std::to_string(i);
+		ASSERT_TRUE(map.contains(k));
+		EXPECT_EQ(map.at(k).val, i);
+		EXPECT_EQ(map[k].val, i);
+	}
+	EXPECT_EQ(map.size(), 100u);
+
+	map[std::string{ "new" }].val = 42;
+	EXPECT_EQ(map.size(), 101u);
+	EXPECT_EQ(map.at("new").val, 42);
+}
+
+// Copies throw when enabled. Moves may throw, so vectors copy on growth.
+bool key_copy_throws = false;
+struct throwing_key {
+	throwing_key(int v)
+			: val(v) {
+	}
+	throwing_key(const throwing_key& other)
+			: val(other.val) {
+		if (key_copy_throws) {
+			throw std::runtime_error{ "throwing_key" };
+		}
+	}
+	throwing_key(throwing_key&& other) noexcept(false)
+			: val(other.val) {
+	}
+	throwing_key& operator=(const throwing_key&) = default;
+	throwing_key& operator=(throwing_key&&) = default;
+	int val = 0;
+};
+bool operator==(const throwing_key& lhs, const throwing_key& rhs) {
+	return lhs.val == rhs.val;
+}
+struct throwing_key_hash {
+	size_t operator()(const throwing_key& k) const {
+		return std::hash<int>{}(k.val);
+	}
+};
+
+TEST(id_hashmap, throwing_key) {
+	fea::id_hashmap<throwing_key, int, throwing_key_hash> map;
+	int i = 0;
+	do {
+		map.insert(throwing_key{ i }, i);
+		++i;
+	} while (map.size() != map.capacity());
+
+	// Growing the keys throws, after the value would have been stored.
+	key_copy_throws = true;
+	EXPECT_THROW(map.try_emplace(throwing_key{ i }, i), std::runtime_error);
+	EXPECT_THROW(map[throwing_key{ i }] = i, std::runtime_error);
+	key_copy_throws = false;
+
+	EXPECT_EQ(map.size(), size_t(i));
+	EXPECT_FALSE(map.contains(throwing_key{ i }));
+	for (int j = 0; j < i; ++j) {
+		EXPECT_EQ(map.at(throwing_key{ j }), j);
+	}
+
+	map[throwing_key{ i }] = i;
+	EXPECT_EQ(map.size(), size_t(i + 1));
+	EXPECT_EQ(map.at(throwing_key{ i }), i);
+}
+} // namespace
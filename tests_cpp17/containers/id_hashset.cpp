@@ -0,0 +1,96 @@
+﻿#include <fea/containers/id_hashset.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <unordered_set>
+
+namespace {
+TEST(id_hashset, basics) {
+	constexpr size_t small_num = 10;
+
+	fea::id_hashset<std::string> set1{ small_num };
+	EXPECT_EQ(set1.capacity(), small_num);
+	set1.shrink_to_fit();
+	EXPECT_EQ(set1.capacity(), 0u);
+	EXPECT_EQ(set1.bucket_count(), 0u);
+	EXPECT_TRUE(set1.empty());
+	EXPECT_FALSE(set1.contains("0"));
+	EXPECT_EQ(set1.find("0"), set1.end());
+
+	for (size_t i = 0; i < small_num; ++i) {
+		auto ret_pair = set1.insert(std::to_string(i));
+		EXPECT_TRUE(ret_pair.second);
+		EXPECT_EQ(*ret_pair.first, std::to_string(i));
+	}
+	EXPECT_EQ(set1.size(), small_num);
+
+	for (size_t i = 0; i < small_num; ++i) {
+		std::string k = std::to_string(i);
+		EXPECT_TRUE(set1.contains(k));
+		EXPECT_EQ(set1.count(k), 1u);
+		EXPECT_EQ(*set1.find(k), k);
+		EXPECT_EQ(set1.data()[i], k);
+	}
+
+	auto ret_pair = set1.emplace(size_t(3), 'a');
+	EXPECT_TRUE(ret_pair.second);
+	EXPECT_EQ(*ret_pair.first, "aaa");
+	ret_pair = set1.insert("aaa");
+	EXPECT_FALSE(ret_pair.second);
+	EXPECT_EQ(set1.size(), small_num + 1);
+
+	// Erase swaps the last key in the hole.
+	EXPECT_EQ(set1.erase("0"), 1u);
+	EXPECT_EQ(set1.erase("0"), 0u);
+	EXPECT_EQ(set1.data()[0], "aaa");
+	set1.erase(set1.begin());
+	EXPECT_FALSE(set1.contains("aaa"));
+	set1.erase(set1.begin(), set1.begin() + 2);
+	EXPECT_EQ(set1.size(), small_num - 3);
+	for (const std::string& k : set1) {
+		EXPECT_EQ(*set1.find(k), k);
+	}
+
+	fea::id_hashset<std::string> set2{ "a", "b", "c" };
+	fea::id_hashset<std::string> set3{ "c", "b", "a" };
+	EXPECT_EQ(set2, set3);
+	set3.insert("d");
+	EXPECT_NE(set2, set3);
+
+	std::vector<std::string> v{ "d", "e", "a" };
+	set2.insert(v.begin(), v.end());
+	EXPECT_EQ(set2.size(), 5u);
+	set2.swap(set3);
+	EXPECT_EQ(set2.size(), 4u);
+	EXPECT_EQ(set3.size(), 5u);
+
+	set3.clear();
+	EXPECT_TRUE(set3.empty());
+	EXPECT_NE(set3.bucket_count(), 0u);
+}
+
+TEST(id_hashset, fuzzing) {
+	std::mt19937_64 gen(42);
+	std::uniform_int_distribution<uint64_t> dis(0, 2000);
+
+	fea::id_hashset<uint64_t> set;
+	std::unordered_set<uint64_t> uset;
+
+	for (size_t i = 0; i < 20'000; ++i) {
+		uint64_t v = dis(gen);
+		if (v % 2 == 0) {
+			EXPECT_EQ(set.erase(v), uset.erase(v));
+		} else {
+			EXPECT_EQ(set.insert(v).second, uset.insert(v).second);
+		}
+		ASSERT_EQ(set.size(), uset.size());
+	}
+
+	for (uint64_t v : uset) {
+		EXPECT_TRUE(set.contains(v));
+	}
+	for (uint64_t v : set) {
+		EXPECT_EQ(uset.count(v), 1u);
+	}
+}
+} // namespace
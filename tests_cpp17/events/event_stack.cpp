@@ -1,8 +1,25 @@
 ﻿#include <atomic>
 #include <fea/events/event_stack.hpp>
 #include <gtest/gtest.h>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+// User code may forward declare the event stacks.
+namespace fea {
+template <class, class...>
+struct event_stack;
+template <class, class...>
+struct inplace_event_stack;
+} // namespace fea
 
 namespace {
+template <template <class, class...> class>
+struct takes_stack {};
+static_assert(sizeof(takes_stack<fea::event_stack>) != 0);
+static_assert(sizeof(takes_stack<fea::inplace_event_stack>) != 0);
+
 TEST(event_stack, basics) {
 	enum class e { one, two, three, count };
 	fea::event_stack<e, int(), int(), int(float, double)> s{};
@@ -207,4 +224,226 @@ TEST(event_stack, basics) {
 	EXPECT_EQ(0u, s.size());
 }
 
+TEST(event_stack, deferred) {
+	enum class e { one, two, count };
+	fea::event_stack<e, void(int), void(const std::string&)> s{};
+
+	std::vector<int> got_one;
+	std::vector<std::string> got_two;
+	std::vector<int> order;
+	s.subscribe<e::one>([&](int i) {
+		got_one.push_back(i);
+		order.push_back(0);
+	});
+	s.subscribe<e::one>([&](int i) {
+		got_one.push_back(i * 10);
+		order.push_back(0);
+	});
+	s.subscribe<e::two>([&](const std::string& str) {
+		got_two.push_back(str);
+		order.push_back(1);
+	});
+
+	// Nothing queued.
+	s.flush();
+	EXPECT_TRUE(got_one.empty());
+
+	s.enqueue<e::two>("a");
+	s.enqueue<e::one>(1);
+	std::string str = "b";
+	s.enqueue<e::two>(str);
+	s.enqueue<e::one>(2);
+	s.enqueue<e::one>(3);
+	EXPECT_TRUE(got_one.empty());
+	EXPECT_TRUE(got_two.empty());
+
+	// Grouped by event, each callback runs over the whole batch.
+	s.flush();
+	EXPECT_EQ(got_one, (std::vector<int>{ 1, 2, 3, 10, 20, 30 }));
+	EXPECT_EQ(got_two, (std::vector<std::string>{ "a", "b" }));
+	EXPECT_EQ(order, (std::vector<int>{ 0, 0, 0, 0, 0, 0, 1, 1 }));
+
+	// Flushed events are gone.
+	got_one.clear();
+	s.flush();
+	EXPECT_TRUE(got_one.empty());
+
+	// Single event flush.
+	s.enqueue<e::one>(4);
+	s.enqueue<e::two>("c");
+	s.flush<e::two>();
+	EXPECT_TRUE(got_one.empty());
+	EXPECT_EQ(got_two.size(), 3u);
+	s.flush<e::one>();
+	EXPECT_EQ(got_one, (std::vector<int>{ 4, 40 }));
+
+	// Events enqueued while flushing wait for the next flush.
+	{
+		fea::event_stack<e, void(int), void(const std::string&)> s2{};
+		int num_calls = 0;
+		s2.subscribe<e::one>([&](int i) {
+			++num_calls;
+			if (i > 0) {
+				s2.enqueue<e::one>(i - 1);
+			}
+		});
+		s2.enqueue<e::one>(2);
+		s2.flush();
+		EXPECT_EQ(num_calls, 1);
+		s2.flush();
+		s2.flush();
+		EXPECT_EQ(num_calls, 3);
+		s2.flush();
+		EXPECT_EQ(num_calls, 3);
+	}
+
+	// Copies don't copy pending events, moves do.
+	{
+		got_one.clear();
+		s.enqueue<e::one>(5);
+		auto s_copy = s;
+		s_copy.flush();
+		EXPECT_TRUE(got_one.empty());
+
+		auto s_moved = std::move(s);
+		s_moved.flush();
+		EXPECT_EQ(got_one, (std::vector<int>{ 5, 50 }));
+	}
+
+	// Pending events are destroyed with the stack.
+	{
+		fea::event_stack<e, void(int), void(const std::string&)> s2{};
+		s2.enqueue<e::two>(std::string(100, 'a'));
+	}
+
+	// Failed enqueues aren't flushed.
+	{
+		struct throwing_copy {
+			throwing_copy() = default;
+			throwing_copy(const throwing_copy& other)
+					: fail(other.fail) {
+				if (fail) {
+					throw std::runtime_error{ "test" };
+				}
+			}
+			bool fail = false;
+		};
+
+		enum class e2 { one, count };
+		fea::event_stack<e2, void(const throwing_copy&)> s2{};
+		size_t num_calls = 0;
+		s2.subscribe<e2::one>([&](const throwing_copy&) { ++num_calls; });
+
+		throwing_copy ok;
+		throwing_copy fail;
+		fail.fail = true;
+		for (size_t i = 0; i < 100; ++i) {
+			EXPECT_THROW(s2.enqueue<e2::one>(fail), std::runtime_error);
+			s2.enqueue<e2::one>(ok);
+		}
+		s2.flush();
+		EXPECT_EQ(num_calls, 100u);
+	}
+}
+
+TEST(event_stack, deferred_multithreading) {
+	enum class e { one, two, count };
+	fea::event_stack<e, void(size_t), void(size_t)> s{};
+
+	constexpr size_t num_threads = 4;
+	constexpr size_t num_events = 10'000;
+
+	std::vector<size_t> got_one;
+	size_t sum_two = 0;
+	s.subscribe<e::one>([&](size_t i) { got_one.push_back(i); });
+	s.subscribe<e::two>([&](size_t i) { sum_two += i; });
+
+	std::atomic<bool> done{ false };
+	std::vector<std::thread> threads;
+	for (size_t t = 0; t < num_threads; ++t) {
+		threads.emplace_back([&, t]() {
+			for (size_t i = 0; i < num_events; ++i) {
+				s.enqueue<e::one>(t * num_events + i);
+				s.enqueue<e::two>(size_t(1));
+			}
+		});
+	}
+
+	// Flush while producers are running.
+	std::thread flusher([&]() {
+		while (!done.load()) {
+			s.flush();
+		}
+	});
+
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	done = true;
+	flusher.join();
+	s.flush();
+
+	EXPECT_EQ(sum_two, num_threads * num_events);
+	ASSERT_EQ(got_one.size(), num_threads * num_events);
+
+	// Each producer's events are executed in order.
+	std::vector<size_t> last(num_threads, 0);
+	std::vector<bool> seen(num_threads, false);
+	for (size_t v : got_one) {
+		size_t t = v / num_events;
+		if (seen[t]) {
+			EXPECT_GT(v, last[t]);
+		}
+		seen[t] = true;
+		last[t] = v;
+	}
+}
+
+TEST(event_stack, inplace) {
+	enum class e { one, two, count };
+	fea::inplace_event_stack<e, void(int), int(float, double)> s{};
+
+	int sum = 0;
+	std::vector<fea::event_id<e, e::one>> ids;
+	for (int i = 0; i < 100; ++i) {
+		ids.push_back(s.subscribe<e::one>([&sum, i](int v) { sum += v + i; }));
+	}
+	auto id_two = s.subscribe<e::two>([](float f, double d) {
+		return int(f + d);
+	});
+	EXPECT_EQ(s.size<e::one>(), 100u);
+	EXPECT_EQ(s.at(id_two)(1.f, 2.0), 3);
+
+	s.trigger<e::one>(1);
+	EXPECT_EQ(sum, 100 + 4950);
+
+	// Callbacks stay contiguous after unsubscribing.
+	for (size_t i = 0; i < ids.size(); i += 2) {
+		s.unsubscribe(ids[i]);
+	}
+	EXPECT_EQ(s.size<e::one>(), 50u);
+	for (size_t i = 0; i < ids.size(); ++i) {
+		EXPECT_EQ(s.contains(ids[i]), i % 2 == 1);
+	}
+
+	sum = 0;
+	s.trigger<e::one>(0);
+	EXPECT_EQ(sum, 2500);
+
+	// Copies.
+	auto s2 = s;
+	sum = 0;
+	s2.trigger<e::one>(0);
+	EXPECT_EQ(sum, 2500);
+
+	// Deferred.
+	sum = 0;
+	s.enqueue<e::one>(1);
+	s.enqueue<e::one>(1);
+	s.flush();
+	EXPECT_EQ(sum, 2 * (50 + 2500));
+
+	s.clear();
+	EXPECT_TRUE(s.empty());
+}
 } // namespace
@@ -2,7 +2,20 @@
 #include <fea/events/event_system.hpp>
 #include <gtest/gtest.h>
 
+// User code may forward declare the event systems.
+namespace fea {
+template <class, class, class...>
+struct event_system;
+template <class, class, class...>
+struct inplace_event_system;
+} // namespace fea
+
 namespace {
+template <template <class, class, class...> class>
+struct takes_system {};
+static_assert(sizeof(takes_system<fea::event_system>) != 0);
+static_assert(sizeof(takes_system<fea::inplace_event_system>) != 0);
+
 TEST(event_system, basics) {
 	enum class events : unsigned { one, two, three, count };
 	enum class channels : unsigned { one, two, three, count };
@@ -597,4 +610,60 @@ TEST(event_system, multithreading) {
 	EXPECT_EQ(test_event_one.load(), 20);
 #endif
 }
+
+TEST(event_system, deferred) {
+	enum class events : unsigned { one, two, count };
+	enum class channels : unsigned { one, two, count };
+	fea::event_system<events, channels, void(), void(int)> s{};
+
+	int num_one = 0;
+	int sum_two = 0;
+	auto nid = s.add_notifier();
+	s.subscribe<events::one>(nid, [&]() { ++num_one; });
+	s.subscribe<events::two>(nid, [&](int i) { sum_two += i; });
+	s.subscribe<channels::two, events::two>([&](int i) { sum_two += i * 10; });
+
+	s.enqueue<events::one>(nid);
+	s.enqueue<events::two>(nid, 1);
+	s.enqueue<events::two>(nid, 2);
+	s.enqueue<channels::two, events::two>(3);
+	s.enqueue<channels::one, events::one>();
+	EXPECT_EQ(num_one, 0);
+	EXPECT_EQ(sum_two, 0);
+
+	s.flush();
+	EXPECT_EQ(num_one, 1);
+	EXPECT_EQ(sum_two, 33);
+
+	s.flush();
+	EXPECT_EQ(num_one, 1);
+	EXPECT_EQ(sum_two, 33);
+}
+
+TEST(event_system, inplace) {
+	enum class events : unsigned { one, two, count };
+	enum class channels : unsigned { one, two, count };
+	fea::inplace_event_system<events, channels, void(), void(int)> s{};
+
+	int num_one = 0;
+	int sum_two = 0;
+	auto nid = s.add_notifier();
+	auto id = s.subscribe<events::one>(nid, [&]() { ++num_one; });
+	s.subscribe<events::two>(nid, [&](int i) { sum_two += i; });
+	s.subscribe<channels::two, events::two>([&](int i) { sum_two += i * 10; });
+	EXPECT_EQ(s.size(), 3u);
+
+	s.trigger<events::one>(nid);
+	s.trigger<events::two>(nid, 1);
+	s.trigger<channels::two, events::two>(2);
+	EXPECT_EQ(num_one, 1);
+	EXPECT_EQ(sum_two, 21);
+
+	s.unsubscribe(id);
+	s.trigger<events::one>(nid);
+	EXPECT_EQ(num_one, 1);
+
+	s.remove_notifier(nid);
+	EXPECT_EQ(s.size(), 1u);
+}
 } // namespace
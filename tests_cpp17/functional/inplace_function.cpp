@@ -0,0 +1,156 @@
+#include <array>
+#include <fea/functional/inplace_function.hpp>
+#include <gtest/gtest.h>
+#include <memory>
+#include <string>
+#include <vector>
+
+namespace {
+int free_func(int i) {
+	return i * 2;
+}
+
+struct counted {
+	counted(int* alive_)
+			: alive(alive_) {
+		++*alive;
+	}
+	counted(const counted& other)
+			: alive(other.alive) {
+		++*alive;
+	}
+	counted(counted&& other) noexcept
+			: alive(other.alive) {
+		++*alive;
+	}
+	~counted() {
+		--*alive;
+	}
+
+	int operator()(int i) const {
+		return i + 1;
+	}
+
+	int* alive;
+};
+
+TEST(inplace_function, basics) {
+	using func_t = fea::inplace_function<int(int)>;
+
+	func_t empty;
+	EXPECT_FALSE(empty);
+	func_t null = nullptr;
+	EXPECT_FALSE(null);
+
+	func_t f = free_func;
+	EXPECT_TRUE(f);
+	EXPECT_EQ(f(2), 4);
+
+	int (*null_ptr)(int) = nullptr;
+	func_t f_null = null_ptr;
+	EXPECT_FALSE(f_null);
+
+	// Captures.
+	int a = 1;
+	int b = 2;
+	func_t f2 = [&a, b](int i) { return i + a + b; };
+	EXPECT_EQ(f2(3), 6);
+	a = 10;
+	EXPECT_EQ(f2(3), 15);
+
+	// Mutable state.
+	fea::inplace_function<int()> counter = [n = 0]() mutable { return ++n; };
+	EXPECT_EQ(counter(), 1);
+	EXPECT_EQ(counter(), 2);
+
+	// Copies and moves.
+	func_t f3 = f2;
+	EXPECT_EQ(f3(3), 15);
+	func_t f4 = std::move(f3);
+	EXPECT_FALSE(f3);
+	EXPECT_EQ(f4(3), 15);
+	f4 = f;
+	EXPECT_EQ(f4(3), 6);
+	f4 = std::move(f2);
+	EXPECT_FALSE(f2);
+	EXPECT_EQ(f4(3), 15);
+	f4 = empty;
+	EXPECT_FALSE(f4);
+
+	// Self assignment.
+	f = *&f;
+	EXPECT_EQ(f(2), 4);
+
+	// Non-trivial captures.
+	{
+		std::string str = "a long string which doesn't fit in sso buffers";
+		auto ptr = std::make_shared<std::string>(str);
+		auto size_func = [ptr](const std::string& s) {
+			return ptr->size() + s.size();
+		};
+		fea::inplace_function<size_t(const std::string&)> f5
+				= std::move(size_func);
+		EXPECT_EQ(ptr.use_count(), 2);
+
+		auto f6 = f5;
+		EXPECT_EQ(ptr.use_count(), 3);
+		EXPECT_EQ(f6("ab"), str.size() + 2);
+
+		auto f7 = std::move(f6);
+		EXPECT_EQ(ptr.use_count(), 3);
+
+		f7 = nullptr;
+		EXPECT_EQ(ptr.use_count(), 2);
+		f5 = {};
+		EXPECT_EQ(ptr.use_count(), 1);
+	}
+
+	// Larger capacity.
+	{
+		std::array<int, 16> arr{};
+		arr[15] = 42;
+		fea::inplace_function<int(), sizeof(arr)> f8
+				= [arr]() { return arr[15]; };
+		EXPECT_EQ(f8(), 42);
+	}
+
+	// Void return, arguments forwarded.
+	{
+		std::vector<std::string> vec;
+		fea::inplace_function<void(std::string&&)> push
+				= [&](std::string&& s) { vec.push_back(std::move(s)); };
+		push("a");
+		ASSERT_EQ(vec.size(), 1u);
+		EXPECT_EQ(vec[0], "a");
+	}
+}
+
+TEST(inplace_function, lifetime) {
+	using func_t = fea::inplace_function<int(int)>;
+
+	int alive = 0;
+	{
+		func_t f = counted{ &alive };
+		EXPECT_EQ(alive, 1);
+		EXPECT_EQ(f(1), 2);
+
+		func_t f2 = f;
+		EXPECT_EQ(alive, 2);
+
+		func_t f3 = std::move(f2);
+		EXPECT_EQ(alive, 2);
+
+		f = free_func;
+		EXPECT_EQ(alive, 1);
+
+		std::vector<func_t> vec;
+		for (size_t i = 0; i < 100; ++i) {
+			vec.push_back(f3);
+		}
+		EXPECT_EQ(alive, 101);
+		vec.erase(vec.begin(), vec.begin() + 50);
+		EXPECT_EQ(alive, 51);
+	}
+	EXPECT_EQ(alive, 0);
+}
+} // namespace
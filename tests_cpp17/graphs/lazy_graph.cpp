@@ -1,5 +1,6 @@
 ﻿#include <algorithm>
 #include <cstdint>
+#include <fea/containers/flat_id_slotmap.hpp>
 #include <fea/containers/id_slotmap.hpp>
 #include <fea/graphs/lazy_graph.hpp>
 #include <fea/utility/platform.hpp>
@@ -153,25 +154,16 @@ TEST(lazy_graph, advanced_example) {
 	// Clean Multithreaded.
 	// This cleans a node (walks its eval graph top to bottom) but schedules
 	// your function in a threaded breadth manner.
-	// It will lock between stages that aren't independent.
-#if FEA_WITH_TBB
+	// Nodes are evaluated as soon as their parents are done.
 	graph.clean_mt(2, fea::make_callback([](const my_callback_data&) {}));
-#else
-	graph.clean(2, fea::make_callback([](const my_callback_data&) {}));
-#endif
 
 	// Clean multiple nodes in a multithreaded eval.
 	// This is the BEST call to make for maximum threading.
 	// It will launch independent eval graphs in seperate threads, plus thread
 	// the graphs' breadths as it can.
 	std::vector<my_id_t> my_nodes_to_clean{ 0, 1, 2 };
-#if FEA_WITH_TBB
 	graph.clean_mt(my_nodes_to_clean,
 			fea::make_callback([](const my_callback_data&) {}));
-#else
-	graph.clean(my_nodes_to_clean,
-			fea::make_callback([](const my_callback_data&) {}));
-#endif
 
 
 	// Even more advanced calls.
@@ -285,14 +277,15 @@ void test_parents(
 	}
 }
 
-TEST(lazy_graph, basics) {
+template <template <class...> class Container>
+void test_basics() {
 	// We use a smaller version tracking int so we can test the edge case when
 	// version has to wrap around.
 	// fea::lazy_graph<unsigned, uint8_t> graph;
 
 	// Can use with different map, as long as it fulfills std::unordered_map
 	// apis.
-	fea::lazy_graph<unsigned, char, uint8_t> graph;
+	fea::lazy_graph<unsigned, char, uint8_t, Container> graph;
 
 	// Basics
 	{
@@ -375,8 +368,14 @@ TEST(lazy_graph, basics) {
 	}
 }
 
-TEST(lazy_graph, removing) {
-	fea::lazy_graph<unsigned, char, uint8_t, std::unordered_map, 4, 4> graph;
+TEST(lazy_graph, basics) {
+	test_basics<std::unordered_map>();
+	test_basics<fea::flat_id_slotmap>();
+}
+
+template <template <class...> class Container>
+void test_removing() {
+	fea::lazy_graph<unsigned, char, uint8_t, Container, 4, 4> graph;
 	reset_graph(graph);
 
 	// Test removing
@@ -424,8 +423,14 @@ TEST(lazy_graph, removing) {
 	EXPECT_FALSE(graph.contains(7));
 }
 
-TEST(lazy_graph, advanced) {
-	fea::lazy_graph<unsigned, char, uint8_t> graph;
+TEST(lazy_graph, removing) {
+	test_removing<std::unordered_map>();
+	test_removing<fea::flat_id_slotmap>();
+}
+
+template <template <class...> class Container>
+void test_advanced() {
+	fea::lazy_graph<unsigned, char, uint8_t, Container> graph;
 	reset_graph(graph);
 
 	// Evaluation graphs
@@ -462,8 +467,14 @@ TEST(lazy_graph, advanced) {
 	EXPECT_EQ(ind_data.dependent_graphs.size(), 8u);
 }
 
-TEST(lazy_graph, dirtyness) {
-	fea::lazy_graph<unsigned, char, uint8_t> graph;
+TEST(lazy_graph, advanced) {
+	test_advanced<std::unordered_map>();
+	test_advanced<fea::flat_id_slotmap>();
+}
+
+template <template <class...> class Container>
+void test_dirtyness() {
+	fea::lazy_graph<unsigned, char, uint8_t, Container> graph;
 	using my_callback_data = fea::callback_data<unsigned>;
 	reset_graph(graph);
 
@@ -753,8 +764,14 @@ TEST(lazy_graph, dirtyness) {
 	EXPECT_FALSE(contains(cleaned_ids, 7u));
 }
 
-TEST(lazy_graph, dirtyness_mt) {
-	fea::lazy_graph<unsigned, char, uint8_t> graph;
+TEST(lazy_graph, dirtyness) {
+	test_dirtyness<std::unordered_map>();
+	test_dirtyness<fea::flat_id_slotmap>();
+}
+
+template <template <class...> class Container>
+void test_dirtyness_mt() {
+	fea::lazy_graph<unsigned, char, uint8_t, Container> graph;
 	using my_callback_data = fea::callback_data<unsigned>;
 	reset_graph(graph);
 
@@ -776,7 +793,6 @@ TEST(lazy_graph, dirtyness_mt) {
 	std::vector<unsigned> cleaned_ids;
 	std::mutex m;
 
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			4, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -788,18 +804,6 @@ TEST(lazy_graph, dirtyness_mt) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(4, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(4, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -853,21 +857,12 @@ TEST(lazy_graph, dirtyness_mt) {
 
 	// Clean it again.
 	cleaned_ids.clear();
-#if FEA_WITH_TBB
 	graph.clean_mt(7, fea::make_callback([&](const my_callback_data& d) {
 		std::lock_guard<std::mutex> g{ m };
 		test_parents(d.id, d.parents);
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.clean(7, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 	// Test the order of evaluation.
 	EXPECT_GT(get_index(cleaned_ids, 2), get_index(cleaned_ids, 1));
@@ -930,7 +925,6 @@ TEST(lazy_graph, dirtyness_mt) {
 
 	evaled_ids.clear();
 	cleaned_ids.clear();
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			2, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -942,18 +936,6 @@ TEST(lazy_graph, dirtyness_mt) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(2, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(2, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -989,7 +971,6 @@ TEST(lazy_graph, dirtyness_mt) {
 	evaled_ids.clear();
 	cleaned_ids.clear();
 
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			5, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -1001,18 +982,6 @@ TEST(lazy_graph, dirtyness_mt) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(5, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(5, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -1050,11 +1019,7 @@ TEST(lazy_graph, dirtyness_mt) {
 	EXPECT_FALSE(contains(cleaned_ids, 7u));
 
 	// Clean everything
-#if FEA_WITH_TBB
 	graph.clean_mt(7, fea::make_callback([](const my_callback_data&) {}));
-#else
-	graph.clean(7, fea::make_callback([](const my_callback_data&) {}));
-#endif
 	EXPECT_FALSE(graph.is_dirty(0));
 	EXPECT_FALSE(graph.is_dirty(1));
 	EXPECT_FALSE(graph.is_dirty(2));
@@ -1077,21 +1042,12 @@ TEST(lazy_graph, dirtyness_mt) {
 	EXPECT_TRUE(graph.is_dirty(7));
 
 	cleaned_ids.clear();
-#if FEA_WITH_TBB
 	graph.clean_mt(6, fea::make_callback([&](const my_callback_data& d) {
 		std::lock_guard<std::mutex> g{ m };
 		test_parents(d.id, d.parents);
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.clean(6, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Only should clean 6.
@@ -1121,6 +1077,11 @@ TEST(lazy_graph, dirtyness_mt) {
 	EXPECT_FALSE(contains(cleaned_ids, 7u));
 }
 
+TEST(lazy_graph, dirtyness_mt) {
+	test_dirtyness_mt<std::unordered_map>();
+	test_dirtyness_mt<fea::flat_id_slotmap>();
+}
+
 TEST(lazy_graph, basics_max_parents) {
 	// We use a smaller version tracking int so we can test the edge case when
 	// version has to wrap around.
@@ -1617,7 +1578,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 	std::vector<unsigned> evaled_ids;
 	std::vector<unsigned> cleaned_ids;
 	std::mutex m;
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			4, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -1629,18 +1589,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(4, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(4, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -1694,21 +1642,12 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 
 	// Clean it again.
 	cleaned_ids.clear();
-#if FEA_WITH_TBB
 	graph.clean_mt(7, fea::make_callback([&](const my_callback_data& d) {
 		std::lock_guard<std::mutex> g{ m };
 		test_parents(d.id, d.parents);
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.clean(7, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 	// Test the order of evaluation.
 	EXPECT_GT(get_index(cleaned_ids, 2), get_index(cleaned_ids, 1));
@@ -1772,7 +1711,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 	evaled_ids.clear();
 	cleaned_ids.clear();
 
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			2, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -1784,18 +1722,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(2, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(2, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -1829,21 +1755,12 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 
 	graph.make_dirty(0);
 	cleaned_ids.clear();
-#if FEA_WITH_TBB
 	graph.clean_mt(5, fea::make_callback([&](const my_callback_data& d) {
 		std::lock_guard<std::mutex> g{ m };
 		test_parents(d.id, d.parents);
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.clean(5, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Test the order of evaluation.
@@ -1878,11 +1795,7 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 	EXPECT_FALSE(contains(cleaned_ids, 7u));
 
 	// Clean everything
-#if FEA_WITH_TBB
 	graph.clean_mt(7, fea::make_callback([](const my_callback_data&) {}));
-#else
-	graph.clean(7, fea::make_callback([](const my_callback_data&) {}));
-#endif
 	EXPECT_FALSE(graph.is_dirty(0));
 	EXPECT_FALSE(graph.is_dirty(1));
 	EXPECT_FALSE(graph.is_dirty(2));
@@ -1907,7 +1820,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 	evaled_ids.clear();
 	cleaned_ids.clear();
 
-#if FEA_WITH_TBB
 	graph.evaluate_dirty_mt(
 			6, fea::make_callback([&](const my_callback_data& d) {
 				std::lock_guard<std::mutex> g{ m };
@@ -1919,18 +1831,6 @@ TEST(lazy_graph, dirtyness_mt_max_parents) {
 		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
 		cleaned_ids.push_back(d.id);
 	}));
-#else
-	graph.evaluate_dirty(6, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		evaled_ids.push_back(d.id);
-	}));
-	graph.clean(6, fea::make_callback([&](const my_callback_data& d) {
-		std::lock_guard<std::mutex> g{ m };
-		test_parents(d.id, d.parents);
-		EXPECT_EQ(num_dirty(d.parents), d.parents.size());
-		cleaned_ids.push_back(d.id);
-	}));
-#endif
 
 
 	// Only should clean 6.
@@ -2000,4 +1900,86 @@ TEST(lazy_graph, fixed_size) {
 #endif
 	}
 }
+TEST(lazy_graph, flat_storage) {
+	using flat_graph_t = fea::flat_lazy_graph<unsigned, char, uint8_t>;
+	using graph_t = fea::lazy_graph<unsigned, char, uint8_t>;
+	using my_callback_data = fea::callback_data<unsigned>;
+
+	flat_graph_t flat_graph;
+	graph_t graph;
+	reset_graph(flat_graph);
+	reset_graph(graph);
+
+	// Parents are provided in their insertion order.
+	auto check_order = fea::make_callback([&](const my_callback_data& d) {
+		fea::span<const unsigned> parents = flat_graph.parents(d.id);
+		EXPECT_EQ(d.parents.size(), parents.size());
+		for (size_t i = 0; i < parents.size(); ++i) {
+			EXPECT_EQ(d.parents[i].parent_id, parents[i]);
+		}
+	});
+	auto noop = fea::make_callback([](const my_callback_data&) {});
+
+	auto compare_dirty = [&]() {
+		for (unsigned i = 0; i < 8; ++i) {
+			if (!graph.contains(i)) {
+				EXPECT_FALSE(flat_graph.contains(i));
+				continue;
+			}
+			EXPECT_EQ(flat_graph.is_dirty(i), graph.is_dirty(i));
+		}
+	};
+
+	// Topology is out of date, const calls walk the nodes.
+	compare_dirty();
+	flat_graph.update_topology();
+	compare_dirty();
+
+	flat_graph.clean(4, check_order);
+	graph.clean(4, noop);
+	compare_dirty();
+
+	flat_graph.make_dirty(1);
+	graph.make_dirty(1);
+	compare_dirty();
+
+	flat_graph.clean_mt(7, check_order);
+	graph.clean_mt(7, noop);
+	compare_dirty();
+	EXPECT_FALSE(flat_graph.is_dirty(7));
+
+	// Removing nodes moves others in the flat storage.
+	flat_graph.remove_node(2);
+	graph.remove_node(2);
+	flat_graph.add_dependency(3, 0);
+	graph.add_dependency(3, 0);
+	flat_graph.make_dirty(0);
+	graph.make_dirty(0);
+	compare_dirty();
+
+	flat_graph.update_topology();
+	compare_dirty();
+	size_t num_parents = 0;
+	flat_graph.recurse_up(7, [&](unsigned, const flat_graph_t::node_t& n) {
+		num_parents += n.parents().size();
+		return false;
+	});
+	size_t expected_num_parents = 0;
+	graph.recurse_up(7, [&](unsigned, const graph_t::node_t& n) {
+		expected_num_parents += n.parents().size();
+		return false;
+	});
+	EXPECT_EQ(num_parents, expected_num_parents);
+
+	flat_graph.clean(7, check_order);
+	graph.clean(7, noop);
+	compare_dirty();
+	EXPECT_FALSE(flat_graph.is_dirty(7));
+
+	flat_graph.clear();
+	EXPECT_TRUE(flat_graph.empty());
+	reset_graph(flat_graph);
+	flat_graph.clean(7, check_order);
+	EXPECT_FALSE(flat_graph.is_dirty(7));
+}
 } // namespace
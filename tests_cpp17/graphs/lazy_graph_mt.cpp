@@ -5,10 +5,9 @@
 #include <fea/utility/platform.hpp>
 #include <gtest/gtest.h>
 #include <mutex>
+#include <random>
 #include <vector>
 
-#if FEA_WITH_TBB
-
 extern bool contains(const std::vector<unsigned>& vec, unsigned i);
 extern bool contains(
 		fea::span<const fea::parent_status<unsigned>> vec, unsigned i);
@@ -397,5 +396,86 @@ TEST(fea_lazy_graph, threading_max_parents) {
 				}));
 	}
 }
+
+template <class graph_t>
+void test_wide() {
+	// Layers of nodes, each depending on random nodes of the previous
+	// layer. A sink depends on the last layer.
+	using my_callback_data = fea::callback_data<unsigned, uint64_t>;
+	constexpr unsigned width = 100;
+	constexpr unsigned depth = 5;
+	constexpr unsigned sink = width * depth;
+
+	graph_t graph;
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<unsigned> dis{ 0, width - 1 };
+	for (unsigned i = 0; i < width; ++i) {
+		graph.add_node(i);
+	}
+	for (unsigned l = 1; l < depth; ++l) {
+		for (unsigned i = 0; i < width; ++i) {
+			unsigned id = l * width + i;
+			for (unsigned p = 0; p < 3; ++p) {
+				graph.add_dependency(id, (l - 1) * width + dis(gen));
+			}
+		}
+	}
+	for (unsigned i = 0; i < width; ++i) {
+		graph.add_dependency(sink, (depth - 1) * width + i);
+	}
+
+	// Node values are the sum of their parents', + 1.
+	std::vector<unsigned> cleaned_ids;
+	std::mutex m;
+	auto cb = fea::make_callback([&](const my_callback_data& d) {
+		uint64_t val = 1;
+		for (const fea::parent_status<unsigned, uint64_t>& p : d.parents) {
+			val += *p.node_data;
+		}
+		*d.node_data = val;
+
+		std::lock_guard<std::mutex> g{ m };
+		cleaned_ids.push_back(d.id);
+	});
+
+	for (size_t run = 0; run < 3; ++run) {
+		for (unsigned i = 0; i < width; ++i) {
+			graph.make_dirty(i);
+		}
+
+		graph_t expected = graph;
+		expected.clean(sink, cb);
+		std::vector<unsigned> expected_ids = cleaned_ids;
+		cleaned_ids.clear();
+
+		graph.clean_mt(sink, cb);
+		EXPECT_EQ(cleaned_ids.size(), expected_ids.size());
+		EXPECT_EQ(cleaned_ids.back(), sink);
+
+		std::sort(cleaned_ids.begin(), cleaned_ids.end());
+		std::sort(expected_ids.begin(), expected_ids.end());
+		EXPECT_EQ(cleaned_ids, expected_ids);
+		cleaned_ids.clear();
+
+		for (unsigned i = 0; i <= sink; ++i) {
+			EXPECT_EQ(graph.node_data(i), expected.node_data(i));
+		}
+
+		// Everything is clean.
+		graph.clean_mt(sink, cb);
+		EXPECT_TRUE(cleaned_ids.empty());
+	}
+
+	// Only part of the graph is dirty.
+	graph.make_dirty(graph.parents(sink - 1).front());
+	graph.evaluate_dirty_mt(sink, cb);
+	EXPECT_GE(cleaned_ids.size(), 2u);
+	EXPECT_LT(cleaned_ids.size(), size_t(width + 1));
+	EXPECT_EQ(cleaned_ids.back(), sink);
+}
+
+TEST(fea_lazy_graph, threading_wide) {
+	test_wide<fea::lazy_graph<unsigned, uint64_t>>();
+	test_wide<fea::flat_lazy_graph<unsigned, uint64_t>>();
+}
 } // namespace
-#endif
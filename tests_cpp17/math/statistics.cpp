@@ -59,6 +59,26 @@ TEST(statistics, basics) {
 		EXPECT_EQ(fea::median(vd.begin(), vd.end()), 17.0);
 	}
 
+	{
+		std::vector<double> vd = { 15, 20, 35, 40, 50 };
+		EXPECT_EQ(fea::percentile(vd.begin(), vd.end(), 0.0), 15.0);
+		EXPECT_EQ(fea::percentile(vd.begin(), vd.end(), 0.5), 35.0);
+		EXPECT_EQ(fea::percentile(vd.begin(), vd.end(), 1.0), 50.0);
+		EXPECT_DOUBLE_EQ(fea::percentile(vd.begin(), vd.end(), 0.4), 29.0);
+		EXPECT_DOUBLE_EQ(fea::percentile(vd.begin(), vd.end(), 0.9), 46.0);
+
+		vd = { 12, 3, 5, 9, 22, 37, 44, 51, 32, 2, 10, 25 };
+		EXPECT_EQ(fea::percentile(vd.begin(), vd.end(), 0.5),
+				fea::median(vd.begin(), vd.end()));
+
+		std::vector<int> v{ 40, 10, 30, 20 };
+		EXPECT_EQ(fea::percentile(v.begin(), v.end(), 0.5), 25);
+		EXPECT_EQ(fea::percentile(v.begin(), v.end(), 0.99), 40);
+
+		v = { 7 };
+		EXPECT_EQ(fea::percentile(v.begin(), v.end(), 0.9), 7);
+	}
+
 	{
 		std::vector<int> v{ 16, 3, 16, 6, 9, 27, 3, 27, 37, 16, 48 };
 
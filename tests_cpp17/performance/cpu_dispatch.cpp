@@ -0,0 +1,68 @@
+#include <fea/performance/cpu_dispatch.hpp>
+#include <gtest/gtest.h>
+#include <string>
+
+namespace {
+int k_scalar() {
+	return 0;
+}
+int k_sse42() {
+	return 1;
+}
+int k_avx512() {
+	return 3;
+}
+
+TEST(cpu_dispatch, basics) {
+	fea::isa level = fea::detected_isa();
+	EXPECT_LT(level, fea::isa::count);
+	EXPECT_EQ(level, fea::detected_isa());
+	EXPECT_NE(std::string(fea::to_string(level)), "");
+
+#if FEA_X86
+	const fea::cpu_info_t& info = fea::get_cpu_info();
+	if (level >= fea::isa::sse42) {
+		EXPECT_TRUE(info.sse42());
+	}
+	if (level >= fea::isa::avx2) {
+		EXPECT_TRUE(info.avx2());
+		EXPECT_TRUE(info.os_avx());
+	}
+	if (level >= fea::isa::avx512) {
+		EXPECT_TRUE(info.avx512_bw());
+		EXPECT_TRUE(info.os_avx512());
+	}
+	if (info.os_avx512()) {
+		EXPECT_TRUE(info.os_avx());
+	}
+#else
+	EXPECT_EQ(level, fea::isa::scalar);
+#endif
+}
+
+TEST(cpu_dispatch, table) {
+	using fn_t = int (*)();
+	constexpr fea::dispatch_table<fn_t> table{ {
+			&k_scalar,
+			&k_sse42,
+			nullptr,
+			&k_avx512,
+	} };
+
+	static_assert(table.get(fea::isa::scalar) == &k_scalar, "");
+	static_assert(table.get(fea::isa::sse42) == &k_sse42, "");
+	static_assert(table.get(fea::isa::avx2) == &k_sse42, "");
+	static_assert(table.get(fea::isa::avx512) == &k_avx512, "");
+
+	int expected = int(fea::detected_isa());
+	if (expected == 2) {
+		expected = 1;
+	}
+	EXPECT_EQ(table.resolve()(), expected);
+
+	// Scalar only.
+	constexpr fea::dispatch_table<fn_t> scalar{ { &k_scalar } };
+	EXPECT_EQ(scalar.get(fea::isa::avx512), &k_scalar);
+	EXPECT_EQ(scalar.resolve()(), 0);
+}
+} // namespace
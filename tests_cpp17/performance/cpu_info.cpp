@@ -306,6 +306,9 @@ TEST(cpu_info, basics) {
 		EXPECT_EQ(std::string{ fea::cpu_info.vendor() }, "AuthenticAMD");
 	}
 
+	// The global is the lazily detected instance.
+	EXPECT_EQ(&fea::cpu_info, &fea::get_cpu_info());
+
 	// fea::cpu_info.print_all();
 }
 } // namespace
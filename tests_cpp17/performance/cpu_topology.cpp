@@ -0,0 +1,68 @@
+#include <fea/performance/cpu_topology.hpp>
+#include <fea/performance/thread.hpp>
+#include <gtest/gtest.h>
+#include <vector>
+
+namespace {
+TEST(cpu_topology, parsing) {
+	using vec_t = std::vector<size_t>;
+	EXPECT_EQ(fea::detail::parse_cpu_list(""), vec_t{});
+	EXPECT_EQ(fea::detail::parse_cpu_list("0"), vec_t{ 0 });
+	EXPECT_EQ(fea::detail::parse_cpu_list("0-3"), (vec_t{ 0, 1, 2, 3 }));
+	EXPECT_EQ(fea::detail::parse_cpu_list("0-1,4,6-7"),
+			(vec_t{ 0, 1, 4, 6, 7 }));
+	EXPECT_EQ(fea::detail::parse_cpu_list("2,5"), (vec_t{ 2, 5 }));
+
+	EXPECT_EQ(fea::detail::parse_size("64"), 64u);
+	EXPECT_EQ(fea::detail::parse_size("48K"), 48u * 1024u);
+	EXPECT_EQ(fea::detail::parse_size("32M"), 32u * 1024u * 1024u);
+	EXPECT_EQ(fea::detail::parse_size(""), 0u);
+}
+
+TEST(cpu_topology, basics) {
+	const fea::cpu_topology_t& topo = fea::cpu_topology();
+	EXPECT_EQ(&topo, &fea::cpu_topology());
+	topo.print();
+
+	EXPECT_GE(topo.logical_cores(), 1u);
+	EXPECT_GE(topo.physical_cores(), 1u);
+	EXPECT_LE(topo.physical_cores(), topo.logical_cores());
+	EXPECT_GE(topo.threads_per_core(), 1u);
+	EXPECT_GE(topo.packages(), 1u);
+	EXPECT_LE(topo.packages(), topo.physical_cores());
+
+	EXPECT_GE(topo.numa_nodes(), 1u);
+	size_t numa_cpus = 0;
+	for (size_t i = 0; i < topo.numa_nodes(); ++i) {
+		EXPECT_FALSE(topo.numa_node_cpus(i).empty());
+		numa_cpus += topo.numa_node_cpus(i).size();
+	}
+	EXPECT_LE(numa_cpus, topo.logical_cores());
+
+	// Powers of 2, between 16 and 256 bytes.
+	size_t line = topo.cache_line_size();
+	EXPECT_EQ(line & (line - 1), 0u);
+	EXPECT_GE(line, 16u);
+	EXPECT_LE(line, 256u);
+
+	uint8_t prev_level = 0;
+	for (const fea::cache_desc& c : topo.caches()) {
+		EXPECT_GE(c.level, prev_level);
+		prev_level = c.level;
+		EXPECT_GT(c.size, 0u);
+		EXPECT_LT(c.type, fea::cache_type::count);
+	}
+
+	// Larger levels are larger.
+	if (topo.l1d_size() != 0 && topo.l2_size() != 0) {
+		EXPECT_GT(topo.l2_size(), topo.l1d_size());
+	}
+	if (topo.find_cache(1) != nullptr) {
+		EXPECT_NE(topo.find_cache(1)->type, fea::cache_type::instruction);
+	}
+	EXPECT_EQ(topo.find_cache(42), nullptr);
+
+	EXPECT_EQ(fea::num_physical_threads(), topo.physical_cores());
+	EXPECT_LE(fea::num_physical_threads(), fea::num_threads());
+}
+} // namespace
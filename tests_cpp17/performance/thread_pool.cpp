@@ -0,0 +1,181 @@
+﻿#include <fea/performance/thread.hpp>
+#include <fea/performance/thread_pool.hpp>
+#include <gtest/gtest.h>
+#include <atomic>
+#include <numeric>
+#include <stdexcept>
+#include <vector>
+
+namespace {
+TEST(thread_pool, basics) {
+	for (size_t num_workers : { size_t(0), size_t(1), size_t(3) }) {
+		fea::thread_pool pool{ num_workers };
+		EXPECT_EQ(pool.num_workers(), num_workers);
+		EXPECT_EQ(pool.concurrency(), num_workers + 1);
+		EXPECT_FALSE(pool.is_worker());
+
+		std::atomic<size_t> count{ 0 };
+		fea::task_group g{ pool };
+		EXPECT_EQ(&g.pool(), &pool);
+		for (size_t i = 0; i < 1000; ++i) {
+			g.run([&]() { ++count; });
+		}
+		g.wait();
+		EXPECT_EQ(count.load(), 1000u);
+
+		// Reusable.
+		g.run([&]() { count = 42; });
+		g.wait();
+		EXPECT_EQ(count.load(), 42u);
+
+		// Tasks know they are workers, unless executed by the waiting thread.
+		std::atomic<size_t> num_on_worker{ 0 };
+		for (size_t i = 0; i < 100; ++i) {
+			g.run([&]() {
+				if (pool.is_worker()) {
+					++num_on_worker;
+				}
+			});
+		}
+		g.wait();
+		if (num_workers == 0) {
+			EXPECT_EQ(num_on_worker.load(), 0u);
+		}
+	}
+}
+
+TEST(thread_pool, exceptions) {
+	fea::thread_pool pool{ 2 };
+	fea::task_group g{ pool };
+	std::atomic<size_t> count{ 0 };
+	for (size_t i = 0; i < 100; ++i) {
+		g.run([&, i]() {
+			++count;
+			if (i == 50) {
+				throw std::runtime_error{ "test" };
+			}
+		});
+	}
+	EXPECT_THROW(g.wait(), std::runtime_error);
+	EXPECT_EQ(count.load(), 100u);
+
+	// Exception is consumed.
+	g.run([]() {});
+	g.wait();
+
+	// A task which fails to queue isn't waited on.
+	struct throwing_copy {
+		throwing_copy() = default;
+		throwing_copy(const throwing_copy&) {
+			throw std::runtime_error{ "test" };
+		}
+		void operator()() const {
+		}
+	};
+	throwing_copy func;
+	EXPECT_THROW(g.run(func), std::runtime_error);
+	g.run([&]() { ++count; });
+	g.wait();
+	EXPECT_EQ(count.load(), 101u);
+}
+
+TEST(thread_pool, nested) {
+	fea::thread_pool pool{ 3 };
+	std::atomic<size_t> count{ 0 };
+
+	// Deeply nested groups, waited on from within tasks.
+	// Would deadlock if waiting threads blocked.
+	fea::task_group g{ pool };
+	for (size_t i = 0; i < 8; ++i) {
+		g.run([&]() {
+			fea::task_group g2{ pool };
+			for (size_t j = 0; j < 8; ++j) {
+				g2.run([&]() {
+					fea::task_group g3{ pool };
+					for (size_t k = 0; k < 8; ++k) {
+						g3.run([&]() { ++count; });
+					}
+					g3.wait();
+				});
+			}
+			g2.wait();
+		});
+	}
+	g.wait();
+	EXPECT_EQ(count.load(), 512u);
+
+	// Destruction executes queued tasks.
+	{
+		fea::thread_pool pool2{ 0 };
+		fea::task_group g2{ pool2 };
+		g2.run([&]() { ++count; });
+	}
+	EXPECT_EQ(count.load(), 513u);
+}
+
+TEST(thread_pool, parallel_for) {
+	constexpr size_t num = 10'000;
+	std::vector<size_t> vals(num, 0);
+
+	// Chunked.
+	std::vector<size_t> chunk_counts(fea::num_threads(), 0);
+	fea::parallel_for(
+			num, [&](const std::pair<size_t, size_t>& range, size_t chunk_idx) {
+				for (size_t i = range.first; i < range.second; ++i) {
+					++vals[i];
+				}
+				++chunk_counts[chunk_idx];
+			});
+	for (size_t v : vals) {
+		EXPECT_EQ(v, 1u);
+	}
+	for (size_t c : chunk_counts) {
+		EXPECT_EQ(c, 1u);
+	}
+
+	// Dynamic.
+	for (size_t grain : { size_t(0), size_t(1), size_t(7), size_t(100'000) }) {
+		fea::parallel_for(
+				num, grain, [&](const std::pair<size_t, size_t>& range) {
+					EXPECT_LT(range.first, range.second);
+					for (size_t i = range.first; i < range.second; ++i) {
+						++vals[i];
+					}
+				});
+	}
+	for (size_t v : vals) {
+		EXPECT_EQ(v, 5u);
+	}
+	fea::parallel_for(0, 1, [](const std::pair<size_t, size_t>&) {
+		ADD_FAILURE();
+	});
+
+	// Nested.
+	std::atomic<size_t> count{ 0 };
+	fea::parallel_for(100, 1, [&](const std::pair<size_t, size_t>&) {
+		fea::parallel_for(100, 10, [&](const std::pair<size_t, size_t>& r) {
+			count += r.second - r.first;
+		});
+	});
+	EXPECT_EQ(count.load(), 10'000u);
+
+	// Exceptions propagate to the caller.
+	EXPECT_THROW(fea::parallel_for(num, 10,
+						 [](const std::pair<size_t, size_t>& r) {
+							 if (r.first == 500) {
+								 throw std::runtime_error{ "test" };
+							 }
+						 }),
+			std::runtime_error);
+}
+
+TEST(thread_pool, parallel_tasks) {
+	std::atomic<size_t> count{ 0 };
+	std::vector<std::function<void()>> tasks;
+	for (size_t i = 0; i < 100; ++i) {
+		tasks.push_back([&]() { ++count; });
+	}
+	fea::parallel_tasks(std::move(tasks));
+	EXPECT_EQ(count.load(), 100u);
+}
+} // namespace
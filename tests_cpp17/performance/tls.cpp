@@ -1,8 +1,13 @@
 #include <algorithm>
 #include <chrono>
+#include <cstdint>
+#include <fea/benchmark/benchmark.hpp>
 #include <fea/performance/tls.hpp>
 #include <fea/utility/platform.hpp>
 #include <gtest/gtest.h>
+#include <memory>
+#include <thread>
+#include <vector>
 
 #if FEA_WITH_TBB
 #include <tbb/parallel_for.h>
@@ -15,10 +20,14 @@ namespace {
 #define FEA_EXPECT_THROW(t, e) EXPECT_THROW(t, e)
 #endif
 
+template <class T, fea::tls_mode Mode>
+using tls_t = fea::tls<T, std::allocator<T>, Mode>;
+
+template <fea::tls_mode Mode>
 void fuzzit(size_t num_fuzz) {
 	// Makes sure everything gets created right.
 	{
-		fea::tls<int> tls;
+		tls_t<int, Mode> tls;
 		EXPECT_TRUE(tls.empty());
 		EXPECT_EQ(tls.size(), 0u);
 		{
@@ -62,7 +71,7 @@ void fuzzit(size_t num_fuzz) {
 
 #if FEA_WITH_TBB
 	{
-		fea::tls<std::vector<int>> tls;
+		tls_t<std::vector<int>, Mode> tls;
 
 		auto tbb_fuzz = [&](const tbb::blocked_range<size_t>& range) {
 			fea::tls_lock<std::vector<int>> lock{ tls };
@@ -141,8 +150,9 @@ void fuzzit(size_t num_fuzz) {
 #endif
 }
 
-TEST(tls, basics) {
-	fea::tls<int> tls;
+template <fea::tls_mode Mode>
+void test_basics() {
+	tls_t<int, Mode> tls;
 
 	{
 		fea::tls_lock<int> lock = tls.lock();
@@ -284,7 +294,171 @@ TEST(tls, basics) {
 		EXPECT_EQ(tids.size(), tls.size());
 	}
 
-	fuzzit(100);
-	fuzzit(1'000);
+	fuzzit<Mode>(100);
+	fuzzit<Mode>(1'000);
+}
+
+TEST(tls, basics) {
+	test_basics<fea::tls_mode::search>();
+	test_basics<fea::tls_mode::cached>();
+	test_basics<fea::tls_mode::padded>();
+	test_basics<fea::tls_mode::cached_padded>();
 }
+
+TEST(tls, cached) {
+	using tls_c = tls_t<int, fea::tls_mode::cached>;
+
+	// Same slot once cached, recursion still gets new slots.
+	{
+		tls_c tls;
+		int* first = nullptr;
+		{
+			fea::tls_lock<int> lock = tls.lock();
+			first = &lock.local();
+			lock.local() = 1;
+		}
+		{
+			fea::tls_lock<int> lock = tls.lock();
+			EXPECT_EQ(&lock.local(), first);
+			EXPECT_EQ(lock.local(), 1);
+			{
+				fea::tls_lock<int> rec = tls.lock();
+				EXPECT_NE(&rec.local(), first);
+				EXPECT_EQ(tls.size(), 2u);
+			}
+		}
+		{
+			fea::tls_lock<int> lock = tls.lock();
+			EXPECT_EQ(&lock.local(), first);
+		}
+		EXPECT_EQ(tls.size(), 2u);
+
+		// Clearing invalidates cached slots.
+		tls.clear();
+		{
+			fea::tls_lock<int> lock = tls.lock();
+			EXPECT_EQ(lock.local(), 0);
+			lock.local() = 2;
+		}
+		EXPECT_EQ(tls.size(), 1u);
+	}
+
+	// More storages than cache entries, and destroyed storages.
+	{
+		constexpr size_t num = 3 * fea::detail::tls_cache_size;
+		std::vector<std::unique_ptr<tls_c>> storages;
+		for (size_t i = 0; i < num; ++i) {
+			storages.push_back(std::make_unique<tls_c>());
+		}
+
+		for (size_t j = 0; j < 3; ++j) {
+			for (size_t i = 0; i < num; ++i) {
+				fea::tls_lock<int> lock = storages[i]->lock();
+				lock.local() += int(i);
+			}
+		}
+
+		for (size_t i = 0; i < num; ++i) {
+			EXPECT_EQ(storages[i]->size(), 1u);
+			storages[i]->combine_each(
+					[&](int v) { EXPECT_EQ(v, 3 * int(i)); });
+		}
+
+		storages.clear();
+		for (size_t i = 0; i < num; ++i) {
+			storages.push_back(std::make_unique<tls_c>());
+			fea::tls_lock<int> lock = storages.back()->lock();
+			EXPECT_EQ(lock.local(), 0);
+		}
+	}
+
+	// Threads reuse their slots.
+	{
+		tls_c tls;
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < 4; ++i) {
+			threads.push_back(std::thread{ [&]() {
+				for (size_t j = 0; j < 1'000; ++j) {
+					fea::tls_lock<int> lock = tls.lock();
+					++lock.local();
+				}
+			} });
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+
+		EXPECT_EQ(tls.size(), 4u);
+		int total = 0;
+		tls.combine_each([&](int v) { total += v; });
+		EXPECT_EQ(total, 4'000);
+	}
+}
+
+TEST(tls, padded) {
+	tls_t<int, fea::tls_mode::cached_padded> tls;
+	std::vector<fea::tls_lock<int>> locks;
+	locks.push_back(tls.lock());
+	locks.push_back(tls.lock());
+
+	uintptr_t a = reinterpret_cast<uintptr_t>(&locks[0].local());
+	uintptr_t b = reinterpret_cast<uintptr_t>(&locks[1].local());
+	EXPECT_EQ(a % fea::cache_line_size, 0u);
+	EXPECT_EQ(b % fea::cache_line_size, 0u);
+	EXPECT_GE(b - a, fea::cache_line_size);
+}
+
+#if FEA_RELEASE
+template <fea::tls_mode Mode>
+void bench_tls(fea::bench::suite& suite, const std::string& name,
+		size_t num_threads, size_t num_locks) {
+	tls_t<uint64_t, Mode> tls;
+
+	// Long running programs accumulate slots from previous threads.
+	// Searches go through them, cached lookups don't.
+	for (size_t i = 0; i < 64; ++i) {
+		std::thread{ [&]() { fea::tls_lock<uint64_t> lock = tls.lock(); } }
+				.join();
+	}
+
+	constexpr size_t num_runs = 5;
+	suite.average(num_runs);
+	suite.benchmark(name, [&]() {
+		std::vector<std::thread> threads;
+		for (size_t i = 0; i < num_threads; ++i) {
+			threads.push_back(std::thread{ [&]() {
+				for (size_t j = 0; j < num_locks; ++j) {
+					fea::tls_lock<uint64_t> lock = tls.lock();
+					++lock.local();
+				}
+			} });
+		}
+		for (std::thread& t : threads) {
+			t.join();
+		}
+	});
+
+	uint64_t total = 0;
+	tls.combine_each([&](uint64_t v) { total += v; });
+	EXPECT_EQ(total, uint64_t(num_runs * num_threads * num_locks));
+}
+
+TEST(tls, benchmarks) {
+	size_t num_threads = (std::max)(
+			size_t(std::thread::hardware_concurrency()), size_t(4));
+	constexpr size_t num_locks = 1'000'000;
+
+	fea::bench::suite suite;
+	std::string title = "tls lock + local, " + std::to_string(num_threads)
+			+ " threads, 1 million locks each";
+	suite.title(title);
+
+	bench_tls<fea::tls_mode::search>(suite, "search", num_threads, num_locks);
+	bench_tls<fea::tls_mode::padded>(suite, "padded", num_threads, num_locks);
+	bench_tls<fea::tls_mode::cached>(suite, "cached", num_threads, num_locks);
+	bench_tls<fea::tls_mode::cached_padded>(
+			suite, "cached_padded", num_threads, num_locks);
+	suite.print();
+}
+#endif
 } // namespace
\ No newline at end of file
@@ -0,0 +1,217 @@
+#include <cstdint>
+#include <cstring>
+#include <fea/serialize/lz.hpp>
+#include <fea/serialize/serialize.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+// Text-like data, words from a small dictionary with some noise.
+std::vector<std::byte> make_data(size_t size, std::mt19937& gen) {
+	const std::vector<std::string> words{ "potato", "tomato", "fea", " ",
+		"serializer", "\n", "0123456789", "aaaaaaaaaaaaaaaaaaaaaaaaaaaa" };
+	std::uniform_int_distribution<size_t> word_dis{ 0, words.size() - 1 };
+	std::uniform_int_distribution<int> noise_dis{ 0, 255 };
+
+	std::vector<std::byte> ret;
+	ret.reserve(size);
+	while (ret.size() < size) {
+		if (noise_dis(gen) < 16) {
+			ret.push_back(std::byte(noise_dis(gen)));
+			continue;
+		}
+		for (char c : words[word_dis(gen)]) {
+			ret.push_back(std::byte(c));
+		}
+	}
+	ret.resize(size);
+	return ret;
+}
+
+void test_roundtrip(const std::vector<std::byte>& data, size_t block_size) {
+	std::vector<std::byte> compressed = fea::lz_compress(data, block_size);
+	EXPECT_EQ(fea::lz_compress_mt(data, block_size), compressed);
+
+	std::vector<std::byte> out;
+	EXPECT_TRUE(fea::lz_decompress(compressed, out));
+	EXPECT_EQ(out, data);
+
+	out.clear();
+	EXPECT_TRUE(fea::lz_decompress_mt(compressed, out));
+	EXPECT_EQ(out, data);
+}
+
+TEST(lz, basics) {
+	std::mt19937 gen{ 42 };
+
+	for (size_t size : { size_t(0), size_t(1), size_t(5), size_t(13),
+				 size_t(100), size_t(4'096), size_t(100'000) }) {
+		std::vector<std::byte> data = make_data(size, gen);
+		for (size_t block_size : { size_t(1), size_t(16), size_t(1'000),
+					 fea::lz_default_block_size }) {
+			if (block_size == 1 && size > 4'096) {
+				continue;
+			}
+			test_roundtrip(data, block_size);
+		}
+	}
+
+	// Compresses text.
+	{
+		std::vector<std::byte> data = make_data(1'000'000, gen);
+		std::vector<std::byte> compressed = fea::lz_compress(data);
+		EXPECT_LT(compressed.size() * 3, data.size());
+		test_roundtrip(data, fea::lz_default_block_size);
+	}
+
+	// Runs, long matches and overlapping copies.
+	{
+		std::vector<std::byte> data(300'000, std::byte(7));
+		for (size_t i = 100'000; i < 200'000; ++i) {
+			data[i] = std::byte(i % 3);
+		}
+		std::vector<std::byte> compressed = fea::lz_compress(data);
+		EXPECT_LT(compressed.size() * 50, data.size());
+		test_roundtrip(data, fea::lz_default_block_size);
+
+		// Short repeating patterns, around the 8 byte copy size.
+		for (size_t period = 1; period < 10; ++period) {
+			for (size_t i = 0; i < data.size(); ++i) {
+				data[i] = std::byte(i % period + (i >> 12));
+			}
+			test_roundtrip(data, fea::lz_default_block_size);
+		}
+	}
+
+	// Doesn't expand noise much.
+	{
+		std::vector<std::byte> data(1'000'000);
+		for (std::byte& b : data) {
+			b = std::byte(gen());
+		}
+		std::vector<std::byte> compressed = fea::lz_compress(data);
+		EXPECT_LT(compressed.size(), data.size() + 1'000);
+		test_roundtrip(data, fea::lz_default_block_size);
+	}
+}
+
+TEST(lz, corrupted) {
+	std::mt19937 gen{ 42 };
+	std::vector<std::byte> data = make_data(100'000, gen);
+	const std::vector<std::byte> compressed = fea::lz_compress(data, 4'096);
+
+	std::vector<std::byte> out;
+	EXPECT_FALSE(fea::lz_decompress({}, out));
+	EXPECT_TRUE(out.empty());
+
+	// Truncated.
+	for (size_t size : { size_t(3), size_t(16), size_t(20),
+				 compressed.size() / 2, compressed.size() - 1 }) {
+		std::vector<std::byte> truncated(
+				compressed.begin(), compressed.begin() + size);
+		EXPECT_FALSE(fea::lz_decompress(truncated, out));
+		EXPECT_TRUE(out.empty());
+	}
+
+	// Bad magic.
+	{
+		std::vector<std::byte> bad = compressed;
+		bad[0] = std::byte(0);
+		EXPECT_FALSE(fea::lz_decompress(bad, out));
+	}
+
+	// Sizes in the header that the stored bytes can't produce.
+	{
+		// magic, block size, raw size, one stored size, one byte.
+		std::vector<std::byte> bad(21);
+		uint32_t magic = 0x315a4c46;
+		uint32_t block_size = 0xFFFFFFFF;
+		uint64_t raw_size = 0xFFFFFFFF;
+		uint32_t stored = 1;
+		std::memcpy(bad.data(), &magic, sizeof(magic));
+		std::memcpy(bad.data() + 4, &block_size, sizeof(block_size));
+		std::memcpy(bad.data() + 8, &raw_size, sizeof(raw_size));
+		std::memcpy(bad.data() + 16, &stored, sizeof(stored));
+		EXPECT_FALSE(fea::lz_decompress(bad, out));
+		EXPECT_TRUE(out.empty());
+		EXPECT_LT(out.capacity(), 1'000u);
+	}
+	{
+		// A huge raw size.
+		std::vector<std::byte> bad = compressed;
+		uint64_t raw_size = (std::numeric_limits<uint64_t>::max)() / 2;
+		std::memcpy(bad.data() + 8, &raw_size, sizeof(raw_size));
+		EXPECT_FALSE(fea::lz_decompress(bad, out));
+		EXPECT_TRUE(out.empty());
+	}
+	{
+		// A raw size which doesn't match the blocks.
+		std::vector<std::byte> bad = compressed;
+		uint64_t raw_size = data.size() - 1'000;
+		std::memcpy(bad.data() + 8, &raw_size, sizeof(raw_size));
+		EXPECT_FALSE(fea::lz_decompress(bad, out));
+		EXPECT_TRUE(out.empty());
+	}
+	{
+		// A block size bigger than the stored blocks can produce.
+		std::vector<std::byte> bad = compressed;
+		uint32_t block_size = 0x7FFFFFFF;
+		std::memcpy(bad.data() + 4, &block_size, sizeof(block_size));
+		EXPECT_FALSE(fea::lz_decompress(bad, out));
+		EXPECT_TRUE(out.empty());
+	}
+
+	// Random header flips.
+	std::uniform_int_distribution<size_t> header_dis{ 4, 15 };
+	for (size_t i = 0; i < 1'000; ++i) {
+		std::vector<std::byte> bad = compressed;
+		bad[header_dis(gen)] = std::byte(gen());
+		if (!fea::lz_decompress_mt(bad, out)) {
+			EXPECT_TRUE(out.empty());
+		}
+		EXPECT_LT(out.capacity(), 255 * compressed.size());
+	}
+
+	// Random flips never read or write out of bounds, and mostly fail.
+	std::uniform_int_distribution<size_t> idx_dis{ 16, compressed.size() - 1 };
+	size_t num_failed = 0;
+	for (size_t i = 0; i < 1'000; ++i) {
+		std::vector<std::byte> bad = compressed;
+		for (size_t j = 0; j < 4; ++j) {
+			bad[idx_dis(gen)] = std::byte(gen());
+		}
+		num_failed += size_t(!fea::lz_decompress_mt(bad, out));
+	}
+	EXPECT_GT(num_failed, 0u);
+}
+
+TEST(lz, serializer) {
+	std::map<int, std::vector<std::string>> map;
+	for (int i = 0; i < 1'000; ++i) {
+		map[i] = std::vector<std::string>(size_t(i % 7), "potato");
+	}
+
+	std::vector<std::byte> compressed;
+	size_t raw_size = 0;
+	{
+		fea::serializer ofs;
+		fea::serialize(map, ofs);
+		std::vector<std::byte> data = ofs.extract();
+		raw_size = data.size();
+		compressed = fea::lz_compress_mt(data, 4'096);
+	}
+	EXPECT_LT(compressed.size() * 4, raw_size);
+
+	std::vector<std::byte> data;
+	ASSERT_TRUE(fea::lz_decompress_mt(compressed, data));
+	fea::deserializer ifs{ std::move(data) };
+
+	decltype(map) map2;
+	EXPECT_TRUE(fea::deserialize(ifs, map2));
+	EXPECT_EQ(map2, map);
+}
+} // namespace
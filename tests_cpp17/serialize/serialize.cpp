@@ -1,17 +1,22 @@
-﻿#include <fea/meta/pack.hpp>
+﻿#include <fea/memory/fmap.hpp>
+#include <fea/meta/pack.hpp>
 #include <fea/serialize/serialize.hpp>
 #include <fea/utility/file.hpp>
 #include <filesystem>
 #include <gtest/gtest.h>
 
+#include <algorithm>
 #include <array>
 #include <cassert>
+#include <cstdint>
 #include <deque>
 #include <fstream>
+#include <limits>
 #include <map>
 #include <queue>
 #include <set>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
 #include <unordered_set>
@@ -697,4 +702,510 @@ TEST(serialize, evewything) {
 
 	printf("TODO : test release vs. debug serialized data.\n");
 }
+TEST(serialize, streaming) {
+	std::map<int, std::vector<potato>> pmap;
+	for (int i = 0; i < 64; ++i) {
+		pmap[i] = std::vector<potato>(size_t(i), potato{ i });
+	}
+
+	// Sizes must fit FEA_SERIALIZE_SIZE_T.
+	std::vector<int> big((std::min)(size_t(100'000),
+			size_t((std::numeric_limits<fea::serializer::msize_t>::max)())));
+	for (size_t i = 0; i < big.size(); ++i) {
+		big[i] = int(i);
+	}
+
+	const std::string str = "a string that isn't too short, but not long";
+
+	auto test = [&](auto&& ifs) {
+		decltype(pmap) pmap2;
+		decltype(big) big2;
+		std::string str2;
+		decltype(pmap) pmap3;
+
+		EXPECT_TRUE(ifs.is_gucci());
+		EXPECT_TRUE(deserialize(ifs, pmap2));
+		EXPECT_TRUE(deserialize(ifs, big2));
+		EXPECT_TRUE(deserialize(ifs, str2));
+		EXPECT_TRUE(deserialize(ifs, pmap3));
+		EXPECT_EQ(pmap2, pmap);
+		EXPECT_EQ(big2, big);
+		EXPECT_EQ(str2, str);
+		EXPECT_EQ(pmap3, pmap);
+	};
+
+	for (size_t buffer_size : { size_t(1), size_t(64), size_t(4'096),
+				 size_t(1'000'000) }) {
+		{
+			fea::serializer ofs{ filepath(), buffer_size };
+			EXPECT_TRUE(ofs.is_streaming());
+			serialize(pmap, ofs);
+			serialize(big, ofs);
+			serialize(str, ofs);
+			ofs.flush();
+			serialize(pmap, ofs);
+		}
+
+		// From file.
+		test(fea::deserializer{ filepath() });
+
+		// From memory.
+		std::vector<std::byte> data(std::filesystem::file_size(filepath()));
+		{
+			std::ifstream ifs{ filepath(), std::ios::binary };
+			ifs.read(reinterpret_cast<char*>(data.data()),
+					std::streamsize(data.size()));
+		}
+		test(fea::deserializer{ std::move(data) });
+	}
+
+	// Same data as the buffered serializer.
+	std::vector<std::byte> expected;
+	{
+		fea::serializer ofs;
+		EXPECT_FALSE(ofs.is_streaming());
+		serialize(pmap, ofs);
+		serialize(big, ofs);
+		serialize(str, ofs);
+		serialize(pmap, ofs);
+		expected = ofs.extract();
+	}
+	test(fea::deserializer{ std::move(expected) });
+
+	// Close writes everything before destruction.
+	auto close_test = [&](fea::serializer& ofs) {
+		serialize(pmap, ofs);
+		serialize(big, ofs);
+		serialize(str, ofs);
+		serialize(pmap, ofs);
+		ofs.close();
+		EXPECT_FALSE(ofs.is_streaming());
+		test(fea::deserializer{ filepath() });
+
+		// Does nothing.
+		ofs.close();
+	};
+	{
+		fea::serializer ofs{ filepath() };
+		close_test(ofs);
+	}
+	{
+		fea::serializer ofs{ filepath(), size_t(64) };
+		close_test(ofs);
+	}
+
+	// Write errors are reported by close.
+	{
+		fea::serializer ofs{ filepath().parent_path() / "not_a_directory"
+							 / "pertatoes.bin" };
+		serialize(str, ofs);
+#if FEA_DEBUG || FEA_NOTHROW
+		EXPECT_DEATH(ofs.close(), "");
+#else
+		EXPECT_THROW(ofs.close(), std::runtime_error);
+#endif
+	}
+}
+
+TEST(serialize, mapped) {
+	// Sizes must fit FEA_SERIALIZE_SIZE_T.
+	std::vector<int> big((std::min)(size_t(100'000),
+			size_t((std::numeric_limits<fea::serializer::msize_t>::max)())));
+	for (size_t i = 0; i < big.size(); ++i) {
+		big[i] = int(i);
+	}
+
+	const std::string str = "a string that isn't too short, but not long";
+	const std::vector<std::string> strs{ "a", "", "bcd", str };
+	std::vector<potato> potatoes(4, potato{ 42 });
+
+	auto write = [&](fea::serializer& ofs) {
+		serialize(size_t(42), ofs);
+		serialize(big, ofs);
+		serialize(str, ofs);
+		serialize(strs, ofs);
+		serialize(std::vector<double>{}, ofs);
+		serialize(potatoes, ofs);
+	};
+
+	auto test = [&](fea::deserializer&& ifs) {
+		size_t s = 0;
+		fea::span<const int> big_view;
+		std::string_view str_view;
+		std::vector<std::string_view> strs_view;
+		fea::span<const double> empty_view;
+		std::vector<potato> potatoes2;
+
+		ASSERT_TRUE(ifs.is_gucci());
+		EXPECT_TRUE(deserialize(ifs, s));
+		EXPECT_TRUE(deserialize(ifs, big_view));
+		EXPECT_TRUE(deserialize(ifs, str_view));
+		EXPECT_TRUE(deserialize(ifs, strs_view));
+		EXPECT_TRUE(deserialize(ifs, empty_view));
+		EXPECT_TRUE(deserialize(ifs, potatoes2));
+
+		EXPECT_EQ(s, 42u);
+		EXPECT_TRUE(std::equal(
+				big_view.begin(), big_view.end(), big.begin(), big.end()));
+		EXPECT_EQ(str_view, str);
+		EXPECT_TRUE(std::equal(
+				strs_view.begin(), strs_view.end(), strs.begin(), strs.end()));
+		EXPECT_TRUE(empty_view.empty());
+		EXPECT_EQ(potatoes2, potatoes);
+
+		// Views stay valid when the deserializer moves.
+		fea::deserializer ifs2 = std::move(ifs);
+		EXPECT_EQ(big_view[42], 42);
+		EXPECT_EQ(str_view, str);
+	};
+
+	// Buffered.
+	{
+		fea::serializer ofs{ filepath() };
+		write(ofs);
+	}
+	test(fea::deserializer{ fea::ifmap{ filepath() } });
+	test(fea::deserializer{ filepath() });
+
+	// Streamed.
+	for (size_t buffer_size : { size_t(1), size_t(64), size_t(1'000'000) }) {
+		{
+			fea::serializer ofs{ filepath(), buffer_size };
+			write(ofs);
+		}
+		test(fea::deserializer{ fea::ifmap{ filepath() } });
+	}
+
+	// Misaligned data is copied.
+	{
+		fea::serializer ofs{ filepath() };
+		serialize(char(1), ofs);
+		serialize(big, ofs);
+		serialize(char(2), ofs);
+	}
+	{
+		fea::deserializer ifs{ fea::ifmap{ filepath() } };
+		char c = 0;
+		fea::span<const int> big_view;
+		EXPECT_TRUE(deserialize(ifs, c));
+		EXPECT_TRUE(deserialize(ifs, big_view));
+		EXPECT_TRUE(deserialize(ifs, c));
+
+		EXPECT_EQ(c, char(2));
+		EXPECT_EQ(reinterpret_cast<std::uintptr_t>(big_view.data())
+						  % alignof(int),
+				0u);
+		EXPECT_TRUE(std::equal(
+				big_view.begin(), big_view.end(), big.begin(), big.end()));
+	}
+
+	// Unmapped file.
+	{
+		fea::deserializer ifs{ fea::ifmap{} };
+		EXPECT_FALSE(ifs.is_gucci());
+	}
+}
+
+TEST(serialize, sections) {
+	std::map<int, std::vector<potato>> pmap;
+	for (int i = 0; i < 16; ++i) {
+		pmap[i] = std::vector<potato>(size_t(i), potato{ i });
+	}
+
+	std::vector<int> big(10'000);
+	for (size_t i = 0; i < big.size(); ++i) {
+		big[i] = int(i);
+	}
+
+	const std::string str = "a string that isn't too short, but not long";
+
+	auto write = [&](fea::serializer& ofs) {
+		// Same sizes on each side of section boundaries.
+		serialize(42, ofs);
+		fea::serialize_section("first int", 43, ofs);
+		fea::serialize_section("pmap", pmap, ofs);
+		fea::serialize_section("big", big, ofs);
+		ofs.begin_section();
+		serialize(str, ofs);
+		serialize(44, ofs);
+		ofs.begin_section("empty");
+	};
+
+	auto test = [&](fea::deserializer&& ifs) {
+		ASSERT_TRUE(ifs.is_gucci());
+		ASSERT_EQ(ifs.section_count(), 5u);
+		EXPECT_EQ(ifs.section_name(0), "first int");
+		EXPECT_EQ(ifs.section_name(3), "");
+		EXPECT_EQ(ifs.section_name(4), "empty");
+
+		// Front to back, without seeking.
+		{
+			int i = 0;
+			int i2 = 0;
+			decltype(pmap) pmap2;
+			decltype(big) big2;
+			std::string str2;
+			int i3 = 0;
+			EXPECT_TRUE(deserialize(ifs, i));
+			EXPECT_TRUE(deserialize(ifs, i2));
+			EXPECT_TRUE(deserialize(ifs, pmap2));
+			EXPECT_TRUE(deserialize(ifs, big2));
+			EXPECT_TRUE(deserialize(ifs, str2));
+			EXPECT_TRUE(deserialize(ifs, i3));
+			EXPECT_EQ(i, 42);
+			EXPECT_EQ(i2, 43);
+			EXPECT_EQ(pmap2, pmap);
+			EXPECT_EQ(big2, big);
+			EXPECT_EQ(str2, str);
+			EXPECT_EQ(i3, 44);
+		}
+
+		// Random access, repeated.
+		for (size_t n = 0; n < 2; ++n) {
+			std::string str2;
+			int i = 0;
+			EXPECT_TRUE(ifs.seek(3));
+			EXPECT_TRUE(deserialize(ifs, str2));
+			EXPECT_TRUE(deserialize(ifs, i));
+			EXPECT_EQ(str2, str);
+			EXPECT_EQ(i, 44);
+
+			fea::span<const int> big_view;
+			EXPECT_TRUE(fea::deserialize_section(ifs, "big", big_view));
+			EXPECT_TRUE(std::equal(
+					big_view.begin(), big_view.end(), big.begin(), big.end()));
+
+			decltype(pmap) pmap2;
+			EXPECT_TRUE(fea::deserialize_section(ifs, "pmap", pmap2));
+			EXPECT_EQ(pmap2, pmap);
+
+			// Read partially.
+			EXPECT_TRUE(ifs.seek("big"));
+
+			i = 0;
+			EXPECT_TRUE(fea::deserialize_section(ifs, "first int", i));
+			EXPECT_EQ(i, 43);
+
+			EXPECT_TRUE(ifs.seek("empty"));
+		}
+
+		EXPECT_FALSE(ifs.seek(5));
+		EXPECT_FALSE(ifs.seek("potato"));
+	};
+
+	{
+		fea::serializer ofs{ filepath() };
+		write(ofs);
+	}
+	test(fea::deserializer{ filepath() });
+	test(fea::deserializer{ fea::ifmap{ filepath() } });
+
+	for (size_t buffer_size : { size_t(1), size_t(64), size_t(4'096) }) {
+		{
+			fea::serializer ofs{ filepath(), buffer_size };
+			write(ofs);
+		}
+		test(fea::deserializer{ fea::ifmap{ filepath() } });
+	}
+
+	{
+		fea::serializer ofs;
+		write(ofs);
+		test(fea::deserializer{ ofs.extract() });
+	}
+
+	// Non indexed archives have no sections.
+	{
+		fea::serializer ofs{ filepath() };
+		serialize(42, ofs);
+	}
+	{
+		fea::deserializer ifs{ filepath() };
+		EXPECT_EQ(ifs.section_count(), 0u);
+		EXPECT_FALSE(ifs.seek(0));
+	}
+}
+
+TEST(serialize, compact) {
+	std::map<int, std::vector<potato>> pmap;
+	for (int i = 0; i < 16; ++i) {
+		pmap[i] = std::vector<potato>(size_t(i), potato{ i });
+	}
+
+	std::vector<uint32_t> ids(10'000);
+	for (size_t i = 0; i < ids.size(); ++i) {
+		ids[i] = uint32_t(i * 3);
+	}
+
+	std::vector<int64_t> unsorted{ 0, -1, 1, -2,
+		(std::numeric_limits<int64_t>::min)(),
+		(std::numeric_limits<int64_t>::max)(), 42, -42 };
+	std::vector<int16_t> sorted{ (std::numeric_limits<int16_t>::min)(), -5,
+		-5, 0, 7, (std::numeric_limits<int16_t>::max)() };
+	std::set<int> set{ -100, -1, 0, 1, 1'000, 1'000'000 };
+	std::deque<uint64_t> deque{ 5, 4, 3, uint64_t(-1) };
+	const std::string str = "a string that isn't too short, but not long";
+	std::tuple<int, unsigned short, double, char, bool> tup{ -3, 7, 0.5, 'c',
+		true };
+
+	auto write = [&](fea::serializer& ofs) {
+		EXPECT_EQ(ofs.encoding(), fea::serialize_encoding::compact);
+		serialize(pmap, ofs);
+		serialize(ids, ofs);
+		fea::serialize_section("unsorted", unsorted, ofs);
+		serialize(sorted, ofs);
+		serialize(set, ofs);
+		serialize(std::set<int>{}, ofs);
+		serialize(deque, ofs);
+		serialize(std::vector<int>{}, ofs);
+		serialize(std::vector<int>{ -7 }, ofs);
+		serialize(str, ofs);
+		serialize(tup, ofs);
+	};
+
+	auto test = [&](fea::deserializer&& ifs) {
+		ASSERT_TRUE(ifs.is_gucci());
+		EXPECT_EQ(ifs.encoding(), fea::serialize_encoding::compact);
+
+		decltype(pmap) pmap2;
+		decltype(ids) ids2;
+		decltype(unsorted) unsorted2;
+		decltype(sorted) sorted2;
+		decltype(set) set2;
+		decltype(set) empty_set;
+		decltype(deque) deque2;
+		std::vector<int> empty_vec;
+		std::vector<int> one;
+		std::string str2;
+		decltype(tup) tup2;
+
+		EXPECT_TRUE(deserialize(ifs, pmap2));
+		EXPECT_TRUE(deserialize(ifs, ids2));
+		EXPECT_TRUE(deserialize(ifs, unsorted2));
+		EXPECT_TRUE(deserialize(ifs, sorted2));
+		EXPECT_TRUE(deserialize(ifs, set2));
+		EXPECT_TRUE(deserialize(ifs, empty_set));
+		EXPECT_TRUE(deserialize(ifs, deque2));
+		EXPECT_TRUE(deserialize(ifs, empty_vec));
+		EXPECT_TRUE(deserialize(ifs, one));
+		EXPECT_TRUE(deserialize(ifs, str2));
+		EXPECT_TRUE(deserialize(ifs, tup2));
+
+		EXPECT_EQ(pmap2, pmap);
+		EXPECT_EQ(ids2, ids);
+		EXPECT_EQ(unsorted2, unsorted);
+		EXPECT_EQ(sorted2, sorted);
+		EXPECT_EQ(set2, set);
+		EXPECT_TRUE(empty_set.empty());
+		EXPECT_EQ(deque2, deque);
+		EXPECT_TRUE(empty_vec.empty());
+		EXPECT_EQ(one, std::vector<int>{ -7 });
+		EXPECT_EQ(str2, str);
+		EXPECT_EQ(tup2, tup);
+
+		unsorted2.clear();
+		EXPECT_TRUE(fea::deserialize_section(ifs, "unsorted", unsorted2));
+		EXPECT_EQ(unsorted2, unsorted);
+
+		// Integers are decoded for views.
+		fea::span<const int16_t> sorted_view;
+		EXPECT_TRUE(deserialize(ifs, sorted_view));
+		EXPECT_TRUE(std::equal(sorted_view.begin(), sorted_view.end(),
+				sorted.begin(), sorted.end()));
+	};
+
+	{
+		fea::serializer ofs{ filepath(), fea::serialize_encoding::compact };
+		write(ofs);
+	}
+	const size_t compact_size = size_t(std::filesystem::file_size(filepath()));
+	test(fea::deserializer{ filepath() });
+	test(fea::deserializer{ fea::ifmap{ filepath() } });
+
+	for (size_t buffer_size : { size_t(1), size_t(64), size_t(4'096) }) {
+		{
+			fea::serializer ofs{ filepath(), buffer_size,
+				fea::serialize_encoding::compact };
+			write(ofs);
+		}
+		test(fea::deserializer{ fea::ifmap{ filepath() } });
+	}
+
+	{
+		fea::serializer ofs{ fea::serialize_encoding::compact };
+		write(ofs);
+		test(fea::deserializer{ ofs.extract() });
+	}
+
+	// Same data, fixed width.
+	{
+		fea::serializer ofs{ filepath() };
+		serialize(pmap, ofs);
+		serialize(ids, ofs);
+		fea::serialize_section("unsorted", unsorted, ofs);
+		serialize(sorted, ofs);
+		serialize(set, ofs);
+		serialize(std::set<int>{}, ofs);
+		serialize(deque, ofs);
+		serialize(std::vector<int>{}, ofs);
+		serialize(std::vector<int>{ -7 }, ofs);
+		serialize(str, ofs);
+		serialize(tup, ofs);
+	}
+	const size_t fixed_size = size_t(std::filesystem::file_size(filepath()));
+	EXPECT_LT(compact_size * 3, fixed_size);
+}
+TEST(serialize, huge_size_table) {
+	// Size table counts must never collide with the format sentinels.
+	// Only reachable with a small FEA_SERIALIZE_SIZE_T.
+	using msize_t = fea::serializer::msize_t;
+	if constexpr (sizeof(msize_t) <= 2) {
+		const size_t count = size_t((std::numeric_limits<msize_t>::max)()) + 10;
+
+		// Alternating sizes, a new size token per write. Then more writes of
+		// the same size than a token can count.
+		auto write = [&](fea::serializer& ofs) {
+			for (size_t i = 0; i < count; ++i) {
+				serialize(uint8_t(i), ofs);
+				serialize(uint16_t(i), ofs);
+			}
+			for (size_t i = 0; i < count; ++i) {
+				serialize(uint32_t(i), ofs);
+			}
+		};
+
+		auto test = [&](fea::deserializer&& ifs) {
+			ASSERT_TRUE(ifs.is_gucci());
+			for (size_t i = 0; i < count; ++i) {
+				uint8_t u8 = 0;
+				uint16_t u16 = 0;
+				ASSERT_TRUE(deserialize(ifs, u8));
+				ASSERT_TRUE(deserialize(ifs, u16));
+				ASSERT_EQ(u8, uint8_t(i));
+				ASSERT_EQ(u16, uint16_t(i));
+			}
+			for (size_t i = 0; i < count; ++i) {
+				uint32_t u32 = 0;
+				ASSERT_TRUE(deserialize(ifs, u32));
+				ASSERT_EQ(u32, uint32_t(i));
+			}
+		};
+
+		{
+			fea::serializer ofs;
+			write(ofs);
+			test(fea::deserializer{ ofs.extract() });
+		}
+		{
+			fea::serializer ofs{ fea::serialize_encoding::compact };
+			write(ofs);
+			test(fea::deserializer{ ofs.extract() });
+		}
+		{
+			fea::serializer ofs{ filepath(), size_t(1'000'000) };
+			write(ofs);
+		}
+		test(fea::deserializer{ filepath() });
+	}
+}
 } // namespace
@@ -0,0 +1,186 @@
+#include <cstdint>
+#include <fea/serialize/varint.hpp>
+#include <gtest/gtest.h>
+#include <limits>
+#include <random>
+#include <vector>
+
+namespace {
+template <class U>
+void test_roundtrip(U v) {
+	std::byte buf[fea::varint_max_size<U>];
+	std::byte* end = fea::varint_encode(v, buf);
+	EXPECT_LE(size_t(end - buf), fea::varint_max_size<U>);
+	EXPECT_EQ(size_t(end - buf), fea::varint_size(v));
+
+	U v2 = 0;
+	EXPECT_EQ(fea::varint_decode(buf, end, v2), end);
+	EXPECT_EQ(v, v2);
+
+	// Truncated.
+	EXPECT_EQ(fea::varint_decode(buf, end - 1, v2), nullptr);
+}
+
+TEST(varint, basics) {
+	static_assert(fea::varint_max_size<uint8_t> == 2);
+	static_assert(fea::varint_max_size<uint16_t> == 3);
+	static_assert(fea::varint_max_size<uint32_t> == 5);
+	static_assert(fea::varint_max_size<uint64_t> == 10);
+
+	std::byte buf[10];
+	EXPECT_EQ(fea::varint_encode(uint32_t(0), buf) - buf, 1);
+	EXPECT_EQ(fea::varint_encode(uint32_t(127), buf) - buf, 1);
+	EXPECT_EQ(fea::varint_encode(uint32_t(128), buf) - buf, 2);
+	EXPECT_EQ(buf[0], std::byte(0x80));
+	EXPECT_EQ(buf[1], std::byte(0x01));
+	EXPECT_EQ(fea::varint_encode(uint64_t(-1), buf) - buf, 10);
+	static_assert(fea::varint_size(uint32_t(127)) == 1);
+	static_assert(fea::varint_size(uint32_t(128)) == 2);
+	static_assert(fea::varint_size(uint64_t(-1)) == 10);
+
+	for (uint64_t v : { uint64_t(0), uint64_t(1), uint64_t(127),
+				 uint64_t(128), uint64_t(16'383), uint64_t(16'384),
+				 uint64_t(-1) }) {
+		test_roundtrip(v);
+		test_roundtrip(uint32_t(v));
+		test_roundtrip(uint16_t(v));
+	}
+
+	// Doesn't fit.
+	fea::varint_encode(uint32_t(70'000), buf);
+	uint16_t small = 0;
+	EXPECT_EQ(fea::varint_decode(buf, buf + 3, small), nullptr);
+	fea::varint_encode(uint64_t(-1), buf);
+	uint32_t medium = 0;
+	EXPECT_EQ(fea::varint_decode(buf, buf + 10, medium), nullptr);
+}
+
+TEST(varint, zigzag) {
+	EXPECT_EQ(fea::zigzag_encode(0), 0u);
+	EXPECT_EQ(fea::zigzag_encode(-1), 1u);
+	EXPECT_EQ(fea::zigzag_encode(1), 2u);
+	EXPECT_EQ(fea::zigzag_encode(-2), 3u);
+	EXPECT_EQ(fea::zigzag_encode((std::numeric_limits<int>::max)()),
+			uint32_t(-2));
+	EXPECT_EQ(fea::zigzag_encode((std::numeric_limits<int>::min)()),
+			uint32_t(-1));
+
+	for (int64_t v : { int64_t(0), int64_t(-1), int64_t(1), int64_t(-64),
+				 int64_t(64), (std::numeric_limits<int64_t>::min)(),
+				 (std::numeric_limits<int64_t>::max)() }) {
+		EXPECT_EQ(fea::zigzag_decode<int64_t>(fea::zigzag_encode(v)), v);
+	}
+
+	for (int v = -40'000; v < 40'000; ++v) {
+		int16_t s = int16_t(v);
+		EXPECT_EQ(fea::zigzag_decode<int16_t>(fea::zigzag_encode(s)), s);
+	}
+}
+
+TEST(varint, bulk) {
+	std::mt19937_64 gen{ 42 };
+	std::vector<uint64_t> vals;
+	for (size_t i = 0; i < 10'000; ++i) {
+		// Mostly runs of small values, with bigger ones sprinkled in.
+		uint64_t v = gen();
+		switch (v % 8) {
+		case 0: {
+			vals.push_back(v);
+		} break;
+		case 1: {
+			vals.push_back(v % 100'000);
+		} break;
+		default: {
+			vals.push_back(v % 128);
+		} break;
+		}
+	}
+
+	std::vector<std::byte> buf(vals.size() * fea::varint_max_size<uint64_t>);
+	std::byte* end = buf.data();
+	for (uint64_t v : vals) {
+		end = fea::varint_encode(v, end);
+	}
+
+	std::vector<uint64_t> vals2(vals.size());
+	EXPECT_EQ(fea::varint_decode(buf.data(), end, vals2.data(), vals2.size()),
+			end);
+	EXPECT_EQ(vals, vals2);
+
+	// Truncated.
+	EXPECT_EQ(fea::varint_decode(
+					  buf.data(), end - 1, vals2.data(), vals2.size()),
+			nullptr);
+	EXPECT_EQ(fea::varint_decode(buf.data(), end, vals2.data(), size_t(0)),
+			buf.data());
+}
+template <class U>
+void test_kernels() {
+	using fn_t = fea::detail::varint_decode_fn<U>;
+	std::vector<fn_t> kernels{ &fea::detail::varint_decode_scalar<U> };
+#if FEA_DISPATCH
+	if (fea::detected_isa() >= fea::isa::sse42) {
+		kernels.push_back(&fea::detail::varint_decode_sse42<U>);
+	}
+	if (fea::detected_isa() >= fea::isa::avx2) {
+		kernels.push_back(&fea::detail::varint_decode_avx2<U>);
+	}
+#endif
+	kernels.push_back(fea::detail::varint_decode_kernel<U>());
+
+	std::mt19937_64 gen{ 42 };
+	for (size_t count = 0; count < 300; ++count) {
+		// Every length, in runs so single byte and mixed paths are hit.
+		std::vector<U> vals(count);
+		size_t max_bits = 7;
+		for (size_t i = 0; i < count; ++i) {
+			if (i % 37 == 0) {
+				max_bits = size_t(gen() % (sizeof(U) * 8)) + 1;
+			}
+			uint64_t v = gen();
+			if (max_bits != 64) {
+				v &= (uint64_t(1) << max_bits) - 1;
+			}
+			vals[i] = U(v);
+		}
+
+		std::vector<std::byte> buf(count * fea::varint_max_size<U>);
+		std::byte* end = buf.data();
+		for (U v : vals) {
+			end = fea::varint_encode(v, end);
+		}
+
+		for (fn_t fn : kernels) {
+			std::vector<U> vals2(count);
+			EXPECT_EQ(fn(buf.data(), end, vals2.data(), count), end);
+			EXPECT_EQ(vals, vals2);
+
+			if (count != 0) {
+				EXPECT_EQ(fn(buf.data(), end - 1, vals2.data(), count),
+						nullptr);
+			}
+		}
+	}
+
+	// Values which don't fit, in the middle of small ones.
+	if constexpr (sizeof(U) == 2) {
+		std::vector<std::byte> buf(64 * fea::varint_max_size<uint32_t>);
+		std::byte* end = buf.data();
+		for (size_t i = 0; i < 64; ++i) {
+			end = fea::varint_encode(i == 21 ? uint32_t(70'000) : uint32_t(i),
+					end);
+		}
+
+		for (fn_t fn : kernels) {
+			std::vector<U> vals2(64);
+			EXPECT_EQ(fn(buf.data(), end, vals2.data(), 64), nullptr);
+		}
+	}
+}
+
+TEST(varint, kernels) {
+	test_kernels<uint16_t>();
+	test_kernels<uint32_t>();
+	test_kernels<uint64_t>();
+}
+} // namespace
@@ -0,0 +1,49 @@
+#include <fea/string/ascii_kernels.hpp>
+#include <gtest/gtest.h>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+TEST(ascii_kernels, flip_case) {
+	using fn_t = fea::detail::ascii_flip_case_fn;
+	std::vector<fn_t> kernels{ &fea::detail::ascii_flip_case_scalar };
+#if FEA_DISPATCH
+	if (fea::detected_isa() >= fea::isa::sse42) {
+		kernels.push_back(&fea::detail::ascii_flip_case_sse42);
+	}
+	if (fea::detected_isa() >= fea::isa::avx2) {
+		kernels.push_back(&fea::detail::ascii_flip_case_avx2);
+	}
+	if (fea::detected_isa() >= fea::isa::avx512) {
+		kernels.push_back(&fea::detail::ascii_flip_case_avx512);
+	}
+#endif
+	kernels.push_back(fea::detail::ascii_flip_case());
+
+	std::mt19937 gen{ 42 };
+	for (size_t size = 0; size < 300; ++size) {
+		// Every byte value, with guard bytes around the string.
+		std::string str(size + 2, '\0');
+		for (char& c : str) {
+			c = char(gen());
+		}
+
+		for (char first : { 'A', 'a' }) {
+			std::string expected = str;
+			for (size_t i = 1; i < size + 1; ++i) {
+				char c = expected[i];
+				if (c >= first && c < first + 26) {
+					expected[i] = char(c ^ 0x20);
+				}
+			}
+
+			for (fn_t fn : kernels) {
+				std::string out = str;
+				fn(out.data() + 1, size, first);
+				EXPECT_EQ(out, expected);
+			}
+		}
+	}
+}
+} // namespace
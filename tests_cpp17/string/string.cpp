@@ -1,10 +1,13 @@
-﻿#include <array>
+﻿#include <algorithm>
+#include <array>
 #include <fea/meta/static_for.hpp>
 #include <fea/meta/traits.hpp>
 #include <fea/meta/tuple.hpp>
 #include <fea/string/string.hpp>
 #include <gtest/gtest.h>
+#include <string>
 #include <tuple>
+#include <vector>
 
 #define gen_constants(tupname, str) \
 	const auto tupname = std::make_tuple(std::string_view{ str }, \
@@ -395,6 +398,34 @@ TEST(string, to_lower_to_upper_ascii) {
 			}
 		}
 	});
+
+	// Long enough for the simd kernels, in place and on any contiguous
+	// container.
+	{
+		std::string str;
+		std::string lower;
+		std::string upper;
+		for (size_t i = 0; i < 300; ++i) {
+			char c = char(i % 128);
+			str.push_back(c);
+			lower.push_back(fea::to_lower_ascii(c));
+			upper.push_back(fea::to_upper_ascii(c));
+		}
+
+		std::string temp_str = str;
+		fea::to_lower_ascii_inplace(temp_str);
+		EXPECT_EQ(temp_str, lower);
+		fea::to_upper_ascii_inplace(temp_str);
+		EXPECT_EQ(temp_str, upper);
+
+		std::vector<char> temp_vec(str.begin(), str.end());
+		fea::to_lower_ascii_inplace(temp_vec);
+		EXPECT_TRUE(std::equal(
+				temp_vec.begin(), temp_vec.end(), lower.begin(), lower.end()));
+		fea::to_upper_ascii_inplace(temp_vec);
+		EXPECT_TRUE(std::equal(
+				temp_vec.begin(), temp_vec.end(), upper.begin(), upper.end()));
+	}
 }
 
 TEST(string, capitalize_ascii) {
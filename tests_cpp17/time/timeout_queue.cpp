@@ -0,0 +1,141 @@
+#include <algorithm>
+#include <fea/time/timeout_queue.hpp>
+#include <gtest/gtest.h>
+#include <map>
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+namespace {
+TEST(timeout_queue, basics) {
+	fea::timeout_queue<int, std::string> q;
+	EXPECT_TRUE(q.empty());
+	EXPECT_EQ(q.size(), 0u);
+	EXPECT_FALSE(q.contains(fea::timeout_id{}));
+	EXPECT_FALSE(q.cancel(fea::timeout_id{}));
+
+	fea::timeout_id id5 = q.push(5, "5");
+	fea::timeout_id id1 = q.push(1, "1");
+	fea::timeout_id id3 = q.push(3, "3");
+	q.push(10, "10");
+	EXPECT_EQ(q.size(), 4u);
+	EXPECT_EQ(q.top_key(), 1);
+	EXPECT_TRUE(q.contains(id5));
+	EXPECT_NE(id5, id1);
+
+	std::vector<std::string> got;
+	auto gather = [&](std::string&& s) { got.push_back(std::move(s)); };
+
+	EXPECT_EQ(q.pop_until(0, gather), 0u);
+	EXPECT_TRUE(got.empty());
+
+	EXPECT_TRUE(q.cancel(id3));
+	EXPECT_FALSE(q.cancel(id3));
+	EXPECT_FALSE(q.contains(id3));
+
+	EXPECT_EQ(q.pop_until(5, gather), 2u);
+	EXPECT_EQ(got, (std::vector<std::string>{ "1", "5" }));
+	EXPECT_FALSE(q.contains(id1));
+	EXPECT_FALSE(q.cancel(id5));
+	EXPECT_EQ(q.size(), 1u);
+	EXPECT_EQ(q.top_key(), 10);
+
+	// Slots are reused, old ids stay invalid.
+	fea::timeout_id id7 = q.push(7, "7");
+	EXPECT_TRUE(q.contains(id7));
+	EXPECT_FALSE(q.contains(id1));
+	EXPECT_FALSE(q.contains(id3));
+	EXPECT_FALSE(q.contains(id5));
+
+	// Pushing while popping.
+	got.clear();
+	auto push_more = [&](std::string&& s) {
+		if (s == "7") {
+			q.push(15, "15");
+			q.push(25, "25");
+		}
+		got.push_back(std::move(s));
+	};
+	EXPECT_EQ(q.pop_until(20, push_more), 3u);
+	EXPECT_EQ(got, (std::vector<std::string>{ "7", "10", "15" }));
+	EXPECT_EQ(q.size(), 1u);
+
+	q.clear();
+	EXPECT_TRUE(q.empty());
+	EXPECT_FALSE(q.contains(id7));
+}
+
+TEST(timeout_queue, values_released) {
+	fea::timeout_queue<int, std::shared_ptr<int>> q;
+	auto ptr = std::make_shared<int>(42);
+
+	fea::timeout_id id = q.push(1, ptr);
+	q.push(2, ptr);
+	q.push(3, ptr);
+	EXPECT_EQ(ptr.use_count(), 4);
+
+	q.cancel(id);
+	EXPECT_EQ(ptr.use_count(), 3);
+
+	q.pop_until(2, [](std::shared_ptr<int>&&) {});
+	EXPECT_EQ(ptr.use_count(), 2);
+
+	q.clear();
+	EXPECT_EQ(ptr.use_count(), 1);
+}
+
+TEST(timeout_queue, random) {
+	std::mt19937 gen{ 42 };
+	std::uniform_int_distribution<unsigned> key_dis{ 0, 1'000 };
+	std::uniform_int_distribution<unsigned> op_dis{ 0, 9 };
+
+	fea::timeout_queue<unsigned, unsigned> q;
+	std::multimap<unsigned, unsigned> ref;
+	std::vector<std::pair<fea::timeout_id, unsigned>> ids;
+	unsigned now = 0;
+	unsigned next_val = 0;
+
+	for (size_t i = 0; i < 20'000; ++i) {
+		unsigned op = op_dis(gen);
+		if (op < 6) {
+			unsigned k = now + key_dis(gen);
+			unsigned v = next_val++;
+			ids.push_back({ q.push(k, v), v });
+			ref.insert({ k, v });
+		} else if (op < 8 && !ids.empty()) {
+			size_t idx = gen() % ids.size();
+			auto [id, v] = ids[idx];
+			auto it = std::find_if(ref.begin(), ref.end(),
+					[v = v](const auto& p) { return p.second == v; });
+			EXPECT_EQ(q.contains(id), it != ref.end());
+			EXPECT_EQ(q.cancel(id), it != ref.end());
+			if (it != ref.end()) {
+				ref.erase(it);
+			}
+			ids.erase(ids.begin() + idx);
+		} else {
+			now += key_dis(gen) / 4;
+			std::vector<unsigned> got;
+			q.pop_until(now, [&](unsigned v) { got.push_back(v); });
+
+			std::vector<unsigned> expected;
+			auto end = ref.upper_bound(now);
+			for (auto it = ref.begin(); it != end; ++it) {
+				expected.push_back(it->second);
+			}
+			ref.erase(ref.begin(), end);
+
+			// Equal deadlines are unordered.
+			std::sort(got.begin(), got.end());
+			std::sort(expected.begin(), expected.end());
+			EXPECT_EQ(got, expected);
+		}
+
+		ASSERT_EQ(q.size(), ref.size());
+		if (!ref.empty()) {
+			EXPECT_EQ(q.top_key(), ref.begin()->first);
+		}
+	}
+}
+} // namespace
@@ -4,6 +4,7 @@
 #include <chrono>
 #include <gtest/gtest.h>
 #include <thread>
+#include <type_traits>
 
 namespace {
 using namespace std::chrono_literals;
@@ -282,5 +283,40 @@ TEST(timer, three_years) {
 	EXPECT_EQ(years_passed, 3u);
 }
 
+TEST(timer, unsubscribe) {
+	// 1 real second = 10 years elapsed.
+	fea::timer<void()> timer{ fea::dyears(10) };
+
+	size_t num_called = 0;
+	fea::timer_elapsed_id id1 = timer.subscribe_elapsed(
+			fea::ddays(1), [&]() { ++num_called; });
+	fea::timer_elapsed_id id2 = timer.subscribe_elapsed(
+			fea::ddays(2), [&]() { ++num_called; });
+	fea::timer_time_id id3 = timer.subscribe_time(
+			fea::dsteady_seconds(timer.start_time().count() + fea::ddays(1)),
+			[&]() { ++num_called; });
+	timer.subscribe_elapsed(fea::dyears(1'000), [&]() { ++num_called; });
+	EXPECT_EQ(timer.pending_callbacks(), 4u);
+
+	// Elapsed and time ids can't be mixed up.
+	static_assert(
+			!std::is_convertible_v<fea::timer_time_id, fea::timer_elapsed_id>,
+			"timer.cpp : test failed");
+	static_assert(
+			!std::is_convertible_v<fea::timer_elapsed_id, fea::timer_time_id>,
+			"timer.cpp : test failed");
+
+	EXPECT_TRUE(timer.unsubscribe_elapsed(id2));
+	EXPECT_FALSE(timer.unsubscribe_elapsed(id2));
+	EXPECT_TRUE(timer.unsubscribe_time(id3));
+	EXPECT_EQ(timer.pending_callbacks(), 2u);
+
+	std::this_thread::sleep_for(100ms);
+	timer.update();
+	EXPECT_EQ(num_called, 1u);
+	EXPECT_EQ(timer.pending_callbacks(), 1u);
+	EXPECT_FALSE(timer.unsubscribe_elapsed(id1));
+}
+
 } // namespace
 #endif
@@ -1,6 +1,8 @@
 #include <fea/encoding/base64.hpp>
 #include <fea/utility/platform.hpp>
 #include <gtest/gtest.h>
+#include <list>
+#include <random>
 #include <string>
 #include <string_view>
 #include <vector>
@@ -293,6 +295,192 @@ TEST(base64, rfc4648) {
 	}
 }
 
+// The lenient scalar encoder, through a non-contiguous input.
+std::string slow_encode(const std::vector<uint8_t>& data) {
+	std::list<uint8_t> l{ data.begin(), data.end() };
+	std::string ret;
+	fea::to_base64(l.begin(), l.end(), std::back_inserter(ret));
+	return ret;
+}
+
+TEST(base64, kernels) {
+	struct kernel_set {
+		fea::detail::base64_encode_fn encode;
+		fea::detail::base64_decode_fn decode;
+	};
+	std::vector<kernel_set> kernels{
+		{ &fea::detail::base64_encode_none, &fea::detail::base64_decode_none },
+		{ fea::detail::base64_encode_kernel(),
+				fea::detail::base64_decode_kernel() },
+	};
+#if FEA_DISPATCH
+	if (fea::detected_isa() >= fea::isa::sse42) {
+		kernels.push_back({ &fea::detail::base64_encode_ssse3,
+				&fea::detail::base64_decode_ssse3 });
+	}
+	if (fea::detected_isa() >= fea::isa::avx2) {
+		kernels.push_back({ &fea::detail::base64_encode_avx2,
+				&fea::detail::base64_decode_avx2 });
+	}
+#endif
+
+	std::mt19937 gen{ 42 };
+	for (size_t size = 0; size < 400; ++size) {
+		std::vector<uint8_t> data(size);
+		for (uint8_t& b : data) {
+			b = uint8_t(gen());
+		}
+		const std::string expected = slow_encode(data);
+		ASSERT_EQ(expected.size(), fea::base64_encoded_size(size));
+		ASSERT_EQ(fea::base64_decoded_size(expected), size);
+
+		for (const kernel_set& k : kernels) {
+			// Encode, guard byte after the output.
+			std::string enc(expected.size() + 1, '#');
+			size_t consumed = k.encode(data.data(), size, enc.data());
+			EXPECT_EQ(consumed % 3, 0u);
+			fea::detail::base64_encode_scalar(data.data() + consumed,
+					size - consumed, enc.data() + consumed / 3 * 4);
+			EXPECT_EQ(enc.back(), '#');
+			enc.pop_back();
+			EXPECT_EQ(enc, expected);
+
+			// Decode, the kernel never writes past the body.
+			std::vector<uint8_t> dec(size + 1, 0xAB);
+			size_t body = expected.empty() ? 0 : expected.size() - 4;
+			size_t read = k.decode(expected.data(), body, dec.data());
+			EXPECT_EQ(read % 4, 0u);
+			EXPECT_LE(read, body);
+			EXPECT_TRUE(std::equal(
+					dec.begin(), dec.begin() + read / 4 * 3, data.begin()));
+			for (size_t i = body / 4 * 3; i < dec.size(); ++i) {
+				EXPECT_EQ(dec[i], 0xAB);
+			}
+		}
+
+		// Public api.
+		std::string enc(expected.size(), '\0');
+		fea::to_base64(std::as_bytes(std::span{ data }), enc.data());
+		EXPECT_EQ(enc, expected);
+
+		std::vector<std::byte> dec(size);
+		fea::base64_result res = fea::from_base64(enc, dec.data());
+		EXPECT_TRUE(res.valid());
+		EXPECT_EQ(res.size, size);
+		EXPECT_TRUE(std::equal(dec.begin(), dec.end(),
+				std::as_bytes(std::span{ data }).begin()));
+	}
+}
+
+TEST(base64, validation) {
+	std::mt19937 gen{ 42 };
+	std::vector<uint8_t> data(200);
+	for (uint8_t& b : data) {
+		b = uint8_t(gen());
+	}
+	const std::string valid = slow_encode(data);
+
+	auto is_b64 = [](char c) {
+		return (c >= 'A' && c <= 'Z') || (c >= 'a' && c <= 'z')
+				|| (c >= '0' && c <= '9') || c == '+' || c == '/';
+	};
+
+	// Every byte value, at positions in simd blocks and tails.
+	for (size_t pos : { size_t(0), size_t(5), size_t(17), size_t(31),
+				 size_t(100), valid.size() - 5, valid.size() - 1 }) {
+		for (int c = 0; c < 256; ++c) {
+			std::string str = valid;
+			str[pos] = char(c);
+			std::vector<std::byte> dec(fea::base64_decoded_size(str));
+			fea::base64_result res = fea::from_base64(str, dec.data());
+
+			bool expect_valid = is_b64(char(c));
+			if (pos == valid.size() - 1 && char(c) == '=') {
+				// Valid padding, if the trailing bits are 0.
+				continue;
+			}
+			EXPECT_EQ(res.valid(), expect_valid) << pos << " " << c;
+			if (!expect_valid) {
+				EXPECT_EQ(res.invalid_idx, pos) << pos << " " << c;
+			}
+		}
+	}
+
+	std::vector<std::byte> out(8);
+	auto check = [&](std::string_view str, size_t invalid_idx, size_t size) {
+		fea::base64_result res = fea::from_base64(str, out.data());
+		EXPECT_EQ(res.invalid_idx, invalid_idx) << str;
+		if (res.valid()) {
+			EXPECT_EQ(res.size, size) << str;
+		}
+	};
+	constexpr size_t npos = fea::base64_result::npos;
+	check("", npos, 0);
+	check("Zg==", npos, 1);
+	check("Zm8=", npos, 2);
+	check("Zm9v", npos, 3);
+	check("Zm9vYg==", npos, 4);
+
+	// Misplaced padding.
+	check("Z===", 1, 0);
+	check("====", 0, 0);
+	check("Zg=v", 2, 0);
+	check("Zg==Zg==", 2, 0);
+
+	// Truncated.
+	check("Z", 1, 0);
+	check("Zm9", 3, 0);
+	check("Zm9vY", 5, 0);
+	check("Zm9vYg", 6, 0);
+}
+
+TEST(base64, iterators) {
+	std::mt19937 gen{ 42 };
+	for (size_t size : { size_t(0), size_t(1), size_t(2), size_t(47),
+				 size_t(767), size_t(768), size_t(769), size_t(5'000) }) {
+		std::vector<uint8_t> data(size);
+		for (uint8_t& b : data) {
+			b = uint8_t(gen());
+		}
+		const std::string expected = slow_encode(data);
+
+		// Contiguous output.
+		std::string enc(expected.size(), '\0');
+		fea::to_base64(data.begin(), data.end(), enc.begin());
+		EXPECT_EQ(enc, expected);
+
+		// Blocks through an output iterator.
+		enc.clear();
+		fea::to_base64(data.begin(), data.end(), std::back_inserter(enc));
+		EXPECT_EQ(enc, expected);
+
+		std::vector<uint8_t> dec(size);
+		fea::from_base64(enc.begin(), enc.end(), dec.begin());
+		EXPECT_EQ(dec, data);
+
+		dec.clear();
+		fea::from_base64(enc.begin(), enc.end(), std::back_inserter(dec));
+		EXPECT_EQ(dec, data);
+
+		// Scalar decoder, non-contiguous input.
+		std::list<char> l{ enc.begin(), enc.end() };
+		dec.clear();
+		fea::from_base64(l.begin(), l.end(), std::back_inserter(dec));
+		EXPECT_EQ(dec, data);
+	}
+
+	// Invalid input keeps the lenient behavior.
+	{
+		std::string enc = "Zm9v\nYmF";
+		std::string dec;
+		fea::from_base64(enc.begin(), enc.end(), std::back_inserter(dec));
+		std::list<char> l{ enc.begin(), enc.end() };
+		std::string dec2;
+		fea::from_base64(l.begin(), l.end(), std::back_inserter(dec2));
+		EXPECT_EQ(dec, dec2);
+	}
+}
+
 TEST(base64, crypto_lib_tests) {
 	// TODO
 #if 0
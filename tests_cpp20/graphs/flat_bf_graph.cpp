@@ -1,5 +1,10 @@
+#include <algorithm>
+#include <atomic>
 #include <fea/graphs/flat_bf_graph.hpp>
 #include <gtest/gtest.h>
+#include <map>
+#include <random>
+#include <vector>
 
 namespace fea {
 using namespace fea::experimental;
@@ -269,4 +274,385 @@ TEST(flat_bf_graph, basics) {
 	}
 }
 
+// Reference topology, used to validate patches.
+struct ref_graph {
+	using id_t = uint32_t;
+	using builder_t = fea::flat_bf_graph_builder<id_t, id_t>;
+
+	void push_back(id_t parent, id_t k) {
+		parents[k] = parent;
+		children[parent].push_back(k);
+	}
+
+	void detach(id_t k) {
+		std::vector<id_t>& siblings = children[parents.at(k)];
+		siblings.erase(std::find(siblings.begin(), siblings.end(), k));
+	}
+
+	void reparent(id_t k, id_t parent) {
+		detach(k);
+		push_back(parent, k);
+	}
+
+	void erase(id_t k) {
+		detach(k);
+		std::vector<id_t> to_erase{ k };
+		while (!to_erase.empty()) {
+			id_t e = to_erase.back();
+			to_erase.pop_back();
+			to_erase.insert(
+					to_erase.end(), children[e].begin(), children[e].end());
+			children.erase(e);
+			parents.erase(e);
+		}
+	}
+
+	bool in_subtree(id_t k, id_t root) const {
+		for (id_t p = k; p != builder_t::root_key(); p = parents.at(p)) {
+			if (p == root) {
+				return true;
+			}
+		}
+		return false;
+	}
+
+	builder_t make_builder() {
+		builder_t ret;
+		std::vector<id_t> breadth = children[builder_t::root_key()];
+		for (id_t k : breadth) {
+			ret.push_back(k, k);
+		}
+		while (!breadth.empty()) {
+			std::vector<id_t> next;
+			for (id_t p : breadth) {
+				for (id_t k : children[p]) {
+					ret.push_back(p, k, k);
+					next.push_back(k);
+				}
+			}
+			breadth = std::move(next);
+		}
+		return ret;
+	}
+
+	// Key -> parent. Roots use the root key.
+	std::map<id_t, id_t> parents;
+	// Ordered children. Roots are stored at the root key.
+	std::map<id_t, std::vector<id_t>> children;
+};
+
+template <class Graph>
+void compare_graphs(const Graph& graph, const Graph& expected) {
+	using id_t = typename Graph::key_type;
+	ASSERT_EQ(graph.size(), expected.size());
+	ASSERT_EQ(graph.breadth_size(), expected.breadth_size());
+	EXPECT_GE(graph.lookup_capacity(), graph.capacity());
+
+	std::span<const id_t> keys = graph.keys();
+	std::span<const id_t> expected_keys = expected.keys();
+	for (size_t i = 0; i < keys.size(); ++i) {
+		ASSERT_EQ(keys[i], expected_keys[i]);
+		EXPECT_EQ(graph.index(keys[i]), i);
+		EXPECT_EQ(graph[i], keys[i]);
+		EXPECT_EQ(graph.parents()[i], expected.parents()[i]);
+
+		std::span<const id_t> children = graph.children()[i];
+		std::span<const id_t> expected_children = expected.children()[i];
+		ASSERT_EQ(children.size(), expected_children.size());
+		EXPECT_TRUE(std::equal(children.begin(), children.end(),
+				expected_children.begin()));
+		if (!children.empty()) {
+			EXPECT_GE(children.data(), keys.data());
+			EXPECT_LT(children.data(), keys.data() + keys.size());
+		}
+	}
+
+	for (size_t i = 0; i < graph.breadth_size(); ++i) {
+		EXPECT_EQ(graph.breadth(i).size(), expected.breadth(i).size());
+		EXPECT_EQ(graph.breadth(i).data() - keys.data(),
+				expected.breadth(i).data() - expected_keys.data());
+	}
+}
+
+TEST(flat_bf_graph, patch) {
+	using id_t = uint32_t;
+	using graph_t = fea::flat_bf_graph<id_t, id_t>;
+	using patch_t = typename graph_t::patch_t;
+	constexpr id_t root = graph_t::root_key();
+
+	std::mt19937 gen{ 42 };
+	ref_graph ref;
+	id_t next_id = 0;
+
+	// A random forest, a few levels deep.
+	for (size_t i = 0; i < 200; ++i) {
+		id_t parent = root;
+		if (!ref.parents.empty() && gen() % 8 != 0) {
+			auto it = ref.parents.begin();
+			std::advance(it, gen() % ref.parents.size());
+			parent = it->first;
+		}
+		ref.push_back(parent, next_id++);
+	}
+
+	graph_t graph{ ref.make_builder() };
+	{
+		graph_t expected{ ref.make_builder() };
+		compare_graphs(graph, expected);
+	}
+
+	auto random_key = [&]() {
+		auto it = ref.parents.begin();
+		std::advance(it, gen() % ref.parents.size());
+		return it->first;
+	};
+
+	for (size_t run = 0; run < 50; ++run) {
+		patch_t patch;
+		size_t num_ops = 1 + gen() % 10;
+		for (size_t i = 0; i < num_ops; ++i) {
+			switch (gen() % 4) {
+			case 0: {
+				// Insert a small subtree.
+				id_t parent = gen() % 16 == 0 ? root : random_key();
+				id_t k = next_id++;
+				patch.push_back(parent, k, k);
+				ref.push_back(parent, k);
+				for (size_t j = 0; j < gen() % 4; ++j) {
+					id_t c = next_id++;
+					patch.push_back(k, c, c);
+					ref.push_back(k, c);
+				}
+			} break;
+			case 1: {
+				if (ref.parents.size() < 50) {
+					break;
+				}
+				id_t k = random_key();
+				patch.erase(k);
+				ref.erase(k);
+			} break;
+			default: {
+				id_t k = random_key();
+				id_t parent = gen() % 16 == 0 ? root : random_key();
+				if (parent != root && ref.in_subtree(parent, k)) {
+					break;
+				}
+				patch.reparent(k, parent);
+				ref.reparent(k, parent);
+			} break;
+			}
+		}
+
+		graph.apply(std::move(patch));
+		EXPECT_TRUE(patch.empty());
+
+		graph_t expected{ ref.make_builder() };
+		compare_graphs(graph, expected);
+		for (id_t k = 0; k < next_id; ++k) {
+			EXPECT_EQ(graph.contains(k), ref.parents.contains(k));
+		}
+	}
+
+	// Untouched breadths aren't relocated.
+	{
+		id_t leaf = graph.breadth(graph.breadth_size() - 1).front();
+		const id_t* first_keys = graph.keys().data();
+		const id_t* first_values = graph.values().data();
+		graph.reserve(graph.size() + 4);
+		patch_t patch;
+		patch.push_back(leaf, next_id, next_id);
+		ref.push_back(leaf, next_id);
+		++next_id;
+		graph.apply(std::move(patch));
+		EXPECT_EQ(graph.keys().data(), first_keys);
+		EXPECT_EQ(graph.values().data(), first_values);
+		graph_t expected{ ref.make_builder() };
+		compare_graphs(graph, expected);
+	}
+
+	// Ops can build on previous ops of the same patch.
+	{
+		patch_t patch;
+		id_t a = next_id++;
+		id_t b = next_id++;
+		patch.push_back(root, a, a);
+		patch.push_back(a, b, b);
+		patch.reparent(b, root);
+		patch.erase(a);
+		ref.push_back(root, a);
+		ref.push_back(a, b);
+		ref.reparent(b, root);
+		ref.erase(a);
+		graph.apply(std::move(patch));
+		EXPECT_FALSE(graph.contains(a));
+		EXPECT_TRUE(graph.is_root(b));
+		graph_t expected{ ref.make_builder() };
+		compare_graphs(graph, expected);
+	}
+
+	// Erased keys can be reinserted in the same patch, without their old
+	// subtree.
+	{
+		id_t k = root;
+		for (id_t key : graph.keys()) {
+			if (!graph.children(key).empty()) {
+				k = key;
+				break;
+			}
+		}
+		ASSERT_NE(k, root);
+		id_t c = graph.children(k).front();
+		id_t n = next_id++;
+
+		patch_t patch;
+		patch.erase(k);
+		patch.push_back(root, k, k);
+		patch.push_back(k, c, c);
+		patch.push_back(c, n, n);
+		patch.erase(c);
+		patch.push_back(k, c, c);
+		ref.erase(k);
+		ref.push_back(root, k);
+		ref.push_back(k, c);
+		ref.push_back(c, n);
+		ref.erase(c);
+		ref.push_back(k, c);
+		graph.apply(std::move(patch));
+
+		EXPECT_TRUE(graph.is_root(k));
+		EXPECT_EQ(graph.children(k).size(), 1u);
+		EXPECT_EQ(graph.parent(c), k);
+		EXPECT_TRUE(graph.children(c).empty());
+		EXPECT_FALSE(graph.contains(n));
+		graph_t expected{ ref.make_builder() };
+		compare_graphs(graph, expected);
+		for (id_t key = 0; key < next_id; ++key) {
+			EXPECT_EQ(graph.contains(key), ref.parents.contains(key));
+		}
+	}
+
+	// Invalid operations.
+	{
+		id_t k = graph.breadth(0).front();
+		id_t child = graph.children(k).empty() ? next_id : graph.children(k)[0];
+		patch_t p1;
+		p1.push_back(root, k, k);
+		patch_t p2;
+		p2.erase(next_id + 10);
+		patch_t p3;
+		p3.reparent(k, child);
+#if FEA_DEBUG || FEA_NOTHROW
+		EXPECT_DEATH(graph.apply(std::move(p1)), "");
+		EXPECT_DEATH(graph.apply(std::move(p2)), "");
+		if (child != next_id) {
+			EXPECT_DEATH(graph.apply(std::move(p3)), "");
+		}
+#else
+		EXPECT_THROW(graph.apply(std::move(p1)), std::invalid_argument);
+		EXPECT_THROW(graph.apply(std::move(p2)), std::invalid_argument);
+		if (child != next_id) {
+			EXPECT_THROW(graph.apply(std::move(p3)), std::invalid_argument);
+		}
+#endif
+	}
+
+	// Empty graph.
+	{
+		graph_t empty_graph;
+		patch_t patch;
+		patch.push_back(root, 0u, 0u);
+		patch.push_back(0u, 1u, 1u);
+		empty_graph.apply(std::move(patch));
+		EXPECT_EQ(empty_graph.size(), 2u);
+		EXPECT_EQ(empty_graph.breadth_size(), 2u);
+		EXPECT_EQ(empty_graph.parent(1u), 0u);
+		EXPECT_EQ(empty_graph.children(0u).front(), 1u);
+	}
+}
+TEST(flat_bf_graph, evaluate_parallel) {
+	using id_t = uint32_t;
+	struct node {
+		size_t depth = 0;
+		id_t parent = 0;
+	};
+	using graph_t = fea::flat_bf_graph<id_t, node>;
+
+	// Wide random tree.
+	std::mt19937 gen{ 42 };
+	fea::flat_bf_graph_builder<id_t, node> builder;
+	constexpr id_t num_roots = 8;
+	constexpr id_t num_nodes = 20'000;
+	for (id_t i = 0; i < num_roots; ++i) {
+		builder.push_back(i, node{});
+	}
+	for (id_t i = num_roots; i < num_nodes; ++i) {
+		builder.push_back(id_t(gen() % i), i, node{});
+	}
+	graph_t graph{ std::move(builder) };
+
+	auto eval = [](const id_t&, node& n, const node* parent) {
+		n.depth = parent == nullptr ? 0 : parent->depth + 1;
+	};
+
+	graph.evaluate_parallel(eval, 16);
+	for (size_t b = 0; b < graph.breadth_size(); ++b) {
+		for (id_t k : graph.breadth(b)) {
+			EXPECT_EQ(graph.at(k).depth, b);
+		}
+	}
+
+	// Parents are provided.
+	graph.evaluate_parallel(
+			[&](const id_t& k, node& n, const node* parent) {
+				if (parent == nullptr) {
+					EXPECT_TRUE(graph.is_root(k));
+					return;
+				}
+				EXPECT_EQ(parent, &graph.at(graph.parent(k)));
+				n.parent = graph.parent(k);
+			},
+			64);
+
+	// Same results serially.
+	std::vector<node> expected(graph.values().begin(), graph.values().end());
+	for (node& n : graph) {
+		n = {};
+	}
+	graph.evaluate(eval);
+	graph.evaluate([&](const id_t& k, node& n, const node*) {
+		if (!graph.is_root(k)) {
+			n.parent = graph.parent(k);
+		}
+	});
+	for (size_t i = 0; i < expected.size(); ++i) {
+		EXPECT_EQ(graph[i].depth, expected[i].depth);
+		EXPECT_EQ(graph[i].parent, expected[i].parent);
+	}
+
+	// Ranges never span breadths, and cover everything once.
+	std::atomic<size_t> count{ 0 };
+	graph.for_each_breadth_parallel(
+			[&](std::span<const id_t> keys, std::span<node> values) {
+				EXPECT_EQ(keys.size(), values.size());
+				size_t depth = values.front().depth;
+				for (const node& n : values) {
+					EXPECT_EQ(n.depth, depth);
+				}
+				count += keys.size();
+			},
+			32);
+	EXPECT_EQ(count, graph.size());
+
+	// Small breadths are given whole.
+	size_t num_breadths = 0;
+	graph.for_each_breadth_parallel(
+			[&](std::span<const id_t> keys, std::span<node>) {
+				EXPECT_EQ(keys.data(), graph.breadth(num_breadths).data());
+				EXPECT_EQ(keys.size(), graph.breadth(num_breadths).size());
+				++num_breadths;
+			},
+			num_nodes);
+	EXPECT_EQ(num_breadths, graph.breadth_size());
+}
 } // namespace
@@ -0,0 +1,223 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstring>
+#include <fea/performance/profiler.hpp>
+#include <fea/state_machines/fsm.hpp>
+#include <fea/utility/file.hpp>
+#include <filesystem>
+#include <gtest/gtest.h>
+#include <string>
+#include <thread>
+#include <vector>
+
+extern const char* argv0;
+
+namespace {
+std::vector<fea::profile::zone_record> collect_named(const char* name) {
+	std::vector<fea::profile::zone_record> ret = fea::profile::collect();
+	ret.erase(std::remove_if(ret.begin(), ret.end(),
+					  [&](const fea::profile::zone_record& z) {
+						  return std::strcmp(z.name, name) != 0;
+					  }),
+			ret.end());
+	return ret;
+}
+
+void record(size_t count) {
+	for (size_t i = 0; i < count; ++i) {
+		FEA_PROFILE_ZONE("profiler record");
+	}
+}
+
+TEST(profiler, basics) {
+	static_assert(FEA_PROFILE, "profiler.cpp : profiling should be enabled");
+	fea::profile::clear();
+
+	{
+		FEA_PROFILE_ZONE("profiler outer");
+		std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		{
+			FEA_PROFILE_ZONE("profiler inner");
+			std::this_thread::sleep_for(std::chrono::milliseconds(1));
+		}
+	}
+
+	std::vector<fea::profile::zone_record> outer
+			= collect_named("profiler outer");
+	std::vector<fea::profile::zone_record> inner
+			= collect_named("profiler inner");
+	ASSERT_EQ(outer.size(), 1u);
+	ASSERT_EQ(inner.size(), 1u);
+	EXPECT_EQ(outer[0].thread_id, inner[0].thread_id);
+	EXPECT_LT(outer[0].begin, inner[0].begin);
+	EXPECT_LT(inner[0].end, outer[0].end);
+
+	// Roughly converted to nanoseconds.
+	EXPECT_GT(outer[0].end - outer[0].begin, 1'500'000.0);
+	EXPECT_LT(outer[0].end - outer[0].begin, 1'000'000'000.0);
+	EXPECT_GT(inner[0].end - inner[0].begin, 500'000.0);
+
+	// Collecting doesn't consume, clearing does.
+	EXPECT_EQ(collect_named("profiler outer").size(), 1u);
+	fea::profile::clear();
+	EXPECT_TRUE(collect_named("profiler outer").empty());
+}
+
+TEST(profiler, threads) {
+	fea::profile::clear();
+
+	constexpr size_t num_threads = 4;
+	constexpr size_t num_zones = 1'000;
+	std::atomic<bool> done{ false };
+
+	// Collects while threads record.
+	std::thread collector([&]() {
+		while (!done.load()) {
+			std::vector<fea::profile::zone_record> zones
+					= fea::profile::collect();
+			for (const fea::profile::zone_record& z : zones) {
+				EXPECT_NE(z.name, nullptr);
+				EXPECT_LE(z.begin, z.end);
+			}
+		}
+	});
+
+	std::vector<std::thread> threads;
+	for (size_t i = 0; i < num_threads; ++i) {
+		threads.emplace_back([=]() {
+			fea::profile::thread_name("profiler thread " + std::to_string(i));
+			record(num_zones);
+		});
+	}
+	for (std::thread& t : threads) {
+		t.join();
+	}
+	done = true;
+	collector.join();
+
+	std::vector<fea::profile::zone_record> zones
+			= collect_named("profiler record");
+	EXPECT_EQ(zones.size(), num_threads * num_zones);
+
+	// Each thread has its own id, zones are sorted per thread.
+	std::vector<uint32_t> ids;
+	for (size_t i = 0; i < zones.size(); ++i) {
+		if (ids.empty() || ids.back() != zones[i].thread_id) {
+			ids.push_back(zones[i].thread_id);
+		} else {
+			EXPECT_LE(zones[i - 1].begin, zones[i].begin);
+		}
+	}
+	std::sort(ids.begin(), ids.end());
+	EXPECT_EQ(std::unique(ids.begin(), ids.end()), ids.end());
+	EXPECT_EQ(ids.size(), num_threads);
+}
+
+TEST(profiler, ring_buffer) {
+	fea::profile::clear();
+
+	// Only affects new threads.
+	fea::profile::buffer_capacity(10);
+	std::thread t([]() { record(100); });
+	t.join();
+	fea::profile::buffer_capacity(size_t(1) << 16);
+
+	// Keeps the most recent zones. The oldest slot could be in the process
+	// of being overwritten and is skipped.
+	std::vector<fea::profile::zone_record> zones
+			= collect_named("profiler record");
+	EXPECT_EQ(zones.size(), 15u);
+}
+
+TEST(profiler, thread_exit) {
+	fea::profile::clear();
+	const fea::profile::detail::registry& reg
+			= fea::profile::detail::get_registry();
+	const size_t num_buffers = reg.buffers.size();
+
+	// Nothing left to collect, freed on exit.
+	std::thread t([]() {
+		record(10);
+		fea::profile::clear();
+	});
+	t.join();
+	EXPECT_EQ(reg.buffers.size(), num_buffers);
+
+	// Zones of exited threads are kept until cleared.
+	t = std::thread([]() { record(10); });
+	t.join();
+	EXPECT_EQ(reg.buffers.size(), num_buffers + 1);
+	EXPECT_EQ(collect_named("profiler record").size(), 10u);
+
+	fea::profile::clear();
+	EXPECT_EQ(reg.buffers.size(), num_buffers);
+	EXPECT_TRUE(collect_named("profiler record").empty());
+
+	// Zones recorded after the reaper ran, the buffer is never freed.
+	struct late_recorder {
+		~late_recorder() {
+			record(10);
+		}
+	};
+	t = std::thread([]() {
+		// Destroyed after the reaper, which is created by the first zone.
+		thread_local late_recorder late;
+		record(10);
+		fea::profile::clear();
+	});
+	t.join();
+	EXPECT_EQ(reg.buffers.size(), num_buffers + 1);
+	EXPECT_EQ(collect_named("profiler record").size(), 10u);
+
+	fea::profile::clear();
+	EXPECT_EQ(reg.buffers.size(), num_buffers + 1);
+	EXPECT_TRUE(collect_named("profiler record").empty());
+}
+
+TEST(profiler, chrome_trace) {
+	fea::profile::clear();
+	fea::profile::thread_name("profiler \"main\"");
+	record(10);
+
+	const std::filesystem::path dir = fea::executable_dir(argv0) / "tests_data";
+	std::filesystem::create_directory(dir);
+	const std::filesystem::path filepath = dir / "profiler_trace.json";
+	ASSERT_TRUE(fea::profile::write_chrome_trace(filepath));
+
+	std::string trace;
+	{
+		std::FILE* f = fea::fopen(filepath, "rb");
+		ASSERT_NE(f, nullptr);
+		char buf[4096];
+		size_t read_size = 0;
+		while ((read_size = std::fread(buf, 1, sizeof(buf), f)) > 0) {
+			trace.append(buf, read_size);
+		}
+		std::fclose(f);
+	}
+
+	EXPECT_EQ(trace.find("{\n\"traceEvents\": ["), 0u);
+	EXPECT_NE(trace.find("\"name\": \"profiler \\\"main\\\"\""),
+			std::string::npos);
+	EXPECT_NE(trace.find("\"name\": \"profiler record\", \"ph\": \"X\""),
+			std::string::npos);
+	EXPECT_NE(trace.find("\"displayTimeUnit\": \"ns\""), std::string::npos);
+}
+
+TEST(profiler, instrumentation) {
+	fea::profile::clear();
+
+	enum class state { idle, count };
+	enum class transition { count };
+
+	fea::fsm_builder<transition, state, void()> builder;
+	auto machine = builder.make_machine();
+	auto idle = machine.make_state();
+	machine.add_state<state::idle>(std::move(idle));
+
+	machine.update();
+	machine.update();
+	EXPECT_EQ(collect_named("fea::fsm::update").size(), 2u);
+}
+} // namespace